@@ -28,12 +28,19 @@
 #ifndef Q_DEBUGSTREAM_H_
 #define Q_DEBUGSTREAM_H_
 
+#include <fstream>
 #include <iostream>
+#include <mutex>
 #include <streambuf>
 #include <string>
 
 #include <QPlainTextEdit>
+#include <QThread>
+#include <QTimer>
 
+///	Redirects a stream to a QPlainTextEdit.
+/**	Lines which are written from threads other than the thread of the text edit
+ * are buffered and appended by a timer on the thread of the text edit.*/
 class Q_DebugStream : public std::basic_streambuf<char>
 {
 public:
@@ -42,10 +49,16 @@ public:
 		log_window = text_edit;
 		m_old_buf = stream.rdbuf();
 		stream.rdbuf(this);
+
+		QTimer* flushTimer = new QTimer(log_window);
+		QObject::connect(flushTimer, &QTimer::timeout,
+						 [this](){flush_pending_lines();});
+		flushTimer->start(100);
 	}
 	~Q_DebugStream()
 	{
 		// output anything that is left
+		flush_pending_lines();
 		if (!m_string.empty()){
 			log_window->moveCursor (QTextCursor::End);
 			log_window->insertPlainText (m_string.c_str());
@@ -63,15 +76,10 @@ public:
 protected:
 	virtual int_type overflow(int_type v)
 	{
+		std::lock_guard<std::recursive_mutex> lock(m_mutex);
 		if (v == '\n')
 		{
-			if(m_file)
-				m_file << m_string << std::endl;
-			log_window->moveCursor (QTextCursor::End);
-			log_window->insertPlainText (m_string.c_str());
-			log_window->insertPlainText("\n");
-			log_window->moveCursor (QTextCursor::End);
-			log_window->repaint();
+			write_line(m_string);
 			m_string.erase(m_string.begin(), m_string.end());
 		}
 		else
@@ -82,6 +90,7 @@ protected:
 
 	virtual std::streamsize xsputn(const char *p, std::streamsize n)
 	{
+		std::lock_guard<std::recursive_mutex> lock(m_mutex);
 		m_string.append(p, p + n);
 
 		size_t pos = 0;
@@ -91,14 +100,7 @@ protected:
 			if (pos != std::string::npos)
 			{
 				std::string tmp(m_string.begin(), m_string.begin() + pos);
-				if(m_file)
-					m_file << tmp << std::endl;
-
-				log_window->moveCursor (QTextCursor::End);
-				log_window->insertPlainText (QString::fromUtf8(tmp.c_str()));
-				log_window->insertPlainText("\n");
-				log_window->moveCursor (QTextCursor::End);
-				log_window->repaint();
+				write_line(tmp);
 				m_string.erase(m_string.begin(), m_string.begin() + pos + 1);
 			}
 		}
@@ -106,10 +108,47 @@ protected:
 		return n;
 	}
 
+///	writes a line to the file and to the text edit. m_mutex has to be locked.
+	void write_line(const std::string& line)
+	{
+		if(m_file)
+			m_file << line << std::endl;
+
+		if(QThread::currentThread() != log_window->thread()){
+			m_pendingLines.append(line).append("\n");
+			return;
+		}
+
+		flush_pending_lines();
+		insert_text(QString::fromUtf8(line.c_str()).append("\n"));
+	}
+
+	void insert_text(const QString& text)
+	{
+		log_window->moveCursor (QTextCursor::End);
+		log_window->insertPlainText (text);
+		log_window->moveCursor (QTextCursor::End);
+		log_window->repaint();
+	}
+
+///	appends the lines which were written by other threads. Called on the thread of the text edit.
+	void flush_pending_lines()
+	{
+		std::string lines;
+		{
+			std::lock_guard<std::recursive_mutex> lock(m_mutex);
+			lines.swap(m_pendingLines);
+		}
+		if(!lines.empty())
+			insert_text(QString::fromUtf8(lines.c_str()));
+	}
+
 private:
 	std::ostream &m_stream;
 	std::streambuf *m_old_buf;
 	std::string m_string;
+	std::string m_pendingLines;
+	std::recursive_mutex m_mutex;
 	std::ofstream m_file;
 	QPlainTextEdit* log_window;
 };
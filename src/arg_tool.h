@@ -5,6 +5,8 @@
 #define __H__PROMESH_arg_tool
 
 #include <sstream>
+#include <string>
+#include <vector>
 
 class ArgTool {
 public:
@@ -45,6 +47,20 @@ public:
 		return defVal;
 	}
 
+	///	returns all arguments which follow the given parameter up to the next parameter
+	std::vector<std::string> get_strings (const std::string& name,
+	                                      const std::string& desc)
+	{
+		add_help_entry (name, desc);
+		std::vector<std::string> vals;
+		int pi = param_index (name);
+		if(pi >= 0){
+			for(int i = pi + 1; i < m_argc && m_argv[i][0] != '-'; ++i)
+				vals.push_back(m_argv[i]);
+		}
+		return vals;
+	}
+
 	const std::string get_help () const
 	{
 		return m_help.str();
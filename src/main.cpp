@@ -31,10 +31,12 @@
 #include <clocale>
 #include <cstring>
 #include <QFileOpenEvent>
+#include <memory>
 #include "app.h"
 #include "arg_tool.h"
 #include "docugen.h"
 #include "scripting.h"
+#include "scene/lg_object_loader.h"
 #include "tools/standard_tools.h"
 #include "bridge/bridge.h"
 #include "common/util/path_provider.h"
@@ -70,11 +72,9 @@ class MyApplication : public QApplication
 				if(foe){
 					QString str = foe->file();
 					if(m_pMainWindow){
-						if(m_pMainWindow->load_grid_from_file(str.toLocal8Bit().constData()))
-						{
-							m_pMainWindow->settings().setValue("file-path",
-												QFileInfo(str).absolutePath());
-						}
+						m_pMainWindow->load_grid_in_background(str.toLocal8Bit().constData());
+						m_pMainWindow->settings().setValue("file-path",
+											QFileInfo(str).absolutePath());
 					}
 					return true;
 				}
@@ -136,9 +136,11 @@ int main(int argc, char *argv[])
 	                                          "-in and -out options. Please use the -help parameter\n"
 	                                          "for more information.");
 
-		string inFile = args.get_string ("-in", "",
-									"(filename): Loads a mesh for script processing.\n"
-									"Only relevant if '-script ...' is specified.");
+		vector<string> inFiles = args.get_strings ("-in",
+									"(filenames): Loads one or more meshes. Several files\n"
+									"are loaded concurrently. For script processing they are\n"
+									"merged into one mesh, otherwise each file is loaded\n"
+									"into a separate object.");
 
 		string outFile = args.get_string ("-out", "",
 									"(filename): The resulting mesh from script processing\n"
@@ -173,10 +175,25 @@ int main(int argc, char *argv[])
 				}
 
 		    	LGObject* obj = new LGObject();
-		    	if(!inFile.empty()){
-		    		cout << "loading mesh from '" << inFile.c_str() << "'\n";
-		    		UG_COND_THROW(!LoadLGObjectFromFile(obj, inFile.c_str(), false),
-		    		              	"Failed to load file " << inFile);
+		    	if(inFiles.size() == 1){
+		    		cout << "loading mesh from '" << inFiles[0].c_str() << "'\n";
+		    		UG_COND_THROW(!LoadLGObjectFromFile(obj, inFiles[0].c_str(), false),
+		    		              	"Failed to load file " << inFiles[0]);
+		    	}
+		    	else if(inFiles.size() > 1){
+		    	//	load all files concurrently and merge them in the given order
+		    		vector<unique_ptr<LGObjectLoader> > loaders;
+		    		for(size_t i = 0; i < inFiles.size(); ++i){
+		    			cout << "loading mesh from '" << inFiles[i].c_str() << "'\n";
+		    			loaders.push_back(unique_ptr<LGObjectLoader>(new LGObjectLoader(inFiles[i])));
+		    		}
+
+		    		for(size_t i = 0; i < loaders.size(); ++i){
+		    			loaders[i]->wait();
+		    			unique_ptr<LGObject> loadedObj(loaders[i]->take_object());
+		    			UG_COND_THROW(!loadedObj, "Failed to load file " << inFiles[i]);
+		    			MergeLGObject(obj, loadedObj.get(), true);
+		    		}
 		    	}
 		    	else if(argv[1][0] != '-'){
 		    		cout << "loading mesh from '" << argv[1] << "'\n";
@@ -262,14 +279,25 @@ int main(int argc, char *argv[])
 
 	setlocale(LC_NUMERIC, "C");
 
+//	files which are passed as leading arguments or through -in are loaded
+//	concurrently and added to the scene in the given order.
+	vector<string> filesToLoad;
 	for(int i = 1; i < argc; ++i){
 		if(argv[i][0] == '-')
 			break;
+		filesToLoad.push_back(argv[i]);
+	}
 
-		if(pMainWindow->load_grid_from_file(argv[i])){
-			pMainWindow->settings().setValue("file-path",
-											 QFileInfo(argv[i]).absolutePath());
-		}
+	{
+		ArgTool args(argc, (const char**) argv);
+		vector<string> inFiles = args.get_strings ("-in", "");
+		filesToLoad.insert(filesToLoad.end(), inFiles.begin(), inFiles.end());
+	}
+
+	for(size_t i = 0; i < filesToLoad.size(); ++i){
+		pMainWindow->load_grid_in_background(filesToLoad[i].c_str());
+		pMainWindow->settings().setValue("file-path",
+										 QFileInfo(filesToLoad[i].c_str()).absolutePath());
 	}
 
 	// dlg->show();
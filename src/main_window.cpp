@@ -25,7 +25,9 @@
  * GNU Lesser General Public License for more details.
  */
 
+#include <algorithm>
 #include <iostream>
+#include <set>
 #include <QtWidgets>
 #include <QDesktopServices>
 #include <boost/archive/xml_oarchive.hpp>
@@ -34,6 +36,8 @@
 #include "view3d/view3d.h"
 #include "scene/lg_scene.h"
 #include "scene/csg_object.h"
+#include "scene/lg_object_loader.h"
+#include "scene/partial_load.h"
 #include "scene_inspector.h"
 #include "scene_item_model.h"
 #include "QDebugStream.h"
@@ -42,8 +46,10 @@
 #include "lib_grid/file_io/file_io_ugx.h"
 #include "lib_grid/file_io/file_io_lgb.h"
 #include "undo.h"
+#include "recovery.h"
 #include "app.h"
 #include "widgets/coordinates_widget.h"
+#include "widgets/partial_load_dialog.h"
 #include "common/util/file_util.h"
 #include "bridge/bridge.h"
 #include "common/util/path_provider.h"
@@ -81,6 +87,7 @@ MainWindow::MainWindow() :
 	m_curSelectionMode(-1),
 	m_elementModeListIndex(3),
 	m_mouseMoveAction(MMA_DEFAULT),
+	m_hoverUpdateScheduled(false),
 	m_activeAxis(X_AXIS | Y_AXIS | Z_AXIS),
 	m_activeObject(NULL),
 	m_actionLogSender(NULL),
@@ -107,6 +114,10 @@ void MainWindow::init()
 			this, SLOT(view3dMouseMoved(QMouseEvent*)));
 	connect(m_pView, SIGNAL(mouseReleased(QMouseEvent*)),
 			this, SLOT(view3dMouseReleased(QMouseEvent*)));
+	connect(m_pView, SIGNAL(mouseHovered(int, int)),
+			this, SLOT(view3dMouseHovered(int, int)));
+	connect(m_pView, SIGNAL(hoverLeft()),
+			this, SLOT(view3dHoverLeft()));
 	connect(m_pView, SIGNAL(keyReleased(QKeyEvent*)),
 			this, SLOT(view3dKeyReleased(QKeyEvent*)));
 
@@ -200,6 +211,11 @@ void MainWindow::init()
 	m_actLoadIntoMesh->setToolTip(tr("Load geometries from file and add it to the current mesh."));
 	connect(m_actLoadIntoMesh, SIGNAL(triggered()), this, SLOT(loadIntoMesh()));
 
+	m_actLoadPartially = new QAction(tr("Load &Partially..."), this);
+	m_actLoadPartially->setIcon(QIcon(":images/fileopen.png"));
+	m_actLoadPartially->setToolTip(tr("Load only some subsets or a region of a .pmb or .ugx file."));
+	connect(m_actLoadPartially, SIGNAL(triggered()), this, SLOT(loadPartially()));
+
 	m_actReload = new QAction(tr("&Reload"), this);
 	//m_actReload->setIcon(QIcon(":images/fileopen.png"));
 	m_actReload->setShortcut(tr("F5"));
@@ -235,6 +251,7 @@ void MainWindow::init()
 	m_fileMenu->addAction(m_actNew);
 	m_fileMenu->addAction(m_actOpen);
 	m_fileMenu->addAction(m_actLoadIntoMesh);
+	m_fileMenu->addAction(m_actLoadPartially);
 	m_fileMenu->addAction(m_actReload);
 	m_fileMenu->addAction(m_actReloadAll);
 	m_fileMenu->addAction(m_actSave);
@@ -346,7 +363,28 @@ void MainWindow::init()
 	m_pLog->raise();
 	
 //	init the status bar
-	// statusBar()->show();
+	m_undoWriteStatus = new QLabel(this);
+	m_undoWriteStatus->hide();
+	statusBar()->addPermanentWidget(m_undoWriteStatus);
+
+	m_loadStatus = new QLabel(this);
+	m_loadStatus->hide();
+	statusBar()->addPermanentWidget(m_loadStatus);
+
+	m_cancelLoads = new QToolButton(this);
+	m_cancelLoads->setText(tr("Cancel"));
+	m_cancelLoads->setToolTip(tr("Cancels loading the files"));
+	m_cancelLoads->hide();
+	statusBar()->addPermanentWidget(m_cancelLoads);
+	connect(m_cancelLoads, SIGNAL(clicked()), this, SLOT(cancelBackgroundLoads()));
+
+	m_writeStatus = new QLabel(this);
+	m_writeStatus->hide();
+	statusBar()->addPermanentWidget(m_writeStatus);
+
+	QTimer* statusTimer = new QTimer(this);
+	connect(statusTimer, SIGNAL(timeout()), this, SLOT(updateStatusBar()));
+	statusTimer->start(250);
 
 //	init undo
 	QDir tmpPath = app::ProMeshTmpDir();
@@ -355,8 +393,17 @@ void MainWindow::init()
 			 << tmpPath.path().toLocal8Bit().constData() << "\n";
 	}
 
+//	init crash recovery
+	if(!RecoveryProvider::inst().init(tmpPath.path().toLocal8Bit().constData())){
+		cout << "initialization of crash recovery failed. couldn't create recovery path in "
+			 << tmpPath.path().toLocal8Bit().constData() << "\n";
+	}
+
 	show();
 	check_options();
+
+//	recovery is offered once the event loop runs
+	QTimer::singleShot(0, this, SLOT(recoverCrashedSessions()));
 }
 
 void MainWindow::check_options() const
@@ -370,6 +417,11 @@ void MainWindow::check_options() const
 
 MainWindow::~MainWindow()
 {
+	m_fileWriter.wait_until_idle();
+	for(size_t i = 0; i < m_loaders.size(); ++i){
+		m_loaders[i]->cancel();
+		delete m_loaders[i];
+	}
 }
 
 QToolBar* MainWindow::createVisibilityToolbar()
@@ -634,31 +686,8 @@ bool MainWindow::load_grid_from_file(const char* filename)
 	try{
 		LOG("loading " << filename << " ...\n");
 		LGObject* pObj = CreateLGObjectFromFile(filename);
-
-	//	add it to the scene
 		if(pObj)
-		{
-			const bool bFirstLoad = m_scene->num_objects() == 0;
-			pObj->set_element_mode(getLGElementMode());
-			int index = m_scene->add_object(pObj);
-			if(index != -1)
-			{
-				setActiveObject(index);
-
-			//	if this is the first object loaded, we will focus it.
-				if(bFirstLoad)
-				{
-					ug::Sphere3 s = pObj->get_bounding_sphere();
-					m_pView->fly_to(cam::vector3(s.get_center().x(),
-													s.get_center().y(),
-													s.get_center().z()),
-									s.get_radius() * 3.f);
-				}
-
-				pObj->set_save_required(false);
-				return true;
-			}
-		}
+			return add_loaded_object(pObj);
 	}
 	catch(UGError err){
 		UG_LOG("ERROR: " << err.get_msg() << endl);
@@ -672,6 +701,128 @@ bool MainWindow::load_grid_from_file(const char* filename)
 	return false;
 }
 
+void MainWindow::load_grid_in_background(const char* filename)
+{
+	LOG("loading " << filename << " in the background ...\n");
+	m_loaders.push_back(new LGObjectLoader(filename));
+	process_background_loads();
+}
+
+void MainWindow::load_grid_in_background(const char* filename,
+										 const PartialLoadFilter& filter)
+{
+	LOG("loading parts of " << filename << " in the background ...\n");
+	m_loaders.push_back(new LGObjectLoader(filename, filter));
+	process_background_loads();
+}
+
+bool MainWindow::add_loaded_object(LGObject* pObj)
+{
+	const bool bFirstLoad = m_scene->num_objects() == 0;
+	pObj->set_element_mode(getLGElementMode());
+	int index = m_scene->add_object(pObj);
+	if(index == -1)
+		return false;
+
+	setActiveObject(index);
+
+//	if this is the first object loaded, we will focus it.
+	if(bFirstLoad)
+	{
+		ug::Sphere3 s = pObj->get_bounding_sphere();
+		m_pView->fly_to(cam::vector3(s.get_center().x(),
+										s.get_center().y(),
+										s.get_center().z()),
+						s.get_radius() * 3.f);
+	}
+
+	pObj->set_save_required(false);
+	return true;
+}
+
+void MainWindow::process_background_loads()
+{
+//	finished loads are added in the order in which they were started.
+//	Canceled loads are deleted as soon as they aren't executed anymore.
+	QStringList failedFiles;
+	bool blocked = false;
+	for(size_t i = 0; i < m_loaders.size();){
+		LGObjectLoader* loader = m_loaders[i];
+		if(loader->canceled()){
+			if(loader->done() || !loader->started()){
+				m_loaders.erase(m_loaders.begin() + i);
+				delete loader;
+			}
+			else
+				++i;
+			continue;
+		}
+
+		if(blocked || !loader->done()){
+			blocked = true;
+			++i;
+			continue;
+		}
+
+		m_loaders.erase(m_loaders.begin() + i);
+
+		LGObject* pObj = loader->take_object();
+		QString filename = QString::fromLocal8Bit(loader->filename().c_str());
+		delete loader;
+
+		bool added = false;
+		if(pObj){
+			try{
+				PerformLoadPostprocessing(pObj);
+				added = add_loaded_object(pObj);
+			}
+			catch(UGError err){
+				UG_LOG("ERROR: " << err.get_msg() << endl);
+			}
+			if(!added)
+				delete pObj;
+		}
+
+		if(!added)
+			failedFiles.push_back(filename);
+	}
+
+//	update the status
+	qint64 numBytes = 0;
+	size_t numElems = 0;
+	int numLoads = 0;
+	QString name;
+	for(size_t i = 0; i < m_loaders.size(); ++i){
+		LGObjectLoader* loader = m_loaders[i];
+		if(loader->canceled())
+			continue;
+		numBytes += loader->file_size();
+		numElems += loader->num_elements_created();
+		if(numLoads == 0)
+			name = QFileInfo(QString::fromLocal8Bit(loader->filename().c_str())).fileName();
+		++numLoads;
+	}
+
+	if(numLoads > 0){
+		if(numLoads > 1)
+			name = tr("%1 files").arg(numLoads);
+		m_loadStatus->setText(tr("Loading %1 (%2 MB): %3 elements created")
+								.arg(name).arg(numBytes >> 20).arg(numElems));
+		m_loadStatus->show();
+		m_cancelLoads->show();
+	}
+	else{
+		m_loadStatus->hide();
+		m_cancelLoads->hide();
+	}
+
+	if(!failedFiles.isEmpty()){
+		QMessageBox msg(this);
+		msg.setText(tr("Load failed: ").append(failedFiles.join(", ")));
+		msg.exec();
+	}
+}
+
 LGObject* MainWindow::create_empty_object(const char* name, SceneObjectType sot)
 {
 //	create a new object
@@ -738,17 +889,9 @@ int MainWindow::openFile()
 		iter != fileNames.end(); ++iter)
 	{
 		settings().setValue("file-path", QFileInfo(*iter).absolutePath());
-	//	load the object
-		if(load_grid_from_file((*iter).toLocal8Bit().constData()))
-			++numOpened;
-		else
-		{
-			QMessageBox msg(this);
-			QString str = tr("Load failed: ");
-			str.append(*iter);
-			msg.setText(str);
-			msg.exec();
-		}
+	//	load the object. Failures are reported once the load finished.
+		load_grid_in_background((*iter).toLocal8Bit().constData());
+		++numOpened;
 	}
 
 	return numOpened;
@@ -821,6 +964,40 @@ int MainWindow::loadIntoMesh()
 }
 
 
+bool MainWindow::loadPartially()
+{
+	QString path = settings().value("file-path", ".").toString();
+
+	QString fileName = QFileDialog::getOpenFileName(
+								this,
+								tr("Load Geometry Partially"),
+								path,
+								tr("geometry files (*.pmb *.ugx)"));
+	if(fileName.isEmpty())
+		return false;
+
+	settings().setValue("file-path", QFileInfo(fileName).absolutePath());
+	string filename = fileName.toLocal8Bit().constData();
+
+//	the subset table is read first, so that the user can choose what to load
+	MeshFileSummary summary;
+	if(!MeshFileSummarySupported(filename.c_str())
+	   || !ReadMeshFileSummary(filename.c_str(), summary))
+	{
+		QMessageBox::warning(this, tr("Load Partially"),
+							 tr("Couldn't read the subsets of '%1'.").arg(fileName));
+		return false;
+	}
+
+	PartialLoadDialog dlg(this, fileName, summary);
+	if(dlg.exec() != QDialog::Accepted)
+		return false;
+
+	load_grid_in_background(filename.c_str(), dlg.filter());
+	return true;
+}
+
+
 bool MainWindow::reloadActiveGeometry()
 {
 	LGObject* obj = app::getActiveObject();
@@ -861,19 +1038,19 @@ bool MainWindow::saveToFile()
 									path,
 									tr("geometry files (").append(LG_SUPPORTED_FILE_FORMATS_SAVE).append(")"));
 
-		if(!fileName.isEmpty())
+		LGObject* lgobj = dynamic_cast<LGObject*>(obj);
+		if(!fileName.isEmpty() && !lgobj)
+			saveFailed = true;
+		else if(!fileName.isEmpty())
 		{
 			settings().setValue("file-path", QFileInfo(fileName).absolutePath());
-		//	save the object
-			if(!save_object_to_file(obj, fileName.toLocal8Bit().constData()))
-				saveFailed = true;
-			else{
-				obj->set_name(QFileInfo(fileName).baseName().toLocal8Bit().constData());
-				obj->visuals_changed();
-				LGObject* lgobj = dynamic_cast<LGObject*>(obj);
-				if(lgobj)
-					lgobj->set_save_required(false);
-			}
+		//	save a copy of the object in the background. The object is
+		//	renamed once the write succeeded.
+			write_in_background(lgobj, fileName.toLocal8Bit().constData(),
+								[lgobj](){return CreateLGObjectSaver(lgobj);},
+								tr("Make sure that the selected filename has a valid suffix: %1")
+									.arg(LG_SUPPORTED_FILE_FORMATS_SAVE),
+								QFileInfo(fileName).baseName().toLocal8Bit().constData());
 		}
 	}
 
@@ -886,7 +1063,7 @@ bool MainWindow::saveToFile()
 		else
 		{
 			str.append("make sure that the selected filename has a valid suffix.\n");
-			str.append("valid suffixes are: *.ugx *.ncdf *.lgb *.obj *.txt *.ele");
+			str.append("valid suffixes are: *.ugx *.pmb *.ncdf *.lgb *.obj *.txt *.ele *.ugxz *.lgbz *.pmbz");
 		}
 		msg.setText(str);
 		msg.exec();
@@ -898,8 +1075,6 @@ bool MainWindow::saveToFile()
 
 bool MainWindow::exportToUG3()
 {
-	bool saveFailed = false;
-
 	LGObject* obj = dynamic_cast<LGObject*>(m_sceneInspector->getActiveObject());
 	if(obj)
 	{
@@ -910,65 +1085,24 @@ bool MainWindow::exportToUG3()
 									this,
 									tr("Save Geometry"),
 									path);
-		try{
-			if(!fileName.isEmpty())
-			{
-				settings().setValue("file-path", QFileInfo(fileName).absolutePath());
-
-			//	get the filenames
-				QFileInfo fileInfo(fileName);
-				QString prefix = fileInfo.absolutePath();
-				prefix.append("/").append(fileInfo.baseName());
-				Grid& g = obj->grid();
-				SubsetHandler& sh = obj->subset_handler();
-
-				if(g.num_volumes() > 0){
-				//	Create the subset-handlers
-					SubsetHandler shFaces(g, SHE_FACE);
-					SubsetHandler shVolumes(g, SHE_VOLUME);
-
-					for(int i = 0; i < sh.num_subsets(); ++i){
-						shFaces.assign_subset(sh.begin<Face>(i), sh.end<Face>(i), i);
-						shVolumes.assign_subset(sh.begin<Volume>(i), sh.end<Volume>(i), i);
-					}
-
-					UG_LOG("Exporting to UG3 3D ... ");
-				//	export the grid
-					saveFailed = !ExportGridToUG(g, shFaces, shVolumes, prefix.toLocal8Bit().constData(),
-												"tmpLGMName", "tmpProblemName", 0);
-				}
-				else{
-					UG_LOG("Exporting to UG3 2D ... ");
-				//	export the grid
-					saveFailed = !ExportGridToUG_2D(g, prefix.toLocal8Bit().constData(),
-													"tmpLGMName", "tmpProblemName", 0, &sh);
-				}
-
-				if(saveFailed){
-					UG_LOG("failed\n");
-				}
-				else{
-					UG_LOG("done\n");
-				}
-			}
-		}
-		catch(UGError err){
-			UG_LOG("\n");
-			UG_LOG("ERROR: " << err.get_msg() << endl);
-		}
-	}
+		if(!fileName.isEmpty())
+		{
+			settings().setValue("file-path", QFileInfo(fileName).absolutePath());
 
-	if(saveFailed)
-	{
-		QMessageBox msg(this);
-		QString str = tr("Export failed: ");
-		str.append(tr("Make sure that all subsets are consecutive. That means:\n"));
-		str.append(tr("  * A subset that contains no faces may not be followed by a subset that contains faces.\n"));
-		str.append(tr("  * A subset that contains no volumes may not be followed by a subset that contains volumes.\n"));
-		str.append(tr("  Consider calling Tools->Subsets->Adjust Subsets For UG3\n"));
-		msg.setText(str);
-		msg.exec();
-		return false;
+		//	get the filenames
+			QFileInfo fileInfo(fileName);
+			QString prefix = fileInfo.absolutePath();
+			prefix.append("/").append(fileInfo.baseName());
+
+			QString hint = tr("Make sure that all subsets are consecutive. That means:\n");
+			hint.append(tr("  * A subset that contains no faces may not be followed by a subset that contains faces.\n"));
+			hint.append(tr("  * A subset that contains no volumes may not be followed by a subset that contains volumes.\n"));
+			hint.append(tr("  Consider calling Tools->Subsets->Adjust Subsets For UG3\n"));
+
+			UG_LOG("Exporting to UG3 in the background.\n");
+			write_in_background(obj, prefix.toLocal8Bit().constData(),
+								[obj](){return CreateLGObjectUG3Exporter(obj);}, hint);
+		}
 	}
 
 	return true;
@@ -1170,6 +1304,13 @@ void MainWindow::elementDrawModeChanged()
 //	events
 void MainWindow::closeEvent(QCloseEvent *event)
 {
+	if(background_writes_pending()){
+		QMessageBox::information(this, tr("Quit"),
+					tr("Files are still being written. Please quit after they were saved."));
+		event->ignore();
+		return;
+	}
+
 	if(m_scene->num_objects() == 0)
 		event->accept();
 	else{
@@ -1208,14 +1349,7 @@ void MainWindow::dropEvent(QDropEvent* event)
 		iter != urls.end(); ++iter)
 	{
 		settings().setValue("file-path", QFileInfo((*iter).toLocalFile()).absolutePath());
-		if(!load_grid_from_file((*iter).toLocalFile().toLatin1().constData()))
-		{
-			QMessageBox msg(this);
-			QString str = tr("Load failed: ");
-			str.append((*iter).toLocalFile());
-			msg.setText(str);
-			msg.exec();
-		}
+		load_grid_in_background((*iter).toLocalFile().toLocal8Bit().constData());
 	}
 }
 
@@ -1253,6 +1387,209 @@ void MainWindow::redo()
 	}
 }
 
+void MainWindow::updateStatusBar()
+{
+	process_background_loads();
+	process_background_writes();
+
+	UndoFileWriter& writer = UndoHistoryProvider::inst().writer();
+	size_t numPending = writer.num_pending();
+	if(numPending > 0){
+		m_undoWriteStatus->setText(tr("Writing undo entries: %1").arg(numPending));
+		m_undoWriteStatus->show();
+	}
+	else
+		m_undoWriteStatus->hide();
+
+	vector<string> failedFiles;
+	writer.take_failed_files(failedFiles);
+	for(size_t i = 0; i < failedFiles.size(); ++i){
+		UG_LOG("WARNING: Couldn't write undo file " << failedFiles[i]
+			   << ". The corresponding undo step can't be restored.\n");
+	}
+
+	RecoveryProvider::inst().writer().take_failed_files(failedFiles);
+	for(size_t i = 0; i < failedFiles.size(); ++i){
+		UG_LOG("WARNING: Couldn't write recovery file " << failedFiles[i]
+			   << ". Changes may not be recoverable after a crash.\n");
+	}
+}
+
+void MainWindow::write_in_background(LGObject* obj, const std::string& filename,
+									 const std::function<LGObjectWriteFunc ()>& createWriteFunc,
+									 const QString& failureHint,
+									 const std::string& newName)
+{
+//	a queued write of the same file would be overwritten anyways
+	for(size_t i = 0; i < m_pendingWrites.size();){
+		if(m_pendingWrites[i].filename == filename
+		   && m_fileWriter.try_discard(m_pendingWrites[i].jobId))
+		{
+			UG_LOG("superseded queued write of " << filename << endl);
+			m_pendingWrites.erase(m_pendingWrites.begin() + i);
+		}
+		else
+			++i;
+	}
+
+//	the mesh is only copied once the writer can hold the copy
+	const size_t numBytes = EstimateLGObjectCopyBytes(obj);
+	m_fileWriter.wait_for_capacity(numBytes);
+	LGObjectWriteFunc write = createWriteFunc();
+
+	PendingWrite pw;
+	pw.jobId = m_fileWriter.enqueue(filename, [write, filename]() mutable -> bool
+	{
+		bool success = write(filename);
+	//	release the copy of the mesh on the writer thread
+		write = LGObjectWriteFunc();
+		return success;
+	}, numBytes);
+	pw.obj = obj;
+	pw.filename = filename;
+	pw.failureHint = failureHint;
+	pw.newName = newName;
+	pw.numChanges = obj->num_changes();
+	m_pendingWrites.push_back(pw);
+	process_background_writes();
+}
+
+void MainWindow::process_background_writes()
+{
+	vector<PendingWrite> finished;
+	for(size_t i = 0; i < m_pendingWrites.size();){
+		if(m_fileWriter.is_job_pending(m_pendingWrites[i].jobId))
+			++i;
+		else{
+			finished.push_back(m_pendingWrites[i]);
+			m_pendingWrites.erase(m_pendingWrites.begin() + i);
+		}
+	}
+
+	if(m_pendingWrites.empty())
+		m_writeStatus->hide();
+	else{
+		m_writeStatus->setText(tr("Saving %1 (%2 pending)")
+				.arg(QFileInfo(m_pendingWrites.front().filename.c_str()).fileName())
+				.arg(m_pendingWrites.size()));
+		m_writeStatus->show();
+	}
+
+	if(finished.empty())
+		return;
+
+//	failures of finished writes were recorded before they left the queue
+	vector<UndoFileWriter::FailedJob> failedJobs;
+	m_fileWriter.take_failed_jobs(failedJobs);
+	set<UndoFileWriter::JobId> failedIds;
+	for(size_t i = 0; i < failedJobs.size(); ++i)
+		failedIds.insert(failedJobs[i].id);
+
+	QString failures;
+	for(size_t i = 0; i < finished.size(); ++i){
+		const PendingWrite& pw = finished[i];
+		if(failedIds.find(pw.jobId) != failedIds.end()){
+			UG_LOG("ERROR: Couldn't write " << pw.filename << endl);
+			failures.append(pw.filename.c_str()).append(":\n  ")
+					.append(pw.failureHint).append("\n");
+			continue;
+		}
+
+		UG_LOG("saved " << pw.filename << endl);
+	//	the object may have been erased meanwhile
+		if(pw.newName.empty() || m_scene->get_object_index(pw.obj) < 0)
+			continue;
+		LGObject* obj = dynamic_cast<LGObject*>(pw.obj);
+		if(!obj)
+			continue;
+	//	renaming doesn't change the mesh and thus creates no undo point
+		obj->set_name(pw.newName.c_str());
+		obj->visuals_changed(false);
+	//	changes which were made after the copy was created aren't saved
+		if(obj->num_changes() == pw.numChanges)
+			obj->set_save_required(false);
+	}
+
+	if(!failures.isEmpty()){
+		QMessageBox msg(this);
+		msg.setText(tr("Save failed: ").append(failures));
+		msg.exec();
+	}
+}
+
+void MainWindow::cancelBackgroundLoads()
+{
+	for(size_t i = 0; i < m_loaders.size(); ++i){
+		if(!m_loaders[i]->canceled()){
+			UG_LOG("loading of " << m_loaders[i]->filename() << " canceled.\n");
+			m_loaders[i]->cancel();
+		}
+	}
+	process_background_loads();
+}
+
+void MainWindow::recoverCrashedSessions()
+{
+	RecoveryProvider& rp = RecoveryProvider::inst();
+	vector<RecoverableObject> objs;
+	rp.find_recoverable_objects(objs);
+	if(objs.empty()){
+	//	sessions which crashed before a checkpoint was written contain nothing
+		rp.remove_crashed_sessions();
+		return;
+	}
+
+	QString names;
+	for(size_t i = 0; i < objs.size(); ++i)
+		names.append("\n    ").append(QString::fromLocal8Bit(objs[i].name.c_str()));
+
+	QMessageBox::StandardButton answer = QMessageBox::question(this,
+			tr("Recover Objects"),
+			tr("ProMesh wasn't shut down properly. The following objects can be "
+			   "recovered:%1\n\nRecover them now? 'Discard' deletes the recovery "
+			   "data, 'Ignore' keeps it for the next start.").arg(names),
+			QMessageBox::Yes | QMessageBox::Discard | QMessageBox::Ignore,
+			QMessageBox::Yes);
+
+	if(answer == QMessageBox::Discard){
+		rp.remove_crashed_sessions();
+		return;
+	}
+	else if(answer != QMessageBox::Yes){
+		rp.release_crashed_sessions();
+		return;
+	}
+
+	bool allRecovered = true;
+	for(size_t i = 0; i < objs.size(); ++i){
+		LOG("recovering " << objs[i].name << " ...\n");
+		LGObject* obj = NULL;
+		try{
+			obj = RecoverLGObject(objs[i]);
+		}
+		catch(UGError err){
+			UG_LOG("ERROR: " << err.get_msg() << endl);
+		}
+
+		if(!obj){
+			UG_LOG("ERROR: Couldn't recover " << objs[i].name << ". The recovery "
+				   "data is kept for the next start.\n");
+			allRecovered = false;
+			continue;
+		}
+
+		obj->set_element_mode(getLGElementMode());
+		int index = m_scene->add_object(obj);
+		if(index != -1)
+			setActiveObject(index);
+	}
+
+	if(allRecovered)
+		rp.remove_crashed_sessions();
+	else
+		rp.release_crashed_sessions();
+}
+
 void MainWindow::quit()
 {
 	this->close();
@@ -1290,15 +1627,30 @@ void MainWindow::
 refreshOptions()
 {
 	m_optWidget->populate(&GetOptions(), "options");
+	applyOptions();
 }
 
 void MainWindow::
 optionsChanged ()
 {
 	m_optWidget->retrieve_values(GetOptions());
+	applyOptions();
 	saveOptions();
 }
 
+void MainWindow::
+applyOptions ()
+{
+	const opts::Options& o = GetOptions();
+	m_pView->set_hover_picking_enabled(o.selection.hoverHighlight);
+	if(!o.selection.hoverHighlight && m_scene->clear_hover())
+		m_pView->update();
+
+	UndoHistoryProvider::inst().set_budgets(
+			size_t(max(o.undo.memoryBudget, 1)) << 20,
+			size_t(max(o.undo.diskBudget, 0)) << 20);
+}
+
 void
 MainWindow::
 saveOptions ()
@@ -1322,8 +1674,9 @@ loadOptions ()
 
 	if(FileExists(userOptsName)){
 		ifstream in(userOptsName.toStdString().c_str());
+	//	options which were added after the config file was written are skipped
+	//	through the class versions stored in the file and keep their defaults.
 		boost::archive::xml_iarchive ar(in);
-
 		ar & make_nvp("config", GetOptions());
 	}
 
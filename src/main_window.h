@@ -48,6 +48,7 @@ class QAction;
 class QComboBox;
 class QFileDialog;
 class QHelpBrowser;
+class QLabel;
 class QPushButton;
 class QPoint;
 class QPlainTextEdit;
@@ -55,6 +56,8 @@ class QTreeView;
 class QToolBar;
 class QToolButton;
 class PropertyWidget;
+class LGObjectLoader;
+struct PartialLoadFilter;
 class SceneInspector;
 class ToolManager;
 class ToolBrowser;
@@ -100,7 +103,17 @@ class MainWindow : public QMainWindow
 		LGScene* get_scene()	{return m_scene;}
 
 		bool load_grid_from_file(const char* filename);
+	///	loads the given file on a background thread and adds it to the scene when done.
+	/**	Progress is displayed in the status bar. Objects are added to the scene
+	 * in the order in which their loads were started.*/
+		void load_grid_in_background(const char* filename);
+	///	loads only the part of the given file which passes filter. See load_grid_in_background.
+		void load_grid_in_background(const char* filename, const PartialLoadFilter& filter);
+	///	returns true if files are currently being loaded in the background.
+		bool background_loads_pending() const	{return !m_loaders.empty();}
 		bool save_object_to_file(ISceneObject* obj, const char* filename);
+	///	returns true if files are currently being written in the background.
+		bool background_writes_pending() const	{return !m_pendingWrites.empty();}
         LGObject* create_empty_object(const char* name, SceneObjectType sot);
 		inline QSettings& settings()	{return m_settings;}
 
@@ -121,8 +134,9 @@ class MainWindow : public QMainWindow
 	public slots:
 		void setActiveObject(int index);
 		void newGeometry();
-		int openFile();///< returns the number of successfully opened files.
+		int openFile();///< returns the number of files whose loading was started.
 		int loadIntoMesh();
+		bool loadPartially();///< returns true if loading was started.
 		bool reloadActiveGeometry();
 		bool reloadAllGeometries();
 		bool saveToFile();
@@ -148,6 +162,9 @@ class MainWindow : public QMainWindow
 		void view3dMousePressed(QMouseEvent *event);
 		void view3dMouseMoved(QMouseEvent *event);
 		void view3dMouseReleased(QMouseEvent *event);
+		void view3dMouseHovered(int x, int y);
+		void view3dHoverLeft();
+		void updateHover();
 		void view3dKeyReleased(QKeyEvent* event);
 		void selectionElementChanged(int newElement);
 		void selectionElementChanged(bool enabled);
@@ -163,6 +180,12 @@ class MainWindow : public QMainWindow
 		void viewScaleXChanged(double value);
 		void viewScaleYChanged(double value);
 		void viewScaleZChanged(double value);
+	///	updates the indicators of background tasks in the status bar
+		void updateStatusBar();
+	///	offers to recover the objects of sessions which crashed
+		void recoverCrashedSessions();
+	///	cancels all loads which were started through load_grid_in_background
+		void cancelBackgroundLoads();
 
 	protected:
 		void closeEvent(QCloseEvent *event);
@@ -183,6 +206,24 @@ class MainWindow : public QMainWindow
 
 		uint getLGElementMode();
 
+	///	adds a freshly loaded object to the scene and activates it. Returns false if it couldn't be added.
+		bool add_loaded_object(LGObject* pObj);
+	///	adds finished background loads to the scene and updates the load status
+		void process_background_loads();
+	///	writes a copy of obj, which is created by createWriteFunc, on a background thread.
+	/**	The copy is only created once m_fileWriter can hold it, see
+	 *	UndoFileWriter::wait_for_capacity. A queued write of the same file
+	 *	which wasn't started yet is superseded by the new one.
+	 *	failureHint is displayed together with the filename if writing fails.
+	 *	If newName isn't empty, obj is renamed to it once the write succeeded
+	 *	and its save-required flag is cleared unless obj was changed meanwhile.*/
+		void write_in_background(LGObject* obj, const std::string& filename,
+								 const std::function<LGObjectWriteFunc ()>& createWriteFunc,
+								 const QString& failureHint,
+								 const std::string& newName = std::string());
+	///	reports finished background writes and updates the write status
+		void process_background_writes();
+
 		void beginMouseMoveAction(MouseMoveAction mma);
 		void updateMouseMoveAction();
 		void endMouseMoveAction(bool bApply);
@@ -193,6 +234,9 @@ class MainWindow : public QMainWindow
 
 		void populateMenuBar ();
 		void activateModule (IModule* mod);
+
+	///	applies the current options (GetOptions()) to the view and scene
+		void applyOptions ();
 		
 	protected:
 	//	3d view
@@ -217,6 +261,8 @@ class MainWindow : public QMainWindow
 
 	//	important for selection etc
 		QPoint m_mouseDownPos;
+		QPoint m_hoverPos;
+		bool m_hoverUpdateScheduled;///< true if updateHover will be called by a timer
 		QPoint m_mouseMoveActionStart;
 		LGObject* m_mouseMoveActionObject;///< Only valid if m_mouseMoveAction != MMA_DEFAULT
 		unsigned int m_activeAxis;
@@ -237,6 +283,28 @@ class MainWindow : public QMainWindow
 		TruncatedDoubleSpinBox*		m_viewScaleX;
 		TruncatedDoubleSpinBox*		m_viewScaleY;
 		TruncatedDoubleSpinBox*		m_viewScaleZ;
+		QLabel*						m_undoWriteStatus;
+		QLabel*						m_loadStatus;
+		QToolButton*				m_cancelLoads;
+
+		QLabel*						m_writeStatus;
+
+	//	background loads in the order in which they were started
+		std::vector<LGObjectLoader*>	m_loaders;
+
+	//	background saves and exports
+		struct PendingWrite{
+			UndoFileWriter::JobId	jobId;
+			ISceneObject*			obj;
+			std::string				filename;
+			QString					failureHint;
+		//	the object is renamed to newName once the write succeeded. Empty for exports.
+			std::string				newName;
+		//	LGObject::num_changes of the object when it was copied
+			size_t					numChanges;
+		};
+		UndoFileWriter				m_fileWriter;
+		std::vector<PendingWrite>	m_pendingWrites;
 
 		#ifdef PROMESH_USE_WEBKIT
 			QHelpBrowser*			m_helpBrowser;
@@ -250,6 +318,7 @@ class MainWindow : public QMainWindow
 		QAction*	m_actNew;
 		QAction*	m_actOpen;
 		QAction*	m_actLoadIntoMesh;
+		QAction*	m_actLoadPartially;
 		QAction*	m_actSave;
 		QAction*	m_actReload;
 		QAction*	m_actReloadAll;
@@ -432,6 +432,45 @@ void MainWindow::view3dMouseMoved(QMouseEvent *event)
 	}
 }
 
+void MainWindow::view3dMouseHovered(int x, int y)
+{
+	m_hoverPos = QPoint(x, y);
+	updateHover();
+}
+
+void MainWindow::view3dHoverLeft()
+{
+	if(m_scene->clear_hover())
+		m_pView->update();
+}
+
+void MainWindow::updateHover()
+{
+	m_hoverUpdateScheduled = false;
+
+	if(m_mouseMoveAction != MMA_DEFAULT || !m_pView->hover_picking_enabled())
+		return;
+
+	const int budget = max(1, GetOptions().selection.hoverPickBudget);
+
+	vector3 from, to;
+	m_pView->get_ray(from, to, m_hoverPos.x(), m_hoverPos.y());
+
+	bool pending = false;
+	if(m_scene->update_hover(getActiveObject(), m_selectionElement, from, to,
+							 budget, pending))
+	{
+		m_pView->update();
+	}
+
+//	the pick structure of big objects is built over several calls. We'll
+//	continue shortly, so that the highlight appears even if the mouse rests.
+	if(pending && !m_hoverUpdateScheduled){
+		m_hoverUpdateScheduled = true;
+		QTimer::singleShot(2 * budget, this, SLOT(updateHover()));
+	}
+}
+
 void MainWindow::view3dMouseReleased(QMouseEvent *event)
 {
 //	if box select is active and the right button was released,
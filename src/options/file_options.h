@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2026:  G-CSC, Goethe University Frankfurt
+ * Author: Sebastian Reiter
+ * 
+ * This file is part of ProMesh.
+ * 
+ * ProMesh is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License version 3 (as published by the
+ * Free Software Foundation) with the following additional attribution
+ * requirements (according to LGPL/GPL v3 §7):
+ * 
+ * (1) The following notice must be displayed in the Appropriate Legal Notices
+ * of covered and combined works: "Based on ProMesh (www.promesh3d.com)".
+ * 
+ * (2) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S. and Wittum, G. ProMesh -- a flexible interactive meshing software
+ *   for unstructured hybrid grids in 1, 2, and 3 dimensions. In preparation."
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#ifndef __H__PROMESH_file_options
+#define __H__PROMESH_file_options
+
+#include "common/boost_serialization.h"
+
+namespace opts{
+
+struct Files {
+///	zlib level between 1 (fastest) and 9 (smallest) for .ugxz, .lgbz and .pmbz files
+	int		compressionLevel;
+///	vertices of imported .stl and .obj files which are at most this far apart are merged.
+/**	0 only merges vertices with identical coordinates.*/
+	double	weldTolerance;
+///	writes .vtu files in the binary appended format instead of ascii.
+/**	Binary files are written much faster but are only read by vtk based tools.
+ * .pvtu files are always binary.*/
+	bool	vtuBinary;
+///	compresses the arrays of binary .vtu and .pvtu files with compressionLevel
+	bool	vtuCompressed;
+///	number of .vtu pieces written for a .pvtu file. 0 writes one piece per worker thread.
+	int		vtuPieces;
+
+	Files() :
+		compressionLevel (3),
+		weldTolerance (0),
+		vtuBinary (false),
+		vtuCompressed (false),
+		vtuPieces (0)
+		{}
+
+private:
+	friend class boost::serialization::access;
+
+	template <class Archive>
+	void serialize( Archive& ar, const unsigned int version)
+	{
+		using namespace ug;
+		ar & make_nvp("compression_level", compressionLevel);
+		ar & make_nvp("weld_tolerance", weldTolerance);
+		ar & make_nvp("vtu_binary", vtuBinary);
+		ar & make_nvp("vtu_compressed", vtuCompressed);
+		ar & make_nvp("vtu_pieces", vtuPieces);
+	}
+};
+
+}
+
+BOOST_CLASS_VERSION(opts::Files, 0);
+
+
+#endif	//__H__PROMESH_file_options
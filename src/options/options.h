@@ -27,6 +27,10 @@
 #define __H__PROMESH_options
 
 #include "draw_path_options.h"
+#include "file_options.h"
+#include "recovery_options.h"
+#include "selection_options.h"
+#include "tetgen_options.h"
 #include "undo_options.h"
 #include "common/boost_serialization.h"
 
@@ -35,7 +39,11 @@ namespace opts{
 
 struct Options{
 	DrawPath	drawPath;
+	Selection	selection;
 	Undo		undo;
+	Recovery	recovery;
+	Files		files;
+	Tetgen		tetgen;
 
 private:
 	friend class boost::serialization::access;
@@ -46,12 +54,19 @@ private:
 		using namespace ug;
 		ar & make_nvp("draw_path", drawPath);
 		ar & make_nvp("undo", undo);
+	//	sections which were added in version 1. Older files keep the defaults.
+		if(version >= 1){
+			ar & make_nvp("selection", selection);
+			ar & make_nvp("recovery", recovery);
+			ar & make_nvp("files", files);
+			ar & make_nvp("tetgen", tetgen);
+		}
 	}
 };
 
 }
 
-BOOST_CLASS_VERSION(opts::Options, 0);
+BOOST_CLASS_VERSION(opts::Options, 1);
 
 inline opts::Options& GetOptions ()
 {
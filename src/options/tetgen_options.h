@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2026:  G-CSC, Goethe University Frankfurt
+ * Author: Sebastian Reiter
+ * 
+ * This file is part of ProMesh.
+ * 
+ * ProMesh is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License version 3 (as published by the
+ * Free Software Foundation) with the following additional attribution
+ * requirements (according to LGPL/GPL v3 §7):
+ * 
+ * (1) The following notice must be displayed in the Appropriate Legal Notices
+ * of covered and combined works: "Based on ProMesh (www.promesh3d.com)".
+ * 
+ * (2) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S. and Wittum, G. ProMesh -- a flexible interactive meshing software
+ *   for unstructured hybrid grids in 1, 2, and 3 dimensions. In preparation."
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#ifndef __H__PROMESH_tetgen_options
+#define __H__PROMESH_tetgen_options
+
+#include "common/boost_serialization.h"
+
+namespace opts{
+
+struct Tetgen {
+///	calls the tetgen library directly instead of the external tetgen executable.
+/**	Only has an effect if ProMesh was built with the tetgen library.
+ * Time outs are only supported by the external executable.*/
+	bool	inProcess;
+
+	Tetgen() :
+		inProcess (true)
+		{}
+
+private:
+	friend class boost::serialization::access;
+
+	template <class Archive>
+	void serialize( Archive& ar, const unsigned int version)
+	{
+		using namespace ug;
+		ar & make_nvp("in_process", inProcess);
+	}
+};
+
+}
+
+BOOST_CLASS_VERSION(opts::Tetgen, 0);
+
+
+#endif	//__H__PROMESH_tetgen_options
@@ -31,9 +31,18 @@ namespace opts {
 struct Undo {
 	bool enabled;
 	bool geometryChangesOnly;
+///	records the changes of each step instead of a snapshot of the whole mesh
+	bool journal;
+///	number of MB each undo history may use for compressed entries in memory
+	int memoryBudget;
+///	number of MB each undo history may use for spilled entries on disk
+	int diskBudget;
 
 	Undo() :
-		enabled(true)
+		enabled(true),
+		journal(true),
+		memoryBudget(512),
+		diskBudget(4096)
 		{}
 
 private:
@@ -44,11 +53,16 @@ private:
 	{
 		using namespace ug;
 		ar & make_nvp("enabled", enabled);
+		if(version >= 1){
+			ar & make_nvp("journal", journal);
+			ar & make_nvp("memory_budget_mb", memoryBudget);
+			ar & make_nvp("disk_budget_mb", diskBudget);
+		}
 	}
 };
 
 }// end of namespace opts
 
-BOOST_CLASS_VERSION(opts::Undo, 0);
+BOOST_CLASS_VERSION(opts::Undo, 1);
 
 #endif	//__H__UG_undo_options
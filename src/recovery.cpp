@@ -0,0 +1,440 @@
+/*
+ * Copyright (c) 2026:  G-CSC, Goethe University Frankfurt
+ * Author: Sebastian Reiter
+ * 
+ * This file is part of ProMesh.
+ * 
+ * ProMesh is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License version 3 (as published by the
+ * Free Software Foundation) with the following additional attribution
+ * requirements (according to LGPL/GPL v3 §7):
+ * 
+ * (1) The following notice must be displayed in the Appropriate Legal Notices
+ * of covered and combined works: "Based on ProMesh (www.promesh3d.com)".
+ * 
+ * (2) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S. and Wittum, G. ProMesh -- a flexible interactive meshing software
+ *   for unstructured hybrid grids in 1, 2, and 3 dimensions. In preparation."
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include <algorithm>
+#include <sstream>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QLockFile>
+#include <QSaveFile>
+#include "recovery.h"
+#include "common/log.h"
+#include "common/math/misc/math_util.h"
+#include "common/util/file_util.h"
+#include "common/util/string_util.h"
+
+using namespace std;
+using namespace ug;
+
+///	version of the info files which describe a checkpoint
+static const quint32 RECOVERY_INFO_VERSION = 1;
+///	suffix of the mesh files of checkpoints. Read through LoadLGObjectFromFile.
+static const char* RECOVERY_MESH_SUFFIX = ".pmb";
+
+///	writes the info file of a checkpoint. The file is renamed in the end,
+///	so that only complete info files exist.
+static bool WriteRecoveryInfo(const string& filename, const QString& name,
+							  const QString& fileName, bool baseIsSourceFile,
+							  qint64 sourceSize, qint64 sourceMTime)
+{
+	QString tmpName = QString::fromLocal8Bit(filename.c_str()).append(".tmp");
+	QFile file(tmpName);
+	if(!file.open(QIODevice::WriteOnly))
+		return false;
+
+	QDataStream out(&file);
+	out << RECOVERY_INFO_VERSION << name << fileName << baseIsSourceFile
+		<< sourceSize << sourceMTime;
+	file.close();
+	if(out.status() != QDataStream::Ok)
+		return false;
+
+	QFile::remove(QString::fromLocal8Bit(filename.c_str()));
+	return QFile::rename(tmpName, QString::fromLocal8Bit(filename.c_str()));
+}
+
+static bool WriteRecoveryFile(const string& filename, const string& content)
+{
+	QFile file(QString::fromLocal8Bit(filename.c_str()));
+	if(!file.open(QIODevice::WriteOnly))
+		return false;
+	return file.write(content.data(), (qint64)content.size()) == (qint64)content.size();
+}
+
+////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////
+//	RecoveryJournal implementation
+RecoveryJournal::
+RecoveryJournal() :
+	m_generation(0),
+	m_idEpoch(-1),
+	m_numRecords(0),
+	m_lastCopyMSecs(0)
+{
+}
+
+RecoveryJournal::
+~RecoveryJournal()
+{
+	release();
+}
+
+string RecoveryJournal::
+filename(int generation, const char* suffix) const
+{
+	stringstream ss;
+	ss << m_prefix << generation << suffix;
+	return ss.str();
+}
+
+bool RecoveryJournal::
+checkpoint_due(qint64 intervalMSecs) const
+{
+	if(!is_initialized())
+		return true;
+	if(m_numRecords == 0)
+		return false;
+	return m_timeSinceCheckpoint.elapsed() >= max(intervalMSecs, 50 * m_lastCopyMSecs);
+}
+
+void RecoveryJournal::
+write_file_checkpoint(int idEpoch, const string& name, const string& sourceFile)
+{
+	write_checkpoint(idEpoch, name, sourceFile, UndoHistory::WriteFunc(), 0,
+					 string(), 0);
+}
+
+void RecoveryJournal::
+write_checkpoint(int idEpoch, const string& name, const string& fileName,
+				 const UndoHistory::WriteFunc& writeMesh, size_t numBytes,
+				 const string& ids, qint64 copyMSecs)
+{
+	if(!RecoveryProvider::inst().is_initialized())
+		return;
+
+	if(!is_initialized())
+		m_prefix = RecoveryProvider::inst().create_journal_prefix();
+
+	++m_generation;
+	m_idEpoch = idEpoch;
+	m_numRecords = 0;
+	m_lastCopyMSecs = copyMSecs;
+	m_timeSinceCheckpoint.start();
+
+	const bool baseIsSourceFile = !writeMesh;
+	qint64 sourceSize = 0;
+	qint64 sourceMTime = 0;
+	if(baseIsSourceFile){
+		QFileInfo info(QString::fromLocal8Bit(fileName.c_str()));
+		sourceSize = info.size();
+		sourceMTime = info.lastModified().toMSecsSinceEpoch();
+	}
+
+	const string meshFile = filename(m_generation, RECOVERY_MESH_SUFFIX);
+	const string idsFile = filename(m_generation, ".ids");
+	const string infoFile = filename(m_generation, ".info");
+	const QString qName = QString::fromLocal8Bit(name.c_str());
+//	the session which recovers the object may use a different working directory
+	const QString qFileName = fileName.empty() ? QString() :
+			QFileInfo(QString::fromLocal8Bit(fileName.c_str())).absoluteFilePath();
+
+	vector<string> obsoleteFiles;
+	for(int i = 1; i < m_generation; ++i){
+	//	the info file is removed first, so that an incomplete generation is never used
+		obsoleteFiles.push_back(filename(i, ".info"));
+		obsoleteFiles.push_back(filename(i, RECOVERY_MESH_SUFFIX));
+		obsoleteFiles.push_back(filename(i, ".ids"));
+		obsoleteFiles.push_back(filename(i, ".journal"));
+	}
+
+	RecoveryProvider::inst().writer().enqueue(infoFile,
+		[=]() -> bool
+	{
+		if(!baseIsSourceFile){
+			QSaveFile file(QString::fromLocal8Bit(meshFile.c_str()));
+			if(!(file.open(QIODevice::WriteOnly) && writeMesh(file) && file.commit()
+				 && WriteRecoveryFile(idsFile, ids)))
+			{
+				return false;
+			}
+		}
+
+		if(!WriteRecoveryInfo(infoFile, qName, qFileName, baseIsSourceFile,
+							  sourceSize, sourceMTime))
+		{
+			return false;
+		}
+
+		for(size_t i = 0; i < obsoleteFiles.size(); ++i)
+			QFile::remove(QString::fromLocal8Bit(obsoleteFiles[i].c_str()));
+		return true;
+	}, numBytes);
+}
+
+void RecoveryJournal::
+append(const string& record)
+{
+	if(!is_initialized())
+		return;
+
+	++m_numRecords;
+	const string journalFile = filename(m_generation, ".journal");
+	RecoveryProvider::inst().writer().enqueue(journalFile,
+		[journalFile, record]() -> bool
+	{
+		QFile file(QString::fromLocal8Bit(journalFile.c_str()));
+		if(!file.open(QIODevice::WriteOnly | QIODevice::Append))
+			return false;
+
+		QDataStream out(&file);
+		out << (quint32)record.size();
+		out.writeRawData(record.data(), (int)record.size());
+		return out.status() == QDataStream::Ok;
+	});
+}
+
+void RecoveryJournal::
+release()
+{
+	if(!is_initialized())
+		return;
+
+	vector<string> files;
+	for(int i = 1; i <= m_generation; ++i){
+		files.push_back(filename(i, ".info"));
+		files.push_back(filename(i, RECOVERY_MESH_SUFFIX));
+		files.push_back(filename(i, ".ids"));
+		files.push_back(filename(i, ".journal"));
+	}
+
+	RecoveryProvider::inst().writer().enqueue(m_prefix + "release",
+		[files]() -> bool
+	{
+		for(size_t i = 0; i < files.size(); ++i)
+			QFile::remove(QString::fromLocal8Bit(files[i].c_str()));
+		return true;
+	});
+
+	m_prefix.clear();
+	m_generation = 0;
+	m_idEpoch = -1;
+	m_numRecords = 0;
+}
+
+////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////
+//	RecoveryProvider implementation
+RecoveryProvider::
+RecoveryProvider() :
+	m_lock(NULL),
+	m_journalCounter(0),
+	m_writer(64)
+{
+}
+
+RecoveryProvider::
+~RecoveryProvider()
+{
+	m_writer.wait_until_idle();
+	release_crashed_sessions();
+
+	if(m_lock){
+	//	the session ended regularly. Its files are not needed anymore.
+		m_lock->unlock();
+		delete m_lock;
+		QDir(QString::fromLocal8Bit(m_sessionPath.c_str())).removeRecursively();
+	}
+}
+
+RecoveryProvider& RecoveryProvider::
+inst()
+{
+	static RecoveryProvider rp;
+	return rp;
+}
+
+bool RecoveryProvider::
+init(const char* path)
+{
+	if(m_lock)
+		return false;
+
+	QDir parentDir(QString::fromLocal8Bit(path));
+	if(!parentDir.exists("recovery") && !parentDir.mkdir("recovery"))
+		return false;
+	m_path = string(path).append("/recovery");
+
+//	append a unique number to the path so that each promesh instance
+//	has its own recovery path
+	QDir recoveryDir(QString::fromLocal8Bit(m_path.c_str()));
+	for(int i = 0; i < 1000; ++i){
+		string sessionName = string("session").append(ToString(urand<int>(100000, 999999)));
+		if(recoveryDir.exists(sessionName.c_str()))
+			continue;
+		if(!recoveryDir.mkdir(sessionName.c_str()))
+			return false;
+
+		m_sessionPath = m_path + "/" + sessionName;
+		QLockFile* lock = new QLockFile(QString::fromLocal8Bit(m_sessionPath.c_str())
+										.append("/session.lock"));
+		lock->setStaleLockTime(0);
+		if(!lock->tryLock(0)){
+			delete lock;
+			return false;
+		}
+		m_lock = lock;
+		return true;
+	}
+	return false;
+}
+
+string RecoveryProvider::
+create_journal_prefix()
+{
+	stringstream ss;
+	ss << m_sessionPath << "/object" << m_journalCounter << "_";
+	++m_journalCounter;
+	return ss.str();
+}
+
+void RecoveryProvider::
+find_recoverable_objects(vector<RecoverableObject>& objsOut)
+{
+	objsOut.clear();
+	if(m_path.empty())
+		return;
+
+	QDir recoveryDir(QString::fromLocal8Bit(m_path.c_str()));
+	QStringList sessions = recoveryDir.entryList(QStringList("session*"),
+												 QDir::Dirs | QDir::NoDotAndDotDot);
+	for(int isession = 0; isession < sessions.size(); ++isession){
+		string sessionPath = m_path + "/" + sessions[isession].toLocal8Bit().constData();
+		if(sessionPath == m_sessionPath)
+			continue;
+
+		bool alreadyLocked = false;
+		for(size_t i = 0; i < m_crashedSessions.size(); ++i){
+			if(m_crashedSessions[i].first == sessionPath)
+				alreadyLocked = true;
+		}
+
+	//	sessions of running instances stay locked. Locks of crashed
+	//	instances are stale and are taken over by tryLock.
+		QLockFile* lock = NULL;
+		if(!alreadyLocked){
+			lock = new QLockFile(QString::fromLocal8Bit(sessionPath.c_str())
+								 .append("/session.lock"));
+			lock->setStaleLockTime(0);
+			if(!lock->tryLock(0)){
+				delete lock;
+				continue;
+			}
+			m_crashedSessions.push_back(make_pair(sessionPath, lock));
+		}
+
+	//	find the newest complete generation of each object
+		QDir sessionDir(QString::fromLocal8Bit(sessionPath.c_str()));
+		QStringList infoFiles = sessionDir.entryList(QStringList("*.info"), QDir::Files);
+		vector<pair<string, int> > newest;
+		for(int i = 0; i < infoFiles.size(); ++i){
+			const QString& infoName = infoFiles[i];
+			const int sepPos = infoName.lastIndexOf('_');
+			if(sepPos < 0)
+				continue;
+			bool ok;
+			const int generation = infoName.mid(sepPos + 1, infoName.size() - sepPos - 6)
+											.toInt(&ok);
+			if(!ok)
+				continue;
+
+			string prefix = sessionPath + "/" + infoName.left(sepPos + 1).toLocal8Bit().constData();
+			bool found = false;
+			for(size_t j = 0; j < newest.size(); ++j){
+				if(newest[j].first == prefix){
+					newest[j].second = max(newest[j].second, generation);
+					found = true;
+				}
+			}
+			if(!found)
+				newest.push_back(make_pair(prefix, generation));
+		}
+
+		for(size_t i = 0; i < newest.size(); ++i){
+			stringstream ss;
+			ss << newest[i].first << newest[i].second;
+			const string base = ss.str();
+
+			QFile file(QString::fromLocal8Bit((base + ".info").c_str()));
+			if(!file.open(QIODevice::ReadOnly))
+				continue;
+
+			QDataStream in(&file);
+			quint32 version;
+			QString name, fileName;
+			bool baseIsSourceFile;
+			qint64 sourceSize, sourceMTime;
+			in >> version >> name >> fileName >> baseIsSourceFile
+			   >> sourceSize >> sourceMTime;
+			if(in.status() != QDataStream::Ok || version != RECOVERY_INFO_VERSION)
+				continue;
+
+			RecoverableObject obj;
+			obj.name = name.toLocal8Bit().constData();
+			obj.fileName = fileName.toLocal8Bit().constData();
+			obj.baseIsSourceFile = baseIsSourceFile;
+			obj.journalFile = base + ".journal";
+			if(baseIsSourceFile){
+				QFileInfo sourceInfo(fileName);
+				if(!sourceInfo.exists() || sourceInfo.size() != sourceSize
+				   || sourceInfo.lastModified().toMSecsSinceEpoch() != sourceMTime)
+				{
+					UG_LOG("WARNING: Can't recover '" << obj.name << "', since "
+						   << obj.fileName << " was changed in the meantime.\n");
+					continue;
+				}
+				obj.baseFile = obj.fileName;
+			}
+			else{
+				obj.baseFile = base + RECOVERY_MESH_SUFFIX;
+				obj.idsFile = base + ".ids";
+			}
+			objsOut.push_back(obj);
+		}
+	}
+}
+
+void RecoveryProvider::
+remove_crashed_sessions()
+{
+	for(size_t i = 0; i < m_crashedSessions.size(); ++i){
+		m_crashedSessions[i].second->unlock();
+		delete m_crashedSessions[i].second;
+		QDir(QString::fromLocal8Bit(m_crashedSessions[i].first.c_str())).removeRecursively();
+	}
+	m_crashedSessions.clear();
+}
+
+void RecoveryProvider::
+release_crashed_sessions()
+{
+	for(size_t i = 0; i < m_crashedSessions.size(); ++i){
+		m_crashedSessions[i].second->unlock();
+		delete m_crashedSessions[i].second;
+	}
+	m_crashedSessions.clear();
+}
@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) 2026:  G-CSC, Goethe University Frankfurt
+ * Author: Sebastian Reiter
+ * 
+ * This file is part of ProMesh.
+ * 
+ * ProMesh is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License version 3 (as published by the
+ * Free Software Foundation) with the following additional attribution
+ * requirements (according to LGPL/GPL v3 §7):
+ * 
+ * (1) The following notice must be displayed in the Appropriate Legal Notices
+ * of covered and combined works: "Based on ProMesh (www.promesh3d.com)".
+ * 
+ * (2) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S. and Wittum, G. ProMesh -- a flexible interactive meshing software
+ *   for unstructured hybrid grids in 1, 2, and 3 dimensions. In preparation."
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#ifndef __H__PROMESH_recovery
+#define __H__PROMESH_recovery
+
+#include <string>
+#include <utility>
+#include <vector>
+#include <QElapsedTimer>
+#include "undo.h"
+
+class QLockFile;
+
+///	files from which an object of a crashed session can be recovered
+struct RecoverableObject{
+	RecoverableObject() : baseIsSourceFile(false)	{}
+	std::string	name;
+///	the file from which the object was originally loaded (may be empty)
+	std::string	fileName;
+///	the mesh onto which the journal has to be replayed
+	std::string	baseFile;
+///	ids of the elements of baseFile. Empty if baseIsSourceFile is true.
+	std::string	idsFile;
+	std::string	journalFile;
+	bool		baseIsSourceFile;
+};
+
+///	Writes crash recovery data of one object in the background.
+/**	The data consists of a checkpoint, i.e. a snapshot of the mesh together
+ * with the ids which the UndoJournal assigned to its elements, and of a
+ * journal to which the records of the UndoJournal are appended. Each
+ * checkpoint starts a new generation of files. Files of older generations
+ * are removed once a checkpoint was completely written.
+ *
+ * All files are written by the writer of the RecoveryProvider and are
+ * removed when the journal is released.*/
+class RecoveryJournal
+{
+	public:
+		RecoveryJournal();
+		~RecoveryJournal();
+
+		bool is_initialized() const		{return !m_prefix.empty();}
+
+	///	the id epoch of the UndoJournal at the time of the last checkpoint
+		int id_epoch() const			{return m_idEpoch;}
+
+	///	returns true if a new checkpoint should be written.
+	/**	Checkpoints are taken at most every intervalMSecs milliseconds. The
+	 * interval is extended if copying the mesh for the last checkpoint took
+	 * long, so that checkpoints cost at most 2% of the elapsed time.*/
+		bool checkpoint_due(qint64 intervalMSecs) const;
+
+	///	starts a new generation whose base is the unchanged source file of the object.
+		void write_file_checkpoint(int idEpoch, const std::string& name,
+								   const std::string& sourceFile);
+
+	///	starts a new generation whose base is written by writeMesh.
+	/**	numBytes is the memory held by writeMesh, see UndoFileWriter::enqueue.
+	 *	copyMSecs is the time which was needed to create writeMesh.*/
+		void write_checkpoint(int idEpoch, const std::string& name,
+							  const std::string& fileName,
+							  const UndoHistory::WriteFunc& writeMesh,
+							  size_t numBytes,
+							  const std::string& ids, qint64 copyMSecs);
+
+	///	appends a record to the journal of the current generation.
+		void append(const std::string& record);
+
+	///	removes all files of this journal.
+		void release();
+
+	private:
+		RecoveryJournal(const RecoveryJournal&);
+		RecoveryJournal& operator=(const RecoveryJournal&);
+
+		std::string filename(int generation, const char* suffix) const;
+		void enqueue_info(const std::string& name, const std::string& fileName,
+						  bool baseIsSourceFile);
+
+	private:
+		std::string		m_prefix;
+		int				m_generation;
+		int				m_idEpoch;
+		size_t			m_numRecords;
+		qint64			m_lastCopyMSecs;
+		QElapsedTimer	m_timeSinceCheckpoint;
+};
+
+///	Creates the recovery folder of the current session and finds crashed sessions.
+/**	Each session writes its recovery files to its own folder in
+ * path/recovery, which is locked while the session is running. Folders
+ * which are not locked belong to sessions which crashed.*/
+class RecoveryProvider
+{
+	public:
+		static RecoveryProvider& inst();
+
+	/** creates and locks the session folder in path/recovery.*/
+		bool init(const char* path);
+
+		bool is_initialized() const		{return m_lock != NULL;}
+
+	/** returns a unique prefix for the files of a RecoveryJournal.*/
+		std::string create_journal_prefix();
+
+	/** writes the recovery files of all objects in the background.*/
+		UndoFileWriter& writer()	{return m_writer;}
+
+	/**	locks the folders of crashed sessions and returns the objects they contain.
+	 *	The folders stay locked until either remove_crashed_sessions or
+	 *	release_crashed_sessions is called.*/
+		void find_recoverable_objects(std::vector<RecoverableObject>& objsOut);
+
+	/** removes the folders of crashed sessions which were found by find_recoverable_objects.*/
+		void remove_crashed_sessions();
+
+	/** unlocks the folders of crashed sessions, so that they are found again next time.*/
+		void release_crashed_sessions();
+
+	private:
+		RecoveryProvider();
+		~RecoveryProvider();
+
+	private:
+		typedef std::pair<std::string, QLockFile*>	LockedSession;
+
+		std::string		m_path;			// the recovery folder
+		std::string		m_sessionPath;
+		QLockFile*		m_lock;
+		int				m_journalCounter;
+		std::vector<LockedSession>	m_crashedSessions;
+		UndoFileWriter	m_writer;
+};
+
+#endif	//__H__PROMESH_recovery
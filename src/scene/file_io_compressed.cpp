@@ -0,0 +1,406 @@
+/*
+ * Copyright (c) 2026:  G-CSC, Goethe University Frankfurt
+ * Author: Sebastian Reiter
+ * 
+ * This file is part of ProMesh.
+ * 
+ * ProMesh is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License version 3 (as published by the
+ * Free Software Foundation) with the following additional attribution
+ * requirements (according to LGPL/GPL v3 §7):
+ * 
+ * (1) The following notice must be displayed in the Appropriate Legal Notices
+ * of covered and combined works: "Based on ProMesh (www.promesh3d.com)".
+ * 
+ * (2) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S. and Wittum, G. ProMesh -- a flexible interactive meshing software
+ *   for unstructured hybrid grids in 1, 2, and 3 dimensions. In preparation."
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#include <QByteArray>
+#include <QDataStream>
+#include <QFile>
+#include <QSaveFile>
+#include "file_io_compressed.h"
+#include "common/log.h"
+#include "common/profiler/profiler.h"
+#include "util/parallel_util.h"
+
+using namespace std;
+
+namespace{
+
+const char COMPRESSED_MAGIC[8] = {'P', 'r', 'o', 'M', 'e', 's', 'h', 'Z'};
+const quint32 COMPRESSED_VERSION = 1;
+///	number of uncompressed bytes per block
+const quint32 COMPRESSED_BLOCK_SIZE = 4 * 1024 * 1024;
+
+///	number of blocks which are held in memory and processed concurrently
+size_t BlocksPerBatch()
+{
+	return 2 * NumWorkerThreads();
+}
+
+///	replaces each block by its compressed (or uncompressed) counterpart.
+/**	Returns false if a block couldn't be processed.*/
+bool ProcessBlocks(vector<QByteArray>& blocks, bool compress, int level)
+{
+	vector<char> failed(blocks.size(), 0);
+	ParallelForChunks(blocks.size(), 1,
+		[&blocks, &failed, compress, level](size_t, size_t begin, size_t end)
+	{
+		for(size_t i = begin; i < end; ++i){
+			if(compress)
+				blocks[i] = qCompress(blocks[i], level);
+			else
+				blocks[i] = qUncompress(blocks[i]);
+			failed[i] = blocks[i].isEmpty();
+		}
+	});
+	return find(failed.begin(), failed.end(), 1) == failed.end();
+}
+
+}//	end of anonymous namespace
+
+
+BlockCompressor::
+BlockCompressor(const BlockSink& sink, int level) :
+	m_sink(sink),
+	m_level(max(1, min(level, 9))),
+	m_failed(false)
+{
+	open(QIODevice::WriteOnly);
+}
+
+BlockCompressor::
+~BlockCompressor()
+{
+}
+
+qint64 BlockCompressor::
+writeData(const char* data, qint64 len)
+{
+	if(m_failed)
+		return -1;
+
+	qint64 numWritten = 0;
+	while(numWritten < len){
+		if(m_blocks.empty() || m_blocks.back().size() == (int)COMPRESSED_BLOCK_SIZE){
+			if(m_blocks.size() == BlocksPerBatch() && !flush_blocks())
+				return -1;
+			m_blocks.push_back(QByteArray());
+			m_blocks.back().reserve(COMPRESSED_BLOCK_SIZE);
+		}
+
+		QByteArray& block = m_blocks.back();
+		const qint64 num = min<qint64>(len - numWritten,
+									   COMPRESSED_BLOCK_SIZE - block.size());
+		block.append(data + numWritten, (int)num);
+		numWritten += num;
+	}
+	return numWritten;
+}
+
+bool BlockCompressor::
+flush_blocks()
+{
+	if(!ProcessBlocks(m_blocks, true, m_level))
+		m_failed = true;
+
+	for(size_t i = 0; !m_failed && i < m_blocks.size(); ++i)
+		m_failed = !m_sink(m_blocks[i]);
+
+	m_blocks.clear();
+	return !m_failed;
+}
+
+bool BlockCompressor::
+finish()
+{
+	if(!m_blocks.empty() && !m_blocks.back().isEmpty())
+		flush_blocks();
+	m_blocks.clear();
+	close();
+	return !m_failed;
+}
+
+
+BlockDecompressor::
+BlockDecompressor(const BlockSource& source) :
+	m_source(source),
+	m_curBlock(0),
+	m_curPos(0),
+	m_finished(false),
+	m_failed(false)
+{
+	open(QIODevice::ReadOnly);
+}
+
+bool BlockDecompressor::
+fetch_blocks()
+{
+	m_blocks.clear();
+	m_curBlock = 0;
+	m_curPos = 0;
+	while(!m_finished && m_blocks.size() < BlocksPerBatch()){
+		QByteArray block;
+		if(!m_source(block)){
+			m_failed = true;
+			return false;
+		}
+		if(block.isEmpty())
+			m_finished = true;
+		else
+			m_blocks.push_back(block);
+	}
+
+	if(!ProcessBlocks(m_blocks, false, 0)){
+		m_blocks.clear();
+		m_failed = true;
+		return false;
+	}
+	return !m_blocks.empty();
+}
+
+qint64 BlockDecompressor::
+readData(char* data, qint64 maxLen)
+{
+	qint64 numRead = 0;
+	while(numRead < maxLen){
+		if(m_curBlock == m_blocks.size()){
+			if(m_finished || m_failed || !fetch_blocks())
+				break;
+		}
+
+		const QByteArray& block = m_blocks[m_curBlock];
+		const qint64 num = min<qint64>(maxLen - numRead, block.size() - m_curPos);
+		memcpy(data + numRead, block.constData() + m_curPos, num);
+		numRead += num;
+		m_curPos += num;
+		if(m_curPos == block.size()){
+		//	release decompressed blocks as early as possible
+			m_blocks[m_curBlock] = QByteArray();
+			++m_curBlock;
+			m_curPos = 0;
+		}
+	}
+
+	if(numRead == 0 && m_failed)
+		return -1;
+	return numRead;
+}
+
+qint64 BlockDecompressor::
+bytesAvailable() const
+{
+	qint64 num = QIODevice::bytesAvailable();
+	for(size_t i = m_curBlock; i < m_blocks.size(); ++i)
+		num += m_blocks[i].size();
+	return num - m_curPos;
+}
+
+bool BlockDecompressor::
+atEnd() const
+{
+	return (m_finished || m_failed) && bytesAvailable() == 0;
+}
+
+
+DeviceOStreamBuf::
+DeviceOStreamBuf(QIODevice& dev) :
+	m_dev(dev),
+	m_buf(1 << 16),
+	m_failed(false)
+{
+	setp(&m_buf.front(), &m_buf.front() + m_buf.size());
+}
+
+DeviceOStreamBuf::
+~DeviceOStreamBuf()
+{
+	flush_buffer();
+}
+
+bool DeviceOStreamBuf::
+flush_buffer()
+{
+	const qint64 num = pptr() - pbase();
+	if(num > 0 && !m_failed)
+		m_failed = (m_dev.write(pbase(), num) != num);
+	setp(&m_buf.front(), &m_buf.front() + m_buf.size());
+	return !m_failed;
+}
+
+DeviceOStreamBuf::int_type DeviceOStreamBuf::
+overflow(int_type c)
+{
+	if(!flush_buffer())
+		return traits_type::eof();
+	if(!traits_type::eq_int_type(c, traits_type::eof())){
+		*pptr() = traits_type::to_char_type(c);
+		pbump(1);
+	}
+	return traits_type::not_eof(c);
+}
+
+int DeviceOStreamBuf::
+sync()
+{
+	return flush_buffer() ? 0 : -1;
+}
+
+
+bool WriteCompressedFile(const char* destFilename, int level,
+						 const function<bool (QIODevice& out)>& writeFunc)
+{
+	PROFILE_FUNC();
+	QSaveFile out(destFilename);
+	if(!out.open(QIODevice::WriteOnly)){
+		UG_LOG("ERROR in WriteCompressedFile: Couldn't open " << destFilename << "\n");
+		return false;
+	}
+
+	QDataStream stream(&out);
+	stream.writeRawData(COMPRESSED_MAGIC, sizeof(COMPRESSED_MAGIC));
+	stream << COMPRESSED_VERSION << COMPRESSED_BLOCK_SIZE;
+
+//	blocks are compressed in batches while they are written, so that only
+//	a bounded part of the uncompressed data is held in memory.
+	BlockCompressor compressor([&stream](const QByteArray& block){
+									stream << block;
+									return stream.status() == QDataStream::Ok;
+								}, level);
+	const bool success = writeFunc(compressor);
+	if(!(compressor.finish() && success)){
+		UG_LOG("ERROR in WriteCompressedFile: Couldn't compress the data of "
+			   << destFilename << "\n");
+		out.cancelWriting();
+		return false;
+	}
+
+//	an empty block terminates the file
+	stream << QByteArray();
+
+	if(stream.status() != QDataStream::Ok || !out.commit()){
+		UG_LOG("ERROR in WriteCompressedFile: Couldn't write " << destFilename << "\n");
+		return false;
+	}
+	return true;
+}
+
+
+bool ReadCompressedFile(const char* srcFilename,
+						const function<bool (QIODevice& in)>& readFunc)
+{
+	PROFILE_FUNC();
+	QFile in(srcFilename);
+	if(!in.open(QIODevice::ReadOnly)){
+		UG_LOG("ERROR in ReadCompressedFile: Couldn't open " << srcFilename << "\n");
+		return false;
+	}
+
+	QDataStream stream(&in);
+	char magic[sizeof(COMPRESSED_MAGIC)];
+	quint32 version = 0, blockSize = 0;
+	if(stream.readRawData(magic, sizeof(magic)) != (int)sizeof(magic)
+	   || memcmp(magic, COMPRESSED_MAGIC, sizeof(magic)) != 0)
+	{
+		UG_LOG("ERROR in ReadCompressedFile: " << srcFilename
+			   << " is not a compressed ProMesh file\n");
+		return false;
+	}
+
+	stream >> version >> blockSize;
+	if(version > COMPRESSED_VERSION){
+		UG_LOG("ERROR in ReadCompressedFile: " << srcFilename
+			   << " was written by a newer version of ProMesh\n");
+		return false;
+	}
+
+	BlockDecompressor decompressor([&stream](QByteArray& blockOut){
+										stream >> blockOut;
+										return stream.status() == QDataStream::Ok;
+									});
+	const bool success = readFunc(decompressor);
+	if(decompressor.failed()){
+		UG_LOG("ERROR in ReadCompressedFile: " << srcFilename
+			   << " is truncated or corrupted\n");
+		return false;
+	}
+	return success;
+}
+
+
+bool ReadCompressedFile(const char* srcFilename, QByteArray& dataOut)
+{
+	dataOut.clear();
+	return ReadCompressedFile(srcFilename, [&dataOut](QIODevice& in){
+										dataOut = in.readAll();
+										return true;
+									});
+}
+
+
+bool CompressFile(const char* srcFilename, const char* destFilename, int level)
+{
+	PROFILE_FUNC();
+	QFile in(srcFilename);
+	if(!in.open(QIODevice::ReadOnly)){
+		UG_LOG("ERROR in CompressFile: Couldn't open " << srcFilename << "\n");
+		return false;
+	}
+
+	return WriteCompressedFile(destFilename, level, [&in](QIODevice& out){
+		while(!in.atEnd()){
+			QByteArray data = in.read(COMPRESSED_BLOCK_SIZE);
+			if(in.error() != QFileDevice::NoError || out.write(data) != data.size())
+				return false;
+		}
+		return true;
+	});
+}
+
+
+bool DecompressFile(const char* srcFilename, const char* destFilename)
+{
+	PROFILE_FUNC();
+	QFile out(destFilename);
+	if(!out.open(QIODevice::WriteOnly | QIODevice::Truncate)){
+		UG_LOG("ERROR in DecompressFile: Couldn't open " << destFilename << "\n");
+		return false;
+	}
+
+	return ReadCompressedFile(srcFilename, [&out, destFilename](QIODevice& in){
+		while(!in.atEnd()){
+			QByteArray data = in.read(COMPRESSED_BLOCK_SIZE);
+			if(out.write(data) != data.size()){
+				UG_LOG("ERROR in DecompressFile: Couldn't write " << destFilename << "\n");
+				return false;
+			}
+		}
+		return true;
+	});
+}
+
+
+const char* UncompressedMeshSuffix(const char* suffix)
+{
+	if(!suffix)
+		return NULL;
+	if(strcmp(suffix, ".ugxz") == 0)
+		return ".ugx";
+	if(strcmp(suffix, ".lgbz") == 0)
+		return ".lgb";
+	if(strcmp(suffix, ".pmbz") == 0)
+		return ".pmb";
+	return NULL;
+}
@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2026:  G-CSC, Goethe University Frankfurt
+ * Author: Sebastian Reiter
+ * 
+ * This file is part of ProMesh.
+ * 
+ * ProMesh is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License version 3 (as published by the
+ * Free Software Foundation) with the following additional attribution
+ * requirements (according to LGPL/GPL v3 §7):
+ * 
+ * (1) The following notice must be displayed in the Appropriate Legal Notices
+ * of covered and combined works: "Based on ProMesh (www.promesh3d.com)".
+ * 
+ * (2) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S. and Wittum, G. ProMesh -- a flexible interactive meshing software
+ *   for unstructured hybrid grids in 1, 2, and 3 dimensions. In preparation."
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#ifndef __H__PROMESH_file_io_compressed
+#define __H__PROMESH_file_io_compressed
+
+#include <functional>
+#include <streambuf>
+#include <vector>
+#include <QByteArray>
+#include <QIODevice>
+
+///	Compresses the data which is written to it in independent zlib blocks.
+/**	Written data is collected in blocks of a fixed size. Batches of full
+ * blocks are compressed concurrently and passed in order to the block sink,
+ * so that only a bounded amount of uncompressed data is held in memory.
+ * Call finish after all data was written.*/
+class BlockCompressor : public QIODevice
+{
+	public:
+	///	receives the compressed blocks in order. Returning false aborts compression.
+		typedef std::function<bool (const QByteArray& block)>	BlockSink;
+
+		BlockCompressor(const BlockSink& sink, int level);
+		virtual ~BlockCompressor();
+
+	///	compresses the remaining data and closes the device.
+	/**	Returns false if a block couldn't be compressed or passed to the sink.*/
+		bool finish();
+
+		virtual bool isSequential() const	{return true;}
+
+	protected:
+		virtual qint64 readData(char*, qint64)	{return -1;}
+		virtual qint64 writeData(const char* data, qint64 len);
+
+	private:
+		bool flush_blocks();
+
+		BlockSink				m_sink;
+		int						m_level;
+		std::vector<QByteArray>	m_blocks;
+		bool					m_failed;
+};
+
+///	Provides the data of blocks which were written by a BlockCompressor.
+/**	Batches of blocks are fetched from the block source and decompressed
+ * concurrently while the device is read.*/
+class BlockDecompressor : public QIODevice
+{
+	public:
+	///	provides the next compressed block. An empty block marks the end of the data.
+	/**	Returning false indicates an error.*/
+		typedef std::function<bool (QByteArray& blockOut)>	BlockSource;
+
+		BlockDecompressor(const BlockSource& source);
+
+	///	true if a block couldn't be fetched or decompressed
+		bool failed() const		{return m_failed;}
+
+		virtual bool isSequential() const	{return true;}
+		virtual bool atEnd() const;
+		virtual qint64 bytesAvailable() const;
+
+	protected:
+		virtual qint64 readData(char* data, qint64 maxLen);
+		virtual qint64 writeData(const char*, qint64)	{return -1;}
+
+	private:
+		bool fetch_blocks();
+
+		BlockSource				m_source;
+		std::vector<QByteArray>	m_blocks;
+		size_t					m_curBlock;
+		qint64					m_curPos;
+		bool					m_finished;
+		bool					m_failed;
+};
+
+///	A stream buffer which passes the data of a std::ostream to a QIODevice.
+/**	Allows serializers which write to a std::ostream to write directly into
+ * a BlockCompressor. failed() returns true if the device rejected data.*/
+class DeviceOStreamBuf : public std::streambuf
+{
+	public:
+		DeviceOStreamBuf(QIODevice& dev);
+		virtual ~DeviceOStreamBuf();
+
+		bool failed() const		{return m_failed;}
+
+	protected:
+		virtual int_type overflow(int_type c);
+		virtual int sync();
+
+	private:
+		bool flush_buffer();
+
+		QIODevice&			m_dev;
+		std::vector<char>	m_buf;
+		bool				m_failed;
+};
+
+///	Writes a file in the block compressed ProMesh container.
+/**	writeFunc writes the uncompressed data to a sequential device. The data
+ * is compressed in batches of blocks while it is written, so that the
+ * uncompressed data is never stored as a whole. The destination file is
+ * only replaced if writing and compression succeeded.
+ *
+ * \param level	zlib compression level between 1 (fastest) and 9 (smallest).*/
+bool WriteCompressedFile(const char* destFilename, int level,
+						 const std::function<bool (QIODevice& out)>& writeFunc);
+
+///	Reads a file which was written by WriteCompressedFile or CompressFile.
+/**	readFunc reads the uncompressed data from a sequential device. Blocks are
+ * decompressed in batches while they are read. Returns false if readFunc
+ * failed or if the file is corrupt.*/
+bool ReadCompressedFile(const char* srcFilename,
+						const std::function<bool (QIODevice& in)>& readFunc);
+
+///	Reads the uncompressed data of a file which was written by WriteCompressedFile into dataOut.
+bool ReadCompressedFile(const char* srcFilename, QByteArray& dataOut);
+
+///	Compresses a file into the block compressed ProMesh container.
+/**	The source file is split into blocks of equal size, which are compressed
+ * independently and concurrently with zlib. The destination file is only
+ * replaced if compression succeeded.
+ *
+ * \param level	zlib compression level between 1 (fastest) and 9 (smallest).*/
+bool CompressFile(const char* srcFilename, const char* destFilename, int level);
+
+///	Restores a file which was written by CompressFile. Blocks are decompressed concurrently.
+bool DecompressFile(const char* srcFilename, const char* destFilename);
+
+///	returns the suffix of the uncompressed format of a compressed mesh file suffix.
+/**	E.g. ".lgb" for ".lgbz". Returns NULL if the given suffix is not the suffix
+ * of a compressed mesh file.*/
+const char* UncompressedMeshSuffix(const char* suffix);
+
+#endif	//__H__PROMESH_file_io_compressed
@@ -0,0 +1,979 @@
+/*
+ * Copyright (c) 2026:  G-CSC, Goethe University Frankfurt
+ * Author: Sebastian Reiter
+ * 
+ * This file is part of ProMesh.
+ * 
+ * ProMesh is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License version 3 (as published by the
+ * Free Software Foundation) with the following additional attribution
+ * requirements (according to LGPL/GPL v3 §7):
+ * 
+ * (1) The following notice must be displayed in the Appropriate Legal Notices
+ * of covered and combined works: "Based on ProMesh (www.promesh3d.com)".
+ * 
+ * (2) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S. and Wittum, G. ProMesh -- a flexible interactive meshing software
+ *   for unstructured hybrid grids in 1, 2, and 3 dimensions. In preparation."
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include <atomic>
+#include <cstring>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include <stdint.h>
+#include <QFile>
+#include <QSaveFile>
+#include <boost/archive/text_iarchive.hpp>
+#include <boost/archive/text_oarchive.hpp>
+#include "file_io_pmb.h"
+#include "partial_load.h"
+#include "util/mapped_file.h"
+#include "common/boost_serialization_routines.h"
+#include "common/profiler/profiler.h"
+#include "common/util/archivar.h"
+#include "common/util/factory.h"
+#include "lib_grid/refinement/projectors/projectors.h"
+
+using namespace std;
+using namespace ug;
+
+namespace{
+
+const char PMB_MAGIC[8] = {'P', 'r', 'o', 'M', 'e', 's', 'h', 'B'};
+const uint32_t PMB_VERSION = 1;
+const uint32_t PMB_BYTE_ORDER = 0x01020304;
+
+///	tags of the sections of a .pmb file.
+/**	Sections with an index exist once per subset handler or selector.*/
+enum PMBSectionTag{
+	PMB_COUNTS = 1,
+	PMB_POSITIONS = 2,
+	PMB_EDGE_VERTICES = 3,
+	PMB_FACE_TYPES = 4,
+	PMB_FACE_VERTICES = 5,
+	PMB_VOLUME_TYPES = 6,
+	PMB_VOLUME_VERTICES = 7,
+	PMB_SUBSET_INFOS = 8,
+	PMB_SUBSET_INDICES = 9,
+	PMB_SELECTION = 10,
+	PMB_PROJECTORS = 11
+};
+
+///	volume types as stored in PMB_VOLUME_TYPES. Faces are stored by their number of corners.
+enum PMBVolumeType{
+	PMB_TETRAHEDRON = 0,
+	PMB_PYRAMID = 1,
+	PMB_PRISM = 2,
+	PMB_HEXAHEDRON = 3,
+	PMB_OCTAHEDRON = 4,
+	PMB_NUM_VOLUME_TYPES
+};
+
+const size_t PMB_VOLUME_CORNERS[PMB_NUM_VOLUME_TYPES] = {4, 5, 6, 8, 6};
+
+struct PMBHeader{
+	char		magic[8];
+	uint32_t	version;
+	uint32_t	byteOrder;
+	uint32_t	numberSize;
+	uint32_t	reserved;
+};
+
+struct PMBSectionHeader{
+	uint32_t	tag;
+	uint32_t	index;
+	uint64_t	numBytes;
+};
+
+///	number of vertices, edges, faces and volumes
+struct PMBCounts{
+	uint64_t	num[4];
+	uint64_t	total() const	{return num[0] + num[1] + num[2] + num[3];}
+};
+
+struct PMBSection{
+	const char*	data;
+	uint64_t	numBytes;
+};
+
+typedef map<pair<uint32_t, uint32_t>, PMBSection>	PMBSectionMap;
+typedef Factory<RefinementProjector, ProjectorTypes>	ProjectorFactory;
+
+inline uint64_t PaddedSize(uint64_t numBytes)
+{
+	return (numBytes + 7) & ~uint64_t(7);
+}
+
+///	Buffers the sections of a .pmb file and writes them to a device.
+class PMBWriter
+{
+	public:
+		PMBWriter(QIODevice& out) :
+			m_out(out), m_ok(true), m_sectionBytesLeft(0), m_padding(0)	{}
+
+		void write_header()
+		{
+			PMBHeader header;
+			memcpy(header.magic, PMB_MAGIC, sizeof(PMB_MAGIC));
+			header.version = PMB_VERSION;
+			header.byteOrder = PMB_BYTE_ORDER;
+			header.numberSize = sizeof(number);
+			header.reserved = 0;
+			write_raw(&header, sizeof(header));
+		}
+
+		void begin_section(uint32_t tag, uint32_t index, uint64_t numBytes)
+		{
+			PMBSectionHeader sh;
+			sh.tag = tag;
+			sh.index = index;
+			sh.numBytes = numBytes;
+			write_raw(&sh, sizeof(sh));
+			m_sectionBytesLeft = numBytes;
+			m_padding = PaddedSize(numBytes) - numBytes;
+		}
+
+		void write(const void* data, size_t numBytes)
+		{
+			UG_COND_THROW(numBytes > m_sectionBytesLeft,
+						  "PMBWriter: Section exceeds its announced size.");
+			m_sectionBytesLeft -= numBytes;
+			write_raw(data, numBytes);
+		}
+
+		template <class T>
+		void write(const T& val)	{write(&val, sizeof(T));}
+
+		void end_section()
+		{
+			UG_COND_THROW(m_sectionBytesLeft != 0,
+						  "PMBWriter: Section is smaller than its announced size.");
+			static const char zeros[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+			write_raw(zeros, m_padding);
+		}
+
+		bool flush()
+		{
+			if(!m_buf.empty()){
+				if(m_out.write(m_buf.data(), m_buf.size()) != (qint64)m_buf.size())
+					m_ok = false;
+				m_buf.clear();
+			}
+			return m_ok;
+		}
+
+	private:
+		void write_raw(const void* data, size_t numBytes)
+		{
+			m_buf.append(reinterpret_cast<const char*>(data), numBytes);
+			if(m_buf.size() >= (4 << 20))
+				flush();
+		}
+
+	private:
+		QIODevice&	m_out;
+		bool		m_ok;
+		uint64_t	m_sectionBytesLeft;
+		uint64_t	m_padding;
+		string		m_buf;
+};
+
+template <class T>
+void AppendValue(string& out, const T& val)
+{
+	out.append(reinterpret_cast<const char*>(&val), sizeof(T));
+}
+
+void AppendString(string& out, const string& str)
+{
+	AppendValue(out, (uint64_t)str.size());
+	out.append(str);
+}
+
+template <class T>
+bool ReadValue(const PMBSection& sec, uint64_t& pos, T& valOut)
+{
+	if(sec.numBytes - pos < sizeof(T))
+		return false;
+	memcpy(&valOut, sec.data + pos, sizeof(T));
+	pos += sizeof(T);
+	return true;
+}
+
+bool ReadString(const PMBSection& sec, uint64_t& pos, string& strOut)
+{
+	uint64_t len;
+	if(!ReadValue(sec, pos, len) || len > sec.numBytes - pos)
+		return false;
+	strOut.assign(sec.data + pos, (size_t)len);
+	pos += len;
+	return true;
+}
+
+string SerializeSubsetInfos(ISubsetHandler& sh)
+{
+	string out;
+	AppendValue(out, (uint64_t)sh.num_subsets());
+	for(int i = 0; i < sh.num_subsets(); ++i){
+		const SubsetInfo& si = sh.subset_info(i);
+		AppendString(out, si.name);
+		AppendValue(out, si.materialIndex);
+		AppendValue(out, si.color);
+		AppendValue(out, si.subsetState);
+	}
+	return out;
+}
+
+///	restores the subset infos of a PMB_SUBSET_INFOS section.
+/**	numSubsetsOut receives the number of subsets which are stored in the section.*/
+bool DeserializeSubsetInfos(ISubsetHandler& sh, const PMBSection& sec,
+							int& numSubsetsOut)
+{
+	uint64_t pos = 0;
+	uint64_t num;
+	if(!ReadValue(sec, pos, num) || num > sec.numBytes)
+		return false;
+	numSubsetsOut = (int)num;
+	for(int i = 0; i < (int)num; ++i){
+		SubsetInfo si;
+		if(!(ReadString(sec, pos, si.name)
+			 && ReadValue(sec, pos, si.materialIndex)
+			 && ReadValue(sec, pos, si.color)
+			 && ReadValue(sec, pos, si.subsetState)))
+		{
+			return false;
+		}
+		sh.subset_info(i) = si;
+	}
+	return true;
+}
+
+///	serializes the projectors of the first numSubsets subsets.
+string SerializeProjectors(ProjectionHandler& ph, int numSubsets)
+{
+	static ProjectorFactory factory;
+	static Archivar<boost::archive::text_oarchive,
+					RefinementProjector,
+					ProjectorTypes>	archivar;
+
+	vector<pair<int, pair<string, string> > > entries;
+	for(int i = 0; i < numSubsets; ++i){
+		SPRefinementProjector proj = ph.projector(i);
+		if(proj.invalid())
+			continue;
+		ostringstream os;
+		{
+			boost::archive::text_oarchive oa(os);
+			archivar.archive(oa, *proj);
+		}
+		entries.push_back(make_pair(i, make_pair(factory.class_name(*proj), os.str())));
+	}
+
+	string out;
+	AppendValue(out, (uint64_t)entries.size());
+	for(size_t i = 0; i < entries.size(); ++i){
+		AppendValue(out, (int32_t)entries[i].first);
+		AppendString(out, entries[i].second.first);
+		AppendString(out, entries[i].second.second);
+	}
+	return out;
+}
+
+bool DeserializeProjectors(ProjectionHandler& ph, const PMBSection& sec)
+{
+	static ProjectorFactory factory;
+	static Archivar<boost::archive::text_iarchive,
+					RefinementProjector,
+					ProjectorTypes>	archivar;
+
+	uint64_t pos = 0;
+	uint64_t num;
+	if(!ReadValue(sec, pos, num) || num > sec.numBytes)
+		return false;
+	for(uint64_t i = 0; i < num; ++i){
+		int32_t si;
+		string name, data;
+		if(!(ReadValue(sec, pos, si) && ReadString(sec, pos, name)
+			 && ReadString(sec, pos, data)))
+		{
+			return false;
+		}
+
+		try{
+			SPRefinementProjector proj = factory.create(name);
+			proj->set_geometry(ph.geometry());
+			istringstream is(data);
+			{
+				boost::archive::text_iarchive ia(is);
+				archivar.archive(ia, *proj);
+			}
+			ph.set_projector(si, proj);
+		}
+		catch(...){
+			UG_LOG("WARNING in LoadGridFromPMB: Couldn't restore projector '"
+				   << name << "' of subset " << si << ".\n");
+		}
+	}
+	return true;
+}
+
+template <class TElem>
+void WriteSubsetIndices(PMBWriter& w, Grid& grid, ISubsetHandler& sh)
+{
+	typedef typename geometry_traits<TElem>::iterator iter_t;
+	for(iter_t iter = grid.begin<TElem>(); iter != grid.end<TElem>(); ++iter)
+		w.write((int32_t)sh.get_subset_index(*iter));
+}
+
+template <class TElem>
+void WriteSelectionStates(PMBWriter& w, Grid& grid, ISelector& sel)
+{
+	typedef typename geometry_traits<TElem>::iterator iter_t;
+	for(iter_t iter = grid.begin<TElem>(); iter != grid.end<TElem>(); ++iter)
+		w.write((uint8_t)sel.get_selection_status(*iter));
+}
+
+///	returns true if all indices of a PMB_SUBSET_INDICES section are -1 or a valid subset.
+/**	Checked before any subset is assigned, since ISubsetHandler creates all
+ * subsets up to the highest assigned index.*/
+bool SubsetIndicesValid(const PMBSection& sec, int numSubsets)
+{
+	const size_t num = (size_t)(sec.numBytes / sizeof(int32_t));
+	for(size_t i = 0; i < num; ++i){
+		int32_t si;
+		memcpy(&si, sec.data + i * sizeof(int32_t), sizeof(int32_t));
+		if(si < -1 || si >= numSubsets)
+			return false;
+	}
+	return true;
+}
+
+template <class TElem>
+const char* AssignSubsetIndices(ISubsetHandler& sh, const vector<TElem*>& elems,
+								const char* data)
+{
+	for(size_t i = 0; i < elems.size(); ++i){
+		int32_t si;
+		memcpy(&si, data + i * sizeof(int32_t), sizeof(int32_t));
+		if(si >= 0 && elems[i])
+			sh.assign_subset(elems[i], si);
+	}
+	return data + elems.size() * sizeof(int32_t);
+}
+
+template <class TElem>
+const char* AssignSelectionStates(ISelector& sel, const vector<TElem*>& elems,
+								  const char* data)
+{
+	for(size_t i = 0; i < elems.size(); ++i){
+		uint8_t status = (uint8_t)data[i];
+		if(status && elems[i])
+			sel.select(elems[i], status);
+	}
+	return data + elems.size();
+}
+
+const PMBSection* FindSection(const PMBSectionMap& sections, uint32_t tag,
+							  uint32_t index = 0)
+{
+	PMBSectionMap::const_iterator iter = sections.find(make_pair(tag, index));
+	if(iter == sections.end())
+		return NULL;
+	return &iter->second;
+}
+
+///	returns true if the cancel flag of a load was set
+inline bool IsCanceled(const atomic<bool>* canceled)
+{
+	return canceled && canceled->load(memory_order_relaxed);
+}
+
+inline uint32_t ReadIndex(const char* data, size_t i)
+{
+	uint32_t ind;
+	memcpy(&ind, data + i * sizeof(uint32_t), sizeof(uint32_t));
+	return ind;
+}
+
+///	the sections of a .pmb file which describe the geometry.
+class PMBGeometry
+{
+	public:
+	///	parses the header and the sections and validates the geometry.
+	/**	caller is used in error messages.*/
+		bool parse(const char* data, size_t size, const char* caller);
+
+		size_t num(int dim) const	{return (size_t)counts.num[dim];}
+
+		size_t num_corners(int dim, size_t i) const
+		{
+			switch(dim){
+				case 0:	return 1;
+				case 1:	return 2;
+				case 2:	return faceOffsets[i + 1] - faceOffsets[i];
+				default:	return volOffsets[i + 1] - volOffsets[i];
+			}
+		}
+
+	///	returns the index of the j-th corner of the i-th element of dimension dim
+		uint32_t corner(int dim, size_t i, size_t j) const
+		{
+			switch(dim){
+				case 0:	return (uint32_t)i;
+				case 1:	return ReadIndex(secEdges->data, 2 * i + j);
+				case 2:	return ReadIndex(secFaceVrts->data, faceOffsets[i] + j);
+				default:	return ReadIndex(secVolVrts->data, volOffsets[i] + j);
+			}
+		}
+
+		vector3 position(size_t i) const
+		{
+			vector3 p;
+			memcpy(&p, secPos->data + i * sizeof(vector3), sizeof(vector3));
+			return p;
+		}
+
+	///	the subset index of the i-th element of dimension dim in the first subset handler
+		int subset_index(int dim, size_t i) const;
+
+	public:
+		PMBSectionMap		sections;
+		PMBCounts			counts;
+		const PMBSection*	secPos;
+		const PMBSection*	secEdges;
+		const PMBSection*	secFaceTypes;
+		const PMBSection*	secFaceVrts;
+		const PMBSection*	secVolTypes;
+		const PMBSection*	secVolVrts;
+	///	subset indices of the first subset handler. May be NULL.
+		const PMBSection*	secSubsets;
+	///	offsets of the corner indices of each face and volume and a final entry
+		vector<size_t>		faceOffsets;
+		vector<size_t>		volOffsets;
+};
+
+bool PMBGeometry::
+parse(const char* data, size_t size, const char* caller)
+{
+	PMBHeader header;
+	if(size < sizeof(header)){
+		UG_LOG("ERROR in " << caller << ": File is too small.\n");
+		return false;
+	}
+	memcpy(&header, data, sizeof(header));
+	if(memcmp(header.magic, PMB_MAGIC, sizeof(PMB_MAGIC)) != 0){
+		UG_LOG("ERROR in " << caller << ": Not a .pmb file.\n");
+		return false;
+	}
+	if(header.version > PMB_VERSION){
+		UG_LOG("ERROR in " << caller << ": The file was written by a newer version of ProMesh.\n");
+		return false;
+	}
+	if(header.byteOrder != PMB_BYTE_ORDER || header.numberSize != sizeof(number)){
+		UG_LOG("ERROR in " << caller << ": The file was written on an incompatible platform.\n");
+		return false;
+	}
+
+//	collect all sections. Unknown sections are ignored.
+	uint64_t pos = sizeof(header);
+	while(pos < size){
+		PMBSectionHeader sh;
+		if(size - pos < sizeof(sh)){
+			UG_LOG("ERROR in " << caller << ": File is truncated.\n");
+			return false;
+		}
+		memcpy(&sh, data + pos, sizeof(sh));
+		pos += sizeof(sh);
+		if(sh.numBytes > size - pos){
+			UG_LOG("ERROR in " << caller << ": File is truncated.\n");
+			return false;
+		}
+		PMBSection sec;
+		sec.data = data + pos;
+		sec.numBytes = sh.numBytes;
+		sections[make_pair(sh.tag, sh.index)] = sec;
+		pos += min<uint64_t>(PaddedSize(sh.numBytes), size - pos);
+	}
+
+	const PMBSection* secCounts = FindSection(sections, PMB_COUNTS);
+	if(!secCounts || secCounts->numBytes != sizeof(counts)){
+		UG_LOG("ERROR in " << caller << ": Element counts are missing.\n");
+		return false;
+	}
+	memcpy(&counts, secCounts->data, sizeof(counts));
+
+	secPos = FindSection(sections, PMB_POSITIONS);
+	secEdges = FindSection(sections, PMB_EDGE_VERTICES);
+	secFaceTypes = FindSection(sections, PMB_FACE_TYPES);
+	secFaceVrts = FindSection(sections, PMB_FACE_VERTICES);
+	secVolTypes = FindSection(sections, PMB_VOLUME_TYPES);
+	secVolVrts = FindSection(sections, PMB_VOLUME_VERTICES);
+	secSubsets = FindSection(sections, PMB_SUBSET_INDICES, 0);
+	if(secSubsets && secSubsets->numBytes != counts.total() * sizeof(int32_t))
+		secSubsets = NULL;
+	if(!(secPos && secEdges && secFaceTypes && secFaceVrts && secVolTypes && secVolVrts)
+	   || secPos->numBytes != counts.num[0] * sizeof(vector3)
+	   || secEdges->numBytes != counts.num[1] * 2 * sizeof(uint32_t)
+	   || secFaceTypes->numBytes != counts.num[2]
+	   || secVolTypes->numBytes != counts.num[3])
+	{
+		UG_LOG("ERROR in " << caller << ": Geometry sections are missing or corrupt.\n");
+		return false;
+	}
+
+//	offsets of the corners of faces and volumes
+	const size_t numFaceInds = (size_t)(secFaceVrts->numBytes / sizeof(uint32_t));
+	faceOffsets.resize(num(2) + 1);
+	faceOffsets[0] = 0;
+	for(size_t i = 0; i < num(2); ++i){
+		const size_t numCorners = (uint8_t)secFaceTypes->data[i];
+		faceOffsets[i + 1] = faceOffsets[i] + numCorners;
+		if((numCorners != 3 && numCorners != 4) || faceOffsets[i + 1] > numFaceInds){
+			UG_LOG("ERROR in " << caller << ": Invalid face.\n");
+			return false;
+		}
+	}
+
+	const size_t numVolInds = (size_t)(secVolVrts->numBytes / sizeof(uint32_t));
+	volOffsets.resize(num(3) + 1);
+	volOffsets[0] = 0;
+	for(size_t i = 0; i < num(3); ++i){
+		const uint8_t type = (uint8_t)secVolTypes->data[i];
+		if(type >= PMB_NUM_VOLUME_TYPES
+		   || volOffsets[i] + PMB_VOLUME_CORNERS[type] > numVolInds)
+		{
+			UG_LOG("ERROR in " << caller << ": Invalid volume.\n");
+			return false;
+		}
+		volOffsets[i + 1] = volOffsets[i] + PMB_VOLUME_CORNERS[type];
+	}
+
+//	all corners have to reference existing vertices
+	static const char* elemNames[] = {"vertex", "edge", "face", "volume"};
+	for(int dim = 1; dim < 4; ++dim){
+		for(size_t i = 0; i < num(dim); ++i){
+			for(size_t j = 0; j < num_corners(dim, i); ++j){
+				if(corner(dim, i, j) >= num(0)){
+					UG_LOG("ERROR in " << caller << ": Invalid " << elemNames[dim] << ".\n");
+					return false;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+int PMBGeometry::
+subset_index(int dim, size_t i) const
+{
+	if(!secSubsets)
+		return -1;
+	uint64_t ind = i;
+	for(int d = 0; d < dim; ++d)
+		ind += counts.num[d];
+	int32_t si;
+	memcpy(&si, secSubsets->data + ind * sizeof(int32_t), sizeof(int32_t));
+	return si;
+}
+
+}//	end of anonymous namespace
+
+
+bool WriteGridToPMB(Grid& grid, QIODevice& out,
+					ISubsetHandler** ppSH, int numSHs,
+					ISelector** ppSel, int numSels,
+					ProjectionHandler* pPH)
+{
+	PROFILE_FUNC();
+	if(!grid.has_vertex_attachment(aPosition)){
+		UG_LOG("ERROR in WriteGridToPMB: Grid has no position attachment.\n");
+		return false;
+	}
+
+	Grid::VertexAttachmentAccessor<APosition> aaPos(grid, aPosition);
+
+	PMBWriter w(out);
+	w.write_header();
+
+	PMBCounts counts;
+	counts.num[0] = grid.num<Vertex>();
+	counts.num[1] = grid.num<Edge>();
+	counts.num[2] = grid.num<Face>();
+	counts.num[3] = grid.num<Volume>();
+	w.begin_section(PMB_COUNTS, 0, sizeof(counts));
+	w.write(counts);
+	w.end_section();
+
+//	positions. Each vertex is associated with its index for the connectivity below.
+	AInt aInd;
+	grid.attach_to_vertices(aInd);
+	Grid::VertexAttachmentAccessor<AInt> aaInd(grid, aInd);
+
+	w.begin_section(PMB_POSITIONS, 0, counts.num[0] * sizeof(vector3));
+	int ind = 0;
+	for(VertexIterator iter = grid.begin<Vertex>(); iter != grid.end<Vertex>(); ++iter){
+		w.write(aaPos[*iter]);
+		aaInd[*iter] = ind++;
+	}
+	w.end_section();
+
+	w.begin_section(PMB_EDGE_VERTICES, 0, counts.num[1] * 2 * sizeof(uint32_t));
+	for(EdgeIterator iter = grid.begin<Edge>(); iter != grid.end<Edge>(); ++iter){
+		w.write((uint32_t)aaInd[(*iter)->vertex(0)]);
+		w.write((uint32_t)aaInd[(*iter)->vertex(1)]);
+	}
+	w.end_section();
+
+	uint64_t numFaceCorners = 0;
+	w.begin_section(PMB_FACE_TYPES, 0, counts.num[2]);
+	for(FaceIterator iter = grid.begin<Face>(); iter != grid.end<Face>(); ++iter){
+		w.write((uint8_t)(*iter)->num_vertices());
+		numFaceCorners += (*iter)->num_vertices();
+	}
+	w.end_section();
+
+	w.begin_section(PMB_FACE_VERTICES, 0, numFaceCorners * sizeof(uint32_t));
+	for(FaceIterator iter = grid.begin<Face>(); iter != grid.end<Face>(); ++iter){
+		Face::ConstVertexArray vrts = (*iter)->vertices();
+		const size_t numVrts = (*iter)->num_vertices();
+		for(size_t i = 0; i < numVrts; ++i)
+			w.write((uint32_t)aaInd[vrts[i]]);
+	}
+	w.end_section();
+
+	uint64_t numVolCorners = 0;
+	w.begin_section(PMB_VOLUME_TYPES, 0, counts.num[3]);
+	for(VolumeIterator iter = grid.begin<Volume>(); iter != grid.end<Volume>(); ++iter){
+		uint8_t type;
+		switch((*iter)->reference_object_id()){
+			case ROID_TETRAHEDRON:	type = PMB_TETRAHEDRON; break;
+			case ROID_PYRAMID:		type = PMB_PYRAMID; break;
+			case ROID_PRISM:		type = PMB_PRISM; break;
+			case ROID_HEXAHEDRON:	type = PMB_HEXAHEDRON; break;
+			case ROID_OCTAHEDRON:	type = PMB_OCTAHEDRON; break;
+			default:
+				grid.detach_from_vertices(aInd);
+				UG_LOG("ERROR in WriteGridToPMB: Unsupported volume type.\n");
+				return false;
+		}
+		w.write(type);
+		numVolCorners += (*iter)->num_vertices();
+	}
+	w.end_section();
+
+	w.begin_section(PMB_VOLUME_VERTICES, 0, numVolCorners * sizeof(uint32_t));
+	for(VolumeIterator iter = grid.begin<Volume>(); iter != grid.end<Volume>(); ++iter){
+		Volume::ConstVertexArray vrts = (*iter)->vertices();
+		const size_t numVrts = (*iter)->num_vertices();
+		for(size_t i = 0; i < numVrts; ++i)
+			w.write((uint32_t)aaInd[vrts[i]]);
+	}
+	w.end_section();
+
+	grid.detach_from_vertices(aInd);
+
+	for(int i = 0; i < numSHs; ++i){
+		if(!ppSH[i])
+			continue;
+		ISubsetHandler& sh = *ppSH[i];
+		string infos = SerializeSubsetInfos(sh);
+		w.begin_section(PMB_SUBSET_INFOS, i, infos.size());
+		w.write(infos.data(), infos.size());
+		w.end_section();
+
+		w.begin_section(PMB_SUBSET_INDICES, i, counts.total() * sizeof(int32_t));
+		WriteSubsetIndices<Vertex>(w, grid, sh);
+		WriteSubsetIndices<Edge>(w, grid, sh);
+		WriteSubsetIndices<Face>(w, grid, sh);
+		WriteSubsetIndices<Volume>(w, grid, sh);
+		w.end_section();
+	}
+
+	for(int i = 0; i < numSels; ++i){
+		if(!ppSel[i])
+			continue;
+		ISelector& sel = *ppSel[i];
+		w.begin_section(PMB_SELECTION, i, counts.total());
+		WriteSelectionStates<Vertex>(w, grid, sel);
+		WriteSelectionStates<Edge>(w, grid, sel);
+		WriteSelectionStates<Face>(w, grid, sel);
+		WriteSelectionStates<Volume>(w, grid, sel);
+		w.end_section();
+	}
+
+	if(pPH && numSHs > 0 && ppSH[0]){
+		string projs = SerializeProjectors(*pPH, ppSH[0]->num_subsets());
+		w.begin_section(PMB_PROJECTORS, 0, projs.size());
+		w.write(projs.data(), projs.size());
+		w.end_section();
+	}
+
+	if(!w.flush()){
+		UG_LOG("ERROR in WriteGridToPMB: Write failed.\n");
+		return false;
+	}
+	return true;
+}
+
+
+bool SaveGridToPMB(Grid& grid, const char* filename,
+				   ISubsetHandler** ppSH, int numSHs,
+				   ISelector** ppSel, int numSels,
+				   ProjectionHandler* pPH)
+{
+	PROFILE_FUNC();
+//	the file only replaces an existing one if it was written completely
+	QSaveFile file(QString::fromLocal8Bit(filename));
+	if(!file.open(QIODevice::WriteOnly)){
+		UG_LOG("ERROR in SaveGridToPMB: Couldn't open file " << filename << "\n");
+		return false;
+	}
+
+	if(!WriteGridToPMB(grid, file, ppSH, numSHs, ppSel, numSels, pPH)
+	   || !file.commit())
+	{
+		UG_LOG("ERROR in SaveGridToPMB: Couldn't write file " << filename << "\n");
+		return false;
+	}
+	return true;
+}
+
+
+bool ReadGridFromPMB(Grid& grid, const char* data, size_t size,
+					 ISubsetHandler** ppSH, int numSHs,
+					 ISelector** ppSel, int numSels,
+					 ProjectionHandler* pPH,
+					 const PartialLoadFilter* filter,
+					 const atomic<bool>* canceled)
+{
+	PROFILE_FUNC();
+	PMBGeometry geom;
+	if(!geom.parse(data, size, "ReadGridFromPMB"))
+		return false;
+	const PMBSectionMap& sections = geom.sections;
+	const PMBCounts& counts = geom.counts;
+
+//	if a filter is given, only the elements whose flag is set are created
+	vector<char> keep[4];
+	const bool filtered = filter && !filter->loads_everything();
+	if(filtered)
+		ComputePartialLoadKeepFlags(keep, geom, *filter);
+
+//	vertices
+	if(!grid.has_vertex_attachment(aPosition))
+		grid.attach_to_vertices(aPosition);
+	Grid::VertexAttachmentAccessor<APosition> aaPos(grid, aPosition);
+
+	const size_t numVrts = geom.num(0);
+	vector<Vertex*> vrts(numVrts, NULL);
+	grid.reserve<Vertex>(grid.num<Vertex>() + numVrts);
+	for(size_t i = 0; i < numVrts; ++i){
+		if(IsCanceled(canceled))
+			return false;
+		if(filtered && !keep[0][i])
+			continue;
+		Vertex* v = *grid.create<RegularVertex>();
+		aaPos[v] = geom.position(i);
+		vrts[i] = v;
+	}
+
+//	edges
+	vector<Edge*> edges(geom.num(1), NULL);
+	grid.reserve<Edge>(grid.num<Edge>() + edges.size());
+	for(size_t i = 0; i < edges.size(); ++i){
+		if(IsCanceled(canceled))
+			return false;
+		if(filtered && !keep[1][i])
+			continue;
+		edges[i] = *grid.create<RegularEdge>(EdgeDescriptor(vrts[geom.corner(1, i, 0)],
+															vrts[geom.corner(1, i, 1)]));
+	}
+
+//	faces
+	vector<Face*> faces(geom.num(2), NULL);
+	grid.reserve<Face>(grid.num<Face>() + faces.size());
+	for(size_t i = 0; i < faces.size(); ++i){
+		if(IsCanceled(canceled))
+			return false;
+		if(filtered && !keep[2][i])
+			continue;
+		Vertex* fv[4];
+		const size_t numCorners = geom.num_corners(2, i);
+		for(size_t j = 0; j < numCorners; ++j)
+			fv[j] = vrts[geom.corner(2, i, j)];
+		if(numCorners == 3)
+			faces[i] = *grid.create<Triangle>(TriangleDescriptor(fv[0], fv[1], fv[2]));
+		else
+			faces[i] = *grid.create<Quadrilateral>(QuadrilateralDescriptor(fv[0], fv[1], fv[2], fv[3]));
+	}
+
+//	volumes
+	vector<Volume*> vols(geom.num(3), NULL);
+	grid.reserve<Volume>(grid.num<Volume>() + vols.size());
+	for(size_t i = 0; i < vols.size(); ++i){
+		if(IsCanceled(canceled))
+			return false;
+		if(filtered && !keep[3][i])
+			continue;
+		Vertex* vv[8];
+		for(size_t j = 0; j < geom.num_corners(3, i); ++j)
+			vv[j] = vrts[geom.corner(3, i, j)];
+
+		switch((uint8_t)geom.secVolTypes->data[i]){
+			case PMB_TETRAHEDRON:
+				vols[i] = *grid.create<Tetrahedron>(TetrahedronDescriptor(
+								vv[0], vv[1], vv[2], vv[3]));
+				break;
+			case PMB_PYRAMID:
+				vols[i] = *grid.create<Pyramid>(PyramidDescriptor(
+								vv[0], vv[1], vv[2], vv[3], vv[4]));
+				break;
+			case PMB_PRISM:
+				vols[i] = *grid.create<Prism>(PrismDescriptor(
+								vv[0], vv[1], vv[2], vv[3], vv[4], vv[5]));
+				break;
+			case PMB_HEXAHEDRON:
+				vols[i] = *grid.create<Hexahedron>(HexahedronDescriptor(
+								vv[0], vv[1], vv[2], vv[3],
+								vv[4], vv[5], vv[6], vv[7]));
+				break;
+			default:
+				vols[i] = *grid.create<Octahedron>(OctahedronDescriptor(
+								vv[0], vv[1], vv[2], vv[3], vv[4], vv[5]));
+				break;
+		}
+	}
+
+//	subsets
+	for(int i = 0; i < numSHs; ++i){
+		if(!ppSH[i])
+			continue;
+		ISubsetHandler& sh = *ppSH[i];
+	//	indices are only valid if they refer to a subset of the infos section
+		int numSubsets = 0;
+		if(const PMBSection* sec = FindSection(sections, PMB_SUBSET_INFOS, i)){
+			if(!DeserializeSubsetInfos(sh, *sec, numSubsets)){
+				UG_LOG("ERROR in ReadGridFromPMB: Corrupt subset infos.\n");
+				return false;
+			}
+		}
+
+		if(const PMBSection* sec = FindSection(sections, PMB_SUBSET_INDICES, i)){
+			if(sec->numBytes != counts.total() * sizeof(int32_t)
+			   || !SubsetIndicesValid(*sec, numSubsets))
+			{
+				UG_LOG("ERROR in ReadGridFromPMB: Corrupt subset indices.\n");
+				return false;
+			}
+			const char* cur = sec->data;
+			cur = AssignSubsetIndices(sh, vrts, cur);
+			cur = AssignSubsetIndices(sh, edges, cur);
+			cur = AssignSubsetIndices(sh, faces, cur);
+			AssignSubsetIndices(sh, vols, cur);
+		}
+	}
+
+//	selection
+	for(int i = 0; i < numSels; ++i){
+		if(!ppSel[i])
+			continue;
+		if(const PMBSection* sec = FindSection(sections, PMB_SELECTION, i)){
+			if(sec->numBytes != counts.total()){
+				UG_LOG("ERROR in ReadGridFromPMB: Corrupt selection.\n");
+				return false;
+			}
+			ISelector& sel = *ppSel[i];
+			const char* cur = sec->data;
+			cur = AssignSelectionStates(sel, vrts, cur);
+			cur = AssignSelectionStates(sel, edges, cur);
+			cur = AssignSelectionStates(sel, faces, cur);
+			AssignSelectionStates(sel, vols, cur);
+		}
+	}
+
+//	projectors
+	if(pPH){
+		if(const PMBSection* sec = FindSection(sections, PMB_PROJECTORS)){
+			if(!DeserializeProjectors(*pPH, *sec)){
+				UG_LOG("ERROR in ReadGridFromPMB: Corrupt projectors.\n");
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+
+bool LoadGridFromPMB(Grid& grid, const char* filename,
+					 ISubsetHandler** ppSH, int numSHs,
+					 ISelector** ppSel, int numSels,
+					 ProjectionHandler* pPH,
+					 const PartialLoadFilter* filter,
+					 const atomic<bool>* canceled)
+{
+	PROFILE_FUNC();
+//	the sections are read in place from the mapped file if possible
+	MappedFile file;
+	if(!file.open(filename)){
+		UG_LOG("ERROR in LoadGridFromPMB: Couldn't open file " << filename << "\n");
+		return false;
+	}
+	return ReadGridFromPMB(grid, file.data(), file.size(),
+						   ppSH, numSHs, ppSel, numSels, pPH, filter, canceled);
+}
+
+
+bool ReadPMBSummary(const char* filename, MeshFileSummary& summaryOut)
+{
+	PROFILE_FUNC();
+	MappedFile file;
+	if(!file.open(filename)){
+		UG_LOG("ERROR in ReadPMBSummary: Couldn't open file " << filename << "\n");
+		return false;
+	}
+
+	PMBGeometry geom;
+	if(!geom.parse(file.data(), file.size(), "ReadPMBSummary"))
+		return false;
+
+	summaryOut = MeshFileSummary();
+	if(const PMBSection* sec = FindSection(geom.sections, PMB_SUBSET_INFOS, 0)){
+		Grid tmpGrid;
+		SubsetHandler sh(tmpGrid);
+		int numSubsets;
+		if(!DeserializeSubsetInfos(sh, *sec, numSubsets)){
+			UG_LOG("ERROR in ReadPMBSummary: Corrupt subset infos.\n");
+			return false;
+		}
+		summaryOut.subsets.resize(sh.num_subsets());
+		for(int i = 0; i < sh.num_subsets(); ++i){
+			summaryOut.subsets[i].name = sh.subset_info(i).name;
+			summaryOut.subsets[i].color = sh.subset_info(i).color;
+		}
+	}
+
+	SummarizeMeshGeometry(summaryOut, geom);
+	return true;
+}
+
+
+bool CopyProjectors(ProjectionHandler& dest, ProjectionHandler& src,
+					int numSubsets)
+{
+	string projs = SerializeProjectors(src, numSubsets);
+	PMBSection sec;
+	sec.data = projs.data();
+	sec.numBytes = projs.size();
+	return DeserializeProjectors(dest, sec);
+}
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2026:  G-CSC, Goethe University Frankfurt
+ * Author: Sebastian Reiter
+ * 
+ * This file is part of ProMesh.
+ * 
+ * ProMesh is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License version 3 (as published by the
+ * Free Software Foundation) with the following additional attribution
+ * requirements (according to LGPL/GPL v3 §7):
+ * 
+ * (1) The following notice must be displayed in the Appropriate Legal Notices
+ * of covered and combined works: "Based on ProMesh (www.promesh3d.com)".
+ * 
+ * (2) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S. and Wittum, G. ProMesh -- a flexible interactive meshing software
+ *   for unstructured hybrid grids in 1, 2, and 3 dimensions. In preparation."
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#ifndef __H__PROMESH_file_io_pmb
+#define __H__PROMESH_file_io_pmb
+
+#include <atomic>
+#include <cstddef>
+#include "lib_grid/lib_grid.h"
+#include "lib_grid/refinement/projectors/projection_handler.h"
+
+class QIODevice;
+struct PartialLoadFilter;
+struct MeshFileSummary;
+
+///	Saves a grid in the native ProMesh binary format (.pmb).
+/**	The format stores vertex positions and the connectivity of all elements
+ * as contiguous arrays, followed by the subset indices and subset infos of
+ * each subset handler, the selection states of each selector and the
+ * projectors of the projection handler. All sections are 8-byte aligned,
+ * so that a mapped file can be read without any parsing.
+ *
+ * Positions are the only attachment which is stored. Constrained elements
+ * (hanging nodes) are stored as regular elements.*/
+bool SaveGridToPMB(ug::Grid& grid, const char* filename,
+				   ug::ISubsetHandler** ppSH, int numSHs,
+				   ug::ISelector** ppSel, int numSels,
+				   ug::ProjectionHandler* pPH = NULL);
+
+///	writes a grid in the .pmb format to an open device. See SaveGridToPMB.
+bool WriteGridToPMB(ug::Grid& grid, QIODevice& out,
+					ug::ISubsetHandler** ppSH, int numSHs,
+					ug::ISelector** ppSel, int numSels,
+					ug::ProjectionHandler* pPH = NULL);
+
+///	Loads a grid from a .pmb file. The file is mapped into memory if possible.
+/**	Handlers and selectors are assigned in the order in which they were
+ * passed to SaveGridToPMB. Superfluous entries in the file are ignored.
+ *
+ * If a filter is given, only the elements which pass it are created,
+ * together with their sides and corners. The filter is evaluated on the
+ * subsets of the first subset handler in the file.
+ *
+ * If canceled is given, it is checked before each element is created. Once
+ * it is set, false is returned and the grid holds the elements created so far.*/
+bool LoadGridFromPMB(ug::Grid& grid, const char* filename,
+					 ug::ISubsetHandler** ppSH, int numSHs,
+					 ug::ISelector** ppSel, int numSels,
+					 ug::ProjectionHandler* pPH = NULL,
+					 const PartialLoadFilter* filter = NULL,
+					 const std::atomic<bool>* canceled = NULL);
+
+///	reads a grid from a memory block which holds the contents of a .pmb file.
+bool ReadGridFromPMB(ug::Grid& grid, const char* data, size_t size,
+					 ug::ISubsetHandler** ppSH, int numSHs,
+					 ug::ISelector** ppSel, int numSels,
+					 ug::ProjectionHandler* pPH = NULL,
+					 const PartialLoadFilter* filter = NULL,
+					 const std::atomic<bool>* canceled = NULL);
+
+///	reads the subset table of a .pmb file and the bounding boxes of its subsets.
+/**	No grid is created. The mapped file is only scanned once.*/
+bool ReadPMBSummary(const char* filename, MeshFileSummary& summaryOut);
+
+///	copies the projectors of the first numSubsets subsets of src to dest.
+/**	The copies don't share any data with the projectors of src. They are
+ * associated with the geometry of dest, which thus has to be set before.*/
+bool CopyProjectors(ug::ProjectionHandler& dest, ug::ProjectionHandler& src,
+					int numSubsets);
+
+#endif	//__H__PROMESH_file_io_pmb
@@ -0,0 +1,811 @@
+/*
+ * Copyright (c) 2026:  G-CSC, Goethe University Frankfurt
+ * Author: Sebastian Reiter
+ * 
+ * This file is part of ProMesh.
+ * 
+ * ProMesh is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License version 3 (as published by the
+ * Free Software Foundation) with the following additional attribution
+ * requirements (according to LGPL/GPL v3 §7):
+ * 
+ * (1) The following notice must be displayed in the Appropriate Legal Notices
+ * of covered and combined works: "Based on ProMesh (www.promesh3d.com)".
+ * 
+ * (2) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S. and Wittum, G. ProMesh -- a flexible interactive meshing software
+ *   for unstructured hybrid grids in 1, 2, and 3 dimensions. In preparation."
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <stdint.h>
+#include <QByteArray>
+#include "file_io_stl_obj.h"
+#include "common/profiler/profiler.h"
+#include "util/mapped_file.h"
+#include "util/parallel_util.h"
+#include "util/text_parsing.h"
+
+using namespace std;
+using namespace ug;
+
+namespace{
+
+///	returns true if the cancel flag of a load was set
+inline bool IsCanceled(const atomic<bool>* canceled)
+{
+	return canceled && canceled->load(memory_order_relaxed);
+}
+
+////////////////////////////////////////////////////////////////////////
+//	parsing
+///	minimal number of bytes which are parsed by one thread
+const size_t MIN_PARSE_CHUNK_SIZE = 1 << 20;
+
+///	returns the position behind token if [p, end) starts with token, NULL otherwise.
+const char* MatchToken(const char* p, const char* end, const char* token)
+{
+	const size_t len = strlen(token);
+	if((size_t)(end - p) < len || memcmp(p, token, len) != 0)
+		return NULL;
+	p += len;
+	if(p < end && !(IsSpace(*p) || *p == '\n'))
+		return NULL;
+	return p;
+}
+
+///	returns the text between p and lineEnd without surrounding white space.
+string RestOfLine(const char* p, const char* lineEnd)
+{
+	p = SkipSpaces(p, lineEnd);
+	while(lineEnd > p && IsSpace(lineEnd[-1]))
+		--lineEnd;
+	return string(p, lineEnd);
+}
+
+const char* ParseVector3(const char* p, const char* end, vector3& vOut)
+{
+	for(int i = 0; i < 3 && p; ++i)
+		p = ParseNumber(SkipSpaces(p, end), end, vOut[i]);
+	return p;
+}
+
+///	returns the first line start at or behind pos for which isStart returns true.
+template <class TPred>
+size_t FindChunkStart(const char* data, size_t size, size_t pos, TPred isStart)
+{
+	if(pos == 0)
+		return 0;
+	while(pos < size){
+		if(data[pos - 1] == '\n' && isStart(data + pos, data + size))
+			return pos;
+		pos = FindLineEnd(data + pos, data + size) - data + 1;
+	}
+	return size;
+}
+
+///	splits data into NumParallelChunks(size, MIN_PARSE_CHUNK_SIZE) chunks and processes them concurrently.
+/**	Each chunk starts at a line for which isStart returns true. func is
+ * called as func(chunkIndex, begin, end).*/
+template <class TPred, class TFunc>
+void ParallelForLineChunks(const char* data, size_t size, TPred isStart, TFunc func)
+{
+	ParallelForChunks(size, MIN_PARSE_CHUNK_SIZE,
+		[&](size_t chunk, size_t begin, size_t end){
+			const size_t chunkBegin = FindChunkStart(data, size, begin, isStart);
+			const size_t chunkEnd = max(chunkBegin, FindChunkStart(data, size, end, isStart));
+			func(chunk, data + chunkBegin, data + chunkEnd);
+		});
+}
+
+
+////////////////////////////////////////////////////////////////////////
+//	welding
+const uint32_t NO_POINT = numeric_limits<uint32_t>::max();
+
+struct WeldCell{
+	int64_t c[3];
+
+	bool operator==(const WeldCell& cell) const
+	{
+		return c[0] == cell.c[0] && c[1] == cell.c[1] && c[2] == cell.c[2];
+	}
+};
+
+inline uint64_t HashWeldCell(const WeldCell& cell)
+{
+	uint64_t h = (uint64_t)cell.c[0] * 0x9E3779B97F4A7C15ull;
+	h ^= (uint64_t)cell.c[1] + 0x632BE59BD9B4E019ull + (h << 6) + (h >> 2);
+	h ^= (uint64_t)cell.c[2] + 0x85157AF5ull + (h << 6) + (h >> 2);
+//	finalizer of splitmix64
+	h ^= h >> 30;
+	h *= 0xBF58476D1CE4E5B9ull;
+	h ^= h >> 27;
+	h *= 0x94D049BB133111EBull;
+	h ^= h >> 31;
+	return h;
+}
+
+struct WeldCellHash{
+	size_t operator()(const WeldCell& cell) const	{return (size_t)HashWeldCell(cell);}
+};
+
+///	the cell of p in a grid with cell size tolerance. If tolerance is 0, the cell represents the exact coordinates.
+inline WeldCell WeldCellOf(const vector3& p, number tolerance)
+{
+	WeldCell cell;
+	for(int i = 0; i < 3; ++i){
+		if(tolerance > 0){
+			number c = floor(p[i] / tolerance);
+			cell.c[i] = (int64_t)max<number>(-4e18, min<number>(4e18, c));
+		}
+		else{
+		//	0 and -0 are the same position
+			double d = (p[i] == 0) ? 0. : (double)p[i];
+			memcpy(&cell.c[i], &d, sizeof(d));
+		}
+	}
+	return cell;
+}
+
+inline size_t WeldBucket(const WeldCell& cell, size_t numBuckets)
+{
+	return (size_t)((HashWeldCell(cell) >> 32) % numBuckets);
+}
+
+///	merges points whose distance is at most tolerance.
+/**	indsOut[i] receives the index of the merged point of pts[i]. Merged
+ * points are numbered in the order of their first occurrence in pts.
+ * Returns the number of merged points.
+ *
+ * Points are distributed to buckets by the hash of their cell in a grid
+ * with cell size tolerance. Each bucket first merges points with earlier
+ * points in the same cell. The remaining representatives are then merged
+ * with the earliest representative within tolerance in a neighbor cell.
+ * Both steps process the buckets concurrently.*/
+size_t WeldPoints(vector<uint32_t>& indsOut, const vector<vector3>& pts,
+				  number tolerance)
+{
+	PROFILE_FUNC();
+	const size_t numPts = pts.size();
+	UG_COND_THROW(numPts >= NO_POINT, "Too many vertices: " << numPts);
+
+	const number tolSq = tolerance * tolerance;
+	const size_t numBuckets = NumWorkerThreads() > 1 ? 4 * NumWorkerThreads() : 1;
+	const size_t minChunkSize = 1 << 16;
+	const size_t numChunks = NumParallelChunks(numPts, minChunkSize);
+
+//	sort the point indices by bucket. Indices are ascending within each bucket.
+	vector<size_t> counts(numChunks * numBuckets, 0);
+	ParallelForChunks(numPts, minChunkSize, [&](size_t chunk, size_t begin, size_t end){
+		size_t* c = &counts[chunk * numBuckets];
+		for(size_t i = begin; i < end; ++i)
+			++c[WeldBucket(WeldCellOf(pts[i], tolerance), numBuckets)];
+	});
+
+	vector<size_t> bucketOffsets(numBuckets + 1);
+	vector<size_t> writePos(numChunks * numBuckets);
+	size_t pos = 0;
+	for(size_t b = 0; b < numBuckets; ++b){
+		bucketOffsets[b] = pos;
+		for(size_t chunk = 0; chunk < numChunks; ++chunk){
+			writePos[chunk * numBuckets + b] = pos;
+			pos += counts[chunk * numBuckets + b];
+		}
+	}
+	bucketOffsets[numBuckets] = pos;
+
+	vector<uint32_t> order(numPts);
+	ParallelForChunks(numPts, minChunkSize, [&](size_t chunk, size_t begin, size_t end){
+		size_t* wp = &writePos[chunk * numBuckets];
+		for(size_t i = begin; i < end; ++i)
+			order[wp[WeldBucket(WeldCellOf(pts[i], tolerance), numBuckets)]++] = (uint32_t)i;
+	});
+
+//	merge points of the same cell. The representatives of a cell form a linked list.
+	typedef unordered_map<WeldCell, uint32_t, WeldCellHash>	CellMap;
+	vector<CellMap> cellMaps(numBuckets);
+	vector<uint32_t> rep(numPts);
+	vector<uint32_t> nextInCell(numPts, NO_POINT);
+
+	ParallelForChunks(numBuckets, 1, [&](size_t, size_t bucketsBegin, size_t bucketsEnd){
+		for(size_t b = bucketsBegin; b < bucketsEnd; ++b){
+			CellMap& cells = cellMaps[b];
+			for(size_t k = bucketOffsets[b]; k < bucketOffsets[b + 1]; ++k){
+				const uint32_t i = order[k];
+				pair<CellMap::iterator, bool> res =
+					cells.insert(make_pair(WeldCellOf(pts[i], tolerance), i));
+				rep[i] = i;
+				if(res.second)
+					continue;
+
+				uint32_t r = res.first->second;
+				while(r != NO_POINT && VecDistanceSq(pts[r], pts[i]) > tolSq)
+					r = nextInCell[r];
+
+				if(r != NO_POINT)
+					rep[i] = r;
+				else{
+					nextInCell[i] = res.first->second;
+					res.first->second = i;
+				}
+			}
+		}
+	});
+
+//	merge representatives with representatives of neighbor cells. The cell
+//	maps and lists are only read, and each bucket only writes its own points.
+	if(tolerance > 0){
+		ParallelForChunks(numBuckets, 1, [&](size_t, size_t bucketsBegin, size_t bucketsEnd){
+			for(size_t b = bucketsBegin; b < bucketsEnd; ++b){
+				for(size_t k = bucketOffsets[b]; k < bucketOffsets[b + 1]; ++k){
+					const uint32_t i = order[k];
+					if(rep[i] != i)
+						continue;
+
+					const WeldCell cell = WeldCellOf(pts[i], tolerance);
+					uint32_t best = i;
+					for(int dx = -1; dx <= 1; ++dx){
+						for(int dy = -1; dy <= 1; ++dy){
+							for(int dz = -1; dz <= 1; ++dz){
+								if(dx == 0 && dy == 0 && dz == 0)
+									continue;
+								WeldCell nbr = cell;
+								nbr.c[0] += dx;
+								nbr.c[1] += dy;
+								nbr.c[2] += dz;
+								const CellMap& nbrCells = cellMaps[WeldBucket(nbr, numBuckets)];
+								CellMap::const_iterator iter = nbrCells.find(nbr);
+								if(iter == nbrCells.end())
+									continue;
+								for(uint32_t r = iter->second; r != NO_POINT; r = nextInCell[r]){
+									if(r < best && VecDistanceSq(pts[r], pts[i]) <= tolSq)
+										best = r;
+								}
+							}
+						}
+					}
+					rep[i] = best;
+				}
+			}
+		});
+	}
+
+//	rep[i] <= i holds for all points. Chains of representatives are thus
+//	resolved by a single ascending pass.
+	indsOut.resize(numPts);
+	uint32_t numMerged = 0;
+	for(size_t i = 0; i < numPts; ++i){
+		if(rep[i] == i)
+			indsOut[i] = numMerged++;
+		else{
+			rep[i] = rep[rep[i]];
+			indsOut[i] = indsOut[rep[i]];
+		}
+	}
+	return numMerged;
+}
+
+
+////////////////////////////////////////////////////////////////////////
+//	grid creation
+///	creates one vertex for each merged point. vrtsOut[inds[i]] is the vertex of pts[i].
+void CreateMergedVertices(vector<Vertex*>& vrtsOut, Grid& grid,
+						  const vector<vector3>& pts, const vector<uint32_t>& inds,
+						  size_t numMerged)
+{
+	if(!grid.has_vertex_attachment(aPosition))
+		grid.attach_to_vertices(aPosition);
+	Grid::VertexAttachmentAccessor<APosition> aaPos(grid, aPosition);
+
+	vrtsOut.assign(numMerged, NULL);
+	grid.reserve<Vertex>(grid.num<Vertex>() + numMerged);
+	for(size_t i = 0; i < pts.size(); ++i){
+		Vertex*& vrt = vrtsOut[inds[i]];
+		if(!vrt){
+			vrt = *grid.create<RegularVertex>();
+			aaPos[vrt] = pts[i];
+		}
+	}
+}
+
+///	returns the index of the subset with the given name which was created by this import.
+/**	A new subset is appended to sh if no such subset exists yet.*/
+int ImportSubset(ISubsetHandler& sh, map<string, int>& subsetsByName, const string& name)
+{
+	map<string, int>::iterator iter = subsetsByName.find(name);
+	if(iter != subsetsByName.end())
+		return iter->second;
+
+	const int si = sh.num_subsets();
+	sh.subset_required(si);
+	sh.subset_info(si).name = name;
+	subsetsByName[name] = si;
+	return si;
+}
+
+string FileBaseName(const char* filename)
+{
+	string name = filename;
+	size_t slashPos = name.find_last_of("/\\");
+	if(slashPos != string::npos)
+		name = name.substr(slashPos + 1);
+	size_t pointPos = name.find_last_of('.');
+	if(pointPos != string::npos)
+		name = name.substr(0, pointPos);
+	return name;
+}
+
+
+////////////////////////////////////////////////////////////////////////
+//	stl
+struct STLChunk{
+	STLChunk() : failed(false)	{}
+
+	vector<vector3>					corners;
+///	index of the first triangle in the chunk and name of each solid which starts in the chunk
+	vector<pair<size_t, string> >	solids;
+	bool							failed;
+};
+
+bool IsSTLChunkStart(const char* p, const char* end)
+{
+	p = SkipSpaces(p, end);
+	return MatchToken(p, end, "facet") || MatchToken(p, end, "solid");
+}
+
+///	true if the file starts with 'solid' and the first line which follows is a facet.
+/**	Binary files may start with 'solid' as well, but aren't followed by a
+ * facet statement.*/
+bool IsASCIISTL(const char* data, size_t size)
+{
+	const char* end = data + size;
+	const char* p = SkipSpaces(data, end);
+	if(!MatchToken(p, end, "solid"))
+		return false;
+	p = NextLine(FindLineEnd(p, end), end);
+	while(p < end){
+		const char* lineEnd = FindLineEnd(p, end);
+		const char* q = SkipSpaces(p, lineEnd);
+		if(q < lineEnd)
+			return MatchToken(q, lineEnd, "facet") != NULL;
+		p = NextLine(lineEnd, end);
+	}
+	return false;
+}
+
+bool ParseSTLChunk(STLChunk& chunk, const char* p, const char* end)
+{
+	while(p < end){
+		const char* lineEnd = FindLineEnd(p, end);
+		const char* q = SkipSpaces(p, lineEnd);
+		const char* t;
+		if((t = MatchToken(q, lineEnd, "vertex"))){
+			vector3 v;
+			if(!ParseVector3(t, lineEnd, v))
+				return false;
+			chunk.corners.push_back(v);
+		}
+		else if((t = MatchToken(q, lineEnd, "solid")))
+			chunk.solids.push_back(make_pair(chunk.corners.size() / 3, RestOfLine(t, lineEnd)));
+		p = NextLine(lineEnd, end);
+	}
+	return chunk.corners.size() % 3 == 0;
+}
+
+
+////////////////////////////////////////////////////////////////////////
+//	obj
+struct OBJGroupStart{
+	size_t	firstFace;
+	size_t	firstEdge;
+	string	name;
+};
+
+struct OBJChunk{
+	OBJChunk() : faceOffsets(1, 0), failed(false)	{}
+
+	vector<vector3>			vrts;
+///	corners of all faces. Those of face i are stored in [faceOffsets[i], faceOffsets[i + 1]).
+	vector<int64_t>			faceInds;
+	vector<size_t>			faceOffsets;
+///	two corners per edge
+	vector<int64_t>			edgeInds;
+///	entries of faceInds and edgeInds which are relative to the first vertex of the chunk
+	vector<size_t>			relFaceInds;
+	vector<size_t>			relEdgeInds;
+	vector<OBJGroupStart>	groups;
+	bool					failed;
+};
+
+///	parses the vertex indices of an f or l statement.
+/**	Negative indices are stored relative to the first vertex of the chunk,
+ * i.e. numChunkVrts is added, and their positions are recorded in relIndsOut.*/
+bool ParseOBJIndices(vector<int64_t>& indsOut, vector<size_t>& relIndsOut,
+					 const char* p, const char* lineEnd, size_t numChunkVrts)
+{
+	while(true){
+		p = SkipSpaces(p, lineEnd);
+		if(p >= lineEnd || *p == '#')
+			return true;
+
+		int64_t ind;
+		p = ParseInt(p, lineEnd, ind);
+		if(!p || ind == 0)
+			return false;
+		if(ind > 0)
+			indsOut.push_back(ind - 1);
+		else{
+			relIndsOut.push_back(indsOut.size());
+			indsOut.push_back((int64_t)numChunkVrts + ind);
+		}
+
+	//	texture and normal indices are ignored
+		while(p < lineEnd && !IsSpace(*p))
+			++p;
+	}
+}
+
+bool ParseOBJChunk(OBJChunk& chunk, const char* p, const char* end)
+{
+	vector<int64_t> lineInds;
+	vector<size_t> relLineInds;
+	while(p < end){
+		const char* lineEnd = FindLineEnd(p, end);
+		const char* q = SkipSpaces(p, lineEnd);
+		const char* t;
+		if((t = MatchToken(q, lineEnd, "v"))){
+			vector3 v;
+			if(!ParseVector3(t, lineEnd, v))
+				return false;
+			chunk.vrts.push_back(v);
+		}
+		else if((t = MatchToken(q, lineEnd, "f"))){
+			const size_t numInds = chunk.faceInds.size();
+			if(!ParseOBJIndices(chunk.faceInds, chunk.relFaceInds, t, lineEnd, chunk.vrts.size())
+			   || chunk.faceInds.size() - numInds < 3)
+			{
+				return false;
+			}
+			chunk.faceOffsets.push_back(chunk.faceInds.size());
+		}
+		else if((t = MatchToken(q, lineEnd, "l"))){
+		//	a polyline is split into edges
+			lineInds.clear();
+			relLineInds.clear();
+			if(!ParseOBJIndices(lineInds, relLineInds, t, lineEnd, chunk.vrts.size())
+			   || lineInds.size() < 2)
+			{
+				return false;
+			}
+			vector<char> isRel(lineInds.size(), 0);
+			for(size_t i = 0; i < relLineInds.size(); ++i)
+				isRel[relLineInds[i]] = 1;
+			for(size_t i = 0; i + 1 < lineInds.size(); ++i){
+				for(size_t j = i; j < i + 2; ++j){
+					if(isRel[j])
+						chunk.relEdgeInds.push_back(chunk.edgeInds.size());
+					chunk.edgeInds.push_back(lineInds[j]);
+				}
+			}
+		}
+		else if((t = MatchToken(q, lineEnd, "g")) || (t = MatchToken(q, lineEnd, "o"))){
+			OBJGroupStart group;
+			group.firstFace = chunk.faceOffsets.size() - 1;
+			group.firstEdge = chunk.edgeInds.size() / 2;
+			group.name = RestOfLine(t, lineEnd);
+			chunk.groups.push_back(group);
+		}
+		p = NextLine(lineEnd, end);
+	}
+	return true;
+}
+
+///	converts relative indices to global ones and checks that all indices reference existing vertices.
+bool ResolveOBJIndices(vector<int64_t>& inds, const vector<size_t>& relInds,
+					   int64_t chunkVrtOffset, int64_t numVrts)
+{
+	for(size_t i = 0; i < relInds.size(); ++i)
+		inds[relInds[i]] += chunkVrtOffset;
+	for(size_t i = 0; i < inds.size(); ++i){
+		if(inds[i] < 0 || inds[i] >= numVrts)
+			return false;
+	}
+	return true;
+}
+
+///	the current group while the elements of an .obj file are created
+struct OBJGroupState{
+	OBJGroupState() : name("default"), subsetIndex(-1)	{}
+
+	void start_group(const string& groupName)
+	{
+		name = groupName.empty() ? string("default") : groupName;
+		subsetIndex = -1;
+	}
+
+	int subset(ISubsetHandler& sh, map<string, int>& subsetsByName)
+	{
+		if(subsetIndex < 0)
+			subsetIndex = ImportSubset(sh, subsetsByName, name);
+		return subsetIndex;
+	}
+
+	string	name;
+	int		subsetIndex;
+};
+
+}//	end of anonymous namespace
+
+
+bool LoadGridFromSTLParallel(Grid& grid, ISubsetHandler& sh,
+							 const char* filename, number weldTolerance,
+							 const atomic<bool>* canceled)
+{
+	PROFILE_FUNC();
+	MappedFile file;
+	if(!file.open(filename)){
+		UG_LOG("ERROR in LoadGridFromSTLParallel: Couldn't open file " << filename << "\n");
+		return false;
+	}
+	const char* data = file.data();
+	const size_t size = file.size();
+
+	vector<vector3> corners;
+	vector<pair<size_t, string> > solids;
+
+	if(!IsASCIISTL(data, size)){
+	//	binary file. Each triangle is stored as normal, three corners and two attribute bytes.
+	//	Bytes behind the last triangle are ignored.
+		uint32_t numBinaryTris = 0;
+		if(size >= 84)
+			memcpy(&numBinaryTris, data + 80, sizeof(numBinaryTris));
+		if(size < 84 || (uint64_t)size < 84 + 50 * (uint64_t)numBinaryTris){
+			UG_LOG("ERROR in LoadGridFromSTLParallel: " << filename
+				   << " is neither an ascii stl file nor a complete binary stl file.\n");
+			return false;
+		}
+		corners.resize(3 * (size_t)numBinaryTris);
+		ParallelForChunks(numBinaryTris, 1 << 16, [&](size_t, size_t begin, size_t end){
+			for(size_t i = begin; i < end; ++i){
+				const char* corner = data + 84 + 50 * i + 12;
+				for(size_t j = 0; j < 3; ++j, corner += 12){
+					float c[3];
+					memcpy(c, corner, sizeof(c));
+					corners[3 * i + j] = vector3(c[0], c[1], c[2]);
+				}
+			}
+		});
+	}
+	else{
+		vector<STLChunk> chunks(NumParallelChunks(size, MIN_PARSE_CHUNK_SIZE));
+		ParallelForLineChunks(data, size, IsSTLChunkStart,
+			[&](size_t chunk, const char* begin, const char* end){
+				chunks[chunk].failed = !ParseSTLChunk(chunks[chunk], begin, end);
+			});
+
+		size_t numCorners = 0;
+		for(size_t i = 0; i < chunks.size(); ++i){
+			if(chunks[i].failed){
+				UG_LOG("ERROR in LoadGridFromSTLParallel: Invalid facet in " << filename << "\n");
+				return false;
+			}
+			numCorners += chunks[i].corners.size();
+		}
+		if(numCorners == 0){
+			UG_LOG("ERROR in LoadGridFromSTLParallel: No facets found in " << filename << "\n");
+			return false;
+		}
+
+	//	the chunks are released while they are appended
+		corners.reserve(numCorners);
+		for(size_t i = 0; i < chunks.size(); ++i){
+			for(size_t j = 0; j < chunks[i].solids.size(); ++j){
+				solids.push_back(make_pair(corners.size() / 3 + chunks[i].solids[j].first,
+										   chunks[i].solids[j].second));
+			}
+			corners.insert(corners.end(), chunks[i].corners.begin(), chunks[i].corners.end());
+			vector<vector3>().swap(chunks[i].corners);
+		}
+	}
+
+//	triangles in front of the first solid (and all triangles of binary files)
+//	are named after the file
+	if(solids.empty() || solids.front().first > 0)
+		solids.insert(solids.begin(), make_pair(size_t(0), FileBaseName(filename)));
+
+	if(IsCanceled(canceled))
+		return false;
+	vector<uint32_t> inds;
+	const size_t numMerged = WeldPoints(inds, corners, weldTolerance);
+
+	if(IsCanceled(canceled))
+		return false;
+	vector<Vertex*> vrts;
+	CreateMergedVertices(vrts, grid, corners, inds, numMerged);
+	vector<vector3>().swap(corners);
+
+	map<string, int> subsetsByName;
+	const size_t numTris = inds.size() / 3;
+	size_t numDegenerated = 0;
+	grid.reserve<Face>(grid.num<Face>() + numTris);
+	for(size_t isolid = 0; isolid < solids.size(); ++isolid){
+		const size_t trisEnd = (isolid + 1 < solids.size()) ? solids[isolid + 1].first : numTris;
+		const string name = solids[isolid].second.empty() ? string("solid") : solids[isolid].second;
+		int si = -1;
+		for(size_t i = solids[isolid].first; i < trisEnd; ++i){
+			if(IsCanceled(canceled))
+				return false;
+			Vertex* v0 = vrts[inds[3 * i]];
+			Vertex* v1 = vrts[inds[3 * i + 1]];
+			Vertex* v2 = vrts[inds[3 * i + 2]];
+			if(v0 == v1 || v0 == v2 || v1 == v2){
+				++numDegenerated;
+				continue;
+			}
+			Face* f = *grid.create<Triangle>(TriangleDescriptor(v0, v1, v2));
+			if(si < 0)
+				si = ImportSubset(sh, subsetsByName, name);
+			sh.assign_subset(f, si);
+		}
+	}
+
+	UG_LOG("  merged " << inds.size() << " stl corners into " << numMerged << " vertices\n");
+	if(numDegenerated > 0)
+		UG_LOG("  skipped " << numDegenerated << " degenerated triangles\n");
+	return true;
+}
+
+
+bool LoadGridFromOBJParallel(Grid& grid, ISubsetHandler& sh,
+							 const char* filename, number weldTolerance,
+							 const atomic<bool>* canceled)
+{
+	PROFILE_FUNC();
+	MappedFile file;
+	if(!file.open(filename)){
+		UG_LOG("ERROR in LoadGridFromOBJParallel: Couldn't open file " << filename << "\n");
+		return false;
+	}
+
+	vector<OBJChunk> chunks(NumParallelChunks(file.size(), MIN_PARSE_CHUNK_SIZE));
+	ParallelForLineChunks(file.data(), file.size(),
+		[](const char*, const char*){return true;},
+		[&](size_t chunk, const char* begin, const char* end){
+			chunks[chunk].failed = !ParseOBJChunk(chunks[chunk], begin, end);
+		});
+
+	if(IsCanceled(canceled))
+		return false;
+	vector<int64_t> chunkVrtOffsets(chunks.size() + 1, 0);
+	for(size_t i = 0; i < chunks.size(); ++i){
+		if(chunks[i].failed){
+			UG_LOG("ERROR in LoadGridFromOBJParallel: Invalid statement in " << filename << "\n");
+			return false;
+		}
+		chunkVrtOffsets[i + 1] = chunkVrtOffsets[i] + (int64_t)chunks[i].vrts.size();
+	}
+	const int64_t numVrts = chunkVrtOffsets.back();
+
+	vector<char> indsValid(chunks.size(), 1);
+	ParallelForChunks(chunks.size(), 1, [&](size_t, size_t begin, size_t end){
+		for(size_t i = begin; i < end; ++i){
+			OBJChunk& chunk = chunks[i];
+			indsValid[i] = ResolveOBJIndices(chunk.faceInds, chunk.relFaceInds,
+											 chunkVrtOffsets[i], numVrts)
+						&& ResolveOBJIndices(chunk.edgeInds, chunk.relEdgeInds,
+											 chunkVrtOffsets[i], numVrts);
+		}
+	});
+	for(size_t i = 0; i < indsValid.size(); ++i){
+		if(!indsValid[i]){
+			UG_LOG("ERROR in LoadGridFromOBJParallel: Invalid vertex index in " << filename << "\n");
+			return false;
+		}
+	}
+
+	vector<vector3> pts;
+	pts.reserve((size_t)numVrts);
+	for(size_t i = 0; i < chunks.size(); ++i){
+		pts.insert(pts.end(), chunks[i].vrts.begin(), chunks[i].vrts.end());
+		vector<vector3>().swap(chunks[i].vrts);
+	}
+
+	vector<uint32_t> inds;
+	const size_t numMerged = WeldPoints(inds, pts, weldTolerance);
+
+	if(IsCanceled(canceled))
+		return false;
+	vector<Vertex*> vrts;
+	CreateMergedVertices(vrts, grid, pts, inds, numMerged);
+	vector<vector3>().swap(pts);
+
+//	faces. Corners which were merged are removed and polygons are triangulated as fans.
+	map<string, int> subsetsByName;
+	OBJGroupState faceGroup;
+	size_t numDegenerated = 0;
+	vector<Vertex*> poly;
+	for(size_t ichunk = 0; ichunk < chunks.size(); ++ichunk){
+		const OBJChunk& chunk = chunks[ichunk];
+		const size_t numFaces = chunk.faceOffsets.size() - 1;
+		grid.reserve<Face>(grid.num<Face>() + numFaces);
+		size_t igroup = 0;
+		for(size_t i = 0; i < numFaces; ++i){
+			if(IsCanceled(canceled))
+				return false;
+			for(; igroup < chunk.groups.size() && chunk.groups[igroup].firstFace <= i; ++igroup)
+				faceGroup.start_group(chunk.groups[igroup].name);
+
+			poly.clear();
+			for(size_t j = chunk.faceOffsets[i]; j < chunk.faceOffsets[i + 1]; ++j){
+				Vertex* vrt = vrts[inds[(size_t)chunk.faceInds[j]]];
+				if(poly.empty() || poly.back() != vrt)
+					poly.push_back(vrt);
+			}
+			if(poly.size() > 1 && poly.front() == poly.back())
+				poly.pop_back();
+			if(poly.size() < 3){
+				++numDegenerated;
+				continue;
+			}
+
+			const int si = faceGroup.subset(sh, subsetsByName);
+			if(poly.size() == 4){
+				Face* f = *grid.create<Quadrilateral>(
+								QuadrilateralDescriptor(poly[0], poly[1], poly[2], poly[3]));
+				sh.assign_subset(f, si);
+			}
+			else{
+				for(size_t j = 1; j + 1 < poly.size(); ++j){
+					Face* f = *grid.create<Triangle>(TriangleDescriptor(poly[0], poly[j], poly[j + 1]));
+					sh.assign_subset(f, si);
+				}
+			}
+		}
+		for(; igroup < chunk.groups.size(); ++igroup)
+			faceGroup.start_group(chunk.groups[igroup].name);
+	}
+
+//	edges of lines. Edges which already exist as sides of faces are reused.
+	OBJGroupState edgeGroup;
+	for(size_t ichunk = 0; ichunk < chunks.size(); ++ichunk){
+		const OBJChunk& chunk = chunks[ichunk];
+		const size_t numEdges = chunk.edgeInds.size() / 2;
+		size_t igroup = 0;
+		for(size_t i = 0; i < numEdges; ++i){
+			if(IsCanceled(canceled))
+				return false;
+			for(; igroup < chunk.groups.size() && chunk.groups[igroup].firstEdge <= i; ++igroup)
+				edgeGroup.start_group(chunk.groups[igroup].name);
+
+			Vertex* v0 = vrts[inds[(size_t)chunk.edgeInds[2 * i]]];
+			Vertex* v1 = vrts[inds[(size_t)chunk.edgeInds[2 * i + 1]]];
+			if(v0 == v1)
+				continue;
+			Edge* e = grid.get_edge(v0, v1);
+			if(!e)
+				e = *grid.create<RegularEdge>(EdgeDescriptor(v0, v1));
+			sh.assign_subset(e, edgeGroup.subset(sh, subsetsByName));
+		}
+		for(; igroup < chunk.groups.size(); ++igroup)
+			edgeGroup.start_group(chunk.groups[igroup].name);
+	}
+
+	if(numDegenerated > 0)
+		UG_LOG("  skipped " << numDegenerated << " degenerated faces\n");
+	return true;
+}
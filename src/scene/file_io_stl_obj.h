@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2026:  G-CSC, Goethe University Frankfurt
+ * Author: Sebastian Reiter
+ * 
+ * This file is part of ProMesh.
+ * 
+ * ProMesh is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License version 3 (as published by the
+ * Free Software Foundation) with the following additional attribution
+ * requirements (according to LGPL/GPL v3 §7):
+ * 
+ * (1) The following notice must be displayed in the Appropriate Legal Notices
+ * of covered and combined works: "Based on ProMesh (www.promesh3d.com)".
+ * 
+ * (2) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S. and Wittum, G. ProMesh -- a flexible interactive meshing software
+ *   for unstructured hybrid grids in 1, 2, and 3 dimensions. In preparation."
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#ifndef __H__PROMESH_file_io_stl_obj
+#define __H__PROMESH_file_io_stl_obj
+
+#include <atomic>
+#include "lib_grid/lib_grid.h"
+
+///	Loads a binary or ascii .stl file. The file is parsed in parallel chunks.
+/**	Coincident vertices, i.e. vertices whose distance is at most
+ * weldTolerance, are merged with the help of a spatial hash. If
+ * weldTolerance is 0, only vertices with identical coordinates are merged.
+ * Triangles which degenerate through merging are skipped.
+ *
+ * Each solid of an ascii file is assigned to its own subset. All triangles
+ * of a binary file are assigned to subset 0.
+ *
+ * If canceled is given, it is checked between the stages of the import and
+ * before each triangle is created. Once it is set, false is returned.*/
+bool LoadGridFromSTLParallel(ug::Grid& grid, ug::ISubsetHandler& sh,
+							 const char* filename, ug::number weldTolerance,
+							 const std::atomic<bool>* canceled = NULL);
+
+///	Loads the vertices, lines and faces of an .obj file. The file is parsed in parallel chunks.
+/**	Vertices are merged as in LoadGridFromSTLParallel. Faces with more than
+ * four corners are triangulated as a fan. Each group or object of the file
+ * is assigned to its own subset. Materials and texture coordinates are
+ * ignored. canceled is checked as in LoadGridFromSTLParallel.*/
+bool LoadGridFromOBJParallel(ug::Grid& grid, ug::ISubsetHandler& sh,
+							 const char* filename, ug::number weldTolerance,
+							 const std::atomic<bool>* canceled = NULL);
+
+#endif	//__H__PROMESH_file_io_stl_obj
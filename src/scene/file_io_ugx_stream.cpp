@@ -0,0 +1,1166 @@
+/*
+ * Copyright (c) 2026:  G-CSC, Goethe University Frankfurt
+ * Author: Sebastian Reiter
+ * 
+ * This file is part of ProMesh.
+ * 
+ * ProMesh is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License version 3 (as published by the
+ * Free Software Foundation) with the following additional attribution
+ * requirements (according to LGPL/GPL v3 §7):
+ * 
+ * (1) The following notice must be displayed in the Appropriate Legal Notices
+ * of covered and combined works: "Based on ProMesh (www.promesh3d.com)".
+ * 
+ * (2) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S. and Wittum, G. ProMesh -- a flexible interactive meshing software
+ *   for unstructured hybrid grids in 1, 2, and 3 dimensions. In preparation."
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include <atomic>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include <stdint.h>
+#include <QFile>
+#include <boost/archive/text_iarchive.hpp>
+#include "file_io_ugx_stream.h"
+#include "common/boost_serialization_routines.h"
+#include "common/profiler/profiler.h"
+#include "common/util/archivar.h"
+#include "common/util/factory.h"
+#include "lib_grid/file_io/file_io_ugx.h"
+#include "lib_grid/refinement/projectors/projectors.h"
+
+using namespace std;
+using namespace ug;
+
+namespace{
+
+string DecodeEntities(const string& str)
+{
+	if(str.find('&') == string::npos)
+		return str;
+
+	string out;
+	for(size_t i = 0; i < str.size(); ++i){
+		if(str[i] != '&'){
+			out.push_back(str[i]);
+			continue;
+		}
+		size_t end = str.find(';', i);
+		if(end == string::npos){
+			out.push_back(str[i]);
+			continue;
+		}
+		string ent = str.substr(i + 1, end - i - 1);
+		if(ent == "amp")		out.push_back('&');
+		else if(ent == "lt")	out.push_back('<');
+		else if(ent == "gt")	out.push_back('>');
+		else if(ent == "quot")	out.push_back('"');
+		else if(ent == "apos")	out.push_back('\'');
+		else if(!ent.empty() && ent[0] == '#'){
+			long code = (ent.size() > 1 && (ent[1] == 'x' || ent[1] == 'X')) ?
+						strtol(ent.c_str() + 2, NULL, 16) : strtol(ent.c_str() + 1, NULL, 10);
+			if(code > 0 && code < 128)
+				out.push_back((char)code);
+		}
+		else{
+			out.append(str, i, end - i + 1);
+		}
+		i = end;
+	}
+	return out;
+}
+
+string EncodeEntities(const string& str)
+{
+	string out;
+	for(size_t i = 0; i < str.size(); ++i){
+		switch(str[i]){
+			case '&':	out.append("&amp;"); break;
+			case '<':	out.append("&lt;"); break;
+			case '>':	out.append("&gt;"); break;
+			case '"':	out.append("&quot;"); break;
+			default:	out.push_back(str[i]);
+		}
+	}
+	return out;
+}
+
+///	A pull parser for the subset of xml which is used by .ugx files.
+/**	The file is read through a buffer of constant size. Text is never
+ * stored but passed token by token to the caller. If a cancel flag is given,
+ * it is checked before the buffer is refilled. Once it is set, the parser
+ * behaves as if the end of the file was reached.*/
+class UGXStreamParser
+{
+	public:
+		struct Tag{
+			string							name;
+			vector<pair<string, string> >	attribs;
+			bool							isEnd;
+		///	true for tags of the form <name/>
+			bool							isEmpty;
+
+			const char* attrib(const char* attribName) const
+			{
+				for(size_t i = 0; i < attribs.size(); ++i){
+					if(attribs[i].first == attribName)
+						return attribs[i].second.c_str();
+				}
+				return NULL;
+			}
+		};
+
+		UGXStreamParser(QIODevice& in, const atomic<bool>* canceled = NULL) :
+			m_in(in), m_canceled(canceled), m_pos(0), m_size(0), m_eof(false),
+			m_capture(NULL), m_buf(1 << 20)	{}
+
+	///	returns true if reading was stopped through the cancel flag.
+		bool canceled() const
+		{
+			return m_canceled && m_canceled->load(memory_order_relaxed);
+		}
+
+	///	reads the next tag. Text, comments and processing instructions are skipped.
+		bool next_tag(Tag& tagOut)
+		{
+			while(skip_to_tag()){
+				get();
+				int c = get();
+				if(c == '?'){
+					if(!skip_past("?>"))
+						return false;
+					continue;
+				}
+				if(c == '!'){
+					if(!skip_declaration())
+						return false;
+					continue;
+				}
+
+				tagOut.name.clear();
+				tagOut.attribs.clear();
+				tagOut.isEnd = (c == '/');
+				tagOut.isEmpty = false;
+				if(tagOut.isEnd)
+					c = get();
+
+				while(c != EOF && !isspace(c) && c != '>' && c != '/'){
+					tagOut.name.push_back((char)c);
+					c = get();
+				}
+
+				while(true){
+					while(c != EOF && isspace(c))
+						c = get();
+					if(c == EOF)
+						return false;
+					if(c == '>')
+						return true;
+					if(c == '/'){
+						tagOut.isEmpty = true;
+						return get() == '>';
+					}
+
+					string name;
+					while(c != EOF && c != '=' && !isspace(c) && c != '>' && c != '/'){
+						name.push_back((char)c);
+						c = get();
+					}
+					while(c != EOF && isspace(c))
+						c = get();
+					if(c != '=')
+						return false;
+					c = get();
+					while(c != EOF && isspace(c))
+						c = get();
+					if(c != '"' && c != '\'')
+						return false;
+
+					const int quote = c;
+					string val;
+					while((c = get()) != EOF && c != quote)
+						val.push_back((char)c);
+					if(c == EOF)
+						return false;
+					tagOut.attribs.push_back(make_pair(name, DecodeEntities(val)));
+					c = get();
+				}
+			}
+			return false;
+		}
+
+	///	passes each whitespace separated token in the text of the element to func.
+	/**	func has to return false if the token is invalid. The end tag of the
+	 * element is consumed. Nested elements are not supported.*/
+		template <class TFunc>
+		bool read_tokens(const Tag& start, TFunc func)
+		{
+			if(start.isEmpty)
+				return true;
+
+			char tok[64];
+			size_t len = 0;
+			int c;
+			while((c = get()) != EOF){
+				if(c == '<' || isspace(c)){
+					if(len > 0){
+						tok[len] = 0;
+						if(!func(tok))
+							return false;
+						len = 0;
+					}
+					if(c == '<'){
+						unget();
+						break;
+					}
+				}
+				else{
+					if(len + 1 >= sizeof(tok))
+						return false;
+					tok[len++] = (char)c;
+				}
+			}
+
+			Tag end;
+			return next_tag(end) && end.isEnd && end.name == start.name;
+		}
+
+	///	skips the element which was started by the given tag, including all its children.
+		bool skip_element(const Tag& start)
+		{
+			if(start.isEmpty)
+				return true;
+
+			int depth = 1;
+			Tag tag;
+			while(depth > 0){
+				if(!next_tag(tag))
+					return false;
+				if(tag.isEnd)
+					--depth;
+				else if(!tag.isEmpty)
+					++depth;
+			}
+			return true;
+		}
+
+	///	returns the xml text of the element which was started by the given tag.
+		bool capture_element(const Tag& start, string& xmlOut)
+		{
+			xmlOut = "<";
+			xmlOut.append(start.name);
+			for(size_t i = 0; i < start.attribs.size(); ++i){
+				xmlOut.append(" ").append(start.attribs[i].first).append("=\"")
+					  .append(EncodeEntities(start.attribs[i].second)).append("\"");
+			}
+			xmlOut.append(start.isEmpty ? "/>" : ">");
+
+			m_capture = &xmlOut;
+			bool success = skip_element(start);
+			m_capture = NULL;
+			return success;
+		}
+
+	private:
+		int get()
+		{
+			if(m_pos == m_size && !refill())
+				return EOF;
+			char c = m_buf[m_pos++];
+			if(m_capture)
+				m_capture->push_back(c);
+			return (unsigned char)c;
+		}
+
+	///	puts back the character which was read by the last call to get.
+		void unget()
+		{
+			--m_pos;
+			if(m_capture)
+				m_capture->erase(m_capture->size() - 1);
+		}
+
+		bool refill()
+		{
+			if(m_eof || canceled())
+				return false;
+			qint64 numRead = m_in.read(&m_buf.front(), m_buf.size());
+			if(numRead <= 0){
+				m_eof = true;
+				return false;
+			}
+			m_size = (size_t)numRead;
+			m_pos = 0;
+			return true;
+		}
+
+	///	moves to the next '<' without consuming it.
+		bool skip_to_tag()
+		{
+			int c;
+			while((c = get()) != EOF){
+				if(c == '<'){
+					unget();
+					return true;
+				}
+			}
+			return false;
+		}
+
+	///	consumes characters until the given pattern was consumed.
+		bool skip_past(const char* pattern)
+		{
+			const size_t len = strlen(pattern);
+			string window;
+			int c;
+			while((c = get()) != EOF){
+				window.push_back((char)c);
+				if(window.size() > len)
+					window.erase(0, 1);
+				if(window == pattern)
+					return true;
+			}
+			return false;
+		}
+
+	///	skips comments, CDATA sections and doctype declarations. '<!' was already consumed.
+		bool skip_declaration()
+		{
+			int c = get();
+			if(c == '-'){
+				if(get() != '-')
+					return false;
+				return skip_past("-->");
+			}
+			if(c == '[')
+				return skip_past("]]>");
+			return skip_past(">");
+		}
+
+	private:
+		QIODevice&			m_in;
+		const atomic<bool>*	m_canceled;
+		size_t				m_pos;
+		size_t				m_size;
+		bool				m_eof;
+		string*				m_capture;
+		vector<char>		m_buf;
+};
+
+typedef UGXStreamParser::Tag	UGXTag;
+
+///	elements in the order in which they appear in the file. Indices in the file refer to them.
+struct UGXElements{
+	vector<Vertex*>	vrts;
+	vector<Edge*>	edges;
+	vector<Face*>	faces;
+	vector<Volume*>	vols;
+};
+
+///	positions, corner indices and subsets of the elements of a .ugx file.
+/**	Elements are indexed in the order in which they appear in the file, as
+ * in UGXElements. Used to evaluate a PartialLoadFilter and to summarize a
+ * file without creating a grid.*/
+struct UGXGeometry{
+	UGXGeometry()
+	{
+		for(int dim = 1; dim < 4; ++dim)
+			offsets[dim].push_back(0);
+	}
+
+	size_t num(int dim) const
+	{
+		return dim == 0 ? positions.size() : offsets[dim].size() - 1;
+	}
+
+	size_t num_corners(int dim, size_t i) const
+	{
+		return dim == 0 ? 1 : offsets[dim][i + 1] - offsets[dim][i];
+	}
+
+	size_t corner(int dim, size_t i, size_t j) const
+	{
+		return dim == 0 ? i : corners[dim][offsets[dim][i] + j];
+	}
+
+	const vector3& position(size_t i) const	{return positions[i];}
+
+	int subset_index(int dim, size_t i) const
+	{
+		return i < subsetIndices[dim].size() ? subsetIndices[dim][i] : -1;
+	}
+
+	vector<vector3>		positions;
+///	corner indices of edges, faces and volumes
+	vector<uint32_t>	corners[4];
+///	offsets of the corner indices of each element and a final entry
+	vector<size_t>		offsets[4];
+///	subset indices in the first subset handler. Elements which appear after it have none.
+	vector<int>			subsetIndices[4];
+};
+
+///	the element nodes of a .ugx file, their dimension and number of corners
+struct UGXElementNode{
+	const char*	name;
+	int			dim;
+	size_t		numCorners;
+};
+
+const UGXElementNode UGX_ELEMENT_NODES[] = {
+	{"edges", 1, 2},
+	{"triangles", 2, 3},
+	{"quadrilaterals", 2, 4},
+	{"tetrahedrons", 3, 4},
+	{"pyramids", 3, 5},
+	{"prisms", 3, 6},
+	{"hexahedrons", 3, 8},
+	{"octahedrons", 3, 6}
+};
+
+const UGXElementNode* FindUGXElementNode(const string& name)
+{
+	const size_t numNodes = sizeof(UGX_ELEMENT_NODES) / sizeof(UGXElementNode);
+	for(size_t i = 0; i < numNodes; ++i){
+		if(name == UGX_ELEMENT_NODES[i].name)
+			return &UGX_ELEMENT_NODES[i];
+	}
+	return NULL;
+}
+
+///	returns true if the i-th element shall be skipped. keep may be NULL.
+inline bool SkipElement(const vector<char>* keep, size_t i)
+{
+	return keep && (i >= keep->size() || !(*keep)[i]);
+}
+
+inline bool ParseIndex(const char* tok, size_t& indOut)
+{
+	char* end;
+	indOut = (size_t)strtoul(tok, &end, 10);
+	return *end == 0;
+}
+
+inline bool ParseNumber(const char* tok, number& valOut)
+{
+	char* end;
+	valOut = (number)strtod(tok, &end);
+	return *end == 0;
+}
+
+///	reads the coordinates of a vertices node and passes each position to func
+template <class TFunc>
+bool ReadPositions(UGXStreamParser& p, const UGXTag& tag, TFunc func)
+{
+	int dim = 3;
+	if(const char* coords = tag.attrib("coords"))
+		dim = atoi(coords);
+	if(dim < 1 || dim > 3)
+		return false;
+
+	vector3 c(0, 0, 0);
+	int numCoords = 0;
+	bool success = p.read_tokens(tag, [&](const char* tok) -> bool{
+		if(!ParseNumber(tok, c[numCoords]))
+			return false;
+		if(++numCoords == dim){
+			func(c);
+			numCoords = 0;
+		}
+		return true;
+	});
+	return success && numCoords == 0;
+}
+
+///	creates the vertices of a vertices node. Vertices which aren't kept are stored as NULL.
+bool ReadVertices(UGXStreamParser& p, const UGXTag& tag, Grid& grid,
+				  Grid::VertexAttachmentAccessor<APosition>& aaPos,
+				  UGXElements& elems, const vector<char>* keep)
+{
+	return ReadPositions(p, tag, [&](const vector3& c){
+		Vertex* v = NULL;
+		if(!SkipElement(keep, elems.vrts.size())){
+			v = *grid.create<RegularVertex>();
+			aaPos[v] = c;
+		}
+		elems.vrts.push_back(v);
+	});
+}
+
+///	reads tuples of numCorners vertex indices and passes the vertices to createFunc
+/**	The created elements are appended to elemsOut. Elements which aren't
+ * kept are stored as NULL. Their corners may be NULL, too.*/
+template <class TElem, class TCreateFunc>
+bool ReadElements(UGXStreamParser& p, const UGXTag& tag, size_t numCorners,
+				  const vector<Vertex*>& vrtsInFile, vector<TElem*>& elemsOut,
+				  const vector<char>* keep, TCreateFunc createFunc)
+{
+	Vertex* vrts[8];
+	size_t numRead = 0;
+	bool success = p.read_tokens(tag, [&](const char* tok) -> bool{
+		size_t ind;
+		if(!ParseIndex(tok, ind) || ind >= vrtsInFile.size())
+			return false;
+		vrts[numRead] = vrtsInFile[ind];
+		if(++numRead == numCorners){
+			if(SkipElement(keep, elemsOut.size()))
+				elemsOut.push_back(NULL);
+			else
+				elemsOut.push_back(createFunc(vrts));
+			numRead = 0;
+		}
+		return true;
+	});
+	return success && numRead == 0;
+}
+
+template <class TElem>
+bool ReadSubsetElements(UGXStreamParser& p, const UGXTag& tag, ISubsetHandler& sh,
+						int si, const vector<TElem*>& elems)
+{
+	return p.read_tokens(tag, [&](const char* tok) -> bool{
+		size_t ind;
+		if(!ParseIndex(tok, ind) || ind >= elems.size())
+			return false;
+		if(elems[ind])
+			sh.assign_subset(elems[ind], si);
+		return true;
+	});
+}
+
+void ReadSubsetAttribs(const UGXTag& tag, SubsetInfo& info)
+{
+	if(const char* name = tag.attrib("name"))
+		info.name = name;
+	if(const char* color = tag.attrib("color")){
+		const char* cur = color;
+		for(int i = 0; i < 4; ++i){
+			char* end;
+			info.color[i] = (number)strtod(cur, &end);
+			cur = end;
+		}
+	}
+	if(const char* state = tag.attrib("state"))
+		info.subsetState = (uint)strtoul(state, NULL, 10);
+}
+
+bool ReadSubset(UGXStreamParser& p, const UGXTag& tag, ISubsetHandler& sh,
+				int si, const UGXElements& elems)
+{
+	ReadSubsetAttribs(tag, sh.subset_info(si));
+	if(tag.isEmpty)
+		return true;
+
+	UGXTag child;
+	while(p.next_tag(child)){
+		if(child.isEnd)
+			return child.name == tag.name;
+
+		bool success;
+		if(child.name == "vertices")
+			success = ReadSubsetElements(p, child, sh, si, elems.vrts);
+		else if(child.name == "edges")
+			success = ReadSubsetElements(p, child, sh, si, elems.edges);
+		else if(child.name == "faces")
+			success = ReadSubsetElements(p, child, sh, si, elems.faces);
+		else if(child.name == "volumes")
+			success = ReadSubsetElements(p, child, sh, si, elems.vols);
+		else
+			success = p.skip_element(child);
+
+		if(!success)
+			return false;
+	}
+	return false;
+}
+
+bool ReadSubsetHandler(UGXStreamParser& p, const UGXTag& tag, ISubsetHandler& sh,
+					   const UGXElements& elems)
+{
+	if(tag.isEmpty)
+		return true;
+
+	int si = 0;
+	UGXTag child;
+	while(p.next_tag(child)){
+		if(child.isEnd)
+			return child.name == tag.name;
+
+		bool success;
+		if(child.name == "subset")
+			success = ReadSubset(p, child, sh, si++, elems);
+		else
+			success = p.skip_element(child);
+
+		if(!success)
+			return false;
+	}
+	return false;
+}
+
+///	selection states are stored as pairs of element index and state
+template <class TElem>
+bool ReadSelectorElements(UGXStreamParser& p, const UGXTag& tag, ISelector& sel,
+						  const vector<TElem*>& elems)
+{
+	size_t ind = 0;
+	bool readState = false;
+	return p.read_tokens(tag, [&](const char* tok) -> bool{
+		if(!readState){
+			readState = true;
+			return ParseIndex(tok, ind) && ind < elems.size();
+		}
+		readState = false;
+		size_t state;
+		if(!ParseIndex(tok, state))
+			return false;
+		if(state != 0 && elems[ind])
+			sel.select(elems[ind], (byte)state);
+		return true;
+	});
+}
+
+bool ReadSelector(UGXStreamParser& p, const UGXTag& tag, ISelector& sel,
+				  const UGXElements& elems)
+{
+	if(tag.isEmpty)
+		return true;
+
+	UGXTag child;
+	while(p.next_tag(child)){
+		if(child.isEnd)
+			return child.name == tag.name;
+
+		bool success;
+		if(child.name == "vertices")
+			success = ReadSelectorElements(p, child, sel, elems.vrts);
+		else if(child.name == "edges")
+			success = ReadSelectorElements(p, child, sel, elems.edges);
+		else if(child.name == "faces")
+			success = ReadSelectorElements(p, child, sel, elems.faces);
+		else if(child.name == "volumes")
+			success = ReadSelectorElements(p, child, sel, elems.vols);
+		else
+			success = p.skip_element(child);
+
+		if(!success)
+			return false;
+	}
+	return false;
+}
+
+bool IsConstrainedElementNode(const string& name)
+{
+	return name.compare(0, 12, "constrained_") == 0
+		|| name.compare(0, 13, "constraining_") == 0;
+}
+
+///	reads tags until the start tag of the first grid was read.
+bool FindGridTag(UGXStreamParser& p, UGXTag& tagOut)
+{
+	while(p.next_tag(tagOut)){
+		if(!tagOut.isEnd && tagOut.name == "grid")
+			return true;
+	}
+	return false;
+}
+
+////////////////////////////////////////////////////////////////////////
+//	geometry pass
+bool ReadCorners(UGXStreamParser& p, const UGXTag& tag, const UGXElementNode& node,
+				 UGXGeometry& geom)
+{
+	vector<uint32_t>& corners = geom.corners[node.dim];
+	size_t numRead = 0;
+	bool success = p.read_tokens(tag, [&](const char* tok) -> bool{
+		size_t ind;
+		if(!ParseIndex(tok, ind) || ind >= geom.positions.size())
+			return false;
+		corners.push_back((uint32_t)ind);
+		if(++numRead == node.numCorners){
+			geom.offsets[node.dim].push_back(corners.size());
+			numRead = 0;
+		}
+		return true;
+	});
+	return success && numRead == 0;
+}
+
+bool ReadSubsetIndices(UGXStreamParser& p, const UGXTag& tag, int si, int dim,
+					   UGXGeometry& geom)
+{
+	return p.read_tokens(tag, [&](const char* tok) -> bool{
+		size_t ind;
+		if(!ParseIndex(tok, ind) || ind >= geom.num(dim))
+			return false;
+		geom.subsetIndices[dim][ind] = si;
+		return true;
+	});
+}
+
+///	reads the subset indices of the first subset handler into geom.
+/**	Names and colors of the subsets are appended to subsetsOut if it isn't NULL.*/
+bool ReadGeometrySubsets(UGXStreamParser& p, const UGXTag& tag, UGXGeometry& geom,
+						 vector<MeshFileSubsetSummary>* subsetsOut)
+{
+	for(int dim = 0; dim < 4; ++dim)
+		geom.subsetIndices[dim].assign(geom.num(dim), -1);
+
+	if(tag.isEmpty)
+		return true;
+
+	static const char* elemNodes[4] = {"vertices", "edges", "faces", "volumes"};
+	int si = 0;
+	UGXTag child;
+	while(p.next_tag(child)){
+		if(child.isEnd)
+			return child.name == tag.name;
+		if(child.name != "subset"){
+			if(!p.skip_element(child))
+				return false;
+			continue;
+		}
+
+		if(subsetsOut){
+			SubsetInfo info;
+			ReadSubsetAttribs(child, info);
+			subsetsOut->push_back(MeshFileSubsetSummary());
+			subsetsOut->back().name = info.name;
+			subsetsOut->back().color = info.color;
+		}
+
+		if(!child.isEmpty){
+			UGXTag elemTag;
+			while(true){
+				if(!p.next_tag(elemTag))
+					return false;
+				if(elemTag.isEnd){
+					if(elemTag.name != child.name)
+						return false;
+					break;
+				}
+
+				bool success = false;
+				bool found = false;
+				for(int dim = 0; dim < 4; ++dim){
+					if(elemTag.name == elemNodes[dim]){
+						success = ReadSubsetIndices(p, elemTag, si, dim, geom);
+						found = true;
+						break;
+					}
+				}
+				if(!found)
+					success = p.skip_element(elemTag);
+				if(!success)
+					return false;
+			}
+		}
+		++si;
+	}
+	return false;
+}
+
+///	reads positions, corner indices and the first subset handler of the first grid.
+/**	No grid elements are created. Returns UGX_STREAM_UNSUPPORTED for files
+ * with constrained elements.*/
+UGXStreamResult ReadUGXGeometry(UGXStreamParser& p, const char* filename,
+								UGXGeometry& geom,
+								vector<MeshFileSubsetSummary>* subsetsOut)
+{
+	UGXTag tag;
+	if(!FindGridTag(p, tag)){
+		UG_LOG("ERROR in ReadUGXGeometry: File contains no grid.\n");
+		return UGX_STREAM_FAILED;
+	}
+	if(tag.isEmpty)
+		return UGX_STREAM_OK;
+
+	bool subsetsRead = false;
+	while(p.next_tag(tag)){
+		if(tag.isEnd){
+			if(tag.name == "grid")
+				return UGX_STREAM_OK;
+			break;
+		}
+
+		const string& name = tag.name;
+		bool success;
+		if(name == "vertices"){
+			success = ReadPositions(p, tag, [&geom](const vector3& c){
+								geom.positions.push_back(c);
+							});
+		}
+		else if(const UGXElementNode* node = FindUGXElementNode(name))
+			success = ReadCorners(p, tag, *node, geom);
+		else if(IsConstrainedElementNode(name))
+			return UGX_STREAM_UNSUPPORTED;
+		else if(name == "subset_handler" && !subsetsRead){
+			success = ReadGeometrySubsets(p, tag, geom, subsetsOut);
+			subsetsRead = true;
+		}
+		else
+			success = p.skip_element(tag);
+
+		if(!success){
+			if(p.canceled())
+				return UGX_STREAM_FAILED;
+			UG_LOG("ERROR in ReadUGXGeometry: Corrupt node '" << name
+				   << "' in " << filename << "\n");
+			return UGX_STREAM_FAILED;
+		}
+	}
+
+	if(!p.canceled())
+		UG_LOG("ERROR in ReadUGXGeometry: Unexpected end of file " << filename << "\n");
+	return UGX_STREAM_FAILED;
+}
+
+////////////////////////////////////////////////////////////////////////
+//	grid creation
+///	deselects the given elements in all selectors
+template <class TElem>
+void DeselectElements(const vector<TElem*>& elems, ISelector** ppSel, int numSels)
+{
+	for(int i = 0; i < numSels; ++i){
+		if(!ppSel[i])
+			continue;
+		for(size_t j = 0; j < elems.size(); ++j){
+			if(elems[j])
+				ppSel[i]->deselect(elems[j]);
+		}
+	}
+}
+
+///	erases the elements which were read and restores the subset infos and selections.
+/**	oldSubsetInfos holds the subset infos of each handler before the file was read.*/
+void RestoreUGXTarget(Grid& grid, UGXElements& elems,
+					  ISubsetHandler** ppSH, int numSHs,
+					  ISelector** ppSel, int numSels,
+					  const vector<vector<SubsetInfo> >& oldSubsetInfos)
+{
+	DeselectElements(elems.vrts, ppSel, numSels);
+	DeselectElements(elems.edges, ppSel, numSels);
+	DeselectElements(elems.faces, ppSel, numSels);
+	DeselectElements(elems.vols, ppSel, numSels);
+
+//	all other elements which were read are erased together with their corners
+	for(size_t i = 0; i < elems.vrts.size(); ++i){
+		if(elems.vrts[i])
+			grid.erase(elems.vrts[i]);
+	}
+
+	for(int i = 0; i < numSHs; ++i){
+		if(!ppSH[i])
+			continue;
+		ISubsetHandler& sh = *ppSH[i];
+		const vector<SubsetInfo>& infos = oldSubsetInfos[i];
+		while(sh.num_subsets() > (int)infos.size())
+			sh.erase_subset(sh.num_subsets() - 1);
+		for(size_t j = 0; j < infos.size(); ++j)
+			sh.subset_info((int)j) = infos[j];
+	}
+}
+
+///	creates the first grid of a .ugx file. If keep isn't NULL, only the elements whose flag is set are created.
+UGXStreamResult LoadGridFromUGXParser(Grid& grid, UGXStreamParser& p, const char* filename,
+									  ISubsetHandler** ppSH, int numSHs,
+									  ISelector** ppSel, int numSels,
+									  string* projectionHandlerXmlOut,
+									  const vector<char>* keep)
+{
+	const vector<char>* keepVrts = keep ? &keep[0] : NULL;
+	const vector<char>* keepEdges = keep ? &keep[1] : NULL;
+	const vector<char>* keepFaces = keep ? &keep[2] : NULL;
+	const vector<char>* keepVols = keep ? &keep[3] : NULL;
+
+	UGXTag tag;
+	if(!FindGridTag(p, tag)){
+		UG_LOG("ERROR in LoadGridFromUGXStream: File contains no grid.\n");
+		return UGX_STREAM_FAILED;
+	}
+
+	if(projectionHandlerXmlOut)
+		projectionHandlerXmlOut->clear();
+	if(tag.isEmpty)
+		return UGX_STREAM_OK;
+
+	if(!grid.has_vertex_attachment(aPosition))
+		grid.attach_to_vertices(aPosition);
+	Grid::VertexAttachmentAccessor<APosition> aaPos(grid, aPosition);
+
+	UGXElements elems;
+	int shIndex = 0;
+	int selIndex = 0;
+	bool phRead = false;
+
+//	subset infos are restored if the file turns out to be unsupported
+	vector<vector<SubsetInfo> > oldSubsetInfos(numSHs);
+	for(int i = 0; i < numSHs; ++i){
+		if(!ppSH[i])
+			continue;
+		for(int j = 0; j < ppSH[i]->num_subsets(); ++j)
+			oldSubsetInfos[i].push_back(ppSH[i]->subset_info(j));
+	}
+
+	while(p.next_tag(tag)){
+		if(tag.isEnd){
+			if(tag.name == "grid")
+				return UGX_STREAM_OK;
+			break;
+		}
+
+		const string& name = tag.name;
+		bool success;
+		if(name == "vertices")
+			success = ReadVertices(p, tag, grid, aaPos, elems, keepVrts);
+		else if(name == "edges"){
+			success = ReadElements(p, tag, 2, elems.vrts, elems.edges, keepEdges,
+				[&](Vertex** v) -> Edge*{
+					return *grid.create<RegularEdge>(EdgeDescriptor(v[0], v[1]));
+				});
+		}
+		else if(name == "triangles"){
+			success = ReadElements(p, tag, 3, elems.vrts, elems.faces, keepFaces,
+				[&](Vertex** v) -> Face*{
+					return *grid.create<Triangle>(TriangleDescriptor(v[0], v[1], v[2]));
+				});
+		}
+		else if(name == "quadrilaterals"){
+			success = ReadElements(p, tag, 4, elems.vrts, elems.faces, keepFaces,
+				[&](Vertex** v) -> Face*{
+					return *grid.create<Quadrilateral>(
+							QuadrilateralDescriptor(v[0], v[1], v[2], v[3]));
+				});
+		}
+		else if(name == "tetrahedrons"){
+			success = ReadElements(p, tag, 4, elems.vrts, elems.vols, keepVols,
+				[&](Vertex** v) -> Volume*{
+					return *grid.create<Tetrahedron>(
+							TetrahedronDescriptor(v[0], v[1], v[2], v[3]));
+				});
+		}
+		else if(name == "pyramids"){
+			success = ReadElements(p, tag, 5, elems.vrts, elems.vols, keepVols,
+				[&](Vertex** v) -> Volume*{
+					return *grid.create<Pyramid>(
+							PyramidDescriptor(v[0], v[1], v[2], v[3], v[4]));
+				});
+		}
+		else if(name == "prisms"){
+			success = ReadElements(p, tag, 6, elems.vrts, elems.vols, keepVols,
+				[&](Vertex** v) -> Volume*{
+					return *grid.create<Prism>(
+							PrismDescriptor(v[0], v[1], v[2], v[3], v[4], v[5]));
+				});
+		}
+		else if(name == "hexahedrons"){
+			success = ReadElements(p, tag, 8, elems.vrts, elems.vols, keepVols,
+				[&](Vertex** v) -> Volume*{
+					return *grid.create<Hexahedron>(
+							HexahedronDescriptor(v[0], v[1], v[2], v[3],
+												 v[4], v[5], v[6], v[7]));
+				});
+		}
+		else if(name == "octahedrons"){
+			success = ReadElements(p, tag, 6, elems.vrts, elems.vols, keepVols,
+				[&](Vertex** v) -> Volume*{
+					return *grid.create<Octahedron>(
+							OctahedronDescriptor(v[0], v[1], v[2], v[3], v[4], v[5]));
+				});
+		}
+		else if(IsConstrainedElementNode(name)){
+		//	restore the original state of the grid, its subsets and selections
+			RestoreUGXTarget(grid, elems, ppSH, numSHs, ppSel, numSels, oldSubsetInfos);
+			if(projectionHandlerXmlOut)
+				projectionHandlerXmlOut->clear();
+			return UGX_STREAM_UNSUPPORTED;
+		}
+		else if(name == "subset_handler"){
+			ISubsetHandler* sh = shIndex < numSHs ? ppSH[shIndex] : NULL;
+			++shIndex;
+			success = sh ? ReadSubsetHandler(p, tag, *sh, elems) : p.skip_element(tag);
+		}
+		else if(name == "selector"){
+			ISelector* sel = selIndex < numSels ? ppSel[selIndex] : NULL;
+			++selIndex;
+			success = sel ? ReadSelector(p, tag, *sel, elems) : p.skip_element(tag);
+		}
+		else if(name == "projection_handler" && projectionHandlerXmlOut && !phRead){
+			success = p.capture_element(tag, *projectionHandlerXmlOut);
+			phRead = true;
+		}
+		else
+			success = p.skip_element(tag);
+
+		if(!success){
+			if(p.canceled())
+				return UGX_STREAM_FAILED;
+			UG_LOG("ERROR in LoadGridFromUGXStream: Corrupt node '" << name
+				   << "' in " << filename << "\n");
+			return UGX_STREAM_FAILED;
+		}
+	}
+
+	if(!p.canceled())
+		UG_LOG("ERROR in LoadGridFromUGXStream: Unexpected end of file " << filename << "\n");
+	return UGX_STREAM_FAILED;
+}
+}//	end of anonymous namespace
+
+
+UGXStreamResult LoadGridFromUGXStream(Grid& grid, const char* filename,
+									  ISubsetHandler** ppSH, int numSHs,
+									  ISelector** ppSel, int numSels,
+									  string* projectionHandlerXmlOut,
+									  const PartialLoadFilter* filter,
+									  const atomic<bool>* canceled)
+{
+	PROFILE_FUNC();
+	const QString qFilename = QString::fromLocal8Bit(filename);
+	vector<char> keep[4];
+	const bool filtered = filter && !filter->loads_everything();
+	if(filtered){
+	//	the filter is evaluated on the positions and corners of the elements
+	//	first, so that only the loaded part of the mesh is created.
+		QFile file(qFilename);
+		if(!file.open(QIODevice::ReadOnly)){
+			UG_LOG("ERROR in LoadGridFromUGXStream: File not found: " << filename << "\n");
+			return UGX_STREAM_FAILED;
+		}
+		UGXStreamParser p(file, canceled);
+		UGXGeometry geom;
+		UGXStreamResult result = ReadUGXGeometry(p, filename, geom, NULL);
+		if(result != UGX_STREAM_OK)
+			return result;
+		ComputePartialLoadKeepFlags(keep, geom, *filter);
+	}
+
+	QFile file(qFilename);
+	if(!file.open(QIODevice::ReadOnly)){
+		UG_LOG("ERROR in LoadGridFromUGXStream: File not found: " << filename << "\n");
+		return UGX_STREAM_FAILED;
+	}
+	UGXStreamParser p(file, canceled);
+	return LoadGridFromUGXParser(grid, p, filename, ppSH, numSHs, ppSel, numSels,
+								 projectionHandlerXmlOut, filtered ? keep : NULL);
+}
+
+
+UGXStreamResult LoadGridFromUGXStream(Grid& grid, QIODevice& in, const char* filename,
+									  ISubsetHandler** ppSH, int numSHs,
+									  ISelector** ppSel, int numSels,
+									  string* projectionHandlerXmlOut,
+									  const atomic<bool>* canceled)
+{
+	PROFILE_FUNC();
+	UGXStreamParser p(in, canceled);
+	return LoadGridFromUGXParser(grid, p, filename, ppSH, numSHs, ppSel, numSels,
+								 projectionHandlerXmlOut, NULL);
+}
+
+
+UGXStreamResult ReadUGXSummary(const char* filename, MeshFileSummary& summaryOut)
+{
+	PROFILE_FUNC();
+	summaryOut = MeshFileSummary();
+	QFile file(QString::fromLocal8Bit(filename));
+	if(!file.open(QIODevice::ReadOnly)){
+		UG_LOG("ERROR in ReadUGXSummary: File not found: " << filename << "\n");
+		return UGX_STREAM_FAILED;
+	}
+
+	UGXStreamParser p(file);
+	UGXGeometry geom;
+	UGXStreamResult result = ReadUGXGeometry(p, filename, geom, &summaryOut.subsets);
+	if(result == UGX_STREAM_OK)
+		SummarizeMeshGeometry(summaryOut, geom);
+	else
+		summaryOut = MeshFileSummary();
+	return result;
+}
+
+
+bool ReadUGXProjectionHandler(ProjectionHandler& ph, const string& xml)
+{
+	PROFILE_FUNC();
+	static Factory<RefinementProjector, ProjectorTypes>	factory;
+	static Archivar<boost::archive::text_iarchive,
+					RefinementProjector,
+					ProjectorTypes>	archivar;
+
+//	the node is parsed with rapidxml, like GridReaderUGX does for whole files
+	vector<char> buf(xml.begin(), xml.end());
+	buf.push_back(0);
+	rapidxml::xml_document<> doc;
+	try{
+		doc.parse<0>(&buf.front());
+	}
+	catch(...){
+		return false;
+	}
+
+	rapidxml::xml_node<>* phNode = doc.first_node("projection_handler");
+	if(!phNode)
+		return false;
+
+	bool success = true;
+	for(rapidxml::xml_node<>* node = phNode->first_node(); node; node = node->next_sibling())
+	{
+	//	the default projector is stored for subset -1
+		int si = -1;
+		if(strcmp(node->name(), "projector") == 0){
+			rapidxml::xml_attribute<>* attSI = node->first_attribute("subset");
+			if(!attSI){
+				success = false;
+				continue;
+			}
+			si = atoi(attSI->value());
+		}
+		else if(strcmp(node->name(), "default") != 0)
+			continue;
+
+		rapidxml::xml_attribute<>* attType = node->first_attribute("type");
+		if(!attType){
+			success = false;
+			continue;
+		}
+
+	//	GridWriterUGX writes the archives without header. Archives with a
+	//	header are accepted, too.
+		const string data(node->value(), node->value_size());
+		bool restored = false;
+		for(int withHeader = 0; withHeader < 2 && !restored; ++withHeader){
+			try{
+				SPRefinementProjector proj = factory.create(attType->value());
+				proj->set_geometry(ph.geometry());
+				istringstream is(data);
+				boost::archive::text_iarchive ia(is, withHeader ? 0
+												 : boost::archive::no_header);
+				archivar.archive(ia, *proj);
+				ph.set_projector(si, proj);
+				restored = true;
+			}
+			catch(...){}
+		}
+
+		if(!restored){
+			UG_LOG("WARNING in ReadUGXProjectionHandler: Couldn't restore projector '"
+				   << attType->value() << "' of subset " << si << ".\n");
+			success = false;
+		}
+	}
+	return success;
+}
@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2026:  G-CSC, Goethe University Frankfurt
+ * Author: Sebastian Reiter
+ * 
+ * This file is part of ProMesh.
+ * 
+ * ProMesh is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License version 3 (as published by the
+ * Free Software Foundation) with the following additional attribution
+ * requirements (according to LGPL/GPL v3 §7):
+ * 
+ * (1) The following notice must be displayed in the Appropriate Legal Notices
+ * of covered and combined works: "Based on ProMesh (www.promesh3d.com)".
+ * 
+ * (2) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S. and Wittum, G. ProMesh -- a flexible interactive meshing software
+ *   for unstructured hybrid grids in 1, 2, and 3 dimensions. In preparation."
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#ifndef __H__PROMESH_file_io_ugx_stream
+#define __H__PROMESH_file_io_ugx_stream
+
+#include <atomic>
+#include <string>
+#include <QIODevice>
+#include "lib_grid/lib_grid.h"
+#include "lib_grid/refinement/projectors/projection_handler.h"
+#include "partial_load.h"
+
+enum UGXStreamResult{
+	UGX_STREAM_OK,
+	UGX_STREAM_FAILED,
+///	the file contains data which the streaming reader doesn't support. The grid is unchanged.
+	UGX_STREAM_UNSUPPORTED
+};
+
+///	Reads the first grid of a .ugx file incrementally with buffers of constant size.
+/**	In contrast to GridReaderUGX, no document tree of the file is created.
+ * Vertices, elements, subsets and selection states are created while the
+ * file is read, so that the peak memory is close to that of the final mesh.
+ *
+ * Subset handlers and selectors are assigned in the order in which they
+ * appear in the file. The first projection handler is not interpreted but
+ * returned as xml text through projectionHandlerXmlOut (if not NULL). It can
+ * be read through ReadUGXProjectionHandler once the subsets exist.
+ *
+ * If a filter is given, the file is read twice. The first pass only keeps
+ * positions, corner indices and the subsets of the first subset handler to
+ * evaluate the filter, so that the second pass only creates the elements
+ * which pass the filter together with their sides and corners.
+ *
+ * Files with constrained elements (hanging nodes) are not supported. In this
+ * case the elements which were already created are erased again, subset
+ * infos and selections are restored and UGX_STREAM_UNSUPPORTED is returned.
+ *
+ * If canceled is given, it is checked whenever the next block of the file
+ * is read. Once it is set, reading stops and UGX_STREAM_FAILED is returned.
+ * The grid then holds the part of the mesh which was read so far.*/
+UGXStreamResult LoadGridFromUGXStream(ug::Grid& grid, const char* filename,
+									  ug::ISubsetHandler** ppSH, int numSHs,
+									  ug::ISelector** ppSel, int numSels,
+									  std::string* projectionHandlerXmlOut = NULL,
+									  const PartialLoadFilter* filter = NULL,
+									  const std::atomic<bool>* canceled = NULL);
+
+///	Reads the first grid of .ugx data from a sequential device. See LoadGridFromUGXStream above.
+/**	filename is only used in messages.*/
+UGXStreamResult LoadGridFromUGXStream(ug::Grid& grid, QIODevice& in,
+									  const char* filename,
+									  ug::ISubsetHandler** ppSH, int numSHs,
+									  ug::ISelector** ppSel, int numSels,
+									  std::string* projectionHandlerXmlOut = NULL,
+									  const std::atomic<bool>* canceled = NULL);
+
+///	reads the subset table and the bounding boxes of the subsets of a .ugx file.
+/**	No grid is created. Only positions, corner indices and the subsets of the
+ * first subset handler are held in memory while the file is streamed.
+ * Returns UGX_STREAM_UNSUPPORTED for files with constrained elements.*/
+UGXStreamResult ReadUGXSummary(const char* filename, MeshFileSummary& summaryOut);
+
+///	restores the projectors of a projection handler node of a .ugx file.
+/**	xml is the text of the node, as returned by LoadGridFromUGXStream. The
+ * node is parsed in memory. Projectors are associated with the geometry of
+ * ph, which thus has to be set before. Returns false if the node is corrupt
+ * or if a projector couldn't be restored. All valid projectors are set anyway.*/
+bool ReadUGXProjectionHandler(ug::ProjectionHandler& ph, const std::string& xml);
+
+#endif	//__H__PROMESH_file_io_ugx_stream
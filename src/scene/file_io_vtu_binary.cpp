@@ -0,0 +1,658 @@
+/*
+ * Copyright (c) 2026:  G-CSC, Goethe University Frankfurt
+ * Author: Sebastian Reiter
+ * 
+ * This file is part of ProMesh.
+ * 
+ * ProMesh is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License version 3 (as published by the
+ * Free Software Foundation) with the following additional attribution
+ * requirements (according to LGPL/GPL v3 §7):
+ * 
+ * (1) The following notice must be displayed in the Appropriate Legal Notices
+ * of covered and combined works: "Based on ProMesh (www.promesh3d.com)".
+ * 
+ * (2) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S. and Wittum, G. ProMesh -- a flexible interactive meshing software
+ *   for unstructured hybrid grids in 1, 2, and 3 dimensions. In preparation."
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include <algorithm>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include <stdint.h>
+#include <QByteArray>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QSysInfo>
+#include "file_io_vtu_binary.h"
+#include "common/profiler/profiler.h"
+#include "util/parallel_util.h"
+
+using namespace std;
+using namespace ug;
+
+namespace{
+
+///	number of uncompressed bytes per block of an appended array
+const size_t VTU_BLOCK_SIZE = 1 << 20;
+
+enum VTKCellType{
+	VTK_LINE = 3,
+	VTK_TRIANGLE = 5,
+	VTK_QUAD = 9,
+	VTK_TETRA = 10,
+	VTK_HEXAHEDRON = 12,
+	VTK_WEDGE = 13,
+	VTK_PYRAMID = 14
+};
+
+///	the arrays of a .vtu file in the order in which they are appended
+enum VTUArray{
+	VTU_POINTS,
+	VTU_CONNECTIVITY,
+	VTU_OFFSETS,
+	VTU_TYPES,
+	VTU_REGIONS,
+	VTU_NUM_ARRAYS
+};
+
+const char* VTKByteOrder()
+{
+	return QSysInfo::ByteOrder == QSysInfo::LittleEndian ? "LittleEndian" : "BigEndian";
+}
+
+struct VTKCell{
+	uint8_t	type;
+	int		numCorners;
+///	indices of the corners in the vertex list of the element
+	int		corners[8];
+};
+
+void SetVTKCell(VTKCell& cell, uint8_t type, int numCorners, const int* corners)
+{
+	cell.type = type;
+	cell.numCorners = numCorners;
+	for(int i = 0; i < numCorners; ++i)
+		cell.corners[i] = corners[i];
+}
+
+///	writes the vtk cells of an element to cellsOut (at most 2) and returns their number.
+int GetVTKCells(Edge*, VTKCell* cellsOut)
+{
+	static const int line[] = {0, 1};
+	SetVTKCell(cellsOut[0], VTK_LINE, 2, line);
+	return 1;
+}
+
+int GetVTKCells(Face* f, VTKCell* cellsOut)
+{
+	static const int corners[] = {0, 1, 2, 3};
+	if(f->num_vertices() == 3)
+		SetVTKCell(cellsOut[0], VTK_TRIANGLE, 3, corners);
+	else
+		SetVTKCell(cellsOut[0], VTK_QUAD, 4, corners);
+	return 1;
+}
+
+int GetVTKCells(Volume* v, VTKCell* cellsOut)
+{
+	static const int tet[] = {0, 1, 2, 3};
+	static const int pyramid[] = {0, 1, 2, 3, 4};
+//	the base triangle of a vtk wedge is oriented away from the top triangle
+	static const int prism[] = {0, 2, 1, 3, 5, 4};
+	static const int hex[] = {0, 1, 2, 3, 4, 5, 6, 7};
+//	octahedra are split at their equator (corners 1 to 4) into two pyramids
+	static const int octaTop[] = {1, 2, 3, 4, 5};
+	static const int octaBottom[] = {1, 4, 3, 2, 0};
+
+	switch(v->reference_object_id()){
+		case ROID_TETRAHEDRON:
+			SetVTKCell(cellsOut[0], VTK_TETRA, 4, tet);
+			return 1;
+		case ROID_PYRAMID:
+			SetVTKCell(cellsOut[0], VTK_PYRAMID, 5, pyramid);
+			return 1;
+		case ROID_PRISM:
+			SetVTKCell(cellsOut[0], VTK_WEDGE, 6, prism);
+			return 1;
+		case ROID_HEXAHEDRON:
+			SetVTKCell(cellsOut[0], VTK_HEXAHEDRON, 8, hex);
+			return 1;
+		case ROID_OCTAHEDRON:
+			SetVTKCell(cellsOut[0], VTK_PYRAMID, 5, octaTop);
+			SetVTKCell(cellsOut[1], VTK_PYRAMID, 5, octaBottom);
+			return 2;
+		default:
+			UG_THROW("Unsupported volume type in vtu export.");
+	}
+}
+
+
+///	encodes one array of the appended section of a .vtu file.
+/**	Uncompressed arrays are written to the device while they are generated,
+ * so their size has to be known in advance. Compressed arrays are kept as
+ * compressed blocks until write_compressed is called, since the header of
+ * the array contains the compressed size of each block.*/
+class VTUArrayEncoder
+{
+	public:
+	///	compressionLevel 0 writes the header and all data directly to out.
+	/**	numBytes is the uncompressed size of the array. Only required for
+	 * uncompressed arrays. If parallel is true, blocks are compressed
+	 * concurrently.*/
+		VTUArrayEncoder(QIODevice& out, uint64_t numBytes,
+						int compressionLevel, bool parallel) :
+			m_out(out),
+			m_level(compressionLevel),
+			m_parallel(parallel),
+			m_numBytes(numBytes),
+			m_numAppended(0),
+			m_failed(false)
+		{
+			if(m_level == 0)
+				write(&numBytes, sizeof(numBytes));
+			m_buf.reserve(VTU_BLOCK_SIZE);
+		}
+
+		template <class T>
+		void append(const T& val)	{append(&val, sizeof(T));}
+
+		void append(const void* data, size_t numBytes)
+		{
+			const char* src = static_cast<const char*>(data);
+			while(numBytes > 0){
+				const size_t num = min(numBytes, VTU_BLOCK_SIZE - m_buf.size());
+				m_buf.append(src, num);
+				src += num;
+				numBytes -= num;
+				m_numAppended += num;
+				if(m_buf.size() == VTU_BLOCK_SIZE)
+					flush_block();
+			}
+		}
+
+	///	processes the last block. Has to be called after all data was appended.
+		void finish()
+		{
+			if(!m_buf.empty())
+				flush_block();
+			if(!m_pending.empty())
+				compress_pending();
+			UG_COND_THROW(m_level == 0 && m_numAppended != m_numBytes,
+						  "Unexpected size of a vtu array.");
+		}
+
+	///	size of the encoded array including its header
+		uint64_t encoded_size() const
+		{
+			if(m_level == 0)
+				return sizeof(uint64_t) + m_numBytes;
+			uint64_t size = (3 + m_blocks.size()) * sizeof(uint64_t);
+			for(size_t i = 0; i < m_blocks.size(); ++i)
+				size += m_blocks[i].size();
+			return size;
+		}
+
+	///	writes the header and the blocks of a compressed array
+		void write_compressed()
+		{
+			vector<uint64_t> header(3 + m_blocks.size());
+			header[0] = m_blocks.size();
+			header[1] = VTU_BLOCK_SIZE;
+			header[2] = m_numAppended % VTU_BLOCK_SIZE;
+			for(size_t i = 0; i < m_blocks.size(); ++i)
+				header[3 + i] = m_blocks[i].size();
+			write(&header.front(), header.size() * sizeof(uint64_t));
+			for(size_t i = 0; i < m_blocks.size(); ++i)
+				write(m_blocks[i].constData(), m_blocks[i].size());
+		}
+
+		bool failed() const		{return m_failed;}
+
+	private:
+		void write(const void* data, size_t numBytes)
+		{
+			if(m_out.write(static_cast<const char*>(data), (qint64)numBytes) != (qint64)numBytes)
+				m_failed = true;
+		}
+
+		void flush_block()
+		{
+			if(m_level == 0){
+				write(m_buf.data(), m_buf.size());
+				m_buf.clear();
+				return;
+			}
+
+			m_pending.push_back(string());
+			m_pending.back().swap(m_buf);
+			m_buf.reserve(VTU_BLOCK_SIZE);
+			if(m_pending.size() >= (m_parallel ? (size_t)NumWorkerThreads() : 1))
+				compress_pending();
+		}
+
+		void compress_pending()
+		{
+			const size_t first = m_blocks.size();
+			m_blocks.resize(first + m_pending.size());
+			auto compress = [this, first](size_t, size_t begin, size_t end){
+				for(size_t i = begin; i < end; ++i){
+				//	qCompress prepends the uncompressed size. vtk expects the plain zlib stream.
+					m_blocks[first + i] = qCompress(reinterpret_cast<const uchar*>(m_pending[i].data()),
+													(int)m_pending[i].size(), m_level).mid(4);
+				}
+			};
+			if(m_parallel)
+				ParallelForChunks(m_pending.size(), 1, compress);
+			else
+				compress(0, 0, m_pending.size());
+			m_pending.clear();
+		}
+
+	private:
+		QIODevice&			m_out;
+		int					m_level;
+		bool				m_parallel;
+		uint64_t			m_numBytes;
+		uint64_t			m_numAppended;
+		bool				m_failed;
+		string				m_buf;
+	///	full blocks which wait for compression
+		vector<string>		m_pending;
+		vector<QByteArray>	m_blocks;
+};
+
+
+///	writes the cells in [begin, end) and their corners to a .vtu file.
+/**	If pieceVrts is NULL, all vertices of the grid are written in the order
+ * of the grid iterators, which also has to be the order of the indices in
+ * aaInd. Otherwise pieceVrts maps the indices in aaInd to vertices and only
+ * the corners of the cells are written.*/
+template <class TElem, class TIter>
+class VTUPieceWriter
+{
+	public:
+		VTUPieceWriter(Grid& grid, ISubsetHandler& sh,
+					   Grid::VertexAttachmentAccessor<APosition>& aaPos,
+					   Grid::VertexAttachmentAccessor<AInt>& aaInd,
+					   const vector<Vertex*>* pieceVrts,
+					   TIter begin, TIter end) :
+			m_grid(grid),
+			m_sh(sh),
+			m_aaPos(aaPos),
+			m_aaInd(aaInd),
+			m_pieceVrts(pieceVrts),
+			m_begin(begin),
+			m_end(end),
+			m_numVTKCells(0),
+			m_numCorners(0)
+		{
+			VTKCell cells[2];
+			for(TIter iter = m_begin; iter != m_end; ++iter){
+				TElem* e = *iter;
+				const int numCells = GetVTKCells(e, cells);
+				m_numVTKCells += numCells;
+				for(int i = 0; i < numCells; ++i)
+					m_numCorners += cells[i].numCorners;
+
+				if(m_pieceVrts){
+					for(size_t i = 0; i < e->num_vertices(); ++i)
+						m_vrtInds.push_back(m_aaInd[e->vertex(i)]);
+				}
+			}
+
+			if(m_pieceVrts){
+				sort(m_vrtInds.begin(), m_vrtInds.end());
+				m_vrtInds.erase(unique(m_vrtInds.begin(), m_vrtInds.end()), m_vrtInds.end());
+				m_numVrts = m_vrtInds.size();
+			}
+			else
+				m_numVrts = m_grid.num<Vertex>();
+
+			m_index64 = m_numVrts > 0x7FFFFFFF || m_numCorners > 0x7FFFFFFF;
+		}
+
+	///	writes the complete .vtu file.
+	/**	If parallel is true, compressed blocks are created concurrently.*/
+		bool write(QIODevice& out, int compressionLevel, bool parallel)
+		{
+			uint64_t offsets[VTU_NUM_ARRAYS];
+			if(compressionLevel == 0){
+			//	the sizes are known in advance. Arrays are written while they are generated.
+				uint64_t offset = 0;
+				for(int i = 0; i < VTU_NUM_ARRAYS; ++i){
+					offsets[i] = offset;
+					offset += sizeof(uint64_t) + array_size(i);
+				}
+				if(!write_string(out, header(offsets, false)))
+					return false;
+				for(int i = 0; i < VTU_NUM_ARRAYS; ++i){
+					VTUArrayEncoder enc(out, array_size(i), 0, parallel);
+					generate(i, enc);
+					enc.finish();
+					if(enc.failed())
+						return false;
+				}
+			}
+			else{
+				vector<unique_ptr<VTUArrayEncoder> > encoders;
+				uint64_t offset = 0;
+				for(int i = 0; i < VTU_NUM_ARRAYS; ++i){
+					encoders.push_back(unique_ptr<VTUArrayEncoder>(
+						new VTUArrayEncoder(out, array_size(i), compressionLevel, parallel)));
+					generate(i, *encoders.back());
+					encoders.back()->finish();
+					offsets[i] = offset;
+					offset += encoders.back()->encoded_size();
+				}
+				if(!write_string(out, header(offsets, true)))
+					return false;
+				for(int i = 0; i < VTU_NUM_ARRAYS; ++i){
+					encoders[i]->write_compressed();
+					if(encoders[i]->failed())
+						return false;
+				}
+			}
+			return write_string(out, "\n  </AppendedData>\n</VTKFile>\n");
+		}
+
+	private:
+		size_t index_size() const	{return m_index64 ? sizeof(int64_t) : sizeof(int32_t);}
+
+		uint64_t array_size(int array) const
+		{
+			switch(array){
+				case VTU_POINTS:		return m_numVrts * 3 * sizeof(double);
+				case VTU_CONNECTIVITY:	return m_numCorners * index_size();
+				case VTU_OFFSETS:		return m_numVTKCells * index_size();
+				case VTU_TYPES:			return m_numVTKCells;
+				default:				return m_numVTKCells * sizeof(int32_t);
+			}
+		}
+
+		void append_index(VTUArrayEncoder& enc, uint64_t ind) const
+		{
+			if(m_index64)
+				enc.append((int64_t)ind);
+			else
+				enc.append((int32_t)ind);
+		}
+
+		uint64_t local_index(Vertex* v) const
+		{
+			const int ind = m_aaInd[v];
+			if(!m_pieceVrts)
+				return ind;
+			return lower_bound(m_vrtInds.begin(), m_vrtInds.end(), ind) - m_vrtInds.begin();
+		}
+
+		void append_position(VTUArrayEncoder& enc, Vertex* v) const
+		{
+			const vector3& p = m_aaPos[v];
+			const double c[3] = {p.x(), p.y(), p.z()};
+			enc.append(c, sizeof(c));
+		}
+
+		void generate(int array, VTUArrayEncoder& enc) const
+		{
+			if(array == VTU_POINTS){
+				if(m_pieceVrts){
+					for(size_t i = 0; i < m_vrtInds.size(); ++i)
+						append_position(enc, (*m_pieceVrts)[m_vrtInds[i]]);
+				}
+				else{
+					for(VertexIterator iter = m_grid.begin<Vertex>();
+						iter != m_grid.end<Vertex>(); ++iter)
+					{
+						append_position(enc, *iter);
+					}
+				}
+				return;
+			}
+
+			VTKCell cells[2];
+			uint64_t offset = 0;
+			for(TIter iter = m_begin; iter != m_end; ++iter){
+				TElem* e = *iter;
+				const int numCells = GetVTKCells(e, cells);
+				for(int i = 0; i < numCells; ++i){
+					const VTKCell& cell = cells[i];
+					switch(array){
+						case VTU_CONNECTIVITY:
+							for(int j = 0; j < cell.numCorners; ++j)
+								append_index(enc, local_index(e->vertex(cell.corners[j])));
+							break;
+						case VTU_OFFSETS:
+							offset += cell.numCorners;
+							append_index(enc, offset);
+							break;
+						case VTU_TYPES:
+							enc.append(cell.type);
+							break;
+						default:
+							enc.append((int32_t)m_sh.get_subset_index(e));
+							break;
+					}
+				}
+			}
+		}
+
+		string header(const uint64_t* offsets, bool compressed) const
+		{
+			const char* indexType = m_index64 ? "Int64" : "Int32";
+			ostringstream ss;
+			ss << "<?xml version=\"1.0\"?>\n"
+			   << "<VTKFile type=\"UnstructuredGrid\" version=\"1.0\" byte_order=\""
+			   << VTKByteOrder() << "\" header_type=\"UInt64\"";
+			if(compressed)
+				ss << " compressor=\"vtkZLibDataCompressor\"";
+			ss << ">\n"
+			   << "  <UnstructuredGrid>\n"
+			   << "    <Piece NumberOfPoints=\"" << m_numVrts
+			   << "\" NumberOfCells=\"" << m_numVTKCells << "\">\n"
+			   << "      <Points>\n"
+			   << "        <DataArray type=\"Float64\" NumberOfComponents=\"3\" format=\"appended\" offset=\""
+			   << offsets[VTU_POINTS] << "\"/>\n"
+			   << "      </Points>\n"
+			   << "      <Cells>\n"
+			   << "        <DataArray type=\"" << indexType << "\" Name=\"connectivity\" format=\"appended\" offset=\""
+			   << offsets[VTU_CONNECTIVITY] << "\"/>\n"
+			   << "        <DataArray type=\"" << indexType << "\" Name=\"offsets\" format=\"appended\" offset=\""
+			   << offsets[VTU_OFFSETS] << "\"/>\n"
+			   << "        <DataArray type=\"UInt8\" Name=\"types\" format=\"appended\" offset=\""
+			   << offsets[VTU_TYPES] << "\"/>\n"
+			   << "      </Cells>\n"
+			   << "      <CellData Scalars=\"regions\">\n"
+			   << "        <DataArray type=\"Int32\" Name=\"regions\" format=\"appended\" offset=\""
+			   << offsets[VTU_REGIONS] << "\"/>\n"
+			   << "      </CellData>\n"
+			   << "    </Piece>\n"
+			   << "  </UnstructuredGrid>\n"
+			   << "  <AppendedData encoding=\"raw\">\n"
+			   << "   _";
+			return ss.str();
+		}
+
+		static bool write_string(QIODevice& out, const string& str)
+		{
+			return out.write(str.c_str(), (qint64)str.size()) == (qint64)str.size();
+		}
+
+	private:
+		Grid&										m_grid;
+		ISubsetHandler&								m_sh;
+		Grid::VertexAttachmentAccessor<APosition>&	m_aaPos;
+		Grid::VertexAttachmentAccessor<AInt>&		m_aaInd;
+		const vector<Vertex*>*						m_pieceVrts;
+		TIter										m_begin;
+		TIter										m_end;
+	///	indices of the vertices of the piece in aaInd. Only used if m_pieceVrts is set.
+		vector<int>									m_vrtInds;
+		uint64_t									m_numVrts;
+		uint64_t									m_numVTKCells;
+		uint64_t									m_numCorners;
+		bool										m_index64;
+};
+
+
+///	assigns consecutive indices to the vertices in the order of the grid iterators.
+void IndexVertices(Grid& grid, Grid::VertexAttachmentAccessor<AInt>& aaInd,
+				   vector<Vertex*>* vrtsOut)
+{
+	int ind = 0;
+	for(VertexIterator iter = grid.begin<Vertex>(); iter != grid.end<Vertex>(); ++iter){
+		aaInd[*iter] = ind++;
+		if(vrtsOut)
+			vrtsOut->push_back(*iter);
+	}
+}
+
+template <class TElem>
+bool SaveCellsToVTU(Grid& grid, ISubsetHandler& sh, const char* filename,
+					int compressionLevel)
+{
+	typedef typename geometry_traits<TElem>::iterator iter_t;
+	QSaveFile out(QString::fromLocal8Bit(filename));
+	if(!out.open(QIODevice::WriteOnly)){
+		UG_LOG("ERROR in SaveGridToBinaryVTU: Couldn't open file " << filename << "\n");
+		return false;
+	}
+
+	Grid::VertexAttachmentAccessor<APosition> aaPos(grid, aPosition);
+	AInt aInd;
+	grid.attach_to_vertices(aInd);
+	Grid::VertexAttachmentAccessor<AInt> aaInd(grid, aInd);
+	IndexVertices(grid, aaInd, NULL);
+
+	VTUPieceWriter<TElem, iter_t> writer(grid, sh, aaPos, aaInd, NULL,
+										 grid.begin<TElem>(), grid.end<TElem>());
+	bool success = writer.write(out, compressionLevel, true) && out.commit();
+	grid.detach_from_vertices(aInd);
+	return success;
+}
+
+template <class TElem>
+bool SaveCellsToPVTU(Grid& grid, ISubsetHandler& sh, const char* filename,
+					 int numPieces, int compressionLevel)
+{
+	typedef typename geometry_traits<TElem>::iterator iter_t;
+	Grid::VertexAttachmentAccessor<APosition> aaPos(grid, aPosition);
+	AInt aInd;
+	grid.attach_to_vertices(aInd);
+	Grid::VertexAttachmentAccessor<AInt> aaInd(grid, aInd);
+	vector<Vertex*> vrts;
+	vrts.reserve(grid.num<Vertex>());
+	IndexVertices(grid, aaInd, &vrts);
+
+	const size_t numCells = grid.num<TElem>();
+	vector<pair<iter_t, iter_t> > ranges;
+	CollectIteratorChunks(ranges, grid.begin<TElem>(), grid.end<TElem>(),
+						  max<size_t>(1, (numCells + numPieces - 1) / numPieces));
+	if(ranges.empty())
+		ranges.push_back(make_pair(grid.end<TElem>(), grid.end<TElem>()));
+
+//	the pieces are stored next to the .pvtu file
+	QFileInfo info(QString::fromLocal8Bit(filename));
+	vector<QString> pieceNames(ranges.size());
+	for(size_t i = 0; i < ranges.size(); ++i)
+		pieceNames[i] = info.completeBaseName() + "_p" + QString::number(i) + ".vtu";
+
+	vector<char> pieceWritten(ranges.size(), 0);
+	ParallelForChunks(ranges.size(), 1, [&](size_t, size_t begin, size_t end){
+		for(size_t i = begin; i < end; ++i){
+			QSaveFile out(info.dir().filePath(pieceNames[i]));
+			if(!out.open(QIODevice::WriteOnly))
+				continue;
+			VTUPieceWriter<TElem, iter_t> writer(grid, sh, aaPos, aaInd, &vrts,
+												 ranges[i].first, ranges[i].second);
+			pieceWritten[i] = writer.write(out, compressionLevel, false) && out.commit();
+		}
+	});
+	grid.detach_from_vertices(aInd);
+
+	for(size_t i = 0; i < pieceWritten.size(); ++i){
+		if(!pieceWritten[i]){
+			UG_LOG("ERROR in SaveGridToPVTU: Couldn't write piece "
+				   << pieceNames[i].toLocal8Bit().constData() << "\n");
+			return false;
+		}
+	}
+
+	ostringstream ss;
+	ss << "<?xml version=\"1.0\"?>\n"
+	   << "<VTKFile type=\"PUnstructuredGrid\" version=\"1.0\" byte_order=\""
+	   << VTKByteOrder() << "\" header_type=\"UInt64\">\n"
+	   << "  <PUnstructuredGrid GhostLevel=\"0\">\n"
+	   << "    <PPoints>\n"
+	   << "      <PDataArray type=\"Float64\" NumberOfComponents=\"3\"/>\n"
+	   << "    </PPoints>\n"
+	   << "    <PCellData Scalars=\"regions\">\n"
+	   << "      <PDataArray type=\"Int32\" Name=\"regions\"/>\n"
+	   << "    </PCellData>\n";
+	for(size_t i = 0; i < pieceNames.size(); ++i)
+		ss << "    <Piece Source=\"" << pieceNames[i].toUtf8().constData() << "\"/>\n";
+	ss << "  </PUnstructuredGrid>\n"
+	   << "</VTKFile>\n";
+
+	QSaveFile out(info.filePath());
+	const string str = ss.str();
+	if(!out.open(QIODevice::WriteOnly)
+	   || out.write(str.c_str(), (qint64)str.size()) != (qint64)str.size()
+	   || !out.commit())
+	{
+		UG_LOG("ERROR in SaveGridToPVTU: Couldn't write file " << filename << "\n");
+		return false;
+	}
+	return true;
+}
+
+}//	end of anonymous namespace
+
+
+bool SaveGridToBinaryVTU(Grid& grid, ISubsetHandler& sh,
+						 const char* filename, int compressionLevel)
+{
+	PROFILE_FUNC();
+	if(!grid.has_vertex_attachment(aPosition)){
+		UG_LOG("ERROR in SaveGridToBinaryVTU: Missing position attachment.\n");
+		return false;
+	}
+	compressionLevel = max(0, min(compressionLevel, 9));
+
+	if(grid.num<Volume>() > 0)
+		return SaveCellsToVTU<Volume>(grid, sh, filename, compressionLevel);
+	if(grid.num<Face>() > 0)
+		return SaveCellsToVTU<Face>(grid, sh, filename, compressionLevel);
+	return SaveCellsToVTU<Edge>(grid, sh, filename, compressionLevel);
+}
+
+
+bool SaveGridToPVTU(Grid& grid, ISubsetHandler& sh,
+					const char* filename, int numPieces, int compressionLevel)
+{
+	PROFILE_FUNC();
+	if(!grid.has_vertex_attachment(aPosition)){
+		UG_LOG("ERROR in SaveGridToPVTU: Missing position attachment.\n");
+		return false;
+	}
+	if(numPieces <= 0)
+		numPieces = (int)NumWorkerThreads();
+	compressionLevel = max(0, min(compressionLevel, 9));
+
+	if(grid.num<Volume>() > 0)
+		return SaveCellsToPVTU<Volume>(grid, sh, filename, numPieces, compressionLevel);
+	if(grid.num<Face>() > 0)
+		return SaveCellsToPVTU<Face>(grid, sh, filename, numPieces, compressionLevel);
+	return SaveCellsToPVTU<Edge>(grid, sh, filename, numPieces, compressionLevel);
+}
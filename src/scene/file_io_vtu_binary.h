@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2026:  G-CSC, Goethe University Frankfurt
+ * Author: Sebastian Reiter
+ * 
+ * This file is part of ProMesh.
+ * 
+ * ProMesh is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License version 3 (as published by the
+ * Free Software Foundation) with the following additional attribution
+ * requirements (according to LGPL/GPL v3 §7):
+ * 
+ * (1) The following notice must be displayed in the Appropriate Legal Notices
+ * of covered and combined works: "Based on ProMesh (www.promesh3d.com)".
+ * 
+ * (2) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S. and Wittum, G. ProMesh -- a flexible interactive meshing software
+ *   for unstructured hybrid grids in 1, 2, and 3 dimensions. In preparation."
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#ifndef __H__PROMESH_file_io_vtu_binary
+#define __H__PROMESH_file_io_vtu_binary
+
+#include "lib_grid/lib_grid.h"
+
+///	Saves the elements of the highest dimension of a grid to a binary .vtu file.
+/**	Points, connectivity, offsets and cell types are written together with
+ * the subset index of each cell (cell data 'regions') as appended raw data.
+ * The arrays are generated from the grid iterators in blocks, so that no
+ * complete copy of the mesh is created.
+ *
+ * If compressionLevel is between 1 and 9, each array is zlib compressed in
+ * blocks (vtkZLibDataCompressor), which are compressed concurrently.
+ * 0 writes uncompressed arrays.
+ *
+ * Octahedra are written as two pyramids, since vtk has no octahedron.*/
+bool SaveGridToBinaryVTU(ug::Grid& grid, ug::ISubsetHandler& sh,
+						 const char* filename, int compressionLevel);
+
+///	Saves a grid as a .pvtu file which references numPieces .vtu files.
+/**	The cells are distributed to the pieces in the order of the grid
+ * iterators. The pieces are written concurrently to files named
+ * <name>_p<i>.vtu next to the .pvtu file. numPieces <= 0 writes one piece
+ * per worker thread. See SaveGridToBinaryVTU for the format of the pieces.*/
+bool SaveGridToPVTU(ug::Grid& grid, ug::ISubsetHandler& sh,
+					const char* filename, int numPieces, int compressionLevel);
+
+#endif	//__H__PROMESH_file_io_vtu_binary
@@ -25,10 +25,26 @@
  * GNU Lesser General Public License for more details.
  */
 
+#include <algorithm>
 #include <cstring>
+#include <functional>
+#include <memory>
+#include <ostream>
 #include <string>
+#include <QDataStream>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTemporaryFile>
 #include "lg_object.h"
+#include "file_io_compressed.h"
+#include "file_io_pmb.h"
+#include "file_io_stl_obj.h"
+#include "file_io_ugx_stream.h"
+#include "file_io_vtu_binary.h"
+#include "partial_load.h"
 #include "../options/options.h"
+#include "util/parallel_util.h"
 #include "lib_grid/file_io/file_io.h"
 #include "lib_grid/file_io/file_io_art.h"
 #include "lib_grid/file_io/file_io_dump.h"
@@ -45,6 +61,7 @@
 #include "lib_grid/file_io/file_io_ug.h"
 #include "lib_grid/file_io/file_io_ugx.h"
 #include "lib_grid/file_io/file_io_vtu.h"
+#include "lib_grid/grid/geometry.h"
 
 #include "common/util/index_list_util.h"
 #include "lib_grid/algorithms/selection_util.h"
@@ -55,12 +72,12 @@ using namespace ug;
 const char* LG_SUPPORTED_FILE_FORMATS_OPEN =
 				"*.ugx *.vtu *.obj *.smesh *.ele *.msh *.stl *.2df "
 				"*.dat *.lgm *.ng *.lgb *.txt *.art *.net "
-				"*.asc *.ASC *.dump *.swc";
+				"*.asc *.ASC *.dump *.swc *.pmb *.ugxz *.lgbz *.pmbz";
 
 
 const char* LG_SUPPORTED_FILE_FORMATS_SAVE =
 				"*.ugx *.vtu *.obj *.smesh *.stl *.ele *.ncdf *.2df "
-				"*.tex *.tikz *.swc *.lgb *.txt";
+				"*.tex *.tikz *.swc *.lgb *.txt *.pmb *.ugxz *.lgbz *.pmbz *.pvtu";
 
 
 LGObject* CreateLGObjectFromFile(const char* filename)
@@ -83,14 +100,90 @@ LGObject* CreateEmptyLGObject(const char* name)
     return obj;
 }
 
+///	loads a .ugx file through GridReaderUGX, which parses the whole document first.
+static bool LoadLGObjectFromUGXDocument(LGObject* pObjOut, const char* filename)
+{
+	GridReaderUGX ugxReader;
+	if(!ugxReader.parse_file(filename)){
+		UG_LOG("ERROR in LoadGridFromUGX: File not found: " << filename << std::endl);
+		return false;
+	}
+
+	if(ugxReader.num_grids() < 1){
+		UG_LOG("ERROR in LoadGridFromUGX: File contains no grid.\n");
+		return false;
+	}
+
+	ugxReader.grid(pObjOut->grid(), 0, aPosition);
+
+	if(ugxReader.num_subset_handlers(0) > 0)
+		ugxReader.subset_handler(pObjOut->subset_handler(), 0, 0);
+
+	if(ugxReader.num_subset_handlers(0) > 1)
+		ugxReader.subset_handler(pObjOut->crease_handler(), 1, 0);
+
+	if(ugxReader.num_selectors(0) > 0)
+		ugxReader.selector(pObjOut->selector(), 0, 0);
+
+	if(ugxReader.num_projection_handlers(0) > 0){
+		ugxReader.projection_handler(pObjOut->projection_handler(), 0, 0);
+	}
+
+	return true;
+}
+
+///	streams .ugx data into pObjOut. See LoadGridFromUGXStream.
+/**	If in is NULL, the file is opened and only the part which passes filter
+ * is created. Otherwise the data is read from in and filter is ignored.*/
+static UGXStreamResult LoadLGObjectFromUGXStream(LGObject* pObjOut, QIODevice* in,
+												 const char* filename,
+												 const PartialLoadFilter* filter,
+												 const std::atomic<bool>* canceled)
+{
+	ISubsetHandler* ppSH[2];
+	ppSH[0] = &pObjOut->subset_handler();
+	ppSH[1] = &pObjOut->crease_handler();
+	ISelector* ppSel[1] = {&pObjOut->selector()};
+	string phXml;
+	UGXStreamResult result = in ?
+			LoadGridFromUGXStream(pObjOut->grid(), *in, filename,
+								  ppSH, 2, ppSel, 1, &phXml, canceled) :
+			LoadGridFromUGXStream(pObjOut->grid(), filename,
+								  ppSH, 2, ppSel, 1, &phXml, filter, canceled);
+	if(result == UGX_STREAM_OK && !phXml.empty()
+	   && !ReadUGXProjectionHandler(pObjOut->projection_handler(), phXml))
+	{
+		UG_LOG("WARNING: Couldn't read the projection handler of "
+			   << filename << std::endl);
+	}
+	return result;
+}
+
+///	loads a compressed file whose format is only supported by file based readers.
+/**	The file is decompressed to a local temporary file with the given suffix.*/
+static bool LoadLGObjectFromCompressedFileCopy(LGObject* pObjOut, const char* filename,
+											   const char* innerSuffix,
+											   const std::function<bool (const char*)>& loadFunc)
+{
+	QTemporaryFile tmpFile(QDir::tempPath() + "/promesh_XXXXXX" + innerSuffix);
+	if(!tmpFile.open())
+		return false;
+	tmpFile.close();
+	string tmpName = tmpFile.fileName().toLocal8Bit().constData();
+	return DecompressFile(filename, tmpName.c_str()) && loadFunc(tmpName.c_str());
+}
+
 bool LoadLGObjectFromFile(LGObject* pObjOut, const char* filename,
-                          bool performLoadPostprocessing)
+                          bool performLoadPostprocessing,
+                          const PartialLoadFilter* filter,
+                          const std::atomic<bool>* canceled)
 {
 	PROFILE_FUNC();
 
 	Grid& grid = pObjOut->grid();
 	SubsetHandler& sh = pObjOut->subset_handler();
 	pObjOut->m_fileName = filename;
+	pObjOut->m_partiallyLoaded = filter && !filter->loads_everything();
 
 	// grid.enable_options(GRIDOPT_STANDARD_INTERCONNECTION | FACEOPT_STORE_ASSOCIATED_VOLUMES);
 
@@ -99,40 +192,57 @@ bool LoadLGObjectFromFile(LGObject* pObjOut, const char* filename,
 	if(!pSuffix)
 		return false;
 
+//	ug4 reads .lgb files only from disk. Compressed .lgb files are thus
+//	decompressed to a local temporary file first.
+	if(strcmp(pSuffix, ".lgbz") == 0){
+		bool bLoadSuccessful = LoadLGObjectFromCompressedFileCopy(
+				pObjOut, filename, ".lgb",
+				[=](const char* tmpName){
+					return LoadLGObjectFromFile(pObjOut, tmpName, false, filter, canceled);
+				});
+	//	postprocessing names the object and records the source file. It
+	//	thus has to run after the temporary file name was replaced.
+		pObjOut->m_fileName = filename;
+		if(bLoadSuccessful && performLoadPostprocessing)
+			PerformLoadPostprocessing(pObjOut);
+		return bLoadSuccessful;
+	}
+
 	bool bLoadSuccessful = false;
 	bool bSetDefaultSubsetColors = false;
 	if(strcmp(pSuffix, ".ugx") == 0)
 	{
-	//	load from ugx
-		GridReaderUGX ugxReader;
-		if(!ugxReader.parse_file(filename)){
-			UG_LOG("ERROR in LoadGridFromUGX: File not found: " << filename << std::endl);
-			bLoadSuccessful = false;
-		}
-		else{
-			if(ugxReader.num_grids() < 1){
-				UG_LOG("ERROR in LoadGridFromUGX: File contains no grid.\n");
-				bLoadSuccessful = false;
-			}
-			else{
-
-				ugxReader.grid(grid, 0, aPosition);
-
-				if(ugxReader.num_subset_handlers(0) > 0)
-					ugxReader.subset_handler(sh, 0, 0);
-
-				if(ugxReader.num_subset_handlers(0) > 1)
-					ugxReader.subset_handler(pObjOut->crease_handler(), 1, 0);
-
-				if(ugxReader.num_selectors(0) > 0)
-					ugxReader.selector(pObjOut->selector(), 0, 0);
-
-				if(ugxReader.num_projection_handlers(0) > 0){
-					ugxReader.projection_handler(pObjOut->projection_handler(), 0, 0);
-				}
-
+	//	stream the file. Files with constrained elements require GridReaderUGX.
+		switch(LoadLGObjectFromUGXStream(pObjOut, NULL, filename, filter, canceled)){
+			case UGX_STREAM_OK:
 				bLoadSuccessful = true;
-			}
+			//	the filter was already evaluated while reading
+				filter = NULL;
+				break;
+			case UGX_STREAM_UNSUPPORTED:
+				bLoadSuccessful = LoadLGObjectFromUGXDocument(pObjOut, filename);
+				break;
+			default:
+				bLoadSuccessful = false;
+		}
+	}
+	else if(strcmp(pSuffix, ".ugxz") == 0)
+	{
+	//	the decompressed data is streamed into the grid
+		UGXStreamResult result = UGX_STREAM_FAILED;
+		bLoadSuccessful = ReadCompressedFile(filename, [&](QIODevice& in){
+								result = LoadLGObjectFromUGXStream(pObjOut, &in, filename,
+																   NULL, canceled);
+								return result == UGX_STREAM_OK;
+							});
+	//	GridReaderUGX only parses files. This is only required for
+	//	files with constrained elements.
+		if(result == UGX_STREAM_UNSUPPORTED){
+			bLoadSuccessful = LoadLGObjectFromCompressedFileCopy(
+					pObjOut, filename, ".ugx",
+					[pObjOut](const char* tmpName){
+						return LoadLGObjectFromUGXDocument(pObjOut, tmpName);
+					});
 		}
 	}
 	else if(strcmp(pSuffix, ".lgb") == 0)
@@ -145,11 +255,56 @@ bool LoadLGObjectFromFile(LGObject* pObjOut, const char* filename,
 		bLoadSuccessful = LoadGridFromLGB(grid, filename, ppSH, 2, ppSel, 1,
 		                                  &pObjOut->projection_handler());
 	}
+	else if(strcmp(pSuffix, ".pmb") == 0)
+	{
+		ISubsetHandler* ppSH[2];
+		ppSH[0] = &pObjOut->subset_handler();
+		ppSH[1] = &pObjOut->crease_handler();
+		ISelector* ppSel[1] = {&pObjOut->selector()};
+		bLoadSuccessful = LoadGridFromPMB(grid, filename, ppSH, 2, ppSel, 1,
+		                                  &pObjOut->projection_handler(), filter, canceled);
+	//	the filter was already evaluated while reading
+		filter = NULL;
+	}
+	else if(strcmp(pSuffix, ".pmbz") == 0)
+	{
+	//	the sections of a .pmb file are read in place. It is thus
+	//	decompressed into memory.
+		ISubsetHandler* ppSH[2];
+		ppSH[0] = &pObjOut->subset_handler();
+		ppSH[1] = &pObjOut->crease_handler();
+		ISelector* ppSel[1] = {&pObjOut->selector()};
+		QByteArray data;
+		bLoadSuccessful = ReadCompressedFile(filename, data)
+						  && ReadGridFromPMB(grid, data.constData(), (size_t)data.size(),
+											 ppSH, 2, ppSel, 1,
+											 &pObjOut->projection_handler(), filter,
+											 canceled);
+		filter = NULL;
+	}
+	else if(strcmp(pSuffix, ".stl") == 0)
+	{
+		bLoadSuccessful = LoadGridFromSTLParallel(grid, sh, filename,
+		                                          GetOptions().files.weldTolerance,
+		                                          canceled);
+		bSetDefaultSubsetColors = true;
+	}
+	else if(strcmp(pSuffix, ".obj") == 0)
+	{
+		bLoadSuccessful = LoadGridFromOBJParallel(grid, sh, filename,
+		                                          GetOptions().files.weldTolerance,
+		                                          canceled);
+		bSetDefaultSubsetColors = true;
+	}
 	else{
 		bLoadSuccessful = LoadGridFromFile(grid, sh, filename, aPosition);
 		bSetDefaultSubsetColors = true;
 	}
 
+//	all other formats are filtered after they were read completely
+	if(bLoadSuccessful && filter && !filter->loads_everything())
+		ApplyPartialLoadFilter(grid, sh, *filter);
+
 	if(bLoadSuccessful)
 	{
 	//	initialize the subset-colors
@@ -184,6 +339,8 @@ void PerformLoadPostprocessing(LGObject* obj)
 	obj->set_name(name.substr(slashPos + 1, pointPos - slashPos - 1).c_str());
 
 	obj->init_subsets();
+//	the first undo point may use the source file as recovery checkpoint
+	obj->m_gridMatchesSourceFile = !obj->m_partiallyLoaded;
 	obj->geometry_changed();
 
 	Grid& grid = obj->grid();
@@ -210,38 +367,630 @@ bool ReloadLGObject(LGObject* obj)
 	return true;
 }
 
-bool SaveLGObjectToFile(LGObject* pObj, const char* filename)
+LGObject* RecoverLGObject(const RecoverableObject& recObj)
 {
 	PROFILE_FUNC();
+	LGObject* obj = new LGObject;
+	if(!LoadLGObjectFromFile(obj, recObj.baseFile.c_str(), false)){
+		delete obj;
+		return NULL;
+	}
+
+	obj->replay_recovery_journal(recObj);
+	obj->m_fileName = recObj.fileName;
+	obj->set_name(recObj.name.c_str());
+	obj->init_subsets();
+	obj->geometry_changed();
+	obj->set_save_required(true);
+	return obj;
+}
+
+void MergeLGObject(LGObject* dest, LGObject* src, bool joinSubsets)
+{
+	PROFILE_FUNC();
+	Grid& mrgGrid = dest->grid();
+	SubsetHandler& mrgSH = dest->subset_handler();
+	Grid& grid = src->grid();
+	SubsetHandler& sh = src->subset_handler();
+
+//	The position attachments of both grids
+	Grid::AttachmentAccessor<Vertex, APosition> aaPosMRG(mrgGrid, aPosition);
+	Grid::AttachmentAccessor<Vertex, APosition> aaPos(grid, aPosition);
+
+//	if we're joining subsets, the subsetBaseInd is always 0. If
+//	we're not joining subsets, then subsetBaseInd has to be set
+//	to the current max subset.
+	int subsetBaseInd = 0;
+	if(!joinSubsets)
+		subsetBaseInd = mrgSH.num_subsets();
+
+//	we need an attachment, which tells us the associated vertex in
+//	mrgGrid for each vertex in grid.
+	AVertex aVrt;
+	Grid::AttachmentAccessor<Vertex, AVertex> aaVrt(grid, aVrt, true);
+
+//	copy vertices
+	for(VertexIterator iter = grid.begin<Vertex>();
+		iter != grid.end<Vertex>(); ++iter)
+	{
+		Vertex* nvrt = *mrgGrid.create_by_cloning(*iter);
+		aaPosMRG[nvrt] = aaPos[*iter];
+		aaVrt[*iter] = nvrt;
+		mrgSH.assign_subset(nvrt, subsetBaseInd + sh.get_subset_index(*iter));
+	}
+
+//	copy edges
+	EdgeDescriptor ed;
+	for(EdgeIterator iter = grid.begin<Edge>();
+		iter != grid.end<Edge>(); ++iter)
+	{
+		Edge* eSrc = *iter;
+		ed.set_vertices(aaVrt[eSrc->vertex(0)], aaVrt[eSrc->vertex(1)]);
+		Edge* e = *mrgGrid.create_by_cloning(eSrc, ed);
+		mrgSH.assign_subset(e, subsetBaseInd + sh.get_subset_index(eSrc));
+	}
+
+//	copy faces
+	FaceDescriptor fd;
+	for(FaceIterator iter = grid.begin<Face>();
+		iter != grid.end<Face>(); ++iter)
+	{
+		Face* fSrc = *iter;
+		fd.set_num_vertices((uint)fSrc->num_vertices());
+		for(size_t i = 0; i < fd.num_vertices(); ++i)
+			fd.set_vertex((uint)i, aaVrt[fSrc->vertex(i)]);
+
+		Face* f = *mrgGrid.create_by_cloning(fSrc, fd);
+		mrgSH.assign_subset(f, subsetBaseInd + sh.get_subset_index(fSrc));
+	}
+
+//	copy volumes
+	VolumeDescriptor vd;
+	for(VolumeIterator iter = grid.begin<Volume>();
+		iter != grid.end<Volume>(); ++iter)
+	{
+		Volume* vSrc = *iter;
+		vd.set_num_vertices((uint)vSrc->num_vertices());
+		for(size_t i = 0; i < vd.num_vertices(); ++i)
+			vd.set_vertex((uint)i, aaVrt[vSrc->vertex(i)]);
+
+		Volume* v = *mrgGrid.create_by_cloning(vSrc, vd);
+		mrgSH.assign_subset(v, subsetBaseInd + sh.get_subset_index(vSrc));
+	}
+
+//	remove the temporary attachment
+	grid.detach_from_vertices(aVrt);
+
+//	now copy the names of the subset handler
+	for(int i_sub = 0; i_sub < sh.num_subsets(); ++i_sub){
+		mrgSH.subset_info(subsetBaseInd + i_sub) = sh.subset_info(i_sub);
+	}
+}
+
+///	saves a mesh to a file. The format is chosen by the suffix of filename.
+static bool SaveMeshToFile(Grid& grid, SubsetHandler& sh, SubsetHandler& creaseHandler,
+						   Selector& sel, ProjectionHandler& ph,
+						   const char* filename, const opts::Files& fileOpts)
+{
 //	extract the suffix
+	const char* pSuffix = strrchr(filename, '.');
+	if(!pSuffix)
+		return false;
+
+//	ug4 writes .lgb files only to disk. Compressed .lgb files are thus
+//	written to a local temporary file first.
+	if(strcmp(pSuffix, ".lgbz") == 0){
+		QTemporaryFile tmpFile(QDir::tempPath() + "/promesh_XXXXXX.lgb");
+		if(!tmpFile.open())
+			return false;
+		tmpFile.close();
+		string tmpName = tmpFile.fileName().toLocal8Bit().constData();
+		return SaveMeshToFile(grid, sh, creaseHandler, sel, ph, tmpName.c_str(),
+							  fileOpts)
+			   && CompressFile(tmpName.c_str(), filename, fileOpts.compressionLevel);
+	}
+
+	if(strcmp(pSuffix, ".ugxz") == 0){
+	//	the xml text is compressed while it is printed
+		GridWriterUGX ugxWriter;
+		ugxWriter.add_grid(grid, "defGrid", aPosition);
+		ugxWriter.add_subset_handler(sh, "defSH", 0);
+		ugxWriter.add_subset_handler(creaseHandler, "markSH", 0);
+		ugxWriter.add_selector(sel, "defSel", 0);
+		ugxWriter.add_projection_handler(ph, "defPH", 0);
+		return WriteCompressedFile(filename, fileOpts.compressionLevel,
+			[&ugxWriter](QIODevice& out){
+				DeviceOStreamBuf buf(out);
+				std::ostream stream(&buf);
+				bool success = ugxWriter.write_to_stream(stream);
+				stream.flush();
+				return success && stream.good() && !buf.failed();
+			});
+	}
+	else if(strcmp(pSuffix, ".pmbz") == 0){
+		ISubsetHandler* ppSH[2];
+		ppSH[0] = &sh;
+		ppSH[1] = &creaseHandler;
+		ISelector* ppSel[1] = {&sel};
+		return WriteCompressedFile(filename, fileOpts.compressionLevel,
+			[&](QIODevice& out){
+				return WriteGridToPMB(grid, out, ppSH, 2, ppSel, 1, &ph);
+			});
+	}
+	else if(strcmp(pSuffix, ".ugx") == 0){
+		GridWriterUGX ugxWriter;
+		ugxWriter.add_grid(grid, "defGrid", aPosition);
+		ugxWriter.add_subset_handler(sh, "defSH", 0);
+		ugxWriter.add_subset_handler(creaseHandler, "markSH", 0);
+		ugxWriter.add_selector(sel, "defSel", 0);
+		ugxWriter.add_projection_handler(ph, "defPH", 0);
+		return ugxWriter.write_to_file(filename);
+	}
+	else if(strcmp(pSuffix, ".lgb") == 0)
+	{
+	//	save to lgb. We want to save the marks too.
+		ISubsetHandler* ppSH[2];
+		ppSH[0] = &sh;
+		ppSH[1] = &creaseHandler;
+		ISelector* ppSel[1] = {&sel};
+		return SaveGridToLGB(grid, filename, ppSH, 2, ppSel, 1, &ph);
+	}
+	else if(strcmp(pSuffix, ".pmb") == 0)
+	{
+		ISubsetHandler* ppSH[2];
+		ppSH[0] = &sh;
+		ppSH[1] = &creaseHandler;
+		ISelector* ppSel[1] = {&sel};
+		return SaveGridToPMB(grid, filename, ppSH, 2, ppSel, 1, &ph);
+	}
+	else if(strcmp(pSuffix, ".vtu") == 0 && fileOpts.vtuBinary)
+	{
+		return SaveGridToBinaryVTU(grid, sh, filename,
+							fileOpts.vtuCompressed ? fileOpts.compressionLevel : 0);
+	}
+	else if(strcmp(pSuffix, ".pvtu") == 0)
+	{
+		return SaveGridToPVTU(grid, sh, filename, fileOpts.vtuPieces,
+							fileOpts.vtuCompressed ? fileOpts.compressionLevel : 0);
+	}
+	else
+		return SaveGridToFile(grid, sh, filename);
+}
+
+bool SaveLGObjectToFile(LGObject* pObj, const char* filename)
+{
+	PROFILE_FUNC();
 	if(pObj){
-		const char* pSuffix = strrchr(filename, '.');
-		if(!pSuffix)
+		return SaveMeshToFile(pObj->grid(), pObj->subset_handler(),
+							  pObj->crease_handler(), pObj->selector(),
+							  pObj->projection_handler(), filename,
+							  GetOptions().files);
+	}
+	return false;
+}
+
+////////////////////////////////////////////////////////////////////////
+//	undo snapshots
+///	a standalone copy of the mesh of an LGObject which is written to an undo file.
+/**	Since the copy is not shared with the LGObject, it can be written and
+ * destroyed on the writer thread while the user continues to work.*/
+struct UndoMeshSnapshot{
+	UndoMeshSnapshot() :
+		sh(grid),
+		creaseHandler(grid),
+		selector(grid)
+	{}
+
+	Grid			grid;
+	SubsetHandler	sh;
+	SubsetHandler	creaseHandler;
+	Selector		selector;
+};
+
+///	references to the parts of a mesh which are stored in undo snapshots
+struct UndoMeshParts{
+	UndoMeshParts(UndoMeshSnapshot& snap) :
+		grid(snap.grid), sh(snap.sh), creaseHandler(snap.creaseHandler),
+		selector(snap.selector)
+	{}
+
+	UndoMeshParts(LGObject* obj) :
+		grid(obj->grid()), sh(obj->subset_handler()),
+		creaseHandler(obj->crease_handler()), selector(obj->selector())
+	{}
+
+	Grid&			grid;
+	SubsetHandler&	sh;
+	SubsetHandler&	creaseHandler;
+	Selector&		selector;
+};
+
+template <class TElem>
+static void CopyUndoElementState(UndoMeshParts& dest, UndoMeshParts& src,
+								 TElem* srcElem, TElem* destElem)
+{
+	int si = src.sh.get_subset_index(srcElem);
+	if(si != -1)
+		dest.sh.assign_subset(destElem, si);
+	si = src.creaseHandler.get_subset_index(srcElem);
+	if(si != -1)
+		dest.creaseHandler.assign_subset(destElem, si);
+	if(byte selStatus = src.selector.get_selection_status(srcElem))
+		dest.selector.select(destElem, selStatus);
+}
+
+static void CopySubsetInfos(SubsetHandler& destSH, SubsetHandler& srcSH)
+{
+	if(srcSH.num_subsets() > 0)
+		destSH.subset_required(srcSH.num_subsets() - 1);
+	for(int i = 0; i < srcSH.num_subsets(); ++i)
+		destSH.subset_info(i) = srcSH.subset_info(i);
+}
+
+///	copies the elements of src together with their subsets and selection states to dest.
+/**	The elements are created in the iteration order of src.*/
+static void CopyUndoMesh(UndoMeshParts dest, UndoMeshParts src)
+{
+	PROFILE_FUNC();
+	Grid& srcGrid = src.grid;
+	Grid& grid = dest.grid;
+
+	if(!grid.has_vertex_attachment(aPosition))
+		grid.attach_to_vertices(aPosition);
+	Grid::VertexAttachmentAccessor<APosition> aaSrcPos(srcGrid, aPosition);
+	Grid::VertexAttachmentAccessor<APosition> aaPos(grid, aPosition);
+
+	typedef Attachment<Vertex*> AVrtPtr;
+	AVrtPtr aNewVrt;
+	srcGrid.attach_to_vertices(aNewVrt);
+	Grid::VertexAttachmentAccessor<AVrtPtr> aaNewVrt(srcGrid, aNewVrt);
+
+	CopySubsetInfos(dest.sh, src.sh);
+	CopySubsetInfos(dest.creaseHandler, src.creaseHandler);
+
+	grid.reserve<Vertex>(srcGrid.num<Vertex>());
+	for(VertexIterator iter = srcGrid.begin<Vertex>();
+		iter != srcGrid.end<Vertex>(); ++iter)
+	{
+		Vertex* v = *iter;
+		Vertex* nv = *grid.create_by_cloning(v);
+		aaPos[nv] = aaSrcPos[v];
+		aaNewVrt[v] = nv;
+		CopyUndoElementState(dest, src, v, nv);
+	}
+
+	grid.reserve<Edge>(srcGrid.num<Edge>());
+	for(EdgeIterator iter = srcGrid.begin<Edge>();
+		iter != srcGrid.end<Edge>(); ++iter)
+	{
+		Edge* e = *iter;
+		Edge* ne = *grid.create_by_cloning(e, EdgeDescriptor(aaNewVrt[e->vertex(0)],
+															 aaNewVrt[e->vertex(1)]));
+		CopyUndoElementState(dest, src, e, ne);
+	}
+
+	grid.reserve<Face>(srcGrid.num<Face>());
+	for(FaceIterator iter = srcGrid.begin<Face>();
+		iter != srcGrid.end<Face>(); ++iter)
+	{
+		Face* f = *iter;
+		FaceDescriptor fd(f->num_vertices());
+		for(size_t i = 0; i < f->num_vertices(); ++i)
+			fd.set_vertex(i, aaNewVrt[f->vertex(i)]);
+		Face* nf = *grid.create_by_cloning(f, fd);
+		CopyUndoElementState(dest, src, f, nf);
+	}
+
+	grid.reserve<Volume>(srcGrid.num<Volume>());
+	for(VolumeIterator iter = srcGrid.begin<Volume>();
+		iter != srcGrid.end<Volume>(); ++iter)
+	{
+		Volume* vol = *iter;
+		VolumeDescriptor vd(vol->num_vertices());
+		for(size_t i = 0; i < vol->num_vertices(); ++i)
+			vd.set_vertex(i, aaNewVrt[vol->vertex(i)]);
+		Volume* nvol = *grid.create_by_cloning(vol, vd);
+		CopyUndoElementState(dest, src, vol, nvol);
+	}
+
+	srcGrid.detach_from_vertices(aNewVrt);
+}
+
+static void CopyMeshToUndoSnapshot(UndoMeshSnapshot& snap, LGObject* obj)
+{
+	CopyUndoMesh(UndoMeshParts(snap), UndoMeshParts(obj));
+}
+
+///	rough estimate of the memory held by a copy of the given mesh.
+/**	Includes the element objects, their attachments (position, subset and
+ * selection info) and the connectivity lists of the grid.*/
+static size_t EstimateUndoSnapshotBytes(Grid& grid)
+{
+	return	grid.num_vertices() * 112
+		+	grid.num_edges() * 80
+		+	grid.num_faces() * 112
+		+	grid.num_volumes() * 144;
+}
+
+///	copies the mesh of obj and returns a function which writes the copy in the .pmb format.
+static UndoHistory::WriteFunc CreateUndoSnapshotWriter(LGObject* obj)
+{
+	shared_ptr<UndoMeshSnapshot> snap(new UndoMeshSnapshot);
+	CopyMeshToUndoSnapshot(*snap, obj);
+
+	return [snap](QIODevice& out) -> bool
+	{
+		ISubsetHandler* ppSH[2];
+		ppSH[0] = &snap->sh;
+		ppSH[1] = &snap->creaseHandler;
+		ISelector* ppSel[1] = {&snap->selector};
+		return WriteGridToPMB(snap->grid, out, ppSH, 2, ppSel, 1);
+	};
+}
+
+///	reads an undo snapshot which was written by the function returned from CreateUndoSnapshotWriter.
+static bool ReadUndoSnapshot(Grid& grid, SubsetHandler& sh,
+							 SubsetHandler& creaseHandler, Selector& sel,
+							 const QByteArray& data)
+{
+	ISubsetHandler* ppSH[2];
+	ppSH[0] = &sh;
+	ppSH[1] = &creaseHandler;
+	ISelector* ppSel[1] = {&sel};
+	return ReadGridFromPMB(grid, data.constData(), (size_t)data.size(),
+						   ppSH, 2, ppSel, 1);
+}
+
+////////////////////////////////////////////////////////////////////////
+//	background saves
+///	a standalone copy of an LGObject including its projectors.
+struct SaveMeshSnapshot : public UndoMeshSnapshot{
+	SaveMeshSnapshot() :
+		projectionHandler(&sh)
+	{}
+
+	ProjectionHandler	projectionHandler;
+};
+
+static shared_ptr<SaveMeshSnapshot> CreateSaveMeshSnapshot(LGObject* obj)
+{
+	PROFILE_FUNC();
+	shared_ptr<SaveMeshSnapshot> snap(new SaveMeshSnapshot);
+	CopyMeshToUndoSnapshot(*snap, obj);
+	snap->projectionHandler.set_geometry(MakeGeometry3d(snap->grid, aPosition));
+	CopyProjectors(snap->projectionHandler, obj->projection_handler(),
+				   obj->subset_handler().num_subsets());
+	return snap;
+}
+
+size_t EstimateLGObjectCopyBytes(LGObject* obj)
+{
+	return EstimateUndoSnapshotBytes(obj->grid());
+}
+
+LGObjectWriteFunc CreateLGObjectSaver(LGObject* obj)
+{
+	shared_ptr<SaveMeshSnapshot> snap = CreateSaveMeshSnapshot(obj);
+	opts::Files fileOpts = GetOptions().files;
+
+	return [snap, fileOpts](const string& filename) -> bool
+	{
+		try{
+			return SaveMeshToFile(snap->grid, snap->sh, snap->creaseHandler,
+								  snap->selector, snap->projectionHandler,
+								  filename.c_str(), fileOpts);
+		}
+		catch(UGError err){
+			UG_LOG("ERROR: " << err.get_msg() << endl);
 			return false;
+		}
+	};
+}
 
-		if(strcmp(pSuffix, ".ugx") == 0){
-			GridWriterUGX ugxWriter;
-			ugxWriter.add_grid(pObj->grid(), "defGrid", aPosition);
-			ugxWriter.add_subset_handler(pObj->subset_handler(), "defSH", 0);
-			ugxWriter.add_subset_handler(pObj->crease_handler(), "markSH", 0);
-			ugxWriter.add_selector(pObj->selector(), "defSel", 0);
-			ugxWriter.add_projection_handler(pObj->projection_handler(), "defPH", 0);
-			return ugxWriter.write_to_file(filename);
+LGObjectWriteFunc CreateLGObjectUG3Exporter(LGObject* obj)
+{
+	shared_ptr<SaveMeshSnapshot> snap = CreateSaveMeshSnapshot(obj);
+
+	return [snap](const string& prefix) -> bool
+	{
+		Grid& g = snap->grid;
+		SubsetHandler& sh = snap->sh;
+		try{
+			if(g.num_volumes() > 0){
+			//	Create the subset-handlers
+				SubsetHandler shFaces(g, SHE_FACE);
+				SubsetHandler shVolumes(g, SHE_VOLUME);
+
+				for(int i = 0; i < sh.num_subsets(); ++i){
+					shFaces.assign_subset(sh.begin<Face>(i), sh.end<Face>(i), i);
+					shVolumes.assign_subset(sh.begin<Volume>(i), sh.end<Volume>(i), i);
+				}
+
+				return ExportGridToUG(g, shFaces, shVolumes, prefix.c_str(),
+									  "tmpLGMName", "tmpProblemName", 0);
+			}
+			return ExportGridToUG_2D(g, prefix.c_str(), "tmpLGMName",
+									 "tmpProblemName", 0, &sh);
 		}
-		else if(strcmp(pSuffix, ".lgb") == 0)
-		{
-		//	save to lgb. We want to save the marks too.
-			ISubsetHandler* ppSH[2];
-			ppSH[0] = &pObj->subset_handler();
-			ppSH[1] = &pObj->crease_handler();
-			ISelector* ppSel[1] = {&pObj->selector()};
-			return SaveGridToLGB(pObj->grid(), filename, ppSH, 2, ppSel, 1,
-                                 &pObj->projection_handler());
+		catch(UGError err){
+			UG_LOG("ERROR: " << err.get_msg() << endl);
+			return false;
+		}
+	};
+}
+
+///	returns true if the elements of both grids have the same types and corners.
+/**	Elements are compared in iteration order. Vertices are identified
+ * through their index in the iteration order, which has to be stored in
+ * aaInd and aaSnapInd.*/
+template <class TElem>
+static bool UndoSnapshotTopologyMatches(Grid& grid, Grid& snapGrid,
+						Grid::VertexAttachmentAccessor<AInt>& aaInd,
+						Grid::VertexAttachmentAccessor<AInt>& aaSnapInd)
+{
+	typedef typename geometry_traits<TElem>::iterator iter_t;
+	if(grid.num<TElem>() != snapGrid.num<TElem>())
+		return false;
+
+	vector<pair<iter_t, iter_t> > chunks, snapChunks;
+	CollectIteratorChunks(chunks, grid.begin<TElem>(), grid.end<TElem>(), 8192);
+	CollectIteratorChunks(snapChunks, snapGrid.begin<TElem>(), snapGrid.end<TElem>(), 8192);
+
+	vector<char> chunkMatches(NumParallelChunks(chunks.size(), 1), 1);
+	ParallelForChunks(chunks.size(), 1,
+		[&](size_t threadChunk, size_t chunksBegin, size_t chunksEnd)
+	{
+		for(size_t ichunk = chunksBegin; ichunk < chunksEnd; ++ichunk){
+			iter_t snapIter = snapChunks[ichunk].first;
+			for(iter_t iter = chunks[ichunk].first; iter != chunks[ichunk].second;
+				++iter, ++snapIter)
+			{
+				TElem* e = *iter;
+				TElem* se = *snapIter;
+				if(e->reference_object_id() != se->reference_object_id()){
+					chunkMatches[threadChunk] = 0;
+					return;
+				}
+
+				typename TElem::ConstVertexArray vrts = e->vertices();
+				typename TElem::ConstVertexArray snapVrts = se->vertices();
+				for(size_t i = 0; i < e->num_vertices(); ++i){
+					if(aaInd[vrts[i]] != aaSnapInd[snapVrts[i]]){
+						chunkMatches[threadChunk] = 0;
+						return;
+					}
+				}
+			}
+		}
+	});
+
+	return find(chunkMatches.begin(), chunkMatches.end(), 0) == chunkMatches.end();
+}
+
+///	assigns subsets, crease subsets and selection states of the snapshot elements.
+/**	Elements are associated by their position in the iteration order.
+ * States are only assigned if they differ.*/
+template <class TElem>
+static void RestoreUndoElementStates(LGObject* obj, UndoMeshSnapshot& snap)
+{
+	typedef typename geometry_traits<TElem>::iterator iter_t;
+	SubsetHandler& sh = obj->subset_handler();
+	SubsetHandler& creaseHandler = obj->crease_handler();
+	Selector& sel = obj->selector();
+
+	iter_t snapIter = snap.grid.begin<TElem>();
+	for(iter_t iter = obj->grid().begin<TElem>(); iter != obj->grid().end<TElem>();
+		++iter, ++snapIter)
+	{
+		TElem* e = *iter;
+		TElem* se = *snapIter;
+
+		int si = snap.sh.get_subset_index(se);
+		if(sh.get_subset_index(e) != si)
+			sh.assign_subset(e, si);
+
+		si = snap.creaseHandler.get_subset_index(se);
+		if(creaseHandler.get_subset_index(e) != si)
+			creaseHandler.assign_subset(e, si);
+
+		const byte selStatus = snap.selector.get_selection_status(se);
+		if(selStatus != sel.get_selection_status(e)){
+			if(selStatus)
+				sel.select(e, selStatus);
+			else
+				sel.deselect(e);
 		}
-		else
-			return SaveGridToFile(pObj->grid(), pObj->subset_handler(), filename);
 	}
-	return false;
+}
+
+///	assigns the subset infos of srcSH to destSH and removes surplus subsets.
+/**	Surplus subsets have to be empty already.*/
+static void RestoreUndoSubsetInfos(SubsetHandler& destSH, SubsetHandler& srcSH)
+{
+	while(destSH.num_subsets() > srcSH.num_subsets())
+		destSH.erase_subset(destSH.num_subsets() - 1);
+	CopySubsetInfos(destSH, srcSH);
+}
+
+///	returns true if snapGrid has the same elements and corners as grid in iteration order.
+static bool UndoSnapshotTopologyMatches(Grid& grid, Grid& snapGrid)
+{
+	if(grid.num<Vertex>() != snapGrid.num<Vertex>())
+		return false;
+
+	AInt aInd;
+	grid.attach_to_vertices(aInd);
+	snapGrid.attach_to_vertices(aInd);
+	Grid::VertexAttachmentAccessor<AInt> aaInd(grid, aInd);
+	Grid::VertexAttachmentAccessor<AInt> aaSnapInd(snapGrid, aInd);
+
+	bool topologyMatches = true;
+	int ind = 0;
+	VertexIterator snapIter = snapGrid.begin<Vertex>();
+	for(VertexIterator iter = grid.begin<Vertex>(); iter != grid.end<Vertex>();
+		++iter, ++snapIter, ++ind)
+	{
+		if((*iter)->reference_object_id() != (*snapIter)->reference_object_id())
+			topologyMatches = false;
+		aaInd[*iter] = aaSnapInd[*snapIter] = ind;
+	}
+
+	topologyMatches = topologyMatches
+			&& UndoSnapshotTopologyMatches<Edge>(grid, snapGrid, aaInd, aaSnapInd)
+			&& UndoSnapshotTopologyMatches<Face>(grid, snapGrid, aaInd, aaSnapInd)
+			&& UndoSnapshotTopologyMatches<Volume>(grid, snapGrid, aaInd, aaSnapInd);
+
+	grid.detach_from_vertices(aInd);
+	snapGrid.detach_from_vertices(aInd);
+	return topologyMatches;
+}
+
+///	restores an undo snapshot which was decompressed to data.
+/**	If the snapshot has the same topology as the current grid, it is restored
+ * in place: only positions, subsets and selection states which differ are
+ * assigned and all elements keep their identity. Otherwise the grid of obj
+ * is rebuilt from the already parsed snapshot.
+ * If the snapshot can't be read, the method returns false and leaves obj untouched.*/
+static bool RestoreUndoSnapshot(LGObject* obj, const QByteArray& data)
+{
+	PROFILE_FUNC();
+	Grid& grid = obj->grid();
+	UndoMeshSnapshot snap;
+	if(!ReadUndoSnapshot(snap.grid, snap.sh, snap.creaseHandler, snap.selector, data))
+		return false;
+
+	if(!UndoSnapshotTopologyMatches(grid, snap.grid)){
+	//	the topology changed. The grid has to be rebuilt.
+		obj->subset_handler().clear();
+		obj->crease_handler().clear();
+		obj->selector().clear();
+		grid.clear_geometry();
+		CopyUndoMesh(UndoMeshParts(obj), UndoMeshParts(snap));
+		return true;
+	}
+
+	Grid::VertexAttachmentAccessor<APosition> aaPos(grid, aPosition);
+	Grid::VertexAttachmentAccessor<APosition> aaSnapPos(snap.grid, aPosition);
+	VertexIterator snapIter = snap.grid.begin<Vertex>();
+	for(VertexIterator iter = grid.begin<Vertex>(); iter != grid.end<Vertex>();
+		++iter, ++snapIter)
+	{
+		aaPos[*iter] = aaSnapPos[*snapIter];
+	}
+
+//	subsets are required before elements can be assigned to them. Surplus
+//	subsets are empty after the elements were assigned.
+	CopySubsetInfos(obj->subset_handler(), snap.sh);
+	CopySubsetInfos(obj->crease_handler(), snap.creaseHandler);
+
+	RestoreUndoElementStates<Vertex>(obj, snap);
+	RestoreUndoElementStates<Edge>(obj, snap);
+	RestoreUndoElementStates<Face>(obj, snap);
+	RestoreUndoElementStates<Volume>(obj, snap);
+
+	RestoreUndoSubsetInfos(obj->subset_handler(), snap.sh);
+	RestoreUndoSubsetInfos(obj->crease_handler(), snap.creaseHandler);
+	return true;
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -266,6 +1015,7 @@ LGObject::~LGObject()
 void LGObject::init()
 {
 	m_saveRequired = false;
+	m_numChanges = 0;
 	
 	m_selectionChangedSinceLastUndoPoint = false;
 
@@ -288,7 +1038,14 @@ void LGObject::init()
 	m_subsetHandler.set_default_subset_info(defSI);
 
 	m_undoHistory = UndoHistoryProvider::inst().create_undo_history();
-	m_undoHistory.set_suffix(".lgb");
+
+//	records of the undo journal are only valid for checkpoints of the same id epoch
+	m_gridMatchesSourceFile = false;
+	m_partiallyLoaded = false;
+	m_undoJournal.set_record_func([this](const string& record){
+		if(m_recoveryJournal.id_epoch() == m_undoJournal.id_epoch())
+			m_recoveryJournal.append(record);
+	});
 
 	m_transformType = TT_NONE;
 	m_selectionDisplayListIndex = -1;
@@ -335,8 +1092,7 @@ void LGObject::selection_changed()
 
 void LGObject::geometry_changed()
 {
-	CalculateFaceNormals(m_grid, m_grid.faces_begin(), m_grid.faces_end(), aPosition, aNormal);
-	update_bounding_shapes();
+	update_geometry_caches();
 
 //	call base implementation
 	ISceneObject::geometry_changed();
@@ -409,14 +1165,137 @@ void LGObject::create_undo_point()
 {
 	PROFILE_FUNC();
 	m_selectionChangedSinceLastUndoPoint = false;
-	if(GetOptions().undo.enabled){
-		log_action ("-- >>> HISTORY ENTRY <<< --\n");
-		const char* filename = m_undoHistory.create_history_entry();
-		SaveLGObjectToFile(this, filename);
+	const bool gridMatchesSourceFile = m_gridMatchesSourceFile;
+	m_gridMatchesSourceFile = false;
+
+	if(!GetOptions().undo.enabled){
+	//	the journal would otherwise record all changes until undo is enabled again
+		m_undoJournal.release();
+		m_recoveryJournal.release();
+		return;
+	}
+
+	log_action ("-- >>> HISTORY ENTRY <<< --\n");
+	if(GetOptions().undo.journal){
+		if(m_undoJournal.is_initialized())
+			m_undoJournal.create_history_entry();
+		else{
+		//	the current state is the initial undo point of the journal.
+		//	Older snapshots must not be restored by a later switch back.
+			m_undoJournal.init(m_grid, m_subsetHandler, m_creaseHandler,
+							   m_selector, aPosition);
+			m_undoHistory = UndoHistoryProvider::inst().create_undo_history();
+		}
+		update_recovery_journal(gridMatchesSourceFile);
+	}
+	else{
+		m_undoJournal.release();
+		m_recoveryJournal.release();
+		m_undoHistory.create_history_entry(
+							[this](){return CreateUndoSnapshotWriter(this);},
+							EstimateUndoSnapshotBytes(m_grid));
 	}
 	// UG_LOG("WARNING: NO UNDO POINT CREATED! THIS IS A DEBUG VERSION OF PROMESH!\n");
 }
 
+void LGObject::update_recovery_journal(bool gridMatchesSourceFile)
+{
+	if(!(GetOptions().recovery.enabled && m_undoJournal.is_initialized()
+		 && RecoveryProvider::inst().is_initialized()))
+	{
+		m_recoveryJournal.release();
+		return;
+	}
+
+	const int idEpoch = m_undoJournal.id_epoch();
+	const qint64 intervalMSecs = qint64(GetOptions().recovery.checkpointInterval) * 60000;
+	if(m_recoveryJournal.id_epoch() == idEpoch
+	   && !m_recoveryJournal.checkpoint_due(intervalMSecs))
+	{
+		return;
+	}
+
+//	elements of a freshly initialized journal have ids in iteration order.
+//	The source file thus can be used as checkpoint.
+	if(gridMatchesSourceFile && !m_fileName.empty()
+	   && !(m_undoJournal.can_undo() || m_undoJournal.can_redo()))
+	{
+		m_recoveryJournal.write_file_checkpoint(idEpoch, m_name, m_fileName);
+		return;
+	}
+
+	const size_t numBytes = EstimateUndoSnapshotBytes(m_grid);
+	RecoveryProvider::inst().writer().wait_for_capacity(numBytes);
+	QElapsedTimer timer;
+	timer.start();
+	UndoHistory::WriteFunc writeMesh = CreateUndoSnapshotWriter(this);
+	string ids;
+	m_undoJournal.write_ids(ids);
+	m_recoveryJournal.write_checkpoint(idEpoch, m_name, m_fileName, writeMesh,
+									   numBytes, ids, timer.elapsed());
+}
+
+bool LGObject::replay_recovery_journal(const RecoverableObject& recObj)
+{
+	PROFILE_FUNC();
+	m_undoJournal.init(m_grid, m_subsetHandler, m_creaseHandler,
+					   m_selector, aPosition);
+
+	bool bSuccess = true;
+	if(!recObj.baseIsSourceFile){
+		QFile idsFile(QString::fromLocal8Bit(recObj.idsFile.c_str()));
+		if(idsFile.open(QIODevice::ReadOnly)){
+			QByteArray ids = idsFile.readAll();
+			bSuccess = m_undoJournal.assign_ids(string(ids.constData(), ids.size()));
+		}
+		else
+			bSuccess = false;
+	}
+
+	if(!bSuccess){
+		UG_LOG("ERROR in LGObject::replay_recovery_journal: The ids of the checkpoint "
+			   "couldn't be read. Only the checkpoint was recovered.\n");
+		m_undoJournal.release();
+		return false;
+	}
+
+	QFile journalFile(QString::fromLocal8Bit(recObj.journalFile.c_str()));
+	size_t numRecords = 0;
+	if(journalFile.open(QIODevice::ReadOnly)){
+		QDataStream in(&journalFile);
+		UndoJournal::TouchedElements touched;
+		while(!in.atEnd()){
+			quint32 size;
+			in >> size;
+		//	the last record may be incomplete if the crash happened while it was written
+			if(in.status() != QDataStream::Ok
+			   || (qint64)size > journalFile.size() - journalFile.pos())
+			{
+				break;
+			}
+
+			string record(size, 0);
+			if(size > 0)
+				in.readRawData(&record[0], (int)size);
+			if(!m_undoJournal.replay_record(record, touched)){
+				UG_LOG("ERROR in LGObject::replay_recovery_journal: Record "
+					   << numRecords << " doesn't match the grid. Later changes "
+					   "are lost.\n");
+				bSuccess = false;
+				break;
+			}
+			touched.clear();
+			++numRecords;
+		}
+	}
+
+	UG_LOG("Recovered '" << recObj.name << "' (" << numRecords << " changes replayed).\n");
+
+//	the next undo point initializes the journal again with fresh ids
+	m_undoJournal.release();
+	return bSuccess;
+}
+
 void LGObject::create_undo_point_if_selection_changed()
 {
 	if(m_selectionChangedSinceLastUndoPoint)
@@ -433,6 +1312,24 @@ bool LGObject::undo()
 		return true;
 	}
 
+	if(m_undoJournal.is_initialized()){
+		if(!m_undoJournal.can_undo())
+			return false;
+
+		log_action("-- <<< UNDO (restore last history entry)<<< --\n");
+
+		create_undo_point_if_selection_changed();
+
+		UndoJournal::TouchedElements touched;
+		bool bSuccess = m_undoJournal.undo(touched);
+		if(!bSuccess){
+			UG_LOG("ERROR in LGObject::undo: The undo journal did not match the grid. "
+				   "The undo history was cleared.\n");
+		}
+		undo_journal_replayed(touched, bSuccess);
+		return bSuccess;
+	}
+
 	if(!m_undoHistory.can_undo())
 		return false;
 
@@ -440,19 +1337,15 @@ bool LGObject::undo()
 
 	create_undo_point_if_selection_changed();
 
-	const char* filename = m_undoHistory.undo();
+	QByteArray data;
+	if(!m_undoHistory.undo(data)){
+		UG_LOG("ERROR in LGObject::undo: The history entry couldn't be restored.\n");
+		return false;
+	}
 
-	m_subsetHandler.clear();
-	m_creaseHandler.clear();
-	m_selector.clear();
-	m_grid.clear_geometry();
-	string oldFileName = m_fileName;
-	bool bLoadSuccessful = LoadLGObjectFromFile(this, filename, false);
-	m_fileName = oldFileName;
-	// bool bLoadSuccessful = load_ugx(filename);
+	bool bLoadSuccessful = RestoreUndoSnapshot(this, data);
 
-	CalculateFaceNormals(m_grid, m_grid.faces_begin(), m_grid.faces_end(), aPosition, aNormal);
-	update_bounding_shapes();
+	update_geometry_caches();
 
 	emit sig_geometry_changed();
 	emit sig_visuals_changed();
@@ -463,23 +1356,39 @@ bool LGObject::undo()
 bool LGObject::redo()
 {
 	PROFILE_FUNC();
+	if(m_undoJournal.is_initialized()){
+		if(!m_undoJournal.can_redo())
+			return false;
+
+		m_selectionChangedSinceLastUndoPoint = false;
+
+		UndoJournal::TouchedElements touched;
+		bool bSuccess = m_undoJournal.redo(touched);
+		if(!bSuccess){
+			UG_LOG("ERROR in LGObject::redo: The undo journal did not match the grid. "
+				   "The undo history was cleared.\n");
+		}
+
+		log_action("-- >>> REDO >>> --\n");
+
+		undo_journal_replayed(touched, bSuccess);
+		return bSuccess;
+	}
+
 	if(!m_undoHistory.can_redo())
 		return false;
 
 	m_selectionChangedSinceLastUndoPoint = false;
 
-	const char* filename = m_undoHistory.redo();
+	QByteArray data;
+	if(!m_undoHistory.redo(data)){
+		UG_LOG("ERROR in LGObject::redo: The history entry couldn't be restored.\n");
+		return false;
+	}
 
-	m_subsetHandler.clear();
-	m_creaseHandler.clear();
-	m_selector.clear();
-	m_grid.clear_geometry();
-	string oldFileName = m_fileName;
-	bool bLoadSuccessful = LoadLGObjectFromFile(this, filename, false);
-	m_fileName = oldFileName;
+	bool bLoadSuccessful = RestoreUndoSnapshot(this, data);
 
-	CalculateFaceNormals(m_grid, m_grid.faces_begin(), m_grid.faces_end(), aPosition, aNormal);
-	update_bounding_shapes();
+	update_geometry_caches();
 
 	log_action("-- >>> REDO >>> --\n");
 
@@ -490,6 +1399,26 @@ bool LGObject::redo()
 }
 
 
+void LGObject::undo_journal_replayed(const UndoJournal::TouchedElements& touched,
+									 bool replaySucceeded)
+{
+//	selection-only steps don't touch geometry or subsets. Only the
+//	selection visuals have to be updated.
+	if(replaySucceeded && m_undoJournal.last_replay_changed_selection_only()){
+		emit sig_selection_changed();
+		return;
+	}
+
+//	a failed replay may have changed arbitrary parts of the grid
+	if(replaySucceeded)
+		update_geometry_caches(touched);
+	else
+		update_geometry_caches();
+
+	emit sig_geometry_changed();
+	emit sig_visuals_changed();
+}
+
 void LGObject::set_num_display_lists(int num)
 {
 //	glGenLists creates returns an index to a list.
@@ -513,11 +1442,213 @@ void LGObject::set_num_display_lists(int num)
 	m_displayModes.resize(num, LGRM_DOUBLE_PASS_SHADED);
 }
 
-void LGObject::update_bounding_shapes()
+///	bounding box of the vertices of one chunk
+struct ChunkBoundingBox{
+	ChunkBoundingBox() : valid(false)	{}
+	vector3	min;
+	vector3	max;
+	bool	valid;
+};
+
+///	merges all valid boxes. The merged box of no vertices is located at the origin.
+static void MergeBoundingBoxes(vector3& minOut, vector3& maxOut,
+							   const vector<ChunkBoundingBox>& boxes)
 {
-//	calculate mesh center and radius
+	minOut = maxOut = vector3(0, 0, 0);
+	bool gotOne = false;
+	for(size_t i = 0; i < boxes.size(); ++i){
+		if(!boxes[i].valid)
+			continue;
+		if(!gotOne){
+			minOut = boxes[i].min;
+			maxOut = boxes[i].max;
+			gotOne = true;
+		}
+		else{
+			VecCompMin(minOut, minOut, boxes[i].min);
+			VecCompMax(maxOut, maxOut, boxes[i].max);
+		}
+	}
+}
+
+void LGObject::update_geometry_caches()
+{
+	PROFILE_FUNC();
+	if(!m_grid.has_face_attachment(aNormal))
+		m_grid.attach_to_faces(aNormal);
+	if(!m_grid.has_face_attachment(m_aSphere))
+		m_grid.attach_to_faces(m_aSphere);
+	if(!m_grid.has_volume_attachment(m_aSphere))
+		m_grid.attach_to_volumes(m_aSphere);
+
 	Grid::VertexAttachmentAccessor<APosition> aaPos(m_grid, aPosition);
-	CalculateBoundingBox(m_boundBoxMin, m_boundBoxMax, m_grid.vertices_begin(), m_grid.vertices_end(), aaPos);
+	Grid::FaceAttachmentAccessor<ANormal> aaNorm(m_grid, aNormal);
+	Grid::FaceAttachmentAccessor<ASphere> aaSphereFACE(m_grid, m_aSphere);
+	Grid::VolumeAttachmentAccessor<ASphere> aaSphereVOL(m_grid, m_aSphere);
+
+//	vertices, faces and volumes are split into chunks, which are all
+//	processed by one parallel loop. Each element is thus visited once.
+	const size_t chunkSize = 8192;
+	vector<pair<VertexIterator, VertexIterator> > vrtChunks;
+	vector<pair<FaceIterator, FaceIterator> > faceChunks;
+	vector<pair<VolumeIterator, VolumeIterator> > volChunks;
+	CollectIteratorChunks(vrtChunks, m_grid.begin<Vertex>(), m_grid.end<Vertex>(), chunkSize);
+	CollectIteratorChunks(faceChunks, m_grid.begin<Face>(), m_grid.end<Face>(), chunkSize);
+	CollectIteratorChunks(volChunks, m_grid.begin<Volume>(), m_grid.end<Volume>(), chunkSize);
+
+	const size_t numVrtChunks = vrtChunks.size();
+	const size_t numFaceChunks = faceChunks.size();
+	const size_t numChunks = numVrtChunks + numFaceChunks + volChunks.size();
+
+	vector<ChunkBoundingBox> boxes(NumParallelChunks(numChunks, 1));
+	ParallelForChunks(numChunks, 1,
+		[&](size_t threadChunk, size_t chunksBegin, size_t chunksEnd)
+	{
+		ChunkBoundingBox& box = boxes[threadChunk];
+		for(size_t ichunk = chunksBegin; ichunk < chunksEnd; ++ichunk){
+			if(ichunk < numVrtChunks){
+				for(VertexIterator iter = vrtChunks[ichunk].first;
+					iter != vrtChunks[ichunk].second; ++iter)
+				{
+					const vector3& p = aaPos[*iter];
+					if(!box.valid){
+						box.min = box.max = p;
+						box.valid = true;
+					}
+					else{
+						VecCompMin(box.min, box.min, p);
+						VecCompMax(box.max, box.max, p);
+					}
+				}
+			}
+			else if(ichunk < numVrtChunks + numFaceChunks){
+				const pair<FaceIterator, FaceIterator>& c = faceChunks[ichunk - numVrtChunks];
+				for(FaceIterator iter = c.first; iter != c.second; ++iter){
+					Face* f = *iter;
+					CalculateNormal(aaNorm[f], f, aaPos);
+					CalculateBoundingSphere(aaSphereFACE[f], f, aaPos);
+				}
+			}
+			else{
+				const pair<VolumeIterator, VolumeIterator>& c =
+						volChunks[ichunk - numVrtChunks - numFaceChunks];
+				for(VolumeIterator iter = c.first; iter != c.second; ++iter)
+					CalculateBoundingSphere(aaSphereVOL[*iter], *iter, aaPos);
+			}
+		}
+	});
+
+	vector3 vMin, vMax;
+	MergeBoundingBoxes(vMin, vMax, boxes);
+	set_bounding_box(vMin, vMax);
+}
+
+void LGObject::update_geometry_caches(const UndoJournal::TouchedElements& touched)
+{
+	PROFILE_FUNC();
+//	the caches of untouched elements have to be valid already
+	if(!(m_grid.has_face_attachment(aNormal)
+		 && m_grid.has_face_attachment(m_aSphere)
+		 && m_grid.has_volume_attachment(m_aSphere)))
+	{
+		update_geometry_caches();
+		return;
+	}
+
+	Grid::VertexAttachmentAccessor<APosition> aaPos(m_grid, aPosition);
+	Grid::FaceAttachmentAccessor<ANormal> aaNorm(m_grid, aNormal);
+	Grid::FaceAttachmentAccessor<ASphere> aaSphereFACE(m_grid, m_aSphere);
+	Grid::VolumeAttachmentAccessor<ASphere> aaSphereVOL(m_grid, m_aSphere);
+
+	const vector<Face*>& faces = touched.faces;
+	const vector<Volume*>& vols = touched.volumes;
+	const size_t numFaces = faces.size();
+	ParallelForChunks(numFaces + vols.size(), 1024,
+		[&](size_t, size_t begin, size_t end)
+	{
+		for(size_t i = begin; i < end; ++i){
+			if(i < numFaces){
+				Face* f = faces[i];
+				CalculateNormal(aaNorm[f], f, aaPos);
+				CalculateBoundingSphere(aaSphereFACE[f], f, aaPos);
+			}
+			else
+				CalculateBoundingSphere(aaSphereVOL[vols[i - numFaces]],
+										vols[i - numFaces], aaPos);
+		}
+	});
+
+//	the bounding box only shrinks if a vertex left one of its sides
+	bool boxShrinks = touched.vacated;
+	if(touched.vacated){
+		boxShrinks = false;
+		for(int i = 0; i < 3; ++i){
+			if(touched.vacatedMin[i] <= m_boundBoxMin[i]
+			   || touched.vacatedMax[i] >= m_boundBoxMax[i])
+			{
+				boxShrinks = true;
+			}
+		}
+	}
+
+//	if all vertices were touched, the old box doesn't contain any of them
+	if(boxShrinks || touched.vertices.size() >= m_grid.num_vertices()){
+		update_bounding_box();
+		return;
+	}
+
+	if(touched.vertices.empty())
+		return;
+
+	vector3 vMin = m_boundBoxMin;
+	vector3 vMax = m_boundBoxMax;
+	for(size_t i = 0; i < touched.vertices.size(); ++i){
+		const vector3& p = aaPos[touched.vertices[i]];
+		VecCompMin(vMin, vMin, p);
+		VecCompMax(vMax, vMax, p);
+	}
+	set_bounding_box(vMin, vMax);
+}
+
+void LGObject::update_bounding_box()
+{
+	PROFILE_FUNC();
+	Grid::VertexAttachmentAccessor<APosition> aaPos(m_grid, aPosition);
+	vector<pair<VertexIterator, VertexIterator> > chunks;
+	CollectIteratorChunks(chunks, m_grid.begin<Vertex>(), m_grid.end<Vertex>(), 8192);
+
+	vector<ChunkBoundingBox> boxes(NumParallelChunks(chunks.size(), 1));
+	ParallelForChunks(chunks.size(), 1,
+		[&](size_t threadChunk, size_t chunksBegin, size_t chunksEnd)
+	{
+		ChunkBoundingBox& box = boxes[threadChunk];
+		for(size_t ichunk = chunksBegin; ichunk < chunksEnd; ++ichunk){
+			for(VertexIterator iter = chunks[ichunk].first;
+				iter != chunks[ichunk].second; ++iter)
+			{
+				const vector3& p = aaPos[*iter];
+				if(!box.valid){
+					box.min = box.max = p;
+					box.valid = true;
+				}
+				else{
+					VecCompMin(box.min, box.min, p);
+					VecCompMax(box.max, box.max, p);
+				}
+			}
+		}
+	});
+
+	vector3 vMin, vMax;
+	MergeBoundingBoxes(vMin, vMax, boxes);
+	set_bounding_box(vMin, vMax);
+}
+
+void LGObject::set_bounding_box(const vector3& vMin, const vector3& vMax)
+{
+//	calculate mesh center and radius
+	m_boundBoxMin = vMin;
+	m_boundBoxMax = vMax;
 	m_boundSphere.set_radius(VecDistance(m_boundBoxMin, m_boundBoxMax) / 2.f);
 	vector3 center;
 	VecAdd(center, m_boundBoxMin, m_boundBoxMax);
@@ -629,6 +1760,43 @@ void LGObject::init_transform()
 										   m_transformVertices.end(), aaPos);
 	m_transformCur = m_transformStart;
 	m_transformCurScales = vector3(1.f, 1.f, 1.f);
+
+//	only the caches of elements around the transform vertices change
+	m_transformTouched.clear();
+	m_transformTouched.vertices = m_transformVertices;
+	Grid::traits<Face>::secure_container faces;
+	Grid::traits<Volume>::secure_container vols;
+	for(size_t i = 0; i < m_transformVertices.size(); ++i){
+		m_grid.associated_elements(faces, m_transformVertices[i]);
+		for(size_t j = 0; j < faces.size(); ++j)
+			m_transformTouched.faces.push_back(faces[j]);
+		m_grid.associated_elements(vols, m_transformVertices[i]);
+		for(size_t j = 0; j < vols.size(); ++j)
+			m_transformTouched.volumes.push_back(vols[j]);
+	}
+
+	vector<Face*>& tfaces = m_transformTouched.faces;
+	sort(tfaces.begin(), tfaces.end());
+	tfaces.erase(unique(tfaces.begin(), tfaces.end()), tfaces.end());
+	vector<Volume*>& tvols = m_transformTouched.volumes;
+	sort(tvols.begin(), tvols.end());
+	tvols.erase(unique(tvols.begin(), tvols.end()), tvols.end());
+}
+
+void LGObject::transform_vertices_to_be_moved()
+{
+	Grid::VertexAttachmentAccessor<APosition> aaPos(m_grid, aPosition);
+	m_transformTouched.vacated = false;
+	for(size_t i = 0; i < m_transformVertices.size(); ++i)
+		m_transformTouched.add_vacated(aaPos[m_transformVertices[i]]);
+}
+
+void LGObject::transform_vertices_moved()
+{
+	update_geometry_caches(m_transformTouched);
+
+//	the base implementation emits the signals without updating the caches
+	ISceneObject::geometry_changed();
 }
 
 void LGObject::begin_transform(TransformType tt)
@@ -657,6 +1825,7 @@ void LGObject::grab(const ug::vector3& offset)
 	assert(m_transformVertices.size() == m_transformInitialPositions.size());
 
 //	Move the vertices according to the offset
+	transform_vertices_to_be_moved();
 	Grid::VertexAttachmentAccessor<APosition> aaPos(m_grid, aPosition);
 	for(size_t i = 0; i < m_transformVertices.size(); ++i)
 		VecAdd(aaPos[m_transformVertices[i]], m_transformInitialPositions[i], offset);
@@ -664,7 +1833,7 @@ void LGObject::grab(const ug::vector3& offset)
 	VecAdd(m_transformCur, m_transformStart, offset);
 
 //	the geometry has changed. We thus have to update them
-	geometry_changed();
+	transform_vertices_moved();
 }
 
 void LGObject::scale(const ug::vector3& scaleFacs)
@@ -675,6 +1844,7 @@ void LGObject::scale(const ug::vector3& scaleFacs)
 	assert(m_transformVertices.size() == m_transformInitialPositions.size());
 
 //	Move the vertices according to the scaleFac
+	transform_vertices_to_be_moved();
 	Grid::VertexAttachmentAccessor<APosition> aaPos(m_grid, aPosition);
 	vector3 d;
 	for(size_t i = 0; i < m_transformVertices.size(); ++i){
@@ -688,7 +1858,7 @@ void LGObject::scale(const ug::vector3& scaleFacs)
 	m_transformCurScales = scaleFacs;
 
 //	the geometry has changed. We thus have to update them
-	geometry_changed();
+	transform_vertices_moved();
 }
 
 void LGObject::end_transform(bool bApply)
@@ -698,9 +1868,11 @@ void LGObject::end_transform(bool bApply)
 		assert(m_transformVertices.size() == m_transformInitialPositions.size());
 
 	//	We have to reset the vertices to their original positions
+		transform_vertices_to_be_moved();
 		Grid::VertexAttachmentAccessor<APosition> aaPos(m_grid, aPosition);
 		for(size_t i = 0; i < m_transformVertices.size(); ++i)
 			aaPos[m_transformVertices[i]] = m_transformInitialPositions[i];
+		update_geometry_caches(m_transformTouched);
 	}
 	else{
 		switch (m_transformType) {
@@ -729,9 +1901,37 @@ void LGObject::end_transform(bool bApply)
 	}
 
 	m_transformType = TT_NONE;
+	m_transformTouched = UndoJournal::TouchedElements();
+
+//	grab and scale keep the caches of the moved elements up to date.
+	if(bApply && create_transform_undo_point()){
+	//	the undo point was already created. geometry_changed must not
+	//	scan the whole grid for changes again.
+		emit sig_geometry_changed();
+		visuals_changed(false);
+		return;
+	}
+
 //	we call geometry_changed again, to generate an undo-entry
 //	(since transform type no is set to TT_NONE)
-	geometry_changed();
+	ISceneObject::geometry_changed();
+}
+
+bool LGObject::create_transform_undo_point()
+{
+	if(!(GetOptions().undo.enabled && GetOptions().undo.journal
+		 && m_undoJournal.is_initialized()))
+	{
+		return false;
+	}
+
+	set_save_required(true);
+	log_action ("-- >>> HISTORY ENTRY <<< --\n");
+//	only the positions of the transformed vertices are recorded
+	m_undoJournal.create_move_entry(m_transformVertices);
+	m_selectionChangedSinceLastUndoPoint = false;
+	update_recovery_journal(false);
+	return true;
 }
 
 
@@ -28,16 +28,20 @@
 #ifndef __H__LG_OBJECT__
 #define __H__LG_OBJECT__
 
+#include <atomic>
 #include <QGL>
 #include <QObject>
 #include "scene_interface.h"
 #include "lg_include.h"
 #include "mesh.h"
 #include "undo.h"
+#include "undo_journal.h"
+#include "recovery.h"
 
 ////////////////////////////////////////////////////////////////////////
 //	predeclarations
 class LGObject;
+struct PartialLoadFilter;
 
 ////////////////////////////////////////////////////////////////////////
 //	constants
@@ -84,10 +88,36 @@ extern const char* LG_SUPPORTED_FILE_FORMATS_SAVE;
 //	methods
 LGObject* CreateLGObjectFromFile(const char* filename);
 LGObject* CreateEmptyLGObject(const char* name);
-bool LoadLGObjectFromFile(LGObject* pObjOut, const char* filename, bool performLoadPostprocessing = true);
+///	loads a mesh file into pObjOut. If a filter is given, only the matching part of the mesh is loaded.
+/**	If canceled is given, the readers of .ugx, .pmb, .stl and .obj files stop
+ * once it is set and false is returned. Other readers always run to the end.*/
+bool LoadLGObjectFromFile(LGObject* pObjOut, const char* filename, bool performLoadPostprocessing = true,
+						  const PartialLoadFilter* filter = NULL,
+						  const std::atomic<bool>* canceled = NULL);
 void PerformLoadPostprocessing(LGObject* obj);
 bool SaveLGObjectToFile(LGObject* pObj, const char* filename);
+///	writes a copy of a mesh to the given file. See CreateLGObjectSaver.
+typedef std::function<bool (const std::string& filename)>	LGObjectWriteFunc;
+///	copies the mesh of obj and returns a function which saves the copy like SaveLGObjectToFile.
+/**	The copy contains subsets, creases, selection and projectors. Since it
+ * isn't shared with obj, the returned function may be executed on a
+ * different thread while obj is modified.*/
+LGObjectWriteFunc CreateLGObjectSaver(LGObject* obj);
+///	copies the mesh of obj and returns a function which exports the copy to UG3.
+/**	The function takes the prefix of the UG3 files. See CreateLGObjectSaver.*/
+LGObjectWriteFunc CreateLGObjectUG3Exporter(LGObject* obj);
+///	rough estimate of the memory held by the copies of CreateLGObjectSaver and CreateLGObjectUG3Exporter.
+size_t EstimateLGObjectCopyBytes(LGObject* obj);
 bool ReloadLGObject(LGObject* obj);
+///	copies the elements of src together with their subsets to dest.
+/**	If joinSubsets is true, elements keep their subset indices. Otherwise the
+ * subsets of src are appended to the subsets of dest. Subset infos of src
+ * overwrite the corresponding subset infos of dest.*/
+void MergeLGObject(LGObject* dest, LGObject* src, bool joinSubsets);
+///	loads the base of a recoverable object and replays its recovery journal.
+/**	Returns NULL if the base couldn't be loaded. If only parts of the journal
+ * could be replayed, the object is returned nevertheless.*/
+LGObject* RecoverLGObject(const RecoverableObject& recObj);
 
 ////////////////////////////////////////////////////////////////////////
 //	LGObject
@@ -169,7 +199,18 @@ class LGObject : public ISceneObject, public ug::promesh::Mesh
 		bool vertex_rendering_enabled()				{return (m_grid.num_vertices() > 0) && ((m_elementMode & LGEM_VERTEX) == LGEM_VERTEX);}
 
 	//	geometry info
-		void update_bounding_shapes();
+	///	updates face normals, bounding spheres of faces and volumes and the bounding box.
+	/**	All of them are computed in a single parallel pass over the grid.
+	 * Called by geometry_changed, e.g. after loads.*/
+		void update_geometry_caches();
+	///	updates the geometry caches of the touched elements only.
+	/**	Normals and bounding spheres are recomputed for the touched faces and
+	 * volumes. The bounding box is extended by the touched vertices. It is
+	 * only recomputed from all vertices if the vacated box of touched reaches
+	 * one of its sides, since it may have shrunk in this case.*/
+		void update_geometry_caches(const UndoJournal::TouchedElements& touched);
+	///	the attachment in which the bounding spheres of faces and volumes are stored
+		inline ug::ASphere& bounding_sphere_attachment()	{return m_aSphere;}
 		inline ug::Sphere3& get_bounding_sphere()	{return m_boundSphere;}
 		inline void get_bounding_box(ug::vector3& vMinOut, ug::vector3& vMaxOut)
 			{vMinOut = m_boundBoxMin; vMaxOut = m_boundBoxMax;}
@@ -185,6 +226,10 @@ class LGObject : public ISceneObject, public ug::promesh::Mesh
 	/** \note This method is automatically invoked from 'visuals_changed(true)'*/
 		void create_undo_point();
 
+	///	replays the recovery journal of recObj onto the grid, which has to contain its base.
+	/**	The undo history is released afterwards.*/
+		bool replay_recovery_journal(const RecoverableObject& recObj);
+
 	////////////////////////////////////////////////////////////////////////////
 	//	TRANSFORMS
 	///	Begins a new transform as indicated in the specified transform-type.
@@ -229,7 +274,16 @@ class LGObject : public ISceneObject, public ug::promesh::Mesh
 	///	call this method to change the saveRequired flag.
 	/**	Note: This method will automatically be called whenever the geometry
 	 *		  or the selection changed*/
-		void set_save_required(bool saveRequired)	{m_saveRequired = saveRequired;}
+		void set_save_required(bool saveRequired)
+		{
+			m_saveRequired = saveRequired;
+			if(saveRequired)
+				++m_numChanges;
+		}
+
+	///	returns the number of calls to set_save_required(true).
+	/**	Used to detect whether an object was changed while a copy of it was saved.*/
+		size_t num_changes() const					{return m_numChanges;}
 
 	///	The action log lists all operations which were performed on the object.
 		const QString& action_log() const	{return m_actionLog;}
@@ -254,9 +308,36 @@ class LGObject : public ISceneObject, public ug::promesh::Mesh
 	/**	Uses Grid::mark()*/
 		void init_transform();
 
+	///	writes a checkpoint of the recovery journal if required.
+	/**	gridMatchesSourceFile indicates that the grid was just loaded from
+	 * m_fileName. The source file then serves as checkpoint.*/
+		void update_recovery_journal(bool gridMatchesSourceFile);
+
+	///	creates an undo point which only records the moves of the transformed vertices.
+	/**	Returns false if the change journal isn't active. In this case no
+	 * undo point was created.*/
+		bool create_transform_undo_point();
+
 	///	loads a file from ugx without emitting signals
 		bool load_ugx(const char* filename);
 
+	///	updates normals and bounding shapes and emits signals after a journal replay
+	/**	If the replayed step only changed the selection, only the selection
+	 * visuals are updated.*/
+		void undo_journal_replayed(const UndoJournal::TouchedElements& touched,
+								   bool replaySucceeded);
+
+	///	recomputes the bounding box from all vertices
+		void update_bounding_box();
+	///	sets the bounding box and the bounding sphere around it
+		void set_bounding_box(const ug::vector3& vMin, const ug::vector3& vMax);
+
+	///	stores the current positions of the transform vertices as vacated positions
+	/**	Has to be called before the transform vertices are moved.*/
+		void transform_vertices_to_be_moved();
+	///	updates the geometry caches of the elements around the transform vertices.
+		void transform_vertices_moved();
+
 	protected:
 		typedef std::vector<GLuint>	DisplayListVec;
 		typedef std::vector<int>	DisplayModeVec;
@@ -271,6 +352,7 @@ class LGObject : public ISceneObject, public ug::promesh::Mesh
 		ug::vector3			m_boundBoxMin;
 		ug::vector3			m_boundBoxMax;
 		ug::Sphere3			m_boundSphere;
+		ug::ASphere			m_aSphere;
 
 		DisplayListVec		m_displayLists;
 		DisplayModeVec		m_displayModes;
@@ -282,11 +364,18 @@ class LGObject : public ISceneObject, public ug::promesh::Mesh
 		QColor				m_color;
 
 		UndoHistory			m_undoHistory;
+		UndoJournal			m_undoJournal;
+		RecoveryJournal		m_recoveryJournal;
+	//	true if the grid was just loaded from m_fileName. Reset by create_undo_point.
+		bool				m_gridMatchesSourceFile;
+	//	true if only a part of m_fileName was loaded. The file then can't serve as checkpoint.
+		bool				m_partiallyLoaded;
 
 		int					m_numInitializedSubsets;
 		bool				m_selectionChangedSinceLastUndoPoint;
 
 		bool				m_saveRequired;
+		size_t				m_numChanges;
 		
 	//	currently used by LGScene to update the selection visuals only.
 		int					m_selectionDisplayListIndex;
@@ -301,6 +390,8 @@ class LGObject : public ISceneObject, public ug::promesh::Mesh
 		ug::vector3			m_transformCurScales;
 		std::vector<ug::Vertex*>	m_transformVertices;
 		std::vector<ug::vector3>	m_transformInitialPositions;
+	///	elements around the transform vertices, whose geometry caches change
+		UndoJournal::TouchedElements	m_transformTouched;
 		std::vector<ug::vector3>	m_vertexCoordinateBuffer;///< used in calls to 'buffer_current_vertex_coordinates' and 'restore_vertex_coordinates_from_buffer'
 
 	protected:
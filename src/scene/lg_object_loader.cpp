@@ -0,0 +1,236 @@
+/*
+ * Copyright (c) 2026:  G-CSC, Goethe University Frankfurt
+ * Author: Sebastian Reiter
+ * 
+ * This file is part of ProMesh.
+ * 
+ * ProMesh is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License version 3 (as published by the
+ * Free Software Foundation) with the following additional attribution
+ * requirements (according to LGPL/GPL v3 §7):
+ * 
+ * (1) The following notice must be displayed in the Appropriate Legal Notices
+ * of covered and combined works: "Based on ProMesh (www.promesh3d.com)".
+ * 
+ * (2) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S. and Wittum, G. ProMesh -- a flexible interactive meshing software
+ *   for unstructured hybrid grids in 1, 2, and 3 dimensions. In preparation."
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+#include <QFile>
+#include "lg_object_loader.h"
+#include "lg_object.h"
+#include "util/parallel_util.h"
+
+using namespace std;
+using namespace ug;
+
+///	Executes LGObjectLoaders on a bounded number of threads.
+/**	Loaders are started in the order in which they were enqueued. Threads are
+ * created on demand. The number of concurrent loads is limited, since each
+ * load holds a whole mesh in memory and competes for the same disk.*/
+class LGObjectLoaderPool
+{
+	public:
+		static LGObjectLoaderPool& inst()
+		{
+			static LGObjectLoaderPool pool;
+			return pool;
+		}
+
+		void enqueue(LGObjectLoader* loader)
+		{
+			lock_guard<mutex> lock(m_mutex);
+			m_queue.push_back(loader);
+			if(m_numIdle == 0 && m_threads.size() < max_threads())
+				m_threads.push_back(thread(&LGObjectLoaderPool::run, this));
+			m_jobQueued.notify_one();
+		}
+
+	///	blocks until the given loader was executed.
+	/**	If removeIfQueued is true and the loader wasn't started yet, it is
+	 * removed from the queue instead.*/
+		void wait(LGObjectLoader* loader, bool removeIfQueued)
+		{
+			unique_lock<mutex> lock(m_mutex);
+			if(removeIfQueued){
+				deque<LGObjectLoader*>::iterator iter =
+						find(m_queue.begin(), m_queue.end(), loader);
+				if(iter != m_queue.end()){
+					m_queue.erase(iter);
+					return;
+				}
+			}
+
+			m_jobDone.wait(lock, [this, loader](){
+				return m_running.count(loader) == 0
+						&& find(m_queue.begin(), m_queue.end(), loader) == m_queue.end();
+			});
+		}
+
+	private:
+		LGObjectLoaderPool() : m_numIdle(0), m_quit(false)	{}
+
+		~LGObjectLoaderPool()
+		{
+			{
+				lock_guard<mutex> lock(m_mutex);
+				m_quit = true;
+				m_queue.clear();
+			}
+			m_jobQueued.notify_all();
+			for(size_t i = 0; i < m_threads.size(); ++i)
+				m_threads[i].join();
+		}
+
+		static size_t max_threads()
+		{
+			return min<size_t>(NumWorkerThreads(), 4);
+		}
+
+		void run()
+		{
+			unique_lock<mutex> lock(m_mutex);
+			while(true){
+				++m_numIdle;
+				m_jobQueued.wait(lock, [this](){return m_quit || !m_queue.empty();});
+				--m_numIdle;
+				if(m_quit)
+					return;
+
+				LGObjectLoader* loader = m_queue.front();
+				m_queue.pop_front();
+				m_running.insert(loader);
+
+				lock.unlock();
+				loader->run();
+				lock.lock();
+
+				m_running.erase(loader);
+				m_jobDone.notify_all();
+			}
+		}
+
+	private:
+		mutex					m_mutex;
+		condition_variable		m_jobQueued;
+		condition_variable		m_jobDone;
+		deque<LGObjectLoader*>	m_queue;
+		set<LGObjectLoader*>	m_running;
+		vector<thread>			m_threads;
+		size_t					m_numIdle;
+		bool					m_quit;
+};
+
+
+LGObjectLoader::
+LGObjectLoader(const std::string& filename, const PartialLoadFilter& filter) :
+	m_filename(filename),
+	m_filter(filter),
+	m_obj(new LGObject),
+	m_success(false),
+	m_fileSize(0),
+	m_numElemsCreated(0),
+	m_canceled(false),
+	m_started(false),
+	m_done(false)
+{
+	m_fileSize = QFile(QString::fromLocal8Bit(filename.c_str())).size();
+	LGObjectLoaderPool::inst().enqueue(this);
+}
+
+LGObjectLoader::
+~LGObjectLoader()
+{
+	m_canceled = true;
+	LGObjectLoaderPool::inst().wait(this, true);
+	delete m_obj;
+}
+
+void LGObjectLoader::
+wait()
+{
+	LGObjectLoaderPool::inst().wait(this, false);
+}
+
+LGObject* LGObjectLoader::
+take_object()
+{
+	if(!m_done || !m_success || m_canceled)
+		return NULL;
+	LGObject* obj = m_obj;
+	m_obj = NULL;
+	return obj;
+}
+
+void LGObjectLoader::
+run()
+{
+	m_started = true;
+	if(!m_canceled){
+		Grid& grid = m_obj->grid();
+		grid.register_observer(this, OT_VERTEX_OBSERVER | OT_EDGE_OBSERVER
+										| OT_FACE_OBSERVER | OT_VOLUME_OBSERVER);
+		try{
+			m_success = LoadLGObjectFromFile(m_obj, m_filename.c_str(), false,
+											 &m_filter, &m_canceled);
+		}
+		catch(UGError& err){
+			UG_LOG("ERROR: " << err.get_msg() << endl);
+			m_success = false;
+		}
+		catch(std::exception& err){
+			UG_LOG("ERROR: " << err.what() << endl);
+			m_success = false;
+		}
+		grid.unregister_observer(this);
+	}
+
+	m_done = true;
+}
+
+void LGObjectLoader::
+element_created()
+{
+//	readers which don't check the cancel flag run to the end. The object of
+//	a canceled load is discarded afterwards, so that progress isn't reported.
+	if(!m_canceled.load(memory_order_relaxed))
+		m_numElemsCreated.fetch_add(1, memory_order_relaxed);
+}
+
+void LGObjectLoader::
+vertex_created(Grid*, Vertex*, GridObject*, bool)
+{
+	element_created();
+}
+
+void LGObjectLoader::
+edge_created(Grid*, Edge*, GridObject*, bool)
+{
+	element_created();
+}
+
+void LGObjectLoader::
+face_created(Grid*, Face*, GridObject*, bool)
+{
+	element_created();
+}
+
+void LGObjectLoader::
+volume_created(Grid*, Volume*, GridObject*, bool)
+{
+	element_created();
+}
@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2026:  G-CSC, Goethe University Frankfurt
+ * Author: Sebastian Reiter
+ * 
+ * This file is part of ProMesh.
+ * 
+ * ProMesh is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License version 3 (as published by the
+ * Free Software Foundation) with the following additional attribution
+ * requirements (according to LGPL/GPL v3 §7):
+ * 
+ * (1) The following notice must be displayed in the Appropriate Legal Notices
+ * of covered and combined works: "Based on ProMesh (www.promesh3d.com)".
+ * 
+ * (2) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S. and Wittum, G. ProMesh -- a flexible interactive meshing software
+ *   for unstructured hybrid grids in 1, 2, and 3 dimensions. In preparation."
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#ifndef __H__PROMESH_lg_object_loader
+#define __H__PROMESH_lg_object_loader
+
+#include <atomic>
+#include <string>
+#include <QtGlobal>
+#include "lg_include.h"
+#include "partial_load.h"
+
+class LGObject;
+class LGObjectLoaderPool;
+
+///	Loads an LGObject from a file on a background thread.
+/**	Loaders are executed by a pool with a bounded number of threads in the
+ * order in which they were created. The loader observes the grid of its
+ * object, so that the number of elements which the reader created so far
+ * is reported while the file is read.
+ *
+ * Load postprocessing (see PerformLoadPostprocessing) is not performed on
+ * the loader thread, since it triggers undo points and Qt signals. It has to
+ * be executed on the GUI thread once done() returns true.
+ *
+ * Loading can be canceled at any time. The cancel flag is passed to
+ * LoadLGObjectFromFile, whose readers of .ugx, .pmb, .stl and .obj files
+ * return early once it is set. All other readers run to the end. In both
+ * cases the object is discarded afterwards.*/
+class LGObjectLoader : public ug::GridObserver
+{
+	public:
+	///	creates a new LGObject and schedules loading it from the given file.
+	/**	Only the part of the mesh which passes filter is loaded.*/
+		LGObjectLoader(const std::string& filename,
+					   const PartialLoadFilter& filter = PartialLoadFilter());
+
+	///	cancels the loader and waits until its thread finished.
+	/**	Deletes the object unless it was taken.*/
+		~LGObjectLoader();
+
+	///	blocks until the loader finished.
+		void wait();
+
+		const std::string& filename() const	{return m_filename;}
+
+	///	returns true if a thread of the pool started to execute the loader.
+		bool started() const				{return m_started;}
+
+	///	returns true if the loader thread finished, either successfully or not.
+		bool done() const					{return m_done;}
+
+	///	requests the loader to stop. done() may still be false afterwards.
+		void cancel()						{m_canceled = true;}
+		bool canceled() const				{return m_canceled;}
+
+		qint64 file_size() const			{return m_fileSize;}
+		size_t num_elements_created() const	{return m_numElemsCreated;}
+
+	///	returns the loaded object and transfers its ownership to the caller.
+	/**	Only valid if done() returns true. Returns NULL if loading failed or
+	 * was canceled.*/
+		LGObject* take_object();
+
+	//	GridObserver callbacks
+		virtual void vertex_created(ug::Grid* grid, ug::Vertex* vrt,
+									ug::GridObject* pParent = NULL,
+									bool replacesParent = false);
+		virtual void edge_created(ug::Grid* grid, ug::Edge* e,
+								  ug::GridObject* pParent = NULL,
+								  bool replacesParent = false);
+		virtual void face_created(ug::Grid* grid, ug::Face* f,
+								  ug::GridObject* pParent = NULL,
+								  bool replacesParent = false);
+		virtual void volume_created(ug::Grid* grid, ug::Volume* vol,
+									ug::GridObject* pParent = NULL,
+									bool replacesParent = false);
+
+	private:
+		friend class LGObjectLoaderPool;
+
+		void run();
+	///	counts a created element unless the loader was canceled.
+		void element_created();
+
+	private:
+		std::string				m_filename;
+		PartialLoadFilter		m_filter;
+		LGObject*				m_obj;
+		bool					m_success;
+		qint64					m_fileSize;
+		std::atomic<size_t>		m_numElemsCreated;
+		std::atomic<bool>		m_canceled;
+		std::atomic<bool>		m_started;
+		std::atomic<bool>		m_done;
+};
+
+#endif	//__H__PROMESH_lg_object_loader
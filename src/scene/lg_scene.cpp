@@ -26,9 +26,11 @@
  */
 
 #include <QtOpenGL>
+#include <QElapsedTimer>
 #include <algorithm>
 #include "lg_scene.h"
 #include "gl_includes.h"
+#include "util/parallel_util.h"
 
 using namespace std;
 using namespace ug;
@@ -39,6 +41,9 @@ LGScene::LGScene() :
 	m_camUp(0, 1, 0),
 	m_worldScale(1, 1, 1),
 	m_aHidden(true),
+	m_hoverObj(NULL),
+	m_hoverElemType(-1),
+	m_hoverElem(NULL),
 	m_drawVertices(true),
 	m_drawEdges(true),
 	m_drawFaces(true),
@@ -127,10 +132,11 @@ void LGScene::set_ortho_perspective(float left, float right, float bottom,
 
 int LGScene::add_object(LGObject* obj, bool autoDelete)
 {
-	if(!obj->grid().has_face_attachment(m_aSphere))
-		obj->grid().attach_to_faces(m_aSphere);
-	if(!obj->grid().has_volume_attachment(m_aSphere))
-		obj->grid().attach_to_volumes(m_aSphere);
+//	normals and bounding spheres are usually up to date since the last
+//	geometry_changed, e.g. during load postprocessing.
+	if(!obj->grid().has_face_attachment(obj->bounding_sphere_attachment()))
+		obj->update_geometry_caches();
+
 	if(!obj->grid().has_vertex_attachment(m_aRendered))
 	{
 		obj->grid().attach_to_vertices(m_aRendered);
@@ -150,7 +156,6 @@ int LGScene::add_object(LGObject* obj, bool autoDelete)
 	connect(obj, SIGNAL(sig_selection_changed()), this, SLOT(object_selection_changed()));
 	connect(obj, SIGNAL(sig_properties_changed()), this, SLOT(object_properties_changed()));
 
-	calculate_bounding_spheres(obj);
 	int retVal = BaseClass::add_object(obj, autoDelete);
 	update_visuals(obj);
 
@@ -159,6 +164,14 @@ int LGScene::add_object(LGObject* obj, bool autoDelete)
 	return retVal;
 }
 
+bool LGScene::remove_object(int index)
+{
+	LGObject* obj = get_object(index);
+	if(obj)
+		release_pick_grid(obj);
+	return BaseClass::remove_object(index);
+}
+
 void LGScene::visibility_changed(ISceneObject* pObj)
 {
 //	update the geometry if volumes are contained
@@ -185,9 +198,7 @@ void LGScene::object_geometry_changed()
 //	LGObject* obj = qobject_cast<LGObject*>(sender());
 	LGObject* obj = dynamic_cast<LGObject*>(sender());
 	if(obj){
-		calculate_bounding_spheres(obj);
-		Grid& g = obj->grid();
-		CalculateFaceNormals(g, g.begin<Face>(), g.end<Face>(), aPosition, aNormal);
+	//	normals and bounding spheres were updated by the object
 		update_visuals(obj);
 		emit geometry_changed();
 	}
@@ -275,21 +286,6 @@ void LGScene::setClipPlane(int index, const ug::Plane& plane)
 	m_clipPlanes[index] = plane;
 }
 
-void LGScene::calculate_bounding_spheres(LGObject* pObj)
-{
-	Grid& grid = pObj->grid();
-
-//	calculate bounding-spheres.
-	Grid::VertexAttachmentAccessor<APosition> aaPos(grid, aPosition);
-	Grid::FaceAttachmentAccessor<ASphere>	aaSphereFACE(grid, m_aSphere);
-	Grid::VolumeAttachmentAccessor<ASphere>	aaSphereVOL(grid, m_aSphere);
-
-	for(FaceIterator iter = grid.faces_begin(); iter != grid.faces_end(); ++iter)
-		CalculateBoundingSphere(aaSphereFACE[*iter], *iter, aaPos);
-	for(VolumeIterator iter = grid.volumes_begin(); iter != grid.volumes_end(); ++iter)
-		CalculateBoundingSphere(aaSphereVOL[*iter], *iter, aaPos);
-}
-
 bool LGScene::clip_vertex(Vertex* v, Grid::VertexAttachmentAccessor<APosition>& aaPos)
 {
 //	exact version
@@ -703,6 +699,93 @@ void LGScene::draw()
 			}
 		}
 	}
+
+	draw_hover_highlight();
+}
+
+void LGScene::draw_hover_highlight()
+{
+	if(!(m_hoverObj && m_hoverElem && m_hoverObj->is_visible()))
+		return;
+
+	Grid& grid = m_hoverObj->grid();
+	Grid::VertexAttachmentAccessor<APosition> aaPos(grid, aPosition);
+
+	glMatrixMode(GL_MODELVIEW);
+	glLoadIdentity();
+	glMultMatrixf(m_matTransform);
+
+//	the highlight is drawn on top of everything else
+	glDisable(GL_LIGHTING);
+	glDisable(GL_CULL_FACE);
+	glDisable(GL_DEPTH_TEST);
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+	glLineWidth(3.f);
+	glPointSize(9.f);
+
+	const GLfloat col[3] = {1.f, 0.8f, 0.1f};
+
+	switch(m_hoverElemType){
+		case 0:{
+			const vector3& p = aaPos[static_cast<Vertex*>(m_hoverElem)];
+			glColor4f(col[0], col[1], col[2], 1.f);
+			glBegin(GL_POINTS);
+			glVertex3d(p.x(), p.y(), p.z());
+			glEnd();
+		}break;
+
+		case 1:{
+			Edge* e = static_cast<Edge*>(m_hoverElem);
+			glColor4f(col[0], col[1], col[2], 1.f);
+			glBegin(GL_LINES);
+			for(size_t i = 0; i < 2; ++i){
+				const vector3& p = aaPos[e->vertex(i)];
+				glVertex3d(p.x(), p.y(), p.z());
+			}
+			glEnd();
+		}break;
+
+		case 2:{
+			Face* f = static_cast<Face*>(m_hoverElem);
+			glColor4f(col[0], col[1], col[2], 0.35f);
+			glBegin(GL_POLYGON);
+			for(size_t i = 0; i < f->num_vertices(); ++i){
+				const vector3& p = aaPos[f->vertex(i)];
+				glVertex3d(p.x(), p.y(), p.z());
+			}
+			glEnd();
+
+			glColor4f(col[0], col[1], col[2], 1.f);
+			glBegin(GL_LINE_LOOP);
+			for(size_t i = 0; i < f->num_vertices(); ++i){
+				const vector3& p = aaPos[f->vertex(i)];
+				glVertex3d(p.x(), p.y(), p.z());
+			}
+			glEnd();
+		}break;
+
+		case 3:{
+			Volume* vol = static_cast<Volume*>(m_hoverElem);
+			FaceDescriptor fd;
+			glColor4f(col[0], col[1], col[2], 1.f);
+			for(size_t iside = 0; iside < vol->num_faces(); ++iside){
+				vol->face_desc(iside, fd);
+				glBegin(GL_LINE_LOOP);
+				for(size_t i = 0; i < fd.num_vertices(); ++i){
+					const vector3& p = aaPos[fd.vertex(i)];
+					glVertex3d(p.x(), p.y(), p.z());
+				}
+				glEnd();
+			}
+		}break;
+	}
+
+	glPointSize(1.f);
+	glLineWidth(1.f);
+	glEnable(GL_DEPTH_TEST);
+	glEnable(GL_LIGHTING);
 }
 
 void LGScene::update_visuals()
@@ -726,6 +809,9 @@ void LGScene::update_visuals(ISceneObject* pObj)
 
 void LGScene::update_visuals(LGObject* pObj)
 {
+//	the rendered state of the elements changes below
+	release_pick_grid(pObj);
+
 //	check whether a clip plane is enabled
 	bool clipPlaneEnabled = false;
 	for(int i = 0; i < numClipPlanes(); ++i)
@@ -1478,8 +1564,8 @@ void LGScene::render_volumes(LGObject* pObj)
 
 	Grid::VertexAttachmentAccessor<APosition> aaPos(grid, aPosition);
 	Grid::FaceAttachmentAccessor<ANormal> aaNorm(grid, aNormal);
-	Grid::FaceAttachmentAccessor<ASphere>	aaSphereFACE(grid, m_aSphere);
-	Grid::VolumeAttachmentAccessor<ASphere>	aaSphereVOL(grid, m_aSphere);
+	Grid::FaceAttachmentAccessor<ASphere>	aaSphereFACE(grid, pObj->bounding_sphere_attachment());
+	Grid::VolumeAttachmentAccessor<ASphere>	aaSphereVOL(grid, pObj->bounding_sphere_attachment());
 
 	Grid::FaceAttachmentAccessor<ABool> aaRenderedFACE(grid, m_aRendered);
 	Grid::VolumeAttachmentAccessor<ABool> aaRenderedVOL(grid, m_aRendered);
@@ -1641,8 +1727,8 @@ void LGScene::render_faces_with_clip_plane(LGObject* pObj)
 
 	Grid::VertexAttachmentAccessor<APosition> aaPos(grid, aPosition);
 	Grid::FaceAttachmentAccessor<ANormal> aaNorm(grid, aNormal);
-	Grid::FaceAttachmentAccessor<ASphere>	aaSphereFACE(grid, m_aSphere);
-	Grid::VolumeAttachmentAccessor<ASphere>	aaSphereVOL(grid, m_aSphere);
+	Grid::FaceAttachmentAccessor<ASphere>	aaSphereFACE(grid, pObj->bounding_sphere_attachment());
+	Grid::VolumeAttachmentAccessor<ASphere>	aaSphereVOL(grid, pObj->bounding_sphere_attachment());
 
 	Grid::VertexAttachmentAccessor<ABool> aaRenderedVRT(grid, m_aRendered);
 	Grid::EdgeAttachmentAccessor<ABool> aaRenderedEDGE(grid, m_aRendered);
@@ -1965,6 +2051,133 @@ Don't forget subset indices and draw order!
 					shFace(face) = -1
 */
 
+void LGScene::
+release_pick_grid(LGObject* obj)
+{
+	m_pickGrids.erase(obj);
+	if(m_hoverObj == obj){
+		m_hoverObj = NULL;
+		m_hoverElem = NULL;
+		m_hoverElemType = -1;
+	}
+}
+
+bool LGScene::
+clear_hover()
+{
+	bool hadOne = (m_hoverElem != NULL);
+	m_hoverObj = NULL;
+	m_hoverElem = NULL;
+	m_hoverElemType = -1;
+	return hadOne;
+}
+
+bool LGScene::
+update_hover(LGObject* obj, int elemType, const ug::vector3& from,
+			 const ug::vector3& to, double budgetMs, bool& pendingOut)
+{
+	pendingOut = false;
+	if(!obj || !obj->is_visible() || get_object_index(obj) == -1)
+		return clear_hover();
+
+	QElapsedTimer timer;
+	timer.start();
+
+	Grid& grid = obj->grid();
+	Grid::VertexAttachmentAccessor<APosition> aaPos(grid, aPosition);
+	Grid::FaceAttachmentAccessor<ANormal> aaNorm(grid, aNormal);
+	Grid::VertexAttachmentAccessor<ABool> aaRenderedVRT(grid, m_aRendered);
+	Grid::EdgeAttachmentAccessor<ABool> aaRenderedEDGE(grid, m_aRendered);
+	Grid::FaceAttachmentAccessor<ABool> aaRenderedFACE(grid, m_aRendered);
+	Grid::VolumeAttachmentAccessor<ABool> aaRenderedVOL(grid, m_aRendered);
+
+	FacePickGrid& pickGrid = m_pickGrids[obj];
+	if(!pickGrid.build(grid, aaRenderedFACE, budgetMs)){
+		pendingOut = true;
+		return false;
+	}
+
+	bool timedOut = false;
+	Face* f = pickGrid.pick(from, to, aaPos, aaNorm,
+							!(m_drawModeFront & DM_SOLID),
+							!(m_drawModeBack & DM_SOLID),
+							max(1., budgetMs - (double)timer.elapsed()),
+							timedOut);
+	if(timedOut){
+		pendingOut = true;
+		return false;
+	}
+
+//	find the element of the requested type on the picked face
+	GridObject* elem = NULL;
+	if(f){
+		switch(elemType){
+			case 0:{
+				number minDist = 0;
+				for(size_t i = 0; i < f->num_vertices(); ++i){
+					Vertex* vrt = f->vertex(i);
+					if(!aaRenderedVRT[vrt])
+						continue;
+					number t;
+					number dist = DistancePointToLine(t, aaPos[vrt], from, to);
+					if(!elem || dist < minDist){
+						elem = vrt;
+						minDist = dist;
+					}
+				}
+			}break;
+
+			case 1:{
+				number minDistSq = 0;
+				for(size_t i = 0; i < f->num_edges(); ++i){
+					Edge* e = grid.get_edge(f, (int)i);
+					if(!(e && aaRenderedEDGE[e]))
+						continue;
+					vector3 isectA, isectB;
+					LineLineIntersection3d(isectA, isectB,
+										   aaPos[e->vertex(0)], aaPos[e->vertex(1)],
+										   from, to);
+					number distSq = VecDistanceSq(isectA, isectB);
+					if(!elem || distSq < minDistSq){
+						elem = e;
+						minDistSq = distSq;
+					}
+				}
+			}break;
+
+			case 2:
+				elem = f;
+				break;
+
+			case 3:{
+				SubsetHandler& sh = obj->subset_handler();
+				Grid::volume_traits::secure_container vols;
+				grid.associated_elements(vols, f);
+				for(size_t i = 0; i < vols.size(); ++i){
+					Volume* vol = vols[i];
+					if(aaRenderedVOL[vol]
+					   && obj->subset_is_visible(sh.get_subset_index(vol)))
+					{
+						elem = vol;
+						break;
+					}
+				}
+			}break;
+		}
+	}
+
+	if(!elem)
+		return clear_hover();
+
+	if(m_hoverObj == obj && m_hoverElem == elem && m_hoverElemType == elemType)
+		return false;
+
+	m_hoverObj = obj;
+	m_hoverElem = elem;
+	m_hoverElemType = elemType;
+	return true;
+}
+
 ug::Vertex* LGScene::
 get_clicked_vertex(LGObject* obj, const ug::vector3& from,
 				   const ug::vector3& to)
@@ -2082,7 +2295,7 @@ get_clicked_face(LGObject* pObj, const ug::vector3& from,
 
 	Grid::VertexAttachmentAccessor<APosition> aaPos(grid, aPosition);
 	Grid::FaceAttachmentAccessor<ANormal> aaNorm(grid, aNormal);
-	Grid::FaceAttachmentAccessor<ASphere>	aaSphereFACE(grid, m_aSphere);
+	Grid::FaceAttachmentAccessor<ASphere>	aaSphereFACE(grid, pObj->bounding_sphere_attachment());
 
 	Grid::FaceAttachmentAccessor<ABool> aaRenderedFACE(grid, m_aRendered);
 
@@ -2388,11 +2601,120 @@ get_faces_in_rect(std::vector<Face*>& facesOut,
 	return facesOut.size();
 }
 
+void LGScene::
+project_vertices(LGObject* obj)
+{
+	PROFILE_FUNC();
+	GLdouble modelMat[16];
+	GLdouble projMat[16];
+	GLint viewport[4];
+
+	glGetDoublev(GL_MODELVIEW_MATRIX, modelMat);
+	glGetDoublev(GL_PROJECTION_MATRIX, projMat);
+	glGetIntegerv(GL_VIEWPORT, viewport);
+
+//	combined transformation (column major, as in OpenGL). Vertices are
+//	transformed exactly as gluProject would do it.
+	double mvp[16];
+	for(int col = 0; col < 4; ++col){
+		for(int row = 0; row < 4; ++row){
+			double s = 0;
+			for(int k = 0; k < 4; ++k)
+				s += projMat[k * 4 + row] * modelMat[col * 4 + k];
+			mvp[col * 4 + row] = s;
+		}
+	}
+
+	const double vpX = viewport[0];
+	const double vpY = viewport[1];
+	const double vpW = viewport[2];
+	const double vpH = viewport[3];
+
+	Plane nearPlane = near_clip_plane();
+	vector<Plane> clipPlanes;
+	for(int i = 0; i < numClipPlanes(); ++i){
+		if(clipPlaneIsEnabled(i))
+			clipPlanes.push_back(m_clipPlanes[i]);
+	}
+
+	Grid& grid = obj->grid();
+	if(!grid.has_vertex_attachment(m_aInt))
+		grid.attach_to_vertices(m_aInt);
+
+	Grid::VertexAttachmentAccessor<APosition> aaPos(grid, aPosition);
+	Grid::VertexAttachmentAccessor<AInt> aaInt(grid, m_aInt);
+
+	m_projectedVrts.resize(grid.num<Vertex>());
+
+	const size_t chunkSize = 16384;
+	vector<pair<VertexIterator, VertexIterator> > chunks;
+	CollectIteratorChunks(chunks, grid.begin<Vertex>(), grid.end<Vertex>(), chunkSize);
+
+	ParallelForChunks(chunks.size(), 1,
+		[&](size_t, size_t chunksBegin, size_t chunksEnd)
+	{
+		for(size_t ichunk = chunksBegin; ichunk < chunksEnd; ++ichunk){
+			int ind = (int)(ichunk * chunkSize);
+			for(VertexIterator iter = chunks[ichunk].first;
+				iter != chunks[ichunk].second; ++iter, ++ind)
+			{
+				Vertex* vrt = *iter;
+				aaInt[vrt] = ind;
+				const vector3& pos = aaPos[vrt];
+				ProjectedVertex& pv = m_projectedVrts[ind];
+				pv.flags = PVF_NONE;
+
+				if(PlanePointTest(nearPlane, pos) == RPI_INSIDE)
+					pv.flags |= PVF_BEHIND_NEAR_PLANE;
+
+				for(size_t i = 0; i < clipPlanes.size(); ++i){
+					if(PlanePointTest(clipPlanes[i], pos) == RPI_OUTSIDE){
+						pv.flags |= PVF_CLIPPED;
+						break;
+					}
+				}
+
+				const double x = pos.x(), y = pos.y(), z = pos.z();
+				const double w = mvp[3] * x + mvp[7] * y + mvp[11] * z + mvp[15];
+				if(w == 0){
+					pv.flags |= PVF_INVALID;
+					pv.x = pv.y = pv.z = 0;
+					continue;
+				}
+
+				const double invW = 1. / w;
+				const double nx = (mvp[0] * x + mvp[4] * y + mvp[8] * z + mvp[12]) * invW;
+				const double ny = (mvp[1] * x + mvp[5] * y + mvp[9] * z + mvp[13]) * invW;
+				const double nz = (mvp[2] * x + mvp[6] * y + mvp[10] * z + mvp[14]) * invW;
+
+				pv.x = (float)(vpX + vpW * (nx + 1.) * 0.5);
+				pv.y = (float)(vpY + vpH * (ny + 1.) * 0.5);
+				pv.z = (float)((nz + 1.) * 0.5);
+			}
+		}
+	});
+}
+
+void LGScene::
+collect_visible_volume_chunks(
+		std::vector<std::pair<ug::VolumeIterator, ug::VolumeIterator> >& chunksOut,
+		LGObject* obj)
+{
+	SubsetHandler& sh = obj->subset_handler();
+	for(int si = 0; si < sh.num_subsets(); ++si){
+		if(obj->subset_is_visible(si)){
+			CollectIteratorChunks(chunksOut, sh.begin<Volume>(si),
+								  sh.end<Volume>(si), 8192);
+		}
+	}
+}
+
 size_t LGScene::
 get_volumes_in_rect(std::vector<Volume*>& volsOut,
 					LGObject* obj,
 					float xMin, float yMin, float xMax, float yMax)
 {
+	PROFILE_FUNC();
 	volsOut.clear();
 	yMin = m_viewHeight - yMin;
 	yMax = m_viewHeight - yMax;
@@ -2400,56 +2722,54 @@ get_volumes_in_rect(std::vector<Volume*>& volsOut,
 
 	if(obj)
 	{
-		GLdouble modelMat[16];
-		GLdouble projMat[16];
-		GLint viewport[4];
+		project_vertices(obj);
 
-		glGetDoublev(GL_MODELVIEW_MATRIX, modelMat);
-		glGetDoublev(GL_PROJECTION_MATRIX, projMat);
-		glGetIntegerv(GL_VIEWPORT, viewport);
-
-		GLdouble vx, vy, vz;
 		Grid& grid = obj->grid();
-		Grid::VertexAttachmentAccessor<APosition> aaPos(grid, aPosition);
-		Grid::VolumeAttachmentAccessor<ABool> aaRenderedVOL(grid, m_aRendered);
-		Plane plane = near_clip_plane();
-		
-		for(VolumeIterator iter = grid.begin<Volume>();
-			iter != grid.end<Volume>(); ++iter)
-		{
-			Volume* v = *iter;
+		Grid::VertexAttachmentAccessor<AInt> aaInt(grid, m_aInt);
+		Grid::VolumeAttachmentAccessor<ABool> aaHiddenVOL(grid, m_aHidden);
+		const vector<ProjectedVertex>& projVrts = m_projectedVrts;
 
-		//	aaRendered is bad here, since only outer volumes are rendered...
-			//if(!aaRenderedVOL[v])
-			//	continue;
-		//	todo: add an is_visible(v) method.
-			if(!obj->subset_is_visible(obj->subset_handler().get_subset_index(v)))
-				continue;
+		vector<pair<VolumeIterator, VolumeIterator> > chunks;
+		collect_visible_volume_chunks(chunks, obj);
 
-			bool allIn = true;
-			for(size_t i = 0; i < v->num_vertices(); ++i){
-				Vertex* vrt = v->vertex(i);
-				vector3& pos = aaPos[vrt];
-				if(PlanePointTest(plane, pos) == RPI_INSIDE){
-					allIn = false;
-					break;
-				}
-				
-				GLdouble px = pos.x();
-				GLdouble py = pos.y();
-				GLdouble pz = pos.z();
+		vector<vector<Volume*> > chunkVols(NumParallelChunks(chunks.size(), 1));
 
-				gluProject(px, py, pz, modelMat, projMat,
-						   viewport, &vx, &vy, &vz);
+		ParallelForChunks(chunks.size(), 1,
+			[&](size_t threadChunk, size_t chunksBegin, size_t chunksEnd)
+		{
+			vector<Volume*>& vols = chunkVols[threadChunk];
+			for(size_t ichunk = chunksBegin; ichunk < chunksEnd; ++ichunk){
+				for(VolumeIterator iter = chunks[ichunk].first;
+					iter != chunks[ichunk].second; ++iter)
+				{
+					Volume* v = *iter;
+					if(aaHiddenVOL[v])
+						continue;
 
-				if(vx < xMin || vx > xMax || vy < yMin || vy > yMax || vz < 0){
-					allIn = false;
-					break;
+				//	a volume which is cut by a clip plane is not visible. Since
+				//	all of its vertices have to lie inside the rect, it is thus
+				//	also sufficient to check the flags of the projected vertices.
+					bool allIn = true;
+					Volume::ConstVertexArray vrts = v->vertices();
+					const size_t numVrts = v->num_vertices();
+					for(size_t i = 0; i < numVrts; ++i){
+						const ProjectedVertex& pv = projVrts[aaInt[vrts[i]]];
+						if(pv.flags != PVF_NONE
+						   || pv.x < xMin || pv.x > xMax
+						   || pv.y < yMin || pv.y > yMax || pv.z < 0)
+						{
+							allIn = false;
+							break;
+						}
+					}
+					if(allIn)
+						vols.push_back(v);
 				}
 			}
-			if(allIn)
-				volsOut.push_back(v);
-		}
+		});
+
+		for(size_t i = 0; i < chunkVols.size(); ++i)
+			volsOut.insert(volsOut.end(), chunkVols[i].begin(), chunkVols[i].end());
 	}
 
 	return volsOut.size();
@@ -2624,95 +2944,141 @@ get_volumes_in_rect_cut(std::vector<Volume*>& volsOut,
 				  LGObject* obj,
 				  float xMin, float yMin, float xMax, float yMax)
 {
+	PROFILE_FUNC();
 	volsOut.clear();
 	yMin = m_viewHeight - yMin;
 	yMax = m_viewHeight - yMax;
 	swap(yMin, yMax);
 
-	vector3 boxMin(xMin, yMin, 0);
-	vector3 boxMax(xMax, yMax, 1.);
+	const vector3 boxMin(xMin, yMin, 0);
+	const vector3 boxMax(xMax, yMax, 1.);
 
 	if(obj)
 	{
-		GLdouble modelMat[16];
-		GLdouble projMat[16];
-		GLint viewport[4];
-
-		glGetDoublev(GL_MODELVIEW_MATRIX, modelMat);
-		glGetDoublev(GL_PROJECTION_MATRIX, projMat);
-		glGetIntegerv(GL_VIEWPORT, viewport);
+		project_vertices(obj);
 
 		Grid& grid = obj->grid();
-		SubsetHandler& sh = obj->subset_handler();
-		Grid::VertexAttachmentAccessor<APosition> aaPos(grid, aPosition);
-		Plane plane = near_clip_plane();
-		
-		grid.begin_marking();
+		Grid::VertexAttachmentAccessor<AInt> aaInt(grid, m_aInt);
+		Grid::VolumeAttachmentAccessor<ABool> aaHiddenVOL(grid, m_aHidden);
+		const vector<ProjectedVertex>& projVrts = m_projectedVrts;
 
-		Grid::volume_traits::secure_container vols;
+		vector<pair<VolumeIterator, VolumeIterator> > chunks;
+		collect_visible_volume_chunks(chunks, obj);
 
-		for(FaceIterator iter = grid.begin<Face>();
-			iter != grid.end<Face>(); ++iter)
+		vector<vector<Volume*> > chunkVols(NumParallelChunks(chunks.size(), 1));
+
+		ParallelForChunks(chunks.size(), 1,
+			[&](size_t threadChunk, size_t chunksBegin, size_t chunksEnd)
 		{
-			Face* f = *iter;
+			vector<Volume*>& vols = chunkVols[threadChunk];
+			FaceDescriptor fd;
 
-			assert((f->num_vertices() == 3 || f->num_vertices() == 4) && "unsupported number of vertices");
+			for(size_t ichunk = chunksBegin; ichunk < chunksEnd; ++ichunk){
+				for(VolumeIterator iter = chunks[ichunk].first;
+					iter != chunks[ichunk].second; ++iter)
+				{
+					Volume* v = *iter;
+					if(aaHiddenVOL[v])
+						continue;
 
-			vector3 projPos[4];
-			bool oneLiesInFront = false;
-			for(size_t i = 0; i < f->num_vertices(); ++i){
-				Vertex* vrt = f->vertex(i);
-				vector3& pos = aaPos[vrt];
-			//	at least one of the vertices has to lie in front of the clip plane
-				if(PlanePointTest(plane, pos) == RPI_OUTSIDE)
-					oneLiesInFront = true;
-				
-				GLdouble px = pos.x();
-				GLdouble py = pos.y();
-				GLdouble pz = pos.z();
-				GLdouble vx, vy, vz;
+					Volume::ConstVertexArray vrts = v->vertices();
+					const size_t numVrts = v->num_vertices();
+
+				//	gather the state of the volume from its projected corners
+					bool clipped = false;
+					bool oneLiesInFront = false;
+					bool allLieInFront = true;
+					bool oneLiesInRect = false;
+					float bxMin = projVrts[aaInt[vrts[0]]].x;
+					float bxMax = bxMin;
+					float byMin = projVrts[aaInt[vrts[0]]].y;
+					float byMax = byMin;
+
+					for(size_t i = 0; i < numVrts; ++i){
+						const ProjectedVertex& pv = projVrts[aaInt[vrts[i]]];
+						if(pv.flags & PVF_CLIPPED){
+							clipped = true;
+							break;
+						}
 
-				gluProject(px, py, pz, modelMat, projMat,
-						   viewport, &vx, &vy, &vz);
+						if(pv.flags & (PVF_BEHIND_NEAR_PLANE | PVF_INVALID)){
+							allLieInFront = false;
+							continue;
+						}
 
-				projPos[i].x() = vx;
-				projPos[i].y() = vy;
-				projPos[i].z() = vz;
-			}
+						oneLiesInFront = true;
+						if(pv.x >= xMin && pv.x <= xMax && pv.y >= yMin && pv.y <= yMax
+						   && pv.z >= 0 && pv.z <= 1)
+						{
+							oneLiesInRect = true;
+						}
 
-			if(!oneLiesInFront)
-				continue;
+						bxMin = min(bxMin, pv.x);	bxMax = max(bxMax, pv.x);
+						byMin = min(byMin, pv.y);	byMax = max(byMax, pv.y);
+					}
 
-			bool intersecting = TriangleBoxIntersection(
-									projPos[0], projPos[1], projPos[2],
-									boxMin, boxMax);
+					if(clipped || !oneLiesInFront)
+						continue;
 
-			if(!intersecting && f->num_vertices() == 4){
-				intersecting = TriangleBoxIntersection(
-									projPos[0], projPos[2], projPos[3],
-									boxMin, boxMax);
-			}
+					if(oneLiesInRect){
+						vols.push_back(v);
+						continue;
+					}
 
-			if(intersecting){
-			//	since the face is intersecting, associated volumes do so too.
-				grid.associated_elements(vols, f);
-				for(size_t ivol = 0; ivol < vols.size(); ++ivol){
-					Volume* vol = vols[ivol];
-					if(!grid.is_marked(vol)){
-						grid.mark(vol);
-						if(obj->subset_is_visible(sh.get_subset_index(vol)))
-							volsOut.push_back(vol);
+				//	if all corners lie in front of the near plane, the projection
+				//	of the volume lies inside the bounding rect of its corners.
+					if(allLieInFront
+					   && (bxMax < xMin || bxMin > xMax || byMax < yMin || byMin > yMax))
+					{
+						continue;
 					}
+
+				//	check the sides of the volume. Note that the sides don't
+				//	have to exist as faces in the grid.
+					bool intersecting = false;
+					const size_t numSides = v->num_faces();
+					for(size_t iside = 0; iside < numSides && !intersecting; ++iside){
+						v->face_desc(iside, fd);
+						const size_t numCorners = fd.num_vertices();
+						if(numCorners < 3)
+							continue;
+
+						vector3 projPos[4];
+						bool sideLiesInFront = false;
+						for(size_t i = 0; i < numCorners && i < 4; ++i){
+							const ProjectedVertex& pv = projVrts[aaInt[fd.vertex(i)]];
+							if(!(pv.flags & PVF_BEHIND_NEAR_PLANE))
+								sideLiesInFront = true;
+							projPos[i] = vector3(pv.x, pv.y, pv.z);
+						}
+
+						if(!sideLiesInFront)
+							continue;
+
+						intersecting = TriangleBoxIntersection(
+											projPos[0], projPos[1], projPos[2],
+											boxMin, boxMax);
+
+						if(!intersecting && numCorners == 4){
+							intersecting = TriangleBoxIntersection(
+											projPos[0], projPos[2], projPos[3],
+											boxMin, boxMax);
+						}
+					}
+
+					if(intersecting)
+						vols.push_back(v);
 				}
 			}
-		}
-		grid.end_marking();
+		});
+
+		for(size_t i = 0; i < chunkVols.size(); ++i)
+			volsOut.insert(volsOut.end(), chunkVols[i].begin(), chunkVols[i].end());
 	}
 
 	return volsOut.size();
 }
 
-
 void LGScene::
 unhide_elements(LGObject* obj)
 {
@@ -28,9 +28,13 @@
 #ifndef __H__LG_SCENE__
 #define __H__LG_SCENE__
 
+#include <map>
 #include <string>
+#include <utility>
+#include <vector>
 #include "lg_include.h"
 #include "lg_object.h"
+#include "pick_grid.h"
 #include "../view3d/renderer3d_interface.h"
 #include "scene_template.h"
 
@@ -98,10 +102,11 @@ class LGScene : public TScene<LGObject>
 							    LGObject* obj,
 							    float xMin, float yMin, float xMax, float yMax);
 
-	/**	This algorithm uses Grid::mark.
-	 *
-	 *  given a rect in screen coordinates, this methods finds all
+	/**	given a rect in screen coordinates, this methods finds all
 	 *	volumes which lie completly in that rect and writes them to volsOut.
+	 *	Only volumes which are currently visible are considered, i.e. volumes
+	 *	in invisible subsets, hidden volumes and volumes which are cut away by
+	 *	an enabled clip plane are ignored. The volumes are processed in parallel.
 	 * \return number of volumes in the rect.*/
 		size_t get_volumes_in_rect(std::vector<ug::Volume*>& volsOut,
 								   LGObject* obj,
@@ -121,15 +126,30 @@ class LGScene : public TScene<LGObject>
 							    LGObject* obj,
 							    float xMin, float yMin, float xMax, float yMax);
 
-	/**	This algorithm uses Grid::mark.
-	 *
-	 *  given a rect in screen coordinates, this methods finds all
+	/**	given a rect in screen coordinates, this methods finds all
 	 *	volumes which intersect that rect and writes them to volsOut.
+	 *	Visibility is handled as in get_volumes_in_rect.
 	 * \return number of volumes in the rect.*/
 		size_t get_volumes_in_rect_cut(std::vector<ug::Volume*>& volsOut,
 								   LGObject* obj,
 								   float xMin, float yMin, float xMax, float yMax);
 
+	//	hover highlighting
+	///	highlights the element of type elemType which is hit by the ray (from, to).
+	/**	elemType: 0: vertices, 1: edges, 2: faces, 3: volumes.
+	 *	Elements are found through a FacePickGrid of obj, which is created on
+	 *	demand and built over several calls if necessary. About budgetMs
+	 *	milliseconds are spent at most. If the pick could not be completed in
+	 *	that time, pendingOut is set to true and the current highlight is kept.
+	 *	The highlight is drawn as an overlay, display lists are not touched.
+	 * \return true if the highlighted element changed.*/
+		bool update_hover(LGObject* obj, int elemType,
+						  const ug::vector3& from, const ug::vector3& to,
+						  double budgetMs, bool& pendingOut);
+
+	///	removes the hover highlight. Returns true if an element was highlighted.
+		bool clear_hover();
+
 	//	derived from IRenderer3D
 	///	this method is called when the renderer shall draw its content
 		virtual void draw();
@@ -164,6 +184,7 @@ class LGScene : public TScene<LGObject>
 
 	//	derived from TScene
 		virtual void update_visuals(ISceneObject* pObj);
+		virtual bool remove_object(int index);
 
 	//	geometry
 	///	returns the bounding box of the scene
@@ -212,8 +233,6 @@ class LGScene : public TScene<LGObject>
 
 	protected:
 		ug::Plane near_clip_plane();
-		
-		void calculate_bounding_spheres(LGObject* pObj);
 
 		void render_skeleton(LGObject* pObj);
 
@@ -273,9 +292,42 @@ class LGScene : public TScene<LGObject>
 		ug::RelativePositionIndicator clip_sphere(const ug::Sphere3& sphere);
 		ug::RelativePositionIndicator clip_point(const ug::vector3& point);
 
+	///	draws the element set by update_hover
+		void draw_hover_highlight();
+
+	///	releases the pick structure of obj and its hover highlight
+		void release_pick_grid(LGObject* obj);
+
 	protected:
 		typedef ug::Attachment<char> AChar;
 
+	///	flags which describe the state of a projected vertex
+		enum ProjectedVertexFlags{
+			PVF_NONE = 0,
+			PVF_BEHIND_NEAR_PLANE = 1,		///< the vertex lies behind the near plane
+			PVF_CLIPPED = 1 << 1,			///< the vertex lies outside of an enabled clip plane
+			PVF_INVALID = 1 << 2			///< the vertex could not be projected
+		};
+
+	///	window coordinates of a vertex together with a combination of ProjectedVertexFlags
+		struct ProjectedVertex{
+			float x;
+			float y;
+			float z;
+			int flags;
+		};
+
+	/**	projects all vertices of obj to window coordinates using the current
+	 *	OpenGL matrices and writes them to m_projectedVrts. The index of each
+	 *	vertex in that buffer is stored in the vertex attachment m_aInt.
+	 *	Has to be called from the thread which owns the OpenGL context.*/
+		void project_vertices(LGObject* obj);
+
+	///	collects chunks of volumes in visible subsets of obj for parallel processing.
+		void collect_visible_volume_chunks(
+				std::vector<std::pair<ug::VolumeIterator, ug::VolumeIterator> >& chunksOut,
+				LGObject* obj);
+
 	protected:
 		unsigned int m_drawModeFront;
 		unsigned int m_drawModeBack;
@@ -292,11 +344,19 @@ class LGScene : public TScene<LGObject>
 		ug::vector3		m_worldScale;
 		
 	//	attachments
-		ug::ASphere		m_aSphere;
 		ug::AInt		m_aInt;
 		ug::ABool		m_aRendered;
 		ug::ABool		m_aHidden;
 
+	///	reused by project_vertices to avoid reallocations during rect selection
+		std::vector<ProjectedVertex>	m_projectedVrts;
+
+	//	hover highlighting
+		std::map<LGObject*, FacePickGrid>	m_pickGrids;
+		LGObject*			m_hoverObj;
+		int					m_hoverElemType;
+		ug::GridObject*		m_hoverElem;
+
 	//	clip planes
 		ug::Plane	m_clipPlanes[MAX_NUM_CLIP_PLANES];
 		bool		m_clipPlaneEnabled[MAX_NUM_CLIP_PLANES];
@@ -0,0 +1,281 @@
+/*
+ * Copyright (c) 2026:  G-CSC, Goethe University Frankfurt
+ * Author: Sebastian Reiter
+ * 
+ * This file is part of ProMesh.
+ * 
+ * ProMesh is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License version 3 (as published by the
+ * Free Software Foundation) with the following additional attribution
+ * requirements (according to LGPL/GPL v3 §7):
+ * 
+ * (1) The following notice must be displayed in the Appropriate Legal Notices
+ * of covered and combined works: "Based on ProMesh (www.promesh3d.com)".
+ * 
+ * (2) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S. and Wittum, G. ProMesh -- a flexible interactive meshing software
+ *   for unstructured hybrid grids in 1, 2, and 3 dimensions. In preparation."
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#include "partial_load.h"
+#include "file_io_pmb.h"
+#include "file_io_ugx_stream.h"
+#include "common/profiler/profiler.h"
+#include "lib_grid/file_io/file_io.h"
+
+using namespace std;
+using namespace ug;
+
+bool PartialLoadFilter::
+subset_passes(int si) const
+{
+	return !useSubsets || binary_search(subsets.begin(), subsets.end(), si);
+}
+
+bool PartialLoadFilter::
+point_passes(const vector3& p) const
+{
+	if(!useBox)
+		return true;
+	for(int i = 0; i < 3; ++i){
+		if(p[i] < boxMin[i] || p[i] > boxMax[i])
+			return false;
+	}
+	return true;
+}
+
+void MeshFileSubsetSummary::
+add_point(const vector3& p)
+{
+	if(!hasBox){
+		boxMin = boxMax = p;
+		hasBox = true;
+	}
+	else{
+		VecCompMin(boxMin, boxMin, p);
+		VecCompMax(boxMax, boxMax, p);
+	}
+}
+
+
+////////////////////////////////////////////////////////////////////////
+//	summaries
+///	returns the center of the corners of e
+template <class TElem>
+static vector3 CornerCenter(TElem* e, Grid::VertexAttachmentAccessor<APosition>& aaPos)
+{
+	typename TElem::ConstVertexArray vrts = e->vertices();
+	vector3 center(0, 0, 0);
+	for(size_t i = 0; i < e->num_vertices(); ++i)
+		VecAdd(center, center, aaPos[vrts[i]]);
+	VecScale(center, center, 1. / (number)e->num_vertices());
+	return center;
+}
+
+static vector3 CornerCenter(Vertex* v, Grid::VertexAttachmentAccessor<APosition>& aaPos)
+{
+	return aaPos[v];
+}
+
+template <class TElem>
+static void AddCorners(MeshFileSubsetSummary& s, TElem* e,
+					   Grid::VertexAttachmentAccessor<APosition>& aaPos)
+{
+	typename TElem::ConstVertexArray vrts = e->vertices();
+	for(size_t i = 0; i < e->num_vertices(); ++i)
+		s.add_point(aaPos[vrts[i]]);
+}
+
+static void AddCorners(MeshFileSubsetSummary& s, Vertex* v,
+					   Grid::VertexAttachmentAccessor<APosition>& aaPos)
+{
+	s.add_point(aaPos[v]);
+}
+
+template <class TElem>
+static void SummarizeElements(MeshFileSummary& summary, Grid& grid,
+							  ISubsetHandler& sh, int dim,
+							  Grid::VertexAttachmentAccessor<APosition>& aaPos)
+{
+	typedef typename geometry_traits<TElem>::iterator iter_t;
+	for(iter_t iter = grid.begin<TElem>(); iter != grid.end<TElem>(); ++iter){
+		TElem* e = *iter;
+		const int si = sh.get_subset_index(e);
+		MeshFileSubsetSummary& s = (si >= 0 && si < (int)summary.subsets.size()) ?
+									summary.subsets[si] : summary.unassigned;
+		++s.numElems[dim];
+		++summary.total.numElems[dim];
+		AddCorners(s, e, aaPos);
+		if(dim == 0)
+			AddCorners(summary.total, e, aaPos);
+	}
+}
+
+bool MeshFileSummarySupported(const char* filename)
+{
+	const char* pSuffix = strrchr(filename, '.');
+	return pSuffix && (strcmp(pSuffix, ".pmb") == 0 || strcmp(pSuffix, ".ugx") == 0);
+}
+
+bool ReadMeshFileSummary(const char* filename, MeshFileSummary& summaryOut)
+{
+	PROFILE_FUNC();
+	summaryOut = MeshFileSummary();
+	const char* pSuffix = strrchr(filename, '.');
+	if(!pSuffix)
+		return false;
+
+	if(strcmp(pSuffix, ".pmb") == 0)
+		return ReadPMBSummary(filename, summaryOut);
+
+	if(strcmp(pSuffix, ".ugx") != 0)
+		return false;
+
+	switch(ReadUGXSummary(filename, summaryOut)){
+		case UGX_STREAM_OK:
+			return true;
+		case UGX_STREAM_UNSUPPORTED:
+			break;
+		default:
+			return false;
+	}
+
+//	files with constrained elements can only be read by GridReaderUGX.
+//	Their elements thus have to be created.
+	Grid grid;
+	SubsetHandler sh(grid);
+	if(!LoadGridFromFile(grid, sh, filename, aPosition))
+		return false;
+
+	if(!grid.has_vertex_attachment(aPosition))
+		return false;
+	Grid::VertexAttachmentAccessor<APosition> aaPos(grid, aPosition);
+
+	summaryOut.subsets.resize(sh.num_subsets());
+	for(int i = 0; i < sh.num_subsets(); ++i){
+		summaryOut.subsets[i].name = sh.subset_info(i).name;
+		summaryOut.subsets[i].color = sh.subset_info(i).color;
+	}
+
+	SummarizeElements<Vertex>(summaryOut, grid, sh, 0, aaPos);
+	SummarizeElements<Edge>(summaryOut, grid, sh, 1, aaPos);
+	SummarizeElements<Face>(summaryOut, grid, sh, 2, aaPos);
+	SummarizeElements<Volume>(summaryOut, grid, sh, 3, aaPos);
+	return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////
+//	filtering of loaded grids
+template <class TElem>
+static bool ElementPasses(TElem* e, ISubsetHandler& sh,
+						  const PartialLoadFilter& filter,
+						  Grid::VertexAttachmentAccessor<APosition>& aaPos)
+{
+	return filter.subset_passes(sh.get_subset_index(e))
+		   && (!filter.useBox || filter.point_passes(CornerCenter(e, aaPos)));
+}
+
+///	marks the corners and sides of e. dim is the dimension of e.
+template <class TElem>
+static void KeepSides(Grid& grid, TElem* e, int dim,
+					  Grid::AttachmentAccessor<Vertex, ABool>& aaKeepVRT,
+					  Grid::AttachmentAccessor<Edge, ABool>& aaKeepEDGE,
+					  Grid::AttachmentAccessor<Face, ABool>& aaKeepFACE)
+{
+	typename TElem::ConstVertexArray vrts = e->vertices();
+	for(size_t i = 0; i < e->num_vertices(); ++i)
+		aaKeepVRT[vrts[i]] = true;
+
+	if(dim > 1){
+		Grid::edge_traits::secure_container edges;
+		grid.associated_elements(edges, e);
+		for(size_t i = 0; i < edges.size(); ++i)
+			aaKeepEDGE[edges[i]] = true;
+	}
+
+	if(dim > 2){
+		Grid::face_traits::secure_container faces;
+		grid.associated_elements(faces, e);
+		for(size_t i = 0; i < faces.size(); ++i)
+			aaKeepFACE[faces[i]] = true;
+	}
+}
+
+template <class TElem>
+static void CollectRejected(vector<TElem*>& rejectedOut, Grid& grid,
+							Grid::AttachmentAccessor<TElem, ABool>& aaKeep)
+{
+	typedef typename geometry_traits<TElem>::iterator iter_t;
+	for(iter_t iter = grid.begin<TElem>(); iter != grid.end<TElem>(); ++iter){
+		if(!aaKeep[*iter])
+			rejectedOut.push_back(*iter);
+	}
+}
+
+void ApplyPartialLoadFilter(Grid& grid, ISubsetHandler& sh,
+							const PartialLoadFilter& filter)
+{
+	PROFILE_FUNC();
+	if(filter.loads_everything() || !grid.has_vertex_attachment(aPosition))
+		return;
+
+	Grid::VertexAttachmentAccessor<APosition> aaPos(grid, aPosition);
+	ABool aKeep;
+	grid.attach_to_all(aKeep, false);
+	Grid::AttachmentAccessor<Vertex, ABool> aaKeepVRT(grid, aKeep);
+	Grid::AttachmentAccessor<Edge, ABool> aaKeepEDGE(grid, aKeep);
+	Grid::AttachmentAccessor<Face, ABool> aaKeepFACE(grid, aKeep);
+	Grid::AttachmentAccessor<Volume, ABool> aaKeepVOL(grid, aKeep);
+
+	for(VolumeIterator iter = grid.begin<Volume>(); iter != grid.end<Volume>(); ++iter){
+		if(ElementPasses(*iter, sh, filter, aaPos)){
+			aaKeepVOL[*iter] = true;
+			KeepSides(grid, *iter, 3, aaKeepVRT, aaKeepEDGE, aaKeepFACE);
+		}
+	}
+
+	for(FaceIterator iter = grid.begin<Face>(); iter != grid.end<Face>(); ++iter){
+		if(aaKeepFACE[*iter] || ElementPasses(*iter, sh, filter, aaPos)){
+			aaKeepFACE[*iter] = true;
+			KeepSides(grid, *iter, 2, aaKeepVRT, aaKeepEDGE, aaKeepFACE);
+		}
+	}
+
+	for(EdgeIterator iter = grid.begin<Edge>(); iter != grid.end<Edge>(); ++iter){
+		if(aaKeepEDGE[*iter] || ElementPasses(*iter, sh, filter, aaPos)){
+			aaKeepEDGE[*iter] = true;
+			KeepSides(grid, *iter, 1, aaKeepVRT, aaKeepEDGE, aaKeepFACE);
+		}
+	}
+
+	for(VertexIterator iter = grid.begin<Vertex>(); iter != grid.end<Vertex>(); ++iter){
+		if(!aaKeepVRT[*iter] && ElementPasses(*iter, sh, filter, aaPos))
+			aaKeepVRT[*iter] = true;
+	}
+
+//	erase from the highest dimension downwards, so that no kept element loses a side
+	vector<Volume*> vols;
+	CollectRejected(vols, grid, aaKeepVOL);
+	grid.erase(vols.begin(), vols.end());
+	vector<Face*> faces;
+	CollectRejected(faces, grid, aaKeepFACE);
+	grid.erase(faces.begin(), faces.end());
+	vector<Edge*> edges;
+	CollectRejected(edges, grid, aaKeepEDGE);
+	grid.erase(edges.begin(), edges.end());
+	vector<Vertex*> vrts;
+	CollectRejected(vrts, grid, aaKeepVRT);
+	grid.erase(vrts.begin(), vrts.end());
+
+	grid.detach_from_all(aKeep);
+}
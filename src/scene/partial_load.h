@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2026:  G-CSC, Goethe University Frankfurt
+ * Author: Sebastian Reiter
+ * 
+ * This file is part of ProMesh.
+ * 
+ * ProMesh is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License version 3 (as published by the
+ * Free Software Foundation) with the following additional attribution
+ * requirements (according to LGPL/GPL v3 §7):
+ * 
+ * (1) The following notice must be displayed in the Appropriate Legal Notices
+ * of covered and combined works: "Based on ProMesh (www.promesh3d.com)".
+ * 
+ * (2) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S. and Wittum, G. ProMesh -- a flexible interactive meshing software
+ *   for unstructured hybrid grids in 1, 2, and 3 dimensions. In preparation."
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#ifndef __H__PROMESH_partial_load
+#define __H__PROMESH_partial_load
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include "lg_include.h"
+
+///	Describes which part of a mesh file shall be loaded.
+/**	An element passes the filter if it belongs to one of the given subsets
+ * of the first subset handler and if the center of its corners lies inside
+ * the box. Passing elements are loaded together with their sides and
+ * corners. Lower dimensional elements which pass themselves are loaded
+ * even if they aren't the side of a loaded element.*/
+struct PartialLoadFilter{
+	PartialLoadFilter() :
+		useSubsets(false),
+		useBox(false),
+		boxMin(0, 0, 0),
+		boxMax(0, 0, 0)
+	{}
+
+	bool loads_everything() const	{return !(useSubsets || useBox);}
+
+	bool subset_passes(int si) const;
+	bool point_passes(const ug::vector3& p) const;
+
+	bool				useSubsets;
+///	subsets which shall be loaded if useSubsets is true. Sorted.
+	std::vector<int>	subsets;
+	bool				useBox;
+	ug::vector3			boxMin;
+	ug::vector3			boxMax;
+};
+
+///	Number of elements and bounding box of a subset in a mesh file.
+struct MeshFileSubsetSummary{
+	MeshFileSubsetSummary() :
+		color(0, 0, 0, -1),
+		hasBox(false),
+		boxMin(0, 0, 0),
+		boxMax(0, 0, 0)
+	{
+		for(int i = 0; i < 4; ++i)
+			numElems[i] = 0;
+	}
+
+	void add_point(const ug::vector3& p);
+
+	std::string	name;
+	ug::vector4	color;
+///	number of vertices, edges, faces and volumes
+	size_t		numElems[4];
+///	bounding box of the corners of all elements of the subset. Only valid if hasBox is true.
+	bool		hasBox;
+	ug::vector3	boxMin;
+	ug::vector3	boxMax;
+};
+
+///	The subset table of a mesh file together with the bounding boxes of the subsets.
+struct MeshFileSummary{
+	std::vector<MeshFileSubsetSummary>	subsets;
+///	elements which aren't assigned to any subset
+	MeshFileSubsetSummary				unassigned;
+///	all elements of the file
+	MeshFileSubsetSummary				total;
+};
+
+///	returns true if ReadMeshFileSummary supports the given file.
+bool MeshFileSummarySupported(const char* filename);
+
+///	reads the subset table and the bounding boxes of the subsets of a .pmb or .ugx file.
+/**	Both formats are summarized without creating a grid, except for .ugx
+ * files with constrained elements.*/
+bool ReadMeshFileSummary(const char* filename, MeshFileSummary& summaryOut);
+
+///	evaluates filter for all elements of a mesh file which wasn't loaded yet.
+/**	keepOut[dim][i] is set for the i-th element of dimension dim if it passes
+ * the filter or if it is a side or corner of a passing element.
+ * TGeom provides the positions, corner indices and the subset indices of the
+ * first subset handler of the file through num(dim), num_corners(dim, i),
+ * corner(dim, i, j), position(i) and subset_index(dim, i).*/
+template <class TGeom>
+void ComputePartialLoadKeepFlags(std::vector<char> keepOut[4], const TGeom& geom,
+								 const PartialLoadFilter& filter);
+
+///	adds the elements of geom to the counts and bounding boxes of summary.
+/**	The subsets of summary have to be set. See ComputePartialLoadKeepFlags for TGeom.*/
+template <class TGeom>
+void SummarizeMeshGeometry(MeshFileSummary& summary, const TGeom& geom);
+
+///	erases all elements of grid which are neither passing filter nor sides of passing elements.
+/**	Subsets of sh are used to evaluate the filter. Used for formats which
+ * can't evaluate the filter while they are read.*/
+void ApplyPartialLoadFilter(ug::Grid& grid, ug::ISubsetHandler& sh,
+							const PartialLoadFilter& filter);
+
+////////////////////////////////////////
+//	include implementation
+#include "partial_load_impl.hpp"
+
+#endif	//__H__PROMESH_partial_load
@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2026:  G-CSC, Goethe University Frankfurt
+ * Author: Sebastian Reiter
+ * 
+ * This file is part of ProMesh.
+ * 
+ * ProMesh is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License version 3 (as published by the
+ * Free Software Foundation) with the following additional attribution
+ * requirements (according to LGPL/GPL v3 §7):
+ * 
+ * (1) The following notice must be displayed in the Appropriate Legal Notices
+ * of covered and combined works: "Based on ProMesh (www.promesh3d.com)".
+ * 
+ * (2) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S. and Wittum, G. ProMesh -- a flexible interactive meshing software
+ *   for unstructured hybrid grids in 1, 2, and 3 dimensions. In preparation."
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#ifndef __H__PROMESH_partial_load_impl
+#define __H__PROMESH_partial_load_impl
+
+namespace partial_load_detail{
+
+///	returns true if the i-th element of dimension dim passes the filter.
+template <class TGeom>
+bool ElementPasses(const TGeom& geom, int dim, size_t i,
+				   const PartialLoadFilter& filter)
+{
+	if(filter.useSubsets && !filter.subset_passes(geom.subset_index(dim, i)))
+		return false;
+	if(!filter.useBox)
+		return true;
+
+	ug::vector3 center(0, 0, 0);
+	const size_t numCorners = geom.num_corners(dim, i);
+	for(size_t j = 0; j < numCorners; ++j)
+		VecAdd(center, center, geom.position(geom.corner(dim, i, j)));
+	VecScale(center, center, 1. / (ug::number)numCorners);
+	return filter.point_passes(center);
+}
+
+///	for each vertex, the elements of dimension dim with keep[i] != 0 which contain it.
+struct VertexOwners{
+	template <class TGeom>
+	VertexOwners(const TGeom& geom, int dim, const std::vector<char>& keep) :
+		offsets(geom.num(0) + 1, 0)
+	{
+		for(size_t i = 0; i < keep.size(); ++i){
+			if(keep[i]){
+				for(size_t j = 0; j < geom.num_corners(dim, i); ++j)
+					++offsets[geom.corner(dim, i, j) + 1];
+			}
+		}
+		for(size_t i = 1; i < offsets.size(); ++i)
+			offsets[i] += offsets[i - 1];
+
+		owners.resize(offsets.back());
+		std::vector<size_t> cur(offsets.begin(), offsets.end() - 1);
+		for(size_t i = 0; i < keep.size(); ++i){
+			if(keep[i]){
+				for(size_t j = 0; j < geom.num_corners(dim, i); ++j)
+					owners[cur[geom.corner(dim, i, j)]++] = (uint32_t)i;
+			}
+		}
+	}
+
+	std::vector<size_t>		offsets;
+	std::vector<uint32_t>	owners;
+};
+
+///	returns true if one of the owners of the first corner of the given element contains all its corners.
+template <class TGeom>
+bool IsSideOfOwner(const TGeom& geom, int dim, size_t i,
+				   const VertexOwners& owners, int ownerDim)
+{
+	const size_t numCorners = geom.num_corners(dim, i);
+	const size_t c0 = geom.corner(dim, i, 0);
+	for(size_t k = owners.offsets[c0]; k < owners.offsets[c0 + 1]; ++k){
+		const size_t o = owners.owners[k];
+		const size_t numOwnerCorners = geom.num_corners(ownerDim, o);
+		bool containsAll = true;
+		for(size_t j = 1; j < numCorners && containsAll; ++j){
+			const size_t c = geom.corner(dim, i, j);
+			containsAll = false;
+			for(size_t l = 0; l < numOwnerCorners; ++l){
+				if(geom.corner(ownerDim, o, l) == c){
+					containsAll = true;
+					break;
+				}
+			}
+		}
+		if(containsAll)
+			return true;
+	}
+	return false;
+}
+
+}//	end of namespace partial_load_detail
+
+
+template <class TGeom>
+void ComputePartialLoadKeepFlags(std::vector<char> keepOut[4], const TGeom& geom,
+								 const PartialLoadFilter& filter)
+{
+	using namespace partial_load_detail;
+	for(int dim = 0; dim < 4; ++dim){
+		keepOut[dim].resize(geom.num(dim));
+		for(size_t i = 0; i < geom.num(dim); ++i)
+			keepOut[dim][i] = ElementPasses(geom, dim, i, filter);
+	}
+
+//	faces which are sides of kept volumes and edges which are sides of kept
+//	faces or volumes. Their corners are corners of the owner.
+	VertexOwners volOwners(geom, 3, keepOut[3]);
+	for(size_t i = 0; i < geom.num(2); ++i){
+		if(!keepOut[2][i])
+			keepOut[2][i] = IsSideOfOwner(geom, 2, i, volOwners, 3);
+	}
+
+	VertexOwners faceOwners(geom, 2, keepOut[2]);
+	for(size_t i = 0; i < geom.num(1); ++i){
+		if(!keepOut[1][i]){
+			keepOut[1][i] = IsSideOfOwner(geom, 1, i, faceOwners, 2)
+							|| IsSideOfOwner(geom, 1, i, volOwners, 3);
+		}
+	}
+
+//	corners of all kept elements
+	for(int dim = 1; dim < 4; ++dim){
+		for(size_t i = 0; i < geom.num(dim); ++i){
+			if(keepOut[dim][i]){
+				for(size_t j = 0; j < geom.num_corners(dim, i); ++j)
+					keepOut[0][geom.corner(dim, i, j)] = 1;
+			}
+		}
+	}
+}
+
+
+template <class TGeom>
+void SummarizeMeshGeometry(MeshFileSummary& summary, const TGeom& geom)
+{
+	for(int dim = 0; dim < 4; ++dim){
+		for(size_t i = 0; i < geom.num(dim); ++i){
+			const int si = geom.subset_index(dim, i);
+			MeshFileSubsetSummary& s = (si >= 0 && si < (int)summary.subsets.size()) ?
+										summary.subsets[si] : summary.unassigned;
+			++s.numElems[dim];
+			++summary.total.numElems[dim];
+			for(size_t j = 0; j < geom.num_corners(dim, i); ++j)
+				s.add_point(geom.position(geom.corner(dim, i, j)));
+			if(dim == 0)
+				summary.total.add_point(geom.position(i));
+		}
+	}
+}
+
+#endif	//__H__PROMESH_partial_load_impl
@@ -0,0 +1,379 @@
+/*
+ * Copyright (c) 2026:  G-CSC, Goethe University Frankfurt
+ * Author: Sebastian Reiter
+ * 
+ * This file is part of ProMesh.
+ * 
+ * ProMesh is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License version 3 (as published by the
+ * Free Software Foundation) with the following additional attribution
+ * requirements (according to LGPL/GPL v3 §7):
+ * 
+ * (1) The following notice must be displayed in the Appropriate Legal Notices
+ * of covered and combined works: "Based on ProMesh (www.promesh3d.com)".
+ * 
+ * (2) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S. and Wittum, G. ProMesh -- a flexible interactive meshing software
+ *   for unstructured hybrid grids in 1, 2, and 3 dimensions. In preparation."
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include "pick_grid.h"
+
+using namespace std;
+using namespace ug;
+
+namespace{
+///	helps to check whether a time budget given in milliseconds was exceeded.
+class BudgetTimer
+{
+	public:
+		BudgetTimer(double budgetMs) :
+			m_start(chrono::steady_clock::now()),
+			m_budgetMs(budgetMs)
+		{}
+
+		bool exceeded() const
+		{
+			chrono::duration<double, milli> dur = chrono::steady_clock::now() - m_start;
+			return dur.count() > m_budgetMs;
+		}
+
+	private:
+		chrono::steady_clock::time_point	m_start;
+		double								m_budgetMs;
+};
+}//	end of anonymous namespace
+
+
+FacePickGrid::FacePickGrid()
+{
+	clear();
+}
+
+void FacePickGrid::clear()
+{
+	m_buildStage = BS_COLLECT;
+	m_collectStarted = false;
+	m_buildIndex = 0;
+	m_faces.clear();
+	m_faceBoxes.clear();
+	m_stamps.clear();
+	m_curStamp = 0;
+	m_res[0] = m_res[1] = m_res[2] = 1;
+	m_cellStart.clear();
+	m_cellFaces.clear();
+	m_cellFill.clear();
+}
+
+bool FacePickGrid::
+build(Grid& grid, Grid::FaceAttachmentAccessor<ABool>& aaRendered, double budgetMs)
+{
+	if(m_buildStage == BS_DONE)
+		return true;
+
+	BudgetTimer timer(budgetMs);
+
+	if(m_buildStage == BS_COLLECT){
+		if(!m_collectStarted){
+			m_collectIter = grid.begin<Face>();
+			m_collectStarted = true;
+		}
+
+		Grid::VertexAttachmentAccessor<APosition> aaPos(grid, aPosition);
+		FaceIterator iterEnd = grid.end<Face>();
+		size_t counter = 0;
+		while(m_collectIter != iterEnd){
+			Face* f = *m_collectIter;
+			++m_collectIter;
+			if(aaRendered[f]){
+				float box[6];
+				const vector3& p0 = aaPos[f->vertex(0)];
+				for(int i = 0; i < 3; ++i)
+					box[i] = box[i + 3] = (float)p0[i];
+
+				for(size_t ivrt = 1; ivrt < f->num_vertices(); ++ivrt){
+					const vector3& p = aaPos[f->vertex(ivrt)];
+					for(int i = 0; i < 3; ++i){
+						box[i] = min(box[i], (float)p[i]);
+						box[i + 3] = max(box[i + 3], (float)p[i]);
+					}
+				}
+
+				m_faces.push_back(f);
+				m_faceBoxes.insert(m_faceBoxes.end(), box, box + 6);
+			}
+
+			if((++counter & 1023) == 0 && timer.exceeded())
+				return false;
+		}
+
+		init_cells();
+		m_buildStage = BS_COUNT;
+		m_buildIndex = 0;
+	}
+
+	int cMin[3], cMax[3];
+
+	if(m_buildStage == BS_COUNT){
+		while(m_buildIndex < m_faces.size()){
+			cell_range(m_buildIndex, cMin, cMax);
+			for(int z = cMin[2]; z <= cMax[2]; ++z){
+				for(int y = cMin[1]; y <= cMax[1]; ++y){
+					for(int x = cMin[0]; x <= cMax[0]; ++x)
+						++m_cellStart[cell_index(x, y, z) + 1];
+				}
+			}
+
+			if((++m_buildIndex & 255) == 0 && timer.exceeded())
+				return false;
+		}
+
+		for(size_t i = 1; i < m_cellStart.size(); ++i)
+			m_cellStart[i] += m_cellStart[i - 1];
+
+		m_cellFaces.resize(m_cellStart.back());
+		m_cellFill.assign(m_cellStart.begin(), m_cellStart.end() - 1);
+		m_buildStage = BS_FILL;
+		m_buildIndex = 0;
+	}
+
+	if(m_buildStage == BS_FILL){
+		while(m_buildIndex < m_faces.size()){
+			cell_range(m_buildIndex, cMin, cMax);
+			for(int z = cMin[2]; z <= cMax[2]; ++z){
+				for(int y = cMin[1]; y <= cMax[1]; ++y){
+					for(int x = cMin[0]; x <= cMax[0]; ++x)
+						m_cellFaces[m_cellFill[cell_index(x, y, z)]++] = (unsigned int)m_buildIndex;
+				}
+			}
+
+			if((++m_buildIndex & 255) == 0 && timer.exceeded())
+				return false;
+		}
+
+		vector<unsigned int>().swap(m_cellFill);
+		m_buildStage = BS_DONE;
+	}
+
+	return true;
+}
+
+void FacePickGrid::init_cells()
+{
+	const size_t numFaces = m_faces.size();
+	m_stamps.assign(numFaces, 0);
+	m_curStamp = 0;
+
+	if(numFaces == 0){
+		m_min = m_max = vector3(0, 0, 0);
+		m_cellSize = vector3(1, 1, 1);
+		m_res[0] = m_res[1] = m_res[2] = 1;
+		m_cellStart.assign(2, 0);
+		return;
+	}
+
+	for(int i = 0; i < 3; ++i){
+		m_min[i] = m_faceBoxes[i];
+		m_max[i] = m_faceBoxes[i + 3];
+	}
+
+	for(size_t iface = 1; iface < numFaces; ++iface){
+		const float* box = &m_faceBoxes[6 * iface];
+		for(int i = 0; i < 3; ++i){
+			m_min[i] = min<number>(m_min[i], box[i]);
+			m_max[i] = max<number>(m_max[i], box[i + 3]);
+		}
+	}
+
+//	flat objects still need a non-degenerated box
+	vector3 ext;
+	VecSubtract(ext, m_max, m_min);
+	number maxExt = max(ext[0], max(ext[1], ext[2]));
+	if(maxExt <= 0)
+		maxExt = 1;
+
+	for(int i = 0; i < 3; ++i){
+		ext[i] = max(ext[i], maxExt * 1.e-3) * (1. + 1.e-6);
+		m_max[i] = m_min[i] + ext[i];
+	}
+
+//	aim at about one face per cell
+	const int maxRes = 256;
+	number k = pow((number)numFaces / (ext[0] * ext[1] * ext[2]), 1./3.);
+	for(int i = 0; i < 3; ++i){
+		m_res[i] = max(1, min(maxRes, (int)ceil(ext[i] * k)));
+		m_cellSize[i] = ext[i] / (number)m_res[i];
+	}
+
+	m_cellStart.assign((size_t)m_res[0] * m_res[1] * m_res[2] + 1, 0);
+}
+
+void FacePickGrid::
+cell_range(size_t faceInd, int minOut[3], int maxOut[3]) const
+{
+	const float* box = &m_faceBoxes[6 * faceInd];
+	for(int i = 0; i < 3; ++i){
+		minOut[i] = (int)((box[i] - m_min[i]) / m_cellSize[i]);
+		maxOut[i] = (int)((box[i + 3] - m_min[i]) / m_cellSize[i]);
+		minOut[i] = max(0, min(m_res[i] - 1, minOut[i]));
+		maxOut[i] = max(0, min(m_res[i] - 1, maxOut[i]));
+	}
+}
+
+bool FacePickGrid::
+test_cell(size_t cellInd, const vector3& from, const vector3& dir,
+		  Grid::VertexAttachmentAccessor<APosition>& aaPos,
+		  Grid::FaceAttachmentAccessor<ANormal>& aaNorm,
+		  bool ignoreFront, bool ignoreBack,
+		  Face*& bestFaceInOut, number& bestTInOut)
+{
+	bool gotOne = false;
+	for(unsigned int i = m_cellStart[cellInd]; i < m_cellStart[cellInd + 1]; ++i){
+		const unsigned int faceInd = m_cellFaces[i];
+	//	faces which span several cells are only tested once per pick
+		if(m_stamps[faceInd] == m_curStamp)
+			continue;
+		m_stamps[faceInd] = m_curStamp;
+
+		Face* f = m_faces[faceInd];
+		number normDot = VecDot(aaNorm[f], dir);
+		if((ignoreBack && normDot > 0) || (ignoreFront && normDot < 0))
+			continue;
+
+		vector3 v;
+		number bc1, bc2, t;
+		bool intersecting = RayTriangleIntersection(v, bc1, bc2, t,
+												aaPos[f->vertex(0)],
+												aaPos[f->vertex(1)],
+												aaPos[f->vertex(2)],
+												from, dir);
+		if(!intersecting && f->num_vertices() == 4){
+			intersecting = RayTriangleIntersection(v, bc1, bc2, t,
+												aaPos[f->vertex(0)],
+												aaPos[f->vertex(2)],
+												aaPos[f->vertex(3)],
+												from, dir);
+		}
+
+		if(intersecting && t > 0 && t < bestTInOut){
+			bestFaceInOut = f;
+			bestTInOut = t;
+			gotOne = true;
+		}
+	}
+	return gotOne;
+}
+
+Face* FacePickGrid::
+pick(const vector3& from, const vector3& to,
+	 Grid::VertexAttachmentAccessor<APosition>& aaPos,
+	 Grid::FaceAttachmentAccessor<ANormal>& aaNorm,
+	 bool ignoreFront, bool ignoreBack,
+	 double budgetMs, bool& timedOutOut)
+{
+	timedOutOut = false;
+	if(!is_complete()){
+		timedOutOut = true;
+		return NULL;
+	}
+
+	if(m_faces.empty())
+		return NULL;
+
+	BudgetTimer timer(budgetMs);
+
+	vector3 dir;
+	VecSubtract(dir, to, from);
+
+//	clip the ray against the box of the grid. The ray is parameterized
+//	as from + t * dir with t in [0, 1].
+	number tEnter = 0;
+	number tExit = 1;
+	for(int i = 0; i < 3; ++i){
+		if(fabs(dir[i]) < SMALL){
+			if(from[i] < m_min[i] || from[i] > m_max[i])
+				return NULL;
+		}
+		else{
+			number t1 = (m_min[i] - from[i]) / dir[i];
+			number t2 = (m_max[i] - from[i]) / dir[i];
+			if(t1 > t2)
+				swap(t1, t2);
+			tEnter = max(tEnter, t1);
+			tExit = min(tExit, t2);
+			if(tEnter > tExit)
+				return NULL;
+		}
+	}
+
+//	initialize the traversal (Amanatides and Woo)
+	const number inf = numeric_limits<number>::max();
+	int c[3], step[3];
+	number tMax[3], tDelta[3];
+	for(int i = 0; i < 3; ++i){
+		number p = from[i] + tEnter * dir[i];
+		c[i] = max(0, min(m_res[i] - 1, (int)((p - m_min[i]) / m_cellSize[i])));
+		if(fabs(dir[i]) < SMALL){
+			step[i] = 0;
+			tMax[i] = inf;
+			tDelta[i] = inf;
+		}
+		else if(dir[i] > 0){
+			step[i] = 1;
+			tMax[i] = (m_min[i] + (c[i] + 1) * m_cellSize[i] - from[i]) / dir[i];
+			tDelta[i] = m_cellSize[i] / dir[i];
+		}
+		else{
+			step[i] = -1;
+			tMax[i] = (m_min[i] + c[i] * m_cellSize[i] - from[i]) / dir[i];
+			tDelta[i] = -m_cellSize[i] / dir[i];
+		}
+	}
+
+	if(++m_curStamp == 0){
+	//	the stamp overflowed. Reset all stamps.
+		fill(m_stamps.begin(), m_stamps.end(), 0);
+		m_curStamp = 1;
+	}
+
+	Face* bestFace = NULL;
+	number bestT = inf;
+	size_t numCellsVisited = 0;
+
+	while(true){
+		test_cell(cell_index(c[0], c[1], c[2]), from, dir, aaPos, aaNorm,
+				  ignoreFront, ignoreBack, bestFace, bestT);
+
+		int axis = 0;
+		if(tMax[1] < tMax[axis])	axis = 1;
+		if(tMax[2] < tMax[axis])	axis = 2;
+
+	//	a hit inside the current cell can't be occluded by faces in later cells
+		if(bestFace && bestT <= tMax[axis])
+			break;
+		if(tMax[axis] > tExit)
+			break;
+
+		c[axis] += step[axis];
+		if(c[axis] < 0 || c[axis] >= m_res[axis])
+			break;
+		tMax[axis] += tDelta[axis];
+
+		if((++numCellsVisited & 15) == 0 && timer.exceeded()){
+			timedOutOut = true;
+			return NULL;
+		}
+	}
+
+	return bestFace;
+}
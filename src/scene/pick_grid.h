@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2026:  G-CSC, Goethe University Frankfurt
+ * Author: Sebastian Reiter
+ * 
+ * This file is part of ProMesh.
+ * 
+ * ProMesh is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License version 3 (as published by the
+ * Free Software Foundation) with the following additional attribution
+ * requirements (according to LGPL/GPL v3 §7):
+ * 
+ * (1) The following notice must be displayed in the Appropriate Legal Notices
+ * of covered and combined works: "Based on ProMesh (www.promesh3d.com)".
+ * 
+ * (2) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S. and Wittum, G. ProMesh -- a flexible interactive meshing software
+ *   for unstructured hybrid grids in 1, 2, and 3 dimensions. In preparation."
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#ifndef __H__PROMESH_pick_grid
+#define __H__PROMESH_pick_grid
+
+#include <vector>
+#include "lg_include.h"
+
+///	A uniform grid over the rendered faces of a grid, used to accelerate ray picks.
+/**	Building the structure for huge grids takes too long to be done in one go
+ * on the GUI thread. build may thus be called repeatedly with a time budget
+ * and continues where the last call stopped.
+ *
+ * The structure does not observe the grid. It has to be cleared by its owner
+ * whenever faces are created, erased, moved or change their rendered state.*/
+class FacePickGrid
+{
+	public:
+		FacePickGrid();
+
+	///	releases all data. The next call to build will start from scratch.
+		void clear();
+
+	///	true if build has processed all faces
+		bool is_complete() const	{return m_buildStage == BS_DONE;}
+
+	///	continues building for at most budgetMs milliseconds.
+	/**	Only faces for which aaRendered is true are considered.
+	 * \return true if the structure is complete.*/
+		bool build(ug::Grid& grid,
+				   ug::Grid::FaceAttachmentAccessor<ug::ABool>& aaRendered,
+				   double budgetMs);
+
+	///	returns the face which is closest to 'from' and which intersects the ray (from, to).
+	/**	Faces whose normal points towards (away from) the ray origin are
+	 * ignored if ignoreFront (ignoreBack) is true.
+	 * If the time budget is exceeded or if the structure is not complete,
+	 * NULL is returned and timedOutOut is set to true.*/
+		ug::Face* pick(const ug::vector3& from, const ug::vector3& to,
+					   ug::Grid::VertexAttachmentAccessor<ug::APosition>& aaPos,
+					   ug::Grid::FaceAttachmentAccessor<ug::ANormal>& aaNorm,
+					   bool ignoreFront, bool ignoreBack,
+					   double budgetMs, bool& timedOutOut);
+
+	private:
+		enum BuildStage{
+			BS_COLLECT,
+			BS_COUNT,
+			BS_FILL,
+			BS_DONE
+		};
+
+		void init_cells();
+		void cell_range(size_t faceInd, int minOut[3], int maxOut[3]) const;
+		inline size_t cell_index(int x, int y, int z) const
+			{return ((size_t)z * m_res[1] + (size_t)y) * m_res[0] + (size_t)x;}
+
+		bool test_cell(size_t cellInd, const ug::vector3& from, const ug::vector3& dir,
+					   ug::Grid::VertexAttachmentAccessor<ug::APosition>& aaPos,
+					   ug::Grid::FaceAttachmentAccessor<ug::ANormal>& aaNorm,
+					   bool ignoreFront, bool ignoreBack,
+					   ug::Face*& bestFaceInOut, ug::number& bestTInOut);
+
+	private:
+		BuildStage					m_buildStage;
+		bool						m_collectStarted;
+		ug::FaceIterator			m_collectIter;
+		size_t						m_buildIndex;
+
+		std::vector<ug::Face*>		m_faces;
+	///	min and max corners of the bounding box of each face (6 floats per face)
+		std::vector<float>			m_faceBoxes;
+		std::vector<unsigned int>	m_stamps;
+		unsigned int				m_curStamp;
+
+		ug::vector3					m_min;
+		ug::vector3					m_max;
+		ug::vector3					m_cellSize;
+		int							m_res[3];
+	///	m_cellFaces[m_cellStart[i]] to m_cellFaces[m_cellStart[i+1]] are the faces in cell i.
+		std::vector<unsigned int>	m_cellStart;
+		std::vector<unsigned int>	m_cellFaces;
+		std::vector<unsigned int>	m_cellFill;
+};
+
+#endif	//__H__PROMESH_pick_grid
@@ -26,10 +26,11 @@
  */
 
 #include <vector>
+#include <QProgressDialog>
 #include "app.h"
 #include "standard_tools.h"
 #include "tools_util.h"
-#include "heightfields/interpolated_heightfield.h"
+#include "heightfields/apply_heightfield.h"
 #include "tools/coordinate_transform_tools.h"
 #include "tooltips.h"
 
@@ -126,13 +127,15 @@ public:
 		ToolWidget* dlg = dynamic_cast<ToolWidget*>(widget);
 
 		QString filename;
+		bool applyToSelection = false;
 		if(dlg){
 			filename = dlg->to_string(0);
+			applyToSelection = (dlg->to_int(1) == 0);
 		}
 
 		if(!filename.isEmpty()){
-			InterpolatedHeightfield interpHf;
-			IHeightfield* hf = &interpHf;
+			unique_ptr<IHeightfield> hf =
+				CreateHeightfieldForFile(filename.toStdString().c_str());
 
 			LGObject* obj = app::getActiveObject();
 			if(!obj)
@@ -146,19 +149,39 @@ public:
 
 			CalculateBoundingBox(min, max, g.vertices_begin(), g.vertices_end(), aaPos);
 
-			if(hf->initialize(filename.toStdString().c_str(), min.x(), min.y(),
+			if(!hf->initialize(filename.toStdString().c_str(), min.x(), min.y(),
 							max.x(), max.y()))
 			{
-			//	iterate over all nodes and adjust height.
-				for(Grid::traits<Vertex>::iterator iter = g.vertices_begin();
-					iter != g.vertices_end(); ++iter)
-				{
-					vector3& v = aaPos[*iter];
-					v.z() = hf->height(v.x(), v.y());
-				}
+				UG_LOG("ERROR in Apply Heightfield: Couldn't load "
+					   << filename.toStdString() << "\n");
+				return;
 			}
 
-			obj->geometry_changed();
+			GridObjectCollection goc;
+			if(applyToSelection)
+				goc = obj->selector().get_grid_objects();
+			else
+				goc = g.get_grid_objects();
+			vector<Vertex*> vrts(goc.begin<Vertex>(), goc.end<Vertex>());
+
+		//	the dialog only shows up if the application takes a while
+			const int progressSteps = 1000;
+			QProgressDialog progressDlg(tr("Applying heightfield..."), tr("Cancel"),
+										0, progressSteps, widget);
+			progressDlg.setWindowModality(Qt::WindowModal);
+			progressDlg.setMinimumDuration(500);
+
+			bool applied = ApplyHeightfield(*hf, vrts, aaPos,
+				[&progressDlg](size_t numDone, size_t numTotal) -> bool
+				{
+					progressDlg.setValue((int)((progressSteps * numDone) / numTotal));
+					return !progressDlg.wasCanceled();
+				});
+
+			if(applied)
+				obj->geometry_changed();
+			else
+				UG_LOG("Apply Heightfield was canceled.\n");
 		}
 
 	}
@@ -171,6 +194,10 @@ public:
 		ToolWidget *dlg = new ToolWidget(get_name(), parent, this,
 								IDB_APPLY | IDB_OK | IDB_CLOSE);
 		dlg->addFileBrowser(tr("heightfield:"), FWT_OPEN, "*.*");
+		QStringList entries;
+		entries.push_back(tr("selection"));
+		entries.push_back(tr("object"));
+		dlg->addComboBox(tr("target:"), entries, 1);
 		return dlg;
 	}
 };
@@ -174,14 +174,6 @@ class ToolMergeMeshes : public ITool
 
 		//	create a new empty object and merge the selected ones into it
 			LGObject* mergedObj = app::createEmptyObject(mergedObjName.toStdString().c_str(), SOT_LG);
-			Grid& mrgGrid = mergedObj->grid();
-			SubsetHandler& mrgSH = mergedObj->subset_handler();
-
-		//	The position attachment for mrgGrid
-			Grid::AttachmentAccessor<Vertex, APosition> aaPosMRG(mrgGrid, aPosition);
-
-		//	we'll use this attachment later on on the vertices of each source grid.
-			AVertex aVrt;
 
 		//	iterate through all selected objects and copy their content to mergedObj
 			LGScene* scene = app::getActiveScene();
@@ -193,82 +185,7 @@ class ToolMergeMeshes : public ITool
 					return;
 				}
 
-				LGObject* obj = scene->get_object(objInd);
-				Grid& grid = obj->grid();
-				SubsetHandler& sh = obj->subset_handler();
-
-			//	if we're joining subsets, the subsetBaseInd is always 0. If
-			//	we're not joining subsets, then subsetBaseInd has to be set
-			//	to the current max subset.
-				int subsetBaseInd = 0;
-				if(!joinSubsets)
-					subsetBaseInd = mrgSH.num_subsets();
-
-			//	we need an attachment, which tells us the associated vertex in
-			//	mrgGrid for each vertex in grid.
-				Grid::AttachmentAccessor<Vertex, AVertex> aaVrt(grid, aVrt, true);
-
-			//	and we need an accessor for the position attachment
-				Grid::AttachmentAccessor<Vertex, APosition> aaPos(grid, aPosition);
-
-			//	copy vertices
-				for(VertexIterator iter = grid.begin<Vertex>();
-					iter != grid.end<Vertex>(); ++iter)
-				{
-					Vertex* nvrt = *mrgGrid.create_by_cloning(*iter);
-					aaPosMRG[nvrt] = aaPos[*iter];
-					aaVrt[*iter] = nvrt;
-					mrgSH.assign_subset(nvrt, subsetBaseInd + sh.get_subset_index(*iter));
-				}
-
-			//	copy edges
-				EdgeDescriptor ed;
-				for(EdgeIterator iter = grid.begin<Edge>();
-					iter != grid.end<Edge>(); ++iter)
-				{
-					Edge* eSrc = *iter;
-					ed.set_vertices(aaVrt[eSrc->vertex(0)], aaVrt[eSrc->vertex(1)]);
-					Edge* e = *mrgGrid.create_by_cloning(eSrc, ed);
-					mrgSH.assign_subset(e, subsetBaseInd + sh.get_subset_index(eSrc));
-				}
-
-			//	copy faces
-				FaceDescriptor fd;
-				for(FaceIterator iter = grid.begin<Face>();
-					iter != grid.end<Face>(); ++iter)
-				{
-					Face* fSrc = *iter;
-					fd.set_num_vertices((uint)fSrc->num_vertices());
-					for(size_t i = 0; i < fd.num_vertices(); ++i)
-						fd.set_vertex((uint)i, aaVrt[fSrc->vertex(i)]);
-
-					Face* f = *mrgGrid.create_by_cloning(fSrc, fd);
-					mrgSH.assign_subset(f, subsetBaseInd + sh.get_subset_index(fSrc));
-				}
-
-			//	copy volumes
-				VolumeDescriptor vd;
-				for(VolumeIterator iter = grid.begin<Volume>();
-					iter != grid.end<Volume>(); ++iter)
-				{
-					Volume* vSrc = *iter;
-					vd.set_num_vertices((uint)vSrc->num_vertices());
-					for(size_t i = 0; i < vd.num_vertices(); ++i)
-						vd.set_vertex((uint)i, aaVrt[vSrc->vertex(i)]);
-
-					Volume* v = *mrgGrid.create_by_cloning(vSrc, vd);
-					mrgSH.assign_subset(v, subsetBaseInd + sh.get_subset_index(vSrc));
-				}
-
-			//	remove the temporary attachment
-				grid.detach_from_vertices(aVrt);
-
-			//	now copy the names of the subset handler
-			//	we overwrite old subset-infos if the name of the new one is not
-			//	empty.
-				for(int i_sub = 0; i_sub < sh.num_subsets(); ++i_sub){
-					mrgSH.subset_info(subsetBaseInd + i_sub) = sh.subset_info(i_sub);
-				}
+				MergeLGObject(mergedObj, scene->get_object(objInd), joinSubsets);
 			}
 
 			scene->object_changed(mergedObj);
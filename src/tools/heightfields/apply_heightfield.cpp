@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2026:  G-CSC, Goethe University Frankfurt
+ * Author: Sebastian Reiter
+ * 
+ * This file is part of ProMesh.
+ * 
+ * ProMesh is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License version 3 (as published by the
+ * Free Software Foundation) with the following additional attribution
+ * requirements (according to LGPL/GPL v3 §7):
+ * 
+ * (1) The following notice must be displayed in the Appropriate Legal Notices
+ * of covered and combined works: "Based on ProMesh (www.promesh3d.com)".
+ * 
+ * (2) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S. and Wittum, G. ProMesh -- a flexible interactive meshing software
+ *   for unstructured hybrid grids in 1, 2, and 3 dimensions. In preparation."
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include <algorithm>
+#include "apply_heightfield.h"
+#include "interpolated_heightfield.h"
+#include "raster_heightfield.h"
+#include "common/profiler/profiler.h"
+#include "util/parallel_util.h"
+
+using namespace std;
+
+namespace ug{
+
+namespace{
+///	number of vertices which are passed to IHeightfield::heights at once
+const size_t HEIGHTFIELD_BLOCK_SIZE = 1024;
+///	number of vertices between two calls to the progress function
+const size_t HEIGHTFIELD_BATCH_SIZE = 1 << 18;
+}
+
+unique_ptr<IHeightfield> CreateHeightfieldForFile(const char* filename)
+{
+	if(RasterHeightfield::supports_file(filename))
+		return unique_ptr<IHeightfield>(new RasterHeightfield);
+	return unique_ptr<IHeightfield>(new InterpolatedHeightfield);
+}
+
+bool ApplyHeightfield(IHeightfield& hf, const vector<Vertex*>& vrts,
+					  Grid::VertexAttachmentAccessor<APosition>& aaPos,
+					  const HeightfieldProgressFunc& progress)
+{
+	PROFILE_FUNC();
+	const size_t numVrts = vrts.size();
+	vector<number> heights(numVrts);
+
+	for(size_t batchBegin = 0; batchBegin < numVrts; batchBegin += HEIGHTFIELD_BATCH_SIZE){
+		const size_t batchEnd = min(numVrts, batchBegin + HEIGHTFIELD_BATCH_SIZE);
+		const size_t numBlocks = (batchEnd - batchBegin + HEIGHTFIELD_BLOCK_SIZE - 1)
+								 / HEIGHTFIELD_BLOCK_SIZE;
+
+		ParallelForChunks(numBlocks, 1, [&](size_t, size_t blocksBegin, size_t blocksEnd){
+		//	the coordinates are gathered into plain arrays, so that hf can
+		//	process them in tight loops
+			number x[HEIGHTFIELD_BLOCK_SIZE];
+			number y[HEIGHTFIELD_BLOCK_SIZE];
+			for(size_t b = blocksBegin; b < blocksEnd; ++b){
+				const size_t begin = batchBegin + b * HEIGHTFIELD_BLOCK_SIZE;
+				const size_t num = min(HEIGHTFIELD_BLOCK_SIZE, batchEnd - begin);
+				for(size_t i = 0; i < num; ++i){
+					const vector3& p = aaPos[vrts[begin + i]];
+					x[i] = p.x();
+					y[i] = p.y();
+				}
+				hf.heights(&heights[begin], x, y, num);
+			}
+		});
+
+		if(progress && !progress(batchEnd, numVrts))
+			return false;
+	}
+
+	for(size_t i = 0; i < numVrts; ++i)
+		aaPos[vrts[i]].z() = heights[i];
+	return true;
+}
+
+}//	end of namespace
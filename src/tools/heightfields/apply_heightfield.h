@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2026:  G-CSC, Goethe University Frankfurt
+ * Author: Sebastian Reiter
+ * 
+ * This file is part of ProMesh.
+ * 
+ * ProMesh is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License version 3 (as published by the
+ * Free Software Foundation) with the following additional attribution
+ * requirements (according to LGPL/GPL v3 §7):
+ * 
+ * (1) The following notice must be displayed in the Appropriate Legal Notices
+ * of covered and combined works: "Based on ProMesh (www.promesh3d.com)".
+ * 
+ * (2) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S. and Wittum, G. ProMesh -- a flexible interactive meshing software
+ *   for unstructured hybrid grids in 1, 2, and 3 dimensions. In preparation."
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#ifndef __H__PROMESH_apply_heightfield
+#define __H__PROMESH_apply_heightfield
+
+#include <functional>
+#include <memory>
+#include <vector>
+#include "lib_grid/lib_grid.h"
+#include "heightfield_interface.h"
+
+namespace ug
+{
+
+///	creates the heightfield which reads the given file. The type is chosen by the suffix.
+/**	Raster DEMs (.asc, .flt) are read by a RasterHeightfield, all other
+ * files by an InterpolatedHeightfield.*/
+std::unique_ptr<IHeightfield> CreateHeightfieldForFile(const char* filename);
+
+///	called with the number of evaluated and the total number of vertices. Returning false cancels.
+typedef std::function<bool (size_t numDone, size_t numTotal)>	HeightfieldProgressFunc;
+
+///	sets the z-coordinate of each vertex to the height of hf at its x- and y-coordinates.
+/**	The heights are evaluated concurrently in blocks of vertices through
+ * IHeightfield::heights and are assigned once all of them are known.
+ * progress is called on the calling thread after each batch of vertices.
+ * If it returns false, the application is canceled and no vertex is moved.
+ *
+ * hf has to be initialized.
+ * \returns false if the application was canceled.*/
+bool ApplyHeightfield(IHeightfield& hf, const std::vector<Vertex*>& vrts,
+					  Grid::VertexAttachmentAccessor<APosition>& aaPos,
+					  const HeightfieldProgressFunc& progress = HeightfieldProgressFunc());
+
+}//	end of namespace
+
+#endif	//__H__PROMESH_apply_heightfield
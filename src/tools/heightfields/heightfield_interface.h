@@ -28,6 +28,7 @@
 #ifndef __H__UG__heightfield_interface__
 #define __H__UG__heightfield_interface__
 
+#include <cstddef>
 #include "common/types.h"
 
 namespace ug
@@ -42,6 +43,16 @@ class IHeightfield
 		virtual bool initialize(const char* filename, number xMin, number yMin, number xMax, number yMax) = 0;
 
 		virtual number height(number x, number y) = 0;
+
+	///	evaluates the heights at the points (x[i], y[i]), i < num.
+	/**	Has to be safe to call concurrently for different ranges once the
+	 * heightfield was initialized.*/
+		virtual void heights(number* heightsOut, const number* x, const number* y, size_t num)
+		{
+			for(size_t i = 0; i < num; ++i)
+				heightsOut[i] = height(x[i], y[i]);
+		}
+
 		virtual ~IHeightfield() {}
 };
 
@@ -0,0 +1,426 @@
+/*
+ * Copyright (c) 2026:  G-CSC, Goethe University Frankfurt
+ * Author: Sebastian Reiter
+ * 
+ * This file is part of ProMesh.
+ * 
+ * ProMesh is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License version 3 (as published by the
+ * Free Software Foundation) with the following additional attribution
+ * requirements (according to LGPL/GPL v3 §7):
+ * 
+ * (1) The following notice must be displayed in the Appropriate Legal Notices
+ * of covered and combined works: "Based on ProMesh (www.promesh3d.com)".
+ * 
+ * (2) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S. and Wittum, G. ProMesh -- a flexible interactive meshing software
+ *   for unstructured hybrid grids in 1, 2, and 3 dimensions. In preparation."
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QSaveFile>
+#include "interpolated_heightfield.h"
+#include "common/log.h"
+#include "common/profiler/profiler.h"
+#include "util/mapped_file.h"
+#include "util/parallel_util.h"
+#include "util/text_parsing.h"
+
+using namespace std;
+
+namespace ug{
+
+namespace{
+
+///	header of the binary cache of a .mesh file. Followed by the coordinates.
+struct HeightfieldCacheHeader{
+	char		magic[8];
+///	size and modification time (ms since epoch) of the .mesh file from which the cache was created
+	int64_t		sourceSize;
+	int64_t		sourceModified;
+///	HEIGHTFIELD_CACHE_BYTE_ORDER as written by the creating machine
+	uint32_t	byteOrder;
+	int32_t		rows;
+	int32_t		columns;
+	uint32_t	reserved;
+};
+
+const char HEIGHTFIELD_CACHE_MAGIC[8] = {'P', 'M', 'H', 'F', 'C', '0', '1', '\0'};
+const uint32_t HEIGHTFIELD_CACHE_BYTE_ORDER = 0x01020304;
+
+///	fills the size and modification time of the given file into header
+bool GetSourceStamp(HeightfieldCacheHeader& header, const char* filename)
+{
+	QFileInfo info(QString::fromLocal8Bit(filename));
+	if(!info.exists())
+		return false;
+	header.sourceSize = info.size();
+	header.sourceModified = info.lastModified().toMSecsSinceEpoch();
+	return true;
+}
+
+///	parses the first maxNum non-empty ';' separated values of a line.
+/**	Values which aren't numbers are read as 0. Returns the number of
+ * non-empty tokens, which may exceed maxNum.*/
+int ParseMeshRow(const char* p, const char* lineEnd, double* valsOut, int maxNum)
+{
+	int numTokens = 0;
+	while(p < lineEnd){
+		const char* tokenEnd = static_cast<const char*>(memchr(p, ';', lineEnd - p));
+		if(!tokenEnd)
+			tokenEnd = lineEnd;
+		if(tokenEnd > p){
+			if(numTokens < maxNum){
+				double val = 0;
+				if(!ParseNumber(SkipSpaces(p, tokenEnd), tokenEnd, val))
+					val = 0;
+				valsOut[numTokens] = val;
+			}
+			++numTokens;
+		}
+		p = tokenEnd + 1;
+	}
+	return numTokens;
+}
+
+///	returns true if the values are ascending with a constant step.
+bool IsEquidistant(const vector<double>& vals)
+{
+	if(vals.size() < 2)
+		return false;
+	const double step = (vals.back() - vals.front()) / (vals.size() - 1);
+	if(!(step > 0))
+		return false;
+	for(size_t i = 1; i < vals.size(); ++i){
+		if(fabs(vals[i] - (vals.front() + i * step)) > 0.5 * step)
+			return false;
+	}
+	return true;
+}
+
+///	returns the index of the first value >= val in ascending vals or vals.size().
+/**	If equidistant is true, the index is guessed from the step size and
+ * corrected by a few comparisons. The result always equals lower_bound.*/
+int FindFirstGreaterOrEqual(const vector<double>& vals, double val, bool equidistant)
+{
+	const int num = (int)vals.size();
+	if(!equidistant)
+		return (int)(lower_bound(vals.begin(), vals.end(), val) - vals.begin());
+
+	const double step = (vals.back() - vals.front()) / (num - 1);
+	const double guess = ceil((val - vals.front()) / step);
+	int i = guess <= 0 ? 0 : (guess >= num ? num : (int)guess);
+	while(i > 0 && vals[i - 1] >= val)
+		--i;
+	while(i < num && vals[i] < val)
+		++i;
+	return i;
+}
+
+}//	end of anonymous namespace
+
+
+int InterpolatedHeightfield::
+readmesh(const char* filename)
+{
+	PROFILE_FUNC();
+	cleanupDataMemory();
+
+	const string cacheFilename = string(filename) + ".cache";
+	if(read_cache(cacheFilename.c_str(), filename))
+		return 0;
+
+	MappedFile file;
+	if(!file.open(filename))
+		return -1;
+
+	const char* data = file.data();
+	const char* dataEnd = data + file.size();
+
+//	the first two lines contain the number of rows and columns
+	int64_t header[2];
+	const char* p = data;
+	for(int i = 0; i < 2; ++i){
+		if(p >= dataEnd)
+			return -2;
+		const char* lineEnd = FindLineEnd(p, dataEnd);
+		if(!ParseInt(SkipSpaces(p, lineEnd), lineEnd, header[i]))
+			header[i] = 0;
+		p = NextLine(lineEnd, dataEnd);
+	}
+
+	if(header[0] <= 0 || header[1] <= 0 || header[0] > 0x7FFFFFFF || header[1] > 0x7FFFFFFF)
+		return -3;
+
+//	x, y and z coordinates are stored in rows lines each
+	const size_t numLines = 3 * header[0];
+	vector<const char*> lines;
+	lines.reserve(numLines + 1);
+	while(lines.size() < numLines && p < dataEnd){
+		lines.push_back(p);
+		p = NextLine(FindLineEnd(p, dataEnd), dataEnd);
+	}
+	if(lines.size() < numLines)
+		return -2;
+	lines.push_back(p);
+
+	rows = (int)header[0];
+	columns = (int)header[1];
+	m_coords.resize(numLines * columns);
+
+	vector<char> rowValid(numLines, 1);
+	ParallelForChunks(numLines, 64, [&](size_t, size_t begin, size_t end){
+		for(size_t i = begin; i < end; ++i){
+			const char* lineEnd = FindLineEnd(lines[i], lines[i + 1]);
+			if(ParseMeshRow(lines[i], lineEnd, &m_coords[i * columns], columns) < columns)
+				rowValid[i] = 0;
+		}
+	});
+
+	for(size_t i = 0; i < numLines; ++i){
+		if(!rowValid[i]){
+			cleanupDataMemory();
+			return -4;
+		}
+	}
+
+	write_cache(cacheFilename.c_str(), filename);
+	return 0;
+}
+
+
+bool InterpolatedHeightfield::
+read_cache(const char* cacheFilename, const char* meshFilename)
+{
+	HeightfieldCacheHeader source;
+	if(!GetSourceStamp(source, meshFilename))
+		return false;
+
+	MappedFile file;
+	if(!QFileInfo(QString::fromLocal8Bit(cacheFilename)).exists()
+	   || !file.open(cacheFilename)
+	   || file.size() < sizeof(HeightfieldCacheHeader))
+	{
+		return false;
+	}
+
+	HeightfieldCacheHeader header;
+	memcpy(&header, file.data(), sizeof(header));
+	if(memcmp(header.magic, HEIGHTFIELD_CACHE_MAGIC, sizeof(header.magic)) != 0
+	   || header.byteOrder != HEIGHTFIELD_CACHE_BYTE_ORDER
+	   || header.sourceSize != source.sourceSize
+	   || header.sourceModified != source.sourceModified
+	   || header.rows <= 0 || header.columns <= 0)
+	{
+		return false;
+	}
+
+	const size_t numCoords = 3 * (size_t)header.rows * (size_t)header.columns;
+	if(file.size() != sizeof(header) + numCoords * sizeof(double))
+		return false;
+
+	rows = header.rows;
+	columns = header.columns;
+	m_coords.resize(numCoords);
+	memcpy(&m_coords.front(), file.data() + sizeof(header), numCoords * sizeof(double));
+	return true;
+}
+
+
+void InterpolatedHeightfield::
+write_cache(const char* cacheFilename, const char* meshFilename)
+{
+	HeightfieldCacheHeader header;
+	memset(&header, 0, sizeof(header));
+	if(!GetSourceStamp(header, meshFilename))
+		return;
+	memcpy(header.magic, HEIGHTFIELD_CACHE_MAGIC, sizeof(header.magic));
+	header.byteOrder = HEIGHTFIELD_CACHE_BYTE_ORDER;
+	header.rows = rows;
+	header.columns = columns;
+
+//	the cache is optional. If it can't be written (e.g. in a read-only
+//	directory), the .mesh file is simply parsed again next time.
+	QSaveFile out(QString::fromLocal8Bit(cacheFilename));
+	const qint64 dataSize = (qint64)(m_coords.size() * sizeof(double));
+	if(!out.open(QIODevice::WriteOnly)
+	   || out.write(reinterpret_cast<const char*>(&header), sizeof(header)) != (qint64)sizeof(header)
+	   || out.write(reinterpret_cast<const char*>(&m_coords.front()), dataSize) != dataSize
+	   || !out.commit())
+	{
+		UG_LOG("WARNING: Couldn't write heightfield cache " << cacheFilename << "\n");
+	}
+}
+
+
+void InterpolatedHeightfield::
+build_index()
+{
+	PROFILE_FUNC();
+	m_xs.clear();
+	m_ys.clear();
+	m_bucketStart.clear();
+	m_bucketPoints.clear();
+	m_bucketMin.clear();
+	m_bucketSuffixMin.clear();
+	if(m_coords.empty())
+		return;
+
+//	check whether the grid is rectilinear with ascending coordinates
+	bool rectilinear = true;
+	for(int j = 0; j < columns && rectilinear; ++j){
+		if(j > 0 && xcoord(0, j) < xcoord(0, j - 1))
+			rectilinear = false;
+		for(int i = 1; i < rows && rectilinear; ++i){
+			if(xcoord(i, j) != xcoord(0, j))
+				rectilinear = false;
+		}
+	}
+	for(int i = 0; i < rows && rectilinear; ++i){
+		if(i > 0 && ycoord(i, 0) < ycoord(i - 1, 0))
+			rectilinear = false;
+		for(int j = 1; j < columns && rectilinear; ++j){
+			if(ycoord(i, j) != ycoord(i, 0))
+				rectilinear = false;
+		}
+	}
+
+	if(rectilinear){
+		m_xs.resize(columns);
+		for(int j = 0; j < columns; ++j)
+			m_xs[j] = xcoord(0, j);
+		m_ys.resize(rows);
+		for(int i = 0; i < rows; ++i)
+			m_ys[i] = ycoord(i, 0);
+		m_equidistantX = IsEquidistant(m_xs);
+		m_equidistantY = IsEquidistant(m_ys);
+		return;
+	}
+
+//	irregular grid. Sort the points into about one bucket per point.
+	const int numPoints = rows * columns;
+	m_minX = m_maxX = xcoord(0, 0);
+	m_minY = m_maxY = ycoord(0, 0);
+	for(int i = 0; i < rows; ++i){
+		for(int j = 0; j < columns; ++j){
+			m_minX = min(m_minX, xcoord(i, j));
+			m_maxX = max(m_maxX, xcoord(i, j));
+			m_minY = min(m_minY, ycoord(i, j));
+			m_maxY = max(m_maxY, ycoord(i, j));
+		}
+	}
+
+	const int numBuckets = max(1, min(2048, (int)sqrt((double)numPoints)));
+	m_numBucketsX = m_numBucketsY = numBuckets;
+	m_bucketWidthX = (m_maxX - m_minX) / numBuckets;
+	m_bucketWidthY = (m_maxY - m_minY) / numBuckets;
+
+	const size_t totalBuckets = (size_t)m_numBucketsX * m_numBucketsY;
+	vector<int> pointBuckets(numPoints);
+	m_bucketStart.assign(totalBuckets + 1, 0);
+	for(int i = 0; i < numPoints; ++i){
+		const int b = bucket_index(bucket_x(m_coords[i]), bucket_y(m_coords[numPoints + i]));
+		pointBuckets[i] = b;
+		++m_bucketStart[b + 1];
+	}
+	for(size_t b = 0; b < totalBuckets; ++b)
+		m_bucketStart[b + 1] += m_bucketStart[b];
+
+//	points are visited in ascending order, so each bucket is sorted
+	m_bucketPoints.resize(numPoints);
+	vector<int> fill(m_bucketStart.begin(), m_bucketStart.end() - 1);
+	for(int i = 0; i < numPoints; ++i)
+		m_bucketPoints[fill[pointBuckets[i]]++] = i;
+
+	m_bucketMin.assign(totalBuckets, numPoints);
+	for(size_t b = 0; b < totalBuckets; ++b){
+		if(m_bucketStart[b] < m_bucketStart[b + 1])
+			m_bucketMin[b] = m_bucketPoints[m_bucketStart[b]];
+	}
+
+	const int sx = m_numBucketsX + 1;
+	m_bucketSuffixMin.assign((size_t)sx * (m_numBucketsY + 1), numPoints);
+	for(int by = m_numBucketsY - 1; by >= 0; --by){
+		for(int bx = m_numBucketsX - 1; bx >= 0; --bx){
+			m_bucketSuffixMin[by * sx + bx] =
+				min(m_bucketMin[bucket_index(bx, by)],
+					min(m_bucketSuffixMin[by * sx + bx + 1],
+						m_bucketSuffixMin[(by + 1) * sx + bx]));
+		}
+	}
+}
+
+
+bool InterpolatedHeightfield::
+locate(double x, double y, int& iOut, int& jOut) const
+{
+	if(m_coords.empty())
+		return false;
+
+	if(!m_xs.empty()){
+		jOut = FindFirstGreaterOrEqual(m_xs, x, m_equidistantX);
+		iOut = FindFirstGreaterOrEqual(m_ys, y, m_equidistantY);
+		return jOut < columns && iOut < rows;
+	}
+
+	int ind;
+	if(!locate_in_buckets(x, y, ind))
+		return false;
+	iOut = ind / columns;
+	jOut = ind % columns;
+	return true;
+}
+
+
+bool InterpolatedHeightfield::
+locate_in_buckets(double x, double y, int& indOut) const
+{
+	const int numPoints = rows * columns;
+	if(x > m_maxX || y > m_maxY)
+		return false;
+
+//	all points in buckets (bx, by) with bx > qx and by > qy lie in the
+//	searched quadrant. Points in the row and column of (qx, qy) have to be checked.
+	const int qx = bucket_x(x);
+	const int qy = bucket_y(y);
+	const int sx = m_numBucketsX + 1;
+	int best = m_bucketSuffixMin[(qy + 1) * sx + qx + 1];
+
+	for(int pass = 0; pass < 2; ++pass){
+		const int num = pass == 0 ? m_numBucketsY - qy : m_numBucketsX - qx - 1;
+		for(int k = 0; k < num; ++k){
+			const int b = pass == 0 ? bucket_index(qx, qy + k) : bucket_index(qx + 1 + k, qy);
+			if(m_bucketMin[b] >= best)
+				continue;
+			for(int l = m_bucketStart[b]; l < m_bucketStart[b + 1]; ++l){
+				const int p = m_bucketPoints[l];
+				if(p >= best)
+					break;
+				if(m_coords[p] >= x && m_coords[numPoints + p] >= y){
+					best = p;
+					break;
+				}
+			}
+		}
+	}
+
+	if(best >= numPoints)
+		return false;
+	indOut = best;
+	return true;
+}
+
+}//	end of namespace
@@ -30,6 +30,7 @@
 
 #include <iostream>
 #include <fstream>
+#include <algorithm>
 #include <string>
 #include <vector>
 #include "heightfield_interface.h"
@@ -49,8 +50,9 @@ public:
 	InterpolatedHeightfield()
 	{
 		// der Konstruktor der Klasse setzt alle Variablen auf ihre Anfangswerte
-		X = Y = Z = 0;
 		rows = columns = 0;
+		m_equidistantX = m_equidistantY = false;
+		m_numBucketsX = m_numBucketsY = 0;
 	}
 
 	~InterpolatedHeightfield()
@@ -74,10 +76,27 @@ public:
 
 	bool initialize(const char* filename, number xMin, number yMin, number xMax, number yMax)
 	{
-		return readmesh( filename ) == 0;
+		if(readmesh( filename ) != 0)
+			return false;
+		build_index();
+		return true;
 	}
 
 	number height(number x, number y)
+	{
+		return evaluate(x, y);
+	}
+
+	void heights(number* heightsOut, const number* x, const number* y, size_t num)
+	{
+		for(size_t i = 0; i < num; ++i)
+			heightsOut[i] = evaluate(x[i], y[i]);
+	}
+
+
+private:
+	// hier kommen Sachen hin, die nur diese Klasse interessieren, also deine Funktionen readline oder interpoliere
+	double evaluate(double x, double y) const
 	{
 		int			idx_a_i=0, idx_a_j=0,
 		idx_b_i=0, idx_b_j=0,
@@ -86,299 +105,125 @@ public:
 		double		alpha;
 		double		z, z_ab, z_cd;
 
-		if(X==0)	// Keine Daten bisher gelesen?
+		if(m_coords.empty())	// Keine Daten bisher gelesen?
 			return 0;
 
 		// in welchem gitterquadrat sich (x,y) befindet
-		for(int i=0; i<rows; i++) {
-			for(int j=0; j<columns; j++) {
-				//printf("%f %f\n", X[i], Y[j]);
-				if(X[i][j] >= x && Y[i][j]>= y) {
-					idx_d_i = i;
-					idx_d_j = j;
-					idx_c_i = i;
-					idx_c_j = j-1;
-					idx_b_i = i-1;
-					idx_b_j = j;
-					idx_a_i = i-1;
-					idx_a_j = j-1;
-					goto stop;
-				}
-			}
+		int i, j;
+		if(locate(x, y, i, j)) {
+			idx_d_i = i;
+			idx_d_j = j;
+			idx_c_i = i;
+			idx_c_j = j-1;
+			idx_b_i = i-1;
+			idx_b_j = j;
+			idx_a_i = i-1;
+			idx_a_j = j-1;
 		}
-	stop:
 
 		//printf("%d %d\n", idx_d_i, idx_d_j);
 
 		if(idx_d_i==0 && idx_d_j==0) {
-			z= Z[idx_d_i][idx_d_j];	// kein a, b, c
+			z= zcoord(idx_d_i, idx_d_j);	// kein a, b, c
 		}else if(idx_d_i==0) {
-			alpha = (x - X[idx_c_i][idx_c_j]) / (X[idx_d_i][idx_d_j] - X[idx_c_i][idx_c_j]);
-			z = interpoliere(Z[idx_c_i][idx_c_j], Z[idx_d_i][idx_d_j], alpha);	//interpoliere c und d (ber x-koordinate)
+			alpha = (x - xcoord(idx_c_i, idx_c_j)) / (xcoord(idx_d_i, idx_d_j) - xcoord(idx_c_i, idx_c_j));
+			z = interpoliere(zcoord(idx_c_i, idx_c_j), zcoord(idx_d_i, idx_d_j), alpha);	//interpoliere c und d (ber x-koordinate)
 		}else if(idx_d_j==0) {
-			alpha = (y - Y[idx_b_i][idx_b_j]) / (Y[idx_d_i][idx_d_j] - Y[idx_b_i][idx_b_j]);
-			z = interpoliere(Z[idx_b_i][idx_b_j], Z[idx_d_i][idx_d_j], alpha);	//interpoliere b und d (ber y-koordinate)
+			alpha = (y - ycoord(idx_b_i, idx_b_j)) / (ycoord(idx_d_i, idx_d_j) - ycoord(idx_b_i, idx_b_j));
+			z = interpoliere(zcoord(idx_b_i, idx_b_j), zcoord(idx_d_i, idx_d_j), alpha);	//interpoliere b und d (ber y-koordinate)
 		}else {
-			alpha = (x - X[idx_c_i][idx_c_j]) / (X[idx_d_i][idx_d_j] - X[idx_c_i][idx_c_j]);	// Allgemeinfall
-			z_ab = interpoliere(Z[idx_a_i][idx_a_j], Z[idx_b_i][idx_b_j], alpha);
-			z_cd = interpoliere(Z[idx_c_i][idx_c_j], Z[idx_d_i][idx_d_j], alpha);
-			alpha = (y - Y[idx_a_i][idx_a_j]) / (Y[idx_c_i][idx_c_j] - Y[idx_a_i][idx_a_j]);
+			alpha = (x - xcoord(idx_c_i, idx_c_j)) / (xcoord(idx_d_i, idx_d_j) - xcoord(idx_c_i, idx_c_j));	// Allgemeinfall
+			z_ab = interpoliere(zcoord(idx_a_i, idx_a_j), zcoord(idx_b_i, idx_b_j), alpha);
+			z_cd = interpoliere(zcoord(idx_c_i, idx_c_j), zcoord(idx_d_i, idx_d_j), alpha);
+			alpha = (y - ycoord(idx_a_i, idx_a_j)) / (ycoord(idx_c_i, idx_c_j) - ycoord(idx_a_i, idx_a_j));
 			z = interpoliere(z_ab, z_cd, alpha);
 		}
 
 		return z;
 	}
 
+	///	reads a .mesh file or its binary cache. Returns 0 on success.
+	/**	The cache is stored next to the .mesh file and is rebuilt whenever
+	 * the size or the modification time of the .mesh file changes.*/
+	int readmesh( const char* filename );
 
-private:
-	// hier kommen Sachen hin, die nur diese Klasse interessieren, also deine Funktionen readline oder interpoliere
-	int readmesh( const char* filename ) {
-		using namespace std;
-		ifstream	f;
-		string		line;
-		//char		*token;
-		//size_t  	size = 1024;
-		int		err=0;
-		vector<std::string>	tokens;
-
-		cleanupDataMemory();	// Lsche Daten, falls schon vorher mal verwendet wurde
-
-		//		line = (char*)malloc(size);
-		f.open(filename);
-
-		if(!f.good()) {
-			err=-1;
-			goto ende2;
-		}
-
-		getline( f, line );
-		rows = atoi(line.c_str());
-
-		if(!f.good()) {
-			err=-2;
-			goto ende2;
-		}
-		getline( f, line );
-		columns = atoi (line.c_str());
-
-		if(columns<=0 || rows<=0) {
-			err=-3;
-			goto ende;
-		}
+	bool read_cache(const char* cacheFilename, const char* meshFilename);
+	void write_cache(const char* cacheFilename, const char* meshFilename);
 
-		if(!f.good()) {
-			err=-2;
-			goto ende2;
-		}
-
-		//		printf("%d %d\n",rows,columns);
-
-		if(!allocateDataMemory())
-			goto ende;
-
-
-		for(int i=0; i<rows; i++) {
-			if(f.good()) {
-				getline( f, line );
-			}else {
-				err=-2;
-				cleanupDataMemory();
-				goto ende;
-			}
-
-			if(TokenizeString(line, ";", true, tokens)<(size_t)columns) {
-				err=-4;
-				cleanupDataMemory();
-				goto ende;
-			}
-			for(int j=0; j<columns; j++) {
-				X[i][j] = atof( tokens[j].c_str() );
-			}
-		}
+	///	finds the first grid point (i, j) in row major order whose x- and y-coordinates are >= (x, y).
+	/**	Returns false if there is no such point. Uses the lookup structures
+	 * created by build_index.*/
+	bool locate(double x, double y, int& iOut, int& jOut) const;
 
+	///	prepares the lookup of grid points.
+	/**	If all rows share the same x-coordinates and all columns the same
+	 * y-coordinates, points are found by index arithmetic (equidistant) or
+	 * binary search. Otherwise the points are sorted into buckets.*/
+	void build_index();
 
-		for(int i=0; i<rows; i++) {
-			if(f.good()) {
-				getline( f, line );
-			}else {
-				err=-2;
-				cleanupDataMemory();
-				goto ende;
-			}
-
-			if(TokenizeString(line, ";", true, tokens)<(size_t)columns) {
-				err=-4;
-				cleanupDataMemory();
-				goto ende;
-			}
-			for(int j=0; j<columns; j++) {
-				Y[i][j] = atof( tokens[j].c_str() );
-			}
-		}
-
+	bool locate_in_buckets(double x, double y, int& indOut) const;
 
-		for(int i=0; i<rows; i++) {
-			if(f.good()) {
-				getline( f, line );
-			}else {
-				err=-2;
-				cleanupDataMemory();
-				goto ende;
-			}
-
-			if(TokenizeString(line, ";", true, tokens)<(size_t)columns) {
-				err=-4;
-				cleanupDataMemory();
-				goto ende;
-			}
-			for(int j=0; j<columns; j++) {
-				Z[i][j] = atof( tokens[j].c_str() );
-			}
-		}
-	ende:
-		f.close();
-	ende2:
-
-		/*	for(int k=0; k<rows*columns; k++)
-		 *		printf("%f\n",X[k]);
-		 */
-		return err;
+	int bucket_x(double x) const
+	{
+		if(!(m_bucketWidthX > 0) || x <= m_minX)
+			return 0;
+		return std::min(m_numBucketsX - 1, (int)((x - m_minX) / m_bucketWidthX));
 	}
 
-	double interpoliere(double a, double b, double alpha) {
-		return (a*(1-alpha) + (b*alpha));
+	int bucket_y(double y) const
+	{
+		if(!(m_bucketWidthY > 0) || y <= m_minY)
+			return 0;
+		return std::min(m_numBucketsY - 1, (int)((y - m_minY) / m_bucketWidthY));
 	}
 
-	/*	char *readline( FILE *f, char **buffer, size_t *size ) {
-	 int     read;
-
-	 read = getline(buffer, size, f);
-
-	 if(read<0)
-	 return 0;
-
-	 return *buffer;
-	 }
-	 */
-	bool allocateDataMemory() {
-		//X = (double**)malloc(rows*sizeof(double*));
-		X = new double*[rows];
-		if(X)
-			memset(X, 0, rows*sizeof(double*));
-		//Y = (double**)malloc(rows*sizeof(double*));
-		Y = new double*[rows];
-		if(Y)
-			memset(Y, 0, rows*sizeof(double*));
-		//Z = (double**)malloc(rows*sizeof(double*));
-		Z = new double*[rows];
-		if(Z)
-			memset(Z, 0, rows*sizeof(double*));
-
-		if(X==0 || Y==0 || Z==0) {
-			cleanupDataMemory();
-			return false;
-		}
-		for(int k=0; k<rows; k++) {
-			//X[k] = (double*)malloc(columns*sizeof(double));
-			X[k] = new double[columns];
-			if(!X[k]) {
-				cleanupDataMemory();
-				return false;
-			}
-		}
-		for(int k=0; k<rows; k++) {
-			//Y[k] = (double*)malloc(columns*sizeof(double));
-			Y[k] = new double[columns];
-			if(!Y[k]) {
-				cleanupDataMemory();
-				return false;
-			}
-		}
-		for(int k=0; k<rows; k++) {
-			//Z[k] = (double*)malloc(columns*sizeof(double));
-			Z[k] = new double[columns];
-			if(!Z[k]) {
-				cleanupDataMemory();
-				return false;
-			}
-		}
-		return true;
+	int bucket_index(int bx, int by) const	{return by * m_numBucketsX + bx;}
+
+	double interpoliere(double a, double b, double alpha) const {
+		return (a*(1-alpha) + (b*alpha));
 	}
 
 	void cleanupDataMemory() {
-		if(X) {
-			for(int i=0; i<rows; i++)
-				if(X[i])
-					delete[](X[i]);
-				else
-					break;
-			delete[] X;
-			X=0;
-		}
-		if(Y) {
-			for(int i=0; i<rows; i++)
-				if(Y[i])
-					delete[](Y[i]);
-				else
-					break;
-			delete[] Y;
-			Y=0;
-		}
-		if(Z) {
-			for(int i=0; i<rows; i++)
-				if(Z[i])
-					delete[](Z[i]);
-				else
-					break;
-			delete[] Z;
-			Z=0;
-		}
+		m_coords.clear();
+		m_xs.clear();
+		m_ys.clear();
+		m_bucketStart.clear();
+		m_bucketPoints.clear();
+		m_bucketMin.clear();
+		m_bucketSuffixMin.clear();
 		rows = columns = 0;
 	}
 
-
-
-	/* Hilfsfunktion um einen String zu zerlegen */
-	unsigned TokenizeString(const std::string& i_source,
-							const std::string& i_seperators,
-							bool i_discard_empty_tokens,
-							std::vector<std::string>& o_tokens)
-	{
-		size_t prev_pos = 0;
-		size_t pos = 0;
-		unsigned number_of_tokens = 0;
-
-		o_tokens.clear();
-		pos = i_source.find_first_of(i_seperators, pos);
-		while (pos != std::string::npos)
-		{
-			std::string token = i_source.substr(prev_pos, pos - prev_pos);
-			if (!i_discard_empty_tokens || token != "")
-			{
-				o_tokens.push_back(token);
-				number_of_tokens++;
-			}
-
-			pos++;
-			prev_pos = pos;
-			pos = i_source.find_first_of(i_seperators, pos);
-		}
-
-		if (prev_pos < i_source.length())
-		{
-			o_tokens.push_back(i_source.substr(prev_pos));
-			number_of_tokens++;
-		}
-
-		return number_of_tokens;
-	}
+	double xcoord(int i, int j) const	{return m_coords[(size_t)i * columns + j];}
+	double ycoord(int i, int j) const	{return m_coords[((size_t)rows + i) * columns + j];}
+	double zcoord(int i, int j) const	{return m_coords[((size_t)2 * rows + i) * columns + j];}
 
 	// hier kommen die variablen hin, die bei dir vorher global waren, also
-	double **X;
-	double **Y;
-	double **Z;
+///	the x, y and z coordinates of all rows one after another in a single allocation
+	std::vector<double> m_coords;
 	int rows;
 	int columns;
+
+///	x-coordinates of the columns and y-coordinates of the rows. Only used for rectilinear grids.
+	std::vector<double> m_xs;
+	std::vector<double> m_ys;
+	bool m_equidistantX;
+	bool m_equidistantY;
+
+///	buckets of a grid with irregular coordinates
+/**	m_bucketPoints contains the row major indices of the points of bucket b
+ * in ascending order at [m_bucketStart[b], m_bucketStart[b+1]).
+ * m_bucketMin holds the smallest index of each bucket and
+ * m_bucketSuffixMin(bx, by) the smallest index in all buckets (bx', by')
+ * with bx' >= bx and by' >= by.*/
+	int m_numBucketsX;
+	int m_numBucketsY;
+	double m_minX, m_minY, m_maxX, m_maxY;
+	double m_bucketWidthX, m_bucketWidthY;
+	std::vector<int> m_bucketStart;
+	std::vector<int> m_bucketPoints;
+	std::vector<int> m_bucketMin;
+	std::vector<int> m_bucketSuffixMin;
 };
 
 // Das ist ein total einfaches heightfield, zum testen
@@ -0,0 +1,421 @@
+/*
+ * Copyright (c) 2026:  G-CSC, Goethe University Frankfurt
+ * Author: Sebastian Reiter
+ * 
+ * This file is part of ProMesh.
+ * 
+ * ProMesh is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License version 3 (as published by the
+ * Free Software Foundation) with the following additional attribution
+ * requirements (according to LGPL/GPL v3 §7):
+ * 
+ * (1) The following notice must be displayed in the Appropriate Legal Notices
+ * of covered and combined works: "Based on ProMesh (www.promesh3d.com)".
+ * 
+ * (2) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S. and Wittum, G. ProMesh -- a flexible interactive meshing software
+ *   for unstructured hybrid grids in 1, 2, and 3 dimensions. In preparation."
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <string>
+#include <stdint.h>
+#include <QString>
+#include <QSysInfo>
+#include "raster_heightfield.h"
+#include "common/log.h"
+#include "common/profiler/profiler.h"
+#include "util/mapped_file.h"
+#include "util/parallel_util.h"
+#include "util/text_parsing.h"
+
+using namespace std;
+
+namespace ug{
+
+namespace{
+
+bool HasSuffix(const char* filename, const char* suffix)
+{
+	const char* p = strrchr(filename, '.');
+	if(!p)
+		return false;
+	string s(p);
+	transform(s.begin(), s.end(), s.begin(), ::tolower);
+	return s == suffix;
+}
+
+bool StartsNumber(char c)
+{
+	return IsDigit(c) || c == '-' || c == '+' || c == '.';
+}
+
+inline uint32_t SwapBytes(uint32_t v)
+{
+	return (v >> 24) | ((v >> 8) & 0xFF00) | ((v << 8) & 0xFF0000) | (v << 24);
+}
+
+}//	end of anonymous namespace
+
+
+RasterHeightfield::Header::
+Header() :
+	numCols(0),
+	numRows(0),
+	xCenter(0),
+	yCenter(0),
+	cellSize(0),
+	noData(0),
+	hasNoData(false),
+	msbFirst(false)
+{}
+
+
+RasterHeightfield::
+RasterHeightfield()
+{
+	clear();
+}
+
+
+RasterHeightfield::
+~RasterHeightfield()
+{
+	clear();
+}
+
+
+bool RasterHeightfield::
+supports_file(const char* filename)
+{
+	return HasSuffix(filename, ".asc") || HasSuffix(filename, ".flt");
+}
+
+
+void RasterHeightfield::
+clear()
+{
+	for(size_t i = 0; i < m_tiles.size(); ++i){
+		if(m_tiles[i])
+			m_file.unmap(m_tiles[i]);
+	}
+	m_tiles.clear();
+	if(m_file.isOpen())
+		m_file.close();
+	m_values.clear();
+	m_rows.clear();
+	m_header = Header();
+	m_yTop = 0;
+	m_rowBegin = m_rowEnd = m_colBegin = m_colEnd = 0;
+	m_rowColOffset = 0;
+	m_swapBytes = false;
+}
+
+
+bool RasterHeightfield::
+initialize(const char* filename, number xMin, number yMin, number xMax, number yMax)
+{
+	PROFILE_FUNC();
+	clear();
+	bool success = false;
+	if(HasSuffix(filename, ".asc"))
+		success = load_ascii(filename, xMin, yMin, xMax, yMax);
+	else if(HasSuffix(filename, ".flt"))
+		success = load_float(filename, xMin, yMin, xMax, yMax);
+	else
+		UG_LOG("ERROR in RasterHeightfield: Unsupported file " << filename << "\n");
+
+	if(!success)
+		clear();
+	return success;
+}
+
+
+bool RasterHeightfield::
+read_header(Header& headerOut, const char* data, const char* end,
+			const char** dataBeginOut)
+{
+	map<string, double> vals;
+	string byteOrder;
+	const char* p = data;
+	while(p < end){
+		const char* lineEnd = FindLineEnd(p, end);
+		const char* q = SkipSpaces(p, lineEnd);
+		if(q < lineEnd && StartsNumber(*q))
+			break;
+
+		const char* keyEnd = q;
+		while(keyEnd < lineEnd && !IsSpace(*keyEnd))
+			++keyEnd;
+		string key(q, keyEnd);
+		transform(key.begin(), key.end(), key.begin(), ::tolower);
+		const char* valBegin = SkipSpaces(keyEnd, lineEnd);
+
+		if(key == "byteorder"){
+			byteOrder.assign(valBegin, lineEnd);
+			transform(byteOrder.begin(), byteOrder.end(), byteOrder.begin(), ::tolower);
+		}
+		else if(!key.empty()){
+			double val;
+			if(ParseNumber(valBegin, lineEnd, val))
+				vals[key] = val;
+		}
+		p = NextLine(lineEnd, end);
+	}
+
+	if(dataBeginOut)
+		*dataBeginOut = p;
+
+	Header& h = headerOut;
+	if(!vals.count("ncols") || !vals.count("nrows") || !vals.count("cellsize")
+	   || !(vals.count("xllcorner") || vals.count("xllcenter"))
+	   || !(vals.count("yllcorner") || vals.count("yllcenter")))
+	{
+		UG_LOG("ERROR in RasterHeightfield: Incomplete raster header.\n");
+		return false;
+	}
+
+	h.numCols = (int)vals["ncols"];
+	h.numRows = (int)vals["nrows"];
+	h.cellSize = vals["cellsize"];
+	if(h.numCols <= 0 || h.numRows <= 0 || !(h.cellSize > 0)){
+		UG_LOG("ERROR in RasterHeightfield: Invalid raster dimensions.\n");
+		return false;
+	}
+
+	if(vals.count("xllcenter"))
+		h.xCenter = vals["xllcenter"];
+	else
+		h.xCenter = vals["xllcorner"] + 0.5 * h.cellSize;
+	if(vals.count("yllcenter"))
+		h.yCenter = vals["yllcenter"];
+	else
+		h.yCenter = vals["yllcorner"] + 0.5 * h.cellSize;
+
+	h.hasNoData = vals.count("nodata_value") > 0;
+	if(h.hasNoData)
+		h.noData = vals["nodata_value"];
+	h.msbFirst = (byteOrder.compare(0, 3, "msb") == 0 || byteOrder == "m");
+	return true;
+}
+
+
+void RasterHeightfield::
+set_window(number xMin, number yMin, number xMax, number yMax)
+{
+	const Header& h = m_header;
+	m_yTop = h.yCenter + (h.numRows - 1) * h.cellSize;
+
+	const double colMin = floor((xMin - h.xCenter) / h.cellSize) - 1;
+	const double colMax = ceil((xMax - h.xCenter) / h.cellSize) + 2;
+	const double rowMin = floor((m_yTop - yMax) / h.cellSize) - 1;
+	const double rowMax = ceil((m_yTop - yMin) / h.cellSize) + 2;
+
+	m_colBegin = (int)max(0., min(colMin, h.numCols - 1.));
+	m_colEnd = (int)max(m_colBegin + 1., min(colMax, (double)h.numCols));
+	m_rowBegin = (int)max(0., min(rowMin, h.numRows - 1.));
+	m_rowEnd = (int)max(m_rowBegin + 1., min(rowMax, (double)h.numRows));
+}
+
+
+bool RasterHeightfield::
+load_ascii(const char* filename, number xMin, number yMin, number xMax, number yMax)
+{
+	MappedFile file;
+	if(!file.open(filename)){
+		UG_LOG("ERROR in RasterHeightfield: Couldn't open " << filename << "\n");
+		return false;
+	}
+
+	const char* end = file.data() + file.size();
+	const char* p;
+	if(!read_header(m_header, file.data(), end, &p))
+		return false;
+	set_window(xMin, yMin, xMax, yMax);
+
+//	each row of the raster is stored in one line. Lines above the window are skipped.
+	const int numWindowRows = m_rowEnd - m_rowBegin;
+	vector<const char*> lines;
+	lines.reserve(numWindowRows + 1);
+	for(int row = 0; row < m_rowEnd && p < end; ++row){
+		if(row >= m_rowBegin)
+			lines.push_back(p);
+		p = NextLine(FindLineEnd(p, end), end);
+	}
+	if((int)lines.size() < numWindowRows){
+		UG_LOG("ERROR in RasterHeightfield: Too few rows in " << filename << "\n");
+		return false;
+	}
+	lines.push_back(p);
+
+	const int numWindowCols = m_colEnd - m_colBegin;
+	m_values.resize((size_t)numWindowRows * numWindowCols);
+	vector<char> rowValid(numWindowRows, 1);
+	ParallelForChunks(numWindowRows, 16, [&](size_t, size_t rowsBegin, size_t rowsEnd){
+		for(size_t i = rowsBegin; i < rowsEnd; ++i){
+			const char* q = lines[i];
+			const char* lineEnd = FindLineEnd(q, lines[i + 1]);
+			float* valsOut = &m_values[i * numWindowCols];
+			for(int col = 0; col < m_colEnd; ++col){
+				double val;
+				q = ParseNumber(SkipSpaces(q, lineEnd), lineEnd, val);
+				if(!q){
+					rowValid[i] = 0;
+					break;
+				}
+				if(col >= m_colBegin)
+					valsOut[col - m_colBegin] = (float)val;
+			}
+		}
+	});
+
+	for(int i = 0; i < numWindowRows; ++i){
+		if(!rowValid[i]){
+			UG_LOG("ERROR in RasterHeightfield: Invalid values in row "
+				   << m_rowBegin + i << " of " << filename << "\n");
+			return false;
+		}
+	}
+
+	m_rows.resize(numWindowRows);
+	for(int i = 0; i < numWindowRows; ++i)
+		m_rows[i] = reinterpret_cast<const char*>(&m_values[(size_t)i * numWindowCols]);
+	m_rowColOffset = m_colBegin;
+	m_swapBytes = false;
+	return true;
+}
+
+
+bool RasterHeightfield::
+load_float(const char* filename, number xMin, number yMin, number xMax, number yMax)
+{
+	string hdrName(filename);
+	hdrName.replace(hdrName.size() - 4, 4, ".hdr");
+	MappedFile hdrFile;
+	if(!hdrFile.open(hdrName.c_str())){
+		UG_LOG("ERROR in RasterHeightfield: Couldn't open " << hdrName << "\n");
+		return false;
+	}
+	if(!read_header(m_header, hdrFile.data(), hdrFile.data() + hdrFile.size(), NULL))
+		return false;
+	set_window(xMin, yMin, xMax, yMax);
+
+	const Header& h = m_header;
+	const qint64 rowBytes = (qint64)h.numCols * sizeof(float);
+	m_file.setFileName(QString::fromLocal8Bit(filename));
+	if(!m_file.open(QIODevice::ReadOnly) || m_file.size() < rowBytes * h.numRows){
+		UG_LOG("ERROR in RasterHeightfield: Couldn't open " << filename
+			   << " or the file is smaller than stated in " << hdrName << "\n");
+		return false;
+	}
+
+//	map the tiles which contain the rows of the window
+	const int firstTile = m_rowBegin / TILE_ROWS;
+	const int lastTile = (m_rowEnd - 1) / TILE_ROWS;
+	m_rows.resize(m_rowEnd - m_rowBegin);
+	for(int tile = firstTile; tile <= lastTile; ++tile){
+		const int tileRowBegin = tile * TILE_ROWS;
+		const int tileRowEnd = min(h.numRows, tileRowBegin + TILE_ROWS);
+		uchar* mapped = m_file.map(tileRowBegin * rowBytes,
+								   (tileRowEnd - tileRowBegin) * rowBytes);
+		if(!mapped){
+			UG_LOG("ERROR in RasterHeightfield: Couldn't map rows of " << filename << "\n");
+			return false;
+		}
+		m_tiles.push_back(mapped);
+
+		for(int row = max(tileRowBegin, m_rowBegin); row < min(tileRowEnd, m_rowEnd); ++row){
+			m_rows[row - m_rowBegin] =
+				reinterpret_cast<const char*>(mapped) + (row - tileRowBegin) * rowBytes;
+		}
+	}
+
+	m_rowColOffset = 0;
+	m_swapBytes = (h.msbFirst != (QSysInfo::ByteOrder == QSysInfo::BigEndian));
+	return true;
+}
+
+
+float RasterHeightfield::
+value(int row, int col) const
+{
+	uint32_t bits;
+	memcpy(&bits, m_rows[row - m_rowBegin] + (col - m_rowColOffset) * sizeof(float),
+		   sizeof(bits));
+	if(m_swapBytes)
+		bits = SwapBytes(bits);
+	float val;
+	memcpy(&val, &bits, sizeof(val));
+	return val;
+}
+
+
+bool RasterHeightfield::
+is_valid(float val) const
+{
+	if(val != val)
+		return false;
+	return !m_header.hasNoData || val != (float)m_header.noData;
+}
+
+
+double RasterHeightfield::
+evaluate(double x, double y) const
+{
+	if(m_rows.empty())
+		return 0;
+
+//	continuous column and row indices, clamped to the window
+	const double fc = max((double)m_colBegin, min((x - m_header.xCenter) / m_header.cellSize,
+												  m_colEnd - 1.));
+	const double fr = max((double)m_rowBegin, min((m_yTop - y) / m_header.cellSize,
+												  m_rowEnd - 1.));
+	const int c0 = (int)fc;
+	const int r0 = (int)fr;
+	const int c1 = min(c0 + 1, m_colEnd - 1);
+	const int r1 = min(r0 + 1, m_rowEnd - 1);
+	const double ax = fc - c0;
+	const double ay = fr - r0;
+
+	const float vals[4] = {value(r0, c0), value(r0, c1), value(r1, c0), value(r1, c1)};
+	const double weights[4] = {(1. - ax) * (1. - ay), ax * (1. - ay),
+							   (1. - ax) * ay, ax * ay};
+
+	double sum = 0;
+	double weightSum = 0;
+	for(int i = 0; i < 4; ++i){
+		if(is_valid(vals[i])){
+			sum += weights[i] * vals[i];
+			weightSum += weights[i];
+		}
+	}
+
+	if(weightSum > 0)
+		return sum / weightSum;
+
+//	the point lies exactly on a cell without data or all neighbors lack data
+	for(int i = 0; i < 4; ++i){
+		if(is_valid(vals[i]))
+			return vals[i];
+	}
+	return 0;
+}
+
+
+void RasterHeightfield::
+heights(number* heightsOut, const number* x, const number* y, size_t num)
+{
+	for(size_t i = 0; i < num; ++i)
+		heightsOut[i] = evaluate(x[i], y[i]);
+}
+
+}//	end of namespace
@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2026:  G-CSC, Goethe University Frankfurt
+ * Author: Sebastian Reiter
+ * 
+ * This file is part of ProMesh.
+ * 
+ * ProMesh is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License version 3 (as published by the
+ * Free Software Foundation) with the following additional attribution
+ * requirements (according to LGPL/GPL v3 §7):
+ * 
+ * (1) The following notice must be displayed in the Appropriate Legal Notices
+ * of covered and combined works: "Based on ProMesh (www.promesh3d.com)".
+ * 
+ * (2) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S. and Wittum, G. ProMesh -- a flexible interactive meshing software
+ *   for unstructured hybrid grids in 1, 2, and 3 dimensions. In preparation."
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#ifndef __H__PROMESH_raster_heightfield
+#define __H__PROMESH_raster_heightfield
+
+#include <string>
+#include <vector>
+#include <QFile>
+#include "heightfield_interface.h"
+
+namespace ug
+{
+
+///	Heightfield which is read from a raster DEM and bilinearly interpolated between cell centers.
+/**	Supported are ESRI ASCII grids (.asc) and ESRI GridFloat rasters (.flt),
+ * raw 32 bit floats whose layout is described by a .hdr file of the same name.
+ *
+ * Only the rows and columns which cover the rectangle passed to initialize
+ * (plus a margin of one cell) are used. Rows of .flt rasters are memory
+ * mapped in tiles of TILE_ROWS rows and are read from the mapping, so only
+ * the pages touched by the mesh are loaded and rasters larger than the main
+ * memory can be applied. .asc files only store the covered values. Each
+ * row of an .asc file has to be stored in a separate line.
+ *
+ * Points outside of the raster get the height of the closest border cell.
+ * Cells with the nodata value are ignored during interpolation. If all
+ * surrounding cells lack data, the height is 0.*/
+class RasterHeightfield : public IHeightfield
+{
+	public:
+		static const int TILE_ROWS = 256;
+
+		RasterHeightfield();
+		~RasterHeightfield();
+
+		bool loads_from_file()				{return true;}
+		const char* file_name_extensions()	{return "*.asc *.flt";}
+
+		bool initialize(const char* filename, number xMin, number yMin, number xMax, number yMax);
+
+		number height(number x, number y)	{return evaluate(x, y);}
+		void heights(number* heightsOut, const number* x, const number* y, size_t num);
+
+	///	returns true if the suffix of filename belongs to a supported raster format
+		static bool supports_file(const char* filename);
+
+	private:
+	///	size and position of the raster as given in its header
+		struct Header{
+			Header();
+			int		numCols;
+			int		numRows;
+		///	center of the lower left cell
+			double	xCenter;
+			double	yCenter;
+			double	cellSize;
+			double	noData;
+			bool	hasNoData;
+			bool	msbFirst;
+		};
+
+		bool read_header(Header& headerOut, const char* data, const char* end,
+						 const char** dataBeginOut);
+		bool load_ascii(const char* filename, number xMin, number yMin, number xMax, number yMax);
+		bool load_float(const char* filename, number xMin, number yMin, number xMax, number yMax);
+
+	///	sets the window of rows and columns which covers the given rectangle
+		void set_window(number xMin, number yMin, number xMax, number yMax);
+		void clear();
+
+		float value(int row, int col) const;
+		bool is_valid(float val) const;
+		double evaluate(double x, double y) const;
+
+	private:
+		Header	m_header;
+	///	y-coordinate of the center of row 0 (the top row)
+		double	m_yTop;
+	///	rows and columns of the raster which are accessible: [begin, end)
+		int		m_rowBegin, m_rowEnd;
+		int		m_colBegin, m_colEnd;
+	///	start of the data of each accessible row. The first value belongs to m_rowColOffset.
+		std::vector<const char*>	m_rows;
+		int							m_rowColOffset;
+		bool						m_swapBytes;
+	///	values of .asc files
+		std::vector<float>			m_values;
+	///	mapped tiles of .flt files
+		QFile						m_file;
+		std::vector<uchar*>			m_tiles;
+};
+
+}//	end of namespace
+
+#endif	//__H__PROMESH_raster_heightfield
@@ -0,0 +1,194 @@
+/*
+ * Copyright (c) 2026:  G-CSC, Goethe University Frankfurt
+ * Author: Sebastian Reiter
+ * 
+ * This file is part of ProMesh.
+ * 
+ * ProMesh is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License version 3 (as published by the
+ * Free Software Foundation) with the following additional attribution
+ * requirements (according to LGPL/GPL v3 §7):
+ * 
+ * (1) The following notice must be displayed in the Appropriate Legal Notices
+ * of covered and combined works: "Based on ProMesh (www.promesh3d.com)".
+ * 
+ * (2) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S. and Wittum, G. ProMesh -- a flexible interactive meshing software
+ *   for unstructured hybrid grids in 1, 2, and 3 dimensions. In preparation."
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include <algorithm>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "tetgen_in_process.h"
+#include "common/profiler/profiler.h"
+
+#ifdef PROMESH_TETGEN_IN_PROCESS
+	#include "tetgen.h"
+#endif
+
+using namespace std;
+using namespace ug;
+
+bool TetgenInProcessAvailable()
+{
+#ifdef PROMESH_TETGEN_IN_PROCESS
+	return true;
+#else
+	return false;
+#endif
+}
+
+
+#ifdef PROMESH_TETGEN_IN_PROCESS
+
+///	guards all calls into the tetgen library
+static mutex& TetgenMutex()
+{
+	static mutex m;
+	return m;
+}
+
+void RunTetgen(const TetgenPLC& plc, TetgenMesh& meshOut, const char* switches)
+{
+	PROFILE_FUNC();
+//	tetgenio releases its arrays with delete[] in its destructor
+	tetgenio in, out;
+	in.firstnumber = 0;
+	in.numberofpoints = plc.num_points();
+	in.pointlist = new REAL[plc.points.size()];
+	copy(plc.points.begin(), plc.points.end(), in.pointlist);
+
+	in.numberoffacets = plc.num_facets();
+	in.facetlist = new tetgenio::facet[in.numberoffacets];
+	in.facetmarkerlist = new int[in.numberoffacets];
+	for(int i = 0; i < in.numberoffacets; ++i){
+		tetgenio::facet& facet = in.facetlist[i];
+		tetgenio::init(&facet);
+		facet.numberofpolygons = 1;
+		facet.polygonlist = new tetgenio::polygon[1];
+		tetgenio::polygon& poly = facet.polygonlist[0];
+		tetgenio::init(&poly);
+		poly.numberofvertices = plc.facetOffsets[i + 1] - plc.facetOffsets[i];
+		poly.vertexlist = new int[poly.numberofvertices];
+		copy(plc.facetCorners.begin() + plc.facetOffsets[i],
+			 plc.facetCorners.begin() + plc.facetOffsets[i + 1], poly.vertexlist);
+		in.facetmarkerlist[i] = plc.facetMarkers[i];
+	}
+
+	in.numberofholes = (int)plc.holes.size() / 3;
+	if(in.numberofholes > 0){
+		in.holelist = new REAL[plc.holes.size()];
+		copy(plc.holes.begin(), plc.holes.end(), in.holelist);
+	}
+
+//	tetgen keeps global state, e.g. the error bounds of its exact predicates,
+//	which exactinit rebuilds from the bounding box of each input. Calls are
+//	thus serialized. Use RunTetgenExecutable for concurrent runs.
+	string sw(switches);
+	try{
+		lock_guard<mutex> lock(TetgenMutex());
+		tetrahedralize(&sw[0], &in, &out);
+	}
+	catch(...){
+		UG_THROW("tetgen failed to tetrahedralize a surface.");
+	}
+
+	UG_COND_THROW(out.numberofpoints < in.numberofpoints,
+				  "tetgen removed points of a surface.");
+
+	meshOut.points.assign(out.pointlist, out.pointlist + 3 * out.numberofpoints);
+	meshOut.tetrahedra.resize(4 * out.numberoftetrahedra);
+	for(int i = 0; i < out.numberoftetrahedra; ++i){
+		for(int j = 0; j < 4; ++j)
+			meshOut.tetrahedra[4 * i + j] = out.tetrahedronlist[out.numberofcorners * i + j];
+	}
+	meshOut.triangles.assign(out.trifacelist, out.trifacelist + 3 * out.numberoftrifaces);
+	if(out.trifacemarkerlist)
+		meshOut.triangleMarkers.assign(out.trifacemarkerlist,
+									   out.trifacemarkerlist + out.numberoftrifaces);
+	else
+		meshOut.triangleMarkers.assign(out.numberoftrifaces, 0);
+}
+
+#else
+
+void RunTetgen(const TetgenPLC&, TetgenMesh&, const char*)
+{
+	UG_THROW("ProMesh was built without the tetgen library. "
+			 "tetgen can't be called in process.");
+}
+
+#endif
+
+
+void TetrahedralizeInProcess(Grid& grid, ISubsetHandler& sh,
+							 APosition& aPos, const char* switches)
+{
+	PROFILE_FUNC();
+	UG_COND_THROW(!grid.has_vertex_attachment(aPos),
+				  "Missing position attachment in TetrahedralizeInProcess.");
+	Grid::VertexAttachmentAccessor<APosition> aaPos(grid, aPos);
+
+	TetgenPLC plc;
+	plc.points.reserve(3 * grid.num<Vertex>());
+	AInt aInd;
+	grid.attach_to_vertices(aInd);
+	Grid::VertexAttachmentAccessor<AInt> aaInd(grid, aInd);
+	for(VertexIterator iter = grid.begin<Vertex>(); iter != grid.end<Vertex>(); ++iter){
+		aaInd[*iter] = plc.num_points();
+		plc.add_point(aaPos[*iter]);
+	}
+
+//	each face is a facet. Markers are subset index + 1, since tetgen uses 0
+//	for faces which don't lie on a facet.
+	for(FaceIterator iter = grid.begin<Face>(); iter != grid.end<Face>(); ++iter){
+		Face* f = *iter;
+		int corners[4];
+		const int numCorners = (int)f->num_vertices();
+		for(int i = 0; i < numCorners; ++i)
+			corners[i] = aaInd[f->vertex(i)];
+		plc.add_facet(corners, numCorners, sh.get_subset_index(f) + 1);
+	}
+	grid.detach_from_vertices(aInd);
+
+	TetgenMesh tetMesh;
+	RunTetgen(plc, tetMesh, switches);
+
+//	replace the content of the grid by tetgen's output
+	grid.clear_geometry();
+	const int numPoints = (int)tetMesh.points.size() / 3;
+	vector<Vertex*> vrts(numPoints);
+	grid.reserve<Vertex>(numPoints);
+	for(int i = 0; i < numPoints; ++i){
+		vrts[i] = *grid.create<RegularVertex>();
+		aaPos[vrts[i]] = vector3(tetMesh.points[3 * i], tetMesh.points[3 * i + 1],
+								 tetMesh.points[3 * i + 2]);
+	}
+
+//	boundary faces are created before the tetrahedra, so that automatically
+//	generated sides find them
+	const int numTris = (int)tetMesh.triangleMarkers.size();
+	grid.reserve<Face>(numTris);
+	for(int i = 0; i < numTris; ++i){
+		const int* c = &tetMesh.triangles[3 * i];
+		Face* f = *grid.create<Triangle>(TriangleDescriptor(vrts[c[0]], vrts[c[1]], vrts[c[2]]));
+		if(tetMesh.triangleMarkers[i] > 0)
+			sh.assign_subset(f, tetMesh.triangleMarkers[i] - 1);
+	}
+
+	const int numTets = (int)tetMesh.tetrahedra.size() / 4;
+	grid.reserve<Volume>(numTets);
+	for(int i = 0; i < numTets; ++i){
+		const int* c = &tetMesh.tetrahedra[4 * i];
+		grid.create<Tetrahedron>(TetrahedronDescriptor(vrts[c[0]], vrts[c[1]],
+													   vrts[c[2]], vrts[c[3]]));
+	}
+}
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2026:  G-CSC, Goethe University Frankfurt
+ * Author: Sebastian Reiter
+ * 
+ * This file is part of ProMesh.
+ * 
+ * ProMesh is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License version 3 (as published by the
+ * Free Software Foundation) with the following additional attribution
+ * requirements (according to LGPL/GPL v3 §7):
+ * 
+ * (1) The following notice must be displayed in the Appropriate Legal Notices
+ * of covered and combined works: "Based on ProMesh (www.promesh3d.com)".
+ * 
+ * (2) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S. and Wittum, G. ProMesh -- a flexible interactive meshing software
+ *   for unstructured hybrid grids in 1, 2, and 3 dimensions. In preparation."
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#ifndef __H__PROMESH_tetgen_in_process
+#define __H__PROMESH_tetgen_in_process
+
+#include <vector>
+#include "lib_grid/lib_grid.h"
+
+///	a piecewise linear complex which is passed to tetgen
+struct TetgenPLC{
+	TetgenPLC() : facetOffsets(1, 0)	{}
+
+	int num_points() const	{return (int)points.size() / 3;}
+	int num_facets() const	{return (int)facetMarkers.size();}
+
+	void add_point(const ug::vector3& p)
+	{
+		points.push_back(p.x());
+		points.push_back(p.y());
+		points.push_back(p.z());
+	}
+
+	void add_facet(const int* corners, int numCorners, int marker)
+	{
+		facetCorners.insert(facetCorners.end(), corners, corners + numCorners);
+		facetOffsets.push_back((int)facetCorners.size());
+		facetMarkers.push_back(marker);
+	}
+
+///	x-, y- and z-coordinate of each point
+	std::vector<double>	points;
+///	the corners of facet i are stored at [facetOffsets[i], facetOffsets[i+1])
+	std::vector<int>	facetCorners;
+	std::vector<int>	facetOffsets;
+	std::vector<int>	facetMarkers;
+///	x-, y- and z-coordinate of a point in each hole
+	std::vector<double>	holes;
+};
+
+///	the tetrahedralization of a TetgenPLC
+struct TetgenMesh{
+///	x-, y- and z-coordinate of each point. The points of the PLC come first.
+	std::vector<double>	points;
+///	4 corners per tetrahedron
+	std::vector<int>	tetrahedra;
+///	3 corners per boundary triangle
+	std::vector<int>	triangles;
+///	marker of the facet in which each boundary triangle lies (0: none)
+	std::vector<int>	triangleMarkers;
+};
+
+///	tetrahedralizes plc by calling the tetgen library.
+/**	switches are tetgen's command line switches without the leading '-'.
+ * Since the tetgen library has global state, concurrent calls are executed
+ * one after the other. Throws an error if tetgen fails or isn't available.*/
+void RunTetgen(const TetgenPLC& plc, TetgenMesh& meshOut, const char* switches);
+
+///	returns true if ProMesh was built with the tetgen library (PROMESH_TETGEN_IN_PROCESS)
+bool TetgenInProcessAvailable();
+
+///	tetrahedralizes the faces and vertices of a grid by calling the tetgen library directly.
+/**	The vertices and faces of the grid are passed to tetgen as a piecewise
+ * linear complex, the subset index of each face as its facet marker.
+ * On success the content of the grid is replaced by the result: the
+ * vertices, the boundary triangles, which keep the subsets of the original
+ * faces, and the tetrahedra, which are not assigned to a subset.
+ * This mirrors reading the .ele output of the tetgen executable but skips
+ * all temporary files.
+ *
+ * switches are tetgen's command line switches without the leading '-'.
+ * Throws an error if tetgen fails or isn't available.*/
+void TetrahedralizeInProcess(ug::Grid& grid, ug::ISubsetHandler& sh,
+							 ug::APosition& aPos, const char* switches);
+
+#endif	//__H__PROMESH_tetgen_in_process
@@ -0,0 +1,601 @@
+/*
+ * Copyright (c) 2026:  G-CSC, Goethe University Frankfurt
+ * Author: Sebastian Reiter
+ * 
+ * This file is part of ProMesh.
+ * 
+ * ProMesh is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License version 3 (as published by the
+ * Free Software Foundation) with the following additional attribution
+ * requirements (according to LGPL/GPL v3 §7):
+ * 
+ * (1) The following notice must be displayed in the Appropriate Legal Notices
+ * of covered and combined works: "Based on ProMesh (www.promesh3d.com)".
+ * 
+ * (2) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S. and Wittum, G. ProMesh -- a flexible interactive meshing software
+ *   for unstructured hybrid grids in 1, 2, and 3 dimensions. In preparation."
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <QFile>
+#include <QProcess>
+#include <QStringList>
+#include "tetgen_regions.h"
+#include "common/profiler/profiler.h"
+#include "util/mapped_file.h"
+#include "util/parallel_util.h"
+#include "util/text_parsing.h"
+
+using namespace std;
+using namespace ug;
+
+namespace{
+
+///	a triangle surface with local vertex indices and centered coordinates
+struct TriSurface{
+	vector<vector3>	pts;
+	vector<int>		tris;
+
+	int num_tris() const	{return (int)tris.size() / 3;}
+
+	const vector3& corner(int tri, int i) const	{return pts[tris[3 * tri + i]];}
+
+///	not normalized. Its length is twice the area of the triangle.
+	vector3 normal(int tri) const
+	{
+		vector3 e1, e2, n;
+		VecSubtract(e1, corner(tri, 1), corner(tri, 0));
+		VecSubtract(e2, corner(tri, 2), corner(tri, 0));
+		VecCross(n, e1, e2);
+		return n;
+	}
+
+	vector3 center(int tri) const
+	{
+		vector3 c;
+		VecAdd(c, corner(tri, 0), corner(tri, 1), corner(tri, 2));
+		VecScale(c, c, 1. / 3.);
+		return c;
+	}
+};
+
+///	an edge of a triangle with sorted corners and the opposite corner
+struct TriEdge{
+	int v0, v1, tri, opp;
+	bool operator<(const TriEdge& e) const
+	{
+		return v0 < e.v0 || (v0 == e.v0 && (v1 < e.v1 || (v1 == e.v1 && tri < e.tri)));
+	}
+};
+
+int FindRoot(vector<int>& parent, int i)
+{
+	while(parent[i] != i){
+		parent[i] = parent[parent[i]];
+		i = parent[i];
+	}
+	return i;
+}
+
+void Unite(vector<int>& parent, int a, int b)
+{
+	a = FindRoot(parent, a);
+	b = FindRoot(parent, b);
+	if(a < b)
+		parent[b] = a;
+	else if(b < a)
+		parent[a] = b;
+}
+
+//	Triangles have two sides. Side 2t faces in the direction of the normal of
+//	triangle t, side 2t+1 in the opposite direction.
+inline vector3 SideDirection(const TriSurface& surf, int side)
+{
+	vector3 n = surf.normal(side / 2);
+	VecNormalize(n, n);
+	if(side % 2 == 1)
+		VecScale(n, n, -1);
+	return n;
+}
+
+///	a point close to the given side of a triangle, in front of that side
+vector3 PointInFrontOfSide(const TriSurface& surf, int side)
+{
+	const int tri = side / 2;
+	const number len = sqrt(0.5 * VecLength(surf.normal(tri)));
+	vector3 p;
+	VecScaleAdd(p, 1., surf.center(tri), 1e-3 * len, SideDirection(surf, side));
+	return p;
+}
+
+///	joins the sides of triangles which face the same region into components.
+/**	The triangles around each edge are sorted by angle. Consecutive triangles
+ * enclose a wedge. The two sides which face a wedge belong to the same region.*/
+void FindSideComponents(vector<int>& compOut, int& numCompsOut, const TriSurface& surf)
+{
+	const int numTris = surf.num_tris();
+	vector<TriEdge> edges;
+	edges.reserve(3 * numTris);
+	for(int t = 0; t < numTris; ++t){
+		for(int i = 0; i < 3; ++i){
+			TriEdge e;
+			e.v0 = surf.tris[3 * t + i];
+			e.v1 = surf.tris[3 * t + (i + 1) % 3];
+			e.opp = surf.tris[3 * t + (i + 2) % 3];
+			e.tri = t;
+			if(e.v1 < e.v0)
+				swap(e.v0, e.v1);
+			edges.push_back(e);
+		}
+	}
+	sort(edges.begin(), edges.end());
+
+	vector<int> parent(2 * numTris);
+	for(size_t i = 0; i < parent.size(); ++i)
+		parent[i] = (int)i;
+
+	vector<pair<number, int> > order;
+	vector<vector3> dirs;
+	for(size_t first = 0; first < edges.size();){
+		size_t last = first + 1;
+		while(last < edges.size() && edges[last].v0 == edges[first].v0
+			  && edges[last].v1 == edges[first].v1)
+			++last;
+
+		UG_COND_THROW(last - first < 2, "The surface isn't closed: "
+					  "an edge has only one triangle.");
+
+	//	directions from the edge to the opposite corners, orthogonal to the edge
+		const vector3& a = surf.pts[edges[first].v0];
+		vector3 d;
+		VecSubtract(d, surf.pts[edges[first].v1], a);
+		VecNormalize(d, d);
+
+		const size_t num = last - first;
+		order.resize(num);
+		dirs.resize(num);
+		for(size_t i = 0; i < num; ++i){
+			vector3& w = dirs[i];
+			VecSubtract(w, surf.pts[edges[first + i].opp], a);
+			VecScaleAdd(w, 1., w, -VecDot(w, d), d);
+			vector3 c;
+			VecCross(c, dirs[0], w);
+			order[i] = make_pair(atan2(VecDot(c, d), VecDot(dirs[0], w)), (int)i);
+		}
+		sort(order.begin(), order.end());
+
+	//	the wedge between cur and next starts at cur in direction d x w_cur
+	//	and ends at next in direction -(d x w_next)
+		for(size_t i = 0; i < num; ++i){
+			const int cur = order[i].second;
+			const int next = order[(i + 1) % num].second;
+			const int triCur = edges[first + cur].tri;
+			const int triNext = edges[first + next].tri;
+			vector3 c;
+			VecCross(c, d, dirs[cur]);
+			const int sideCur = 2 * triCur + (VecDot(surf.normal(triCur), c) > 0 ? 0 : 1);
+			VecCross(c, d, dirs[next]);
+			const int sideNext = 2 * triNext + (VecDot(surf.normal(triNext), c) < 0 ? 0 : 1);
+			Unite(parent, sideCur, sideNext);
+		}
+		first = last;
+	}
+
+	compOut.resize(2 * numTris);
+	vector<int> rootComp(2 * numTris, -1);
+	numCompsOut = 0;
+	for(int i = 0; i < 2 * numTris; ++i){
+		const int root = FindRoot(parent, i);
+		if(rootComp[root] == -1)
+			rootComp[root] = numCompsOut++;
+		compOut[i] = rootComp[root];
+	}
+}
+
+///	Möller-Trumbore ray-triangle intersection. Only hits with t > 0 count.
+bool RayHitsTriangle(const vector3& from, const vector3& dir,
+					 const vector3& p0, const vector3& p1, const vector3& p2)
+{
+	vector3 e1, e2, h, s, q;
+	VecSubtract(e1, p1, p0);
+	VecSubtract(e2, p2, p0);
+	VecCross(h, dir, e2);
+	const number det = VecDot(e1, h);
+	if(fabs(det) < 1e-20)
+		return false;
+	const number invDet = 1. / det;
+	VecSubtract(s, from, p0);
+	const number u = invDet * VecDot(s, h);
+	if(u < 0 || u > 1)
+		return false;
+	VecCross(q, s, e1);
+	const number v = invDet * VecDot(dir, q);
+	if(v < 0 || u + v > 1)
+		return false;
+	return invDet * VecDot(e2, q) > 0;
+}
+
+///	true if p lies inside the closed shell which is formed by the triangles
+///	with exactly one side in component comp.
+bool PointInComponent(const vector3& p, int comp, const vector<int>& triangles,
+					  const vector<int>& sideComp, const TriSurface& surf)
+{
+//	an arbitrary direction which is unlikely to hit edges exactly
+	const vector3 dir(0.5773421, 0.5773862, 0.5772232);
+	int numHits = 0;
+	for(size_t i = 0; i < triangles.size(); ++i){
+		const int t = triangles[i];
+		if((sideComp[2 * t] == comp) == (sideComp[2 * t + 1] == comp))
+			continue;
+		if(RayHitsTriangle(p, dir, surf.corner(t, 0), surf.corner(t, 1), surf.corner(t, 2)))
+			++numHits;
+	}
+	return numHits % 2 == 1;
+}
+
+///	the input for tetgen of a single region
+struct Region{
+	TetgenPLC		plc;
+///	grid vertex index of each point of the plc
+	vector<int>		vrts;
+	TetgenMesh		mesh;
+};
+
+///	skips empty lines and comments of tetgen files
+const char* NextDataLine(const char* p, const char* end)
+{
+	while(p < end){
+		p = SkipSpaces(p, end);
+		if(p < end && *p != '#' && *p != '\n')
+			return p;
+		p = NextLine(FindLineEnd(p, end), end);
+	}
+	return end;
+}
+
+///	parses num numbers of type T from a line. Returns false if there are less.
+template <class T>
+bool ParseNumbers(const char*& p, const char* end, T* valsOut, int num)
+{
+	const char* lineEnd = FindLineEnd(p, end);
+	for(int i = 0; i < num; ++i){
+		p = SkipSpaces(p, lineEnd);
+		double val;
+		p = ParseNumber(p, lineEnd, val);
+		if(!p)
+			return false;
+		valsOut[i] = (T)val;
+	}
+	p = NextLine(lineEnd, end);
+	return true;
+}
+
+void RemoveTetgenRegionFiles(const QString& fileBase)
+{
+	QFile::remove(fileBase + ".smesh");
+	QFile::remove(fileBase + ".1.node");
+	QFile::remove(fileBase + ".1.ele");
+	QFile::remove(fileBase + ".1.face");
+	QFile::remove(fileBase + ".1.edge");
+}
+
+}//	end of anonymous namespace
+
+
+int TetrahedralizeRegions(Grid& grid, ISubsetHandler& sh, APosition& aPos,
+						  const vector<Face*>& faces, const TetgenRegionFunc& tetgen,
+						  bool concurrent)
+{
+	PROFILE_FUNC();
+	UG_COND_THROW(!grid.has_vertex_attachment(aPos),
+				  "Missing position attachment in TetrahedralizeRegions.");
+	Grid::VertexAttachmentAccessor<APosition> aaPos(grid, aPos);
+
+//	collect the surface. Coordinates are centered to improve the accuracy
+//	of the volume and angle computations.
+	TriSurface surf;
+	vector<Vertex*> vrts;
+	AInt aInd;
+	grid.attach_to_vertices_dv(aInd, -1);
+	Grid::VertexAttachmentAccessor<AInt> aaInd(grid, aInd);
+	surf.tris.reserve(3 * faces.size());
+	for(size_t i = 0; i < faces.size(); ++i){
+		Face* f = faces[i];
+		if(f->num_vertices() != 3){
+			grid.detach_from_vertices(aInd);
+			UG_THROW("Only triangles can be tetrahedralized by region.");
+		}
+		for(size_t j = 0; j < 3; ++j){
+			Vertex* v = f->vertex(j);
+			if(aaInd[v] == -1){
+				aaInd[v] = (int)vrts.size();
+				vrts.push_back(v);
+				surf.pts.push_back(aaPos[v]);
+			}
+			surf.tris.push_back(aaInd[v]);
+		}
+	}
+	grid.detach_from_vertices(aInd);
+
+	if(vrts.empty())
+		return 0;
+
+	vector3 minCorner = surf.pts[0], maxCorner = surf.pts[0];
+	for(size_t i = 1; i < surf.pts.size(); ++i){
+		for(int j = 0; j < 3; ++j){
+			minCorner[j] = min(minCorner[j], surf.pts[i][j]);
+			maxCorner[j] = max(maxCorner[j], surf.pts[i][j]);
+		}
+	}
+	vector3 center;
+	VecScaleAdd(center, 0.5, minCorner, 0.5, maxCorner);
+	for(size_t i = 0; i < surf.pts.size(); ++i)
+		VecSubtract(surf.pts[i], surf.pts[i], center);
+
+	vector<int> sideComp;
+	int numComps;
+	FindSideComponents(sideComp, numComps, surf);
+
+//	the triangles of each component and its enclosed volume. Components with
+//	a positive volume bound a region. Others face the exterior of a surface.
+	const int numTris = surf.num_tris();
+	vector<vector<int> > compTris(numComps);
+	vector<number> compVolume(numComps, 0);
+	for(int t = 0; t < numTris; ++t){
+		vector3 c;
+		VecCross(c, surf.corner(t, 1), surf.corner(t, 2));
+		const number vol = VecDot(surf.corner(t, 0), c) / 6.;
+		compVolume[sideComp[2 * t]] -= vol;
+		compVolume[sideComp[2 * t + 1]] += vol;
+		compTris[sideComp[2 * t]].push_back(t);
+		if(sideComp[2 * t + 1] != sideComp[2 * t])
+			compTris[sideComp[2 * t + 1]].push_back(t);
+	}
+
+	vector<int> compRegion(numComps, -1);
+	vector<int> regionComps;
+	for(int i = 0; i < numComps; ++i){
+		if(compVolume[i] > 0){
+			compRegion[i] = (int)regionComps.size();
+			regionComps.push_back(i);
+		}
+	}
+	const int numRegions = (int)regionComps.size();
+	UG_COND_THROW(numRegions == 0, "The surface doesn't enclose any volume.");
+
+//	the outside of a surface which lies inside another region belongs to the
+//	smallest region which contains it. All others face the global exterior.
+	vector<vector<int> > regionInclusions(numRegions);
+	for(int i = 0; i < numComps; ++i){
+		if(compRegion[i] != -1)
+			continue;
+		const int t = compTris[i][0];
+		const vector3 p = PointInFrontOfSide(surf, sideComp[2 * t] == i ? 2 * t : 2 * t + 1);
+		int container = -1;
+		for(int r = 0; r < numRegions; ++r){
+			const int comp = regionComps[r];
+			if((container == -1 || compVolume[comp] < compVolume[regionComps[container]])
+				&& PointInComponent(p, comp, compTris[comp], sideComp, surf))
+			{
+				container = r;
+			}
+		}
+		if(container != -1)
+			regionInclusions[container].push_back(i);
+	}
+
+//	build the plc of each region
+	vector<Region> regions(numRegions);
+	vector<int> localInd(vrts.size(), -1);
+	vector<char> triAdded(numTris, 0);
+	for(int r = 0; r < numRegions; ++r){
+		Region& region = regions[r];
+		vector<int> tris = compTris[regionComps[r]];
+		const vector<int>& inclusions = regionInclusions[r];
+		for(size_t i = 0; i < inclusions.size(); ++i){
+			const int comp = inclusions[i];
+			tris.insert(tris.end(), compTris[comp].begin(), compTris[comp].end());
+
+		//	a hole point in each region which lies behind the inclusion
+			vector<char> holeAdded(numComps, 0);
+			for(size_t j = 0; j < compTris[comp].size(); ++j){
+				const int t = compTris[comp][j];
+				const int side = sideComp[2 * t] == comp ? 2 * t + 1 : 2 * t;
+				const int behind = sideComp[side];
+				if(behind == comp || compRegion[behind] == -1 || holeAdded[behind])
+					continue;
+				holeAdded[behind] = 1;
+				vector3 p = PointInFrontOfSide(surf, side);
+				VecAdd(p, p, center);
+				region.plc.holes.push_back(p.x());
+				region.plc.holes.push_back(p.y());
+				region.plc.holes.push_back(p.z());
+			}
+		}
+
+		for(size_t i = 0; i < tris.size(); ++i){
+			const int t = tris[i];
+			if(triAdded[t])
+				continue;
+			triAdded[t] = 1;
+			int corners[3];
+			for(int j = 0; j < 3; ++j){
+				const int vrt = surf.tris[3 * t + j];
+				if(localInd[vrt] == -1){
+					localInd[vrt] = (int)region.vrts.size();
+					region.vrts.push_back(vrt);
+					region.plc.add_point(aaPos[vrts[vrt]]);
+				}
+				corners[j] = localInd[vrt];
+			}
+			region.plc.add_facet(corners, 3, sh.get_subset_index(faces[t]) + 1);
+		}
+
+	//	reset the marks for the next region
+		for(size_t i = 0; i < tris.size(); ++i)
+			triAdded[tris[i]] = 0;
+		for(size_t i = 0; i < region.vrts.size(); ++i)
+			localInd[region.vrts[i]] = -1;
+	}
+
+//	large regions are started first, since they take longest.
+//	Each worker picks the next region as soon as it is done.
+	vector<int> order(numRegions);
+	for(int i = 0; i < numRegions; ++i)
+		order[i] = i;
+	sort(order.begin(), order.end(), [&regions](int a, int b){
+			return regions[a].plc.num_facets() > regions[b].plc.num_facets();
+		});
+
+	atomic<int> nextRegion(0);
+	const size_t numWorkers = concurrent ? min<size_t>(numRegions, NumWorkerThreads()) : 1;
+	ParallelForChunks(numWorkers, 1,
+		[&](size_t, size_t, size_t)
+		{
+			for(int i = nextRegion++; i < numRegions; i = nextRegion++){
+				Region& region = regions[order[i]];
+				tetgen(region.plc, region.mesh, order[i]);
+			}
+		});
+
+//	merge the results. Points of the plc are the original vertices.
+	for(int r = 0; r < numRegions; ++r){
+		Region& region = regions[r];
+		const TetgenMesh& mesh = region.mesh;
+		const int numPLCPoints = region.plc.num_points();
+		const int numPoints = (int)mesh.points.size() / 3;
+		UG_COND_THROW(numPoints < numPLCPoints,
+					  "tetgen removed points of region " << r << ".");
+
+		vector<Vertex*> regionVrts(numPoints);
+		for(int i = 0; i < numPLCPoints; ++i)
+			regionVrts[i] = vrts[region.vrts[i]];
+		grid.reserve<Vertex>(grid.num<Vertex>() + numPoints - numPLCPoints);
+		for(int i = numPLCPoints; i < numPoints; ++i){
+			regionVrts[i] = *grid.create<RegularVertex>();
+			aaPos[regionVrts[i]] = vector3(mesh.points[3 * i], mesh.points[3 * i + 1],
+										   mesh.points[3 * i + 2]);
+		}
+
+		const int si = sh.num_subsets();
+		sh.subset_info(si).name = "tetrahedra";
+		const int numTets = (int)mesh.tetrahedra.size() / 4;
+		grid.reserve<Volume>(grid.num<Volume>() + numTets);
+		for(int i = 0; i < numTets; ++i){
+			const int* c = &mesh.tetrahedra[4 * i];
+			UG_COND_THROW(min(min(c[0], c[1]), min(c[2], c[3])) < 0
+						  || max(max(c[0], c[1]), max(c[2], c[3])) >= numPoints,
+						  "tetgen returned an invalid tetrahedron for region " << r << ".");
+			Volume* vol = *grid.create<Tetrahedron>(
+								TetrahedronDescriptor(regionVrts[c[0]], regionVrts[c[1]],
+													  regionVrts[c[2]], regionVrts[c[3]]));
+			sh.assign_subset(vol, si);
+		}
+	}
+
+	return numRegions;
+}
+
+
+void RunTetgenExecutable(const TetgenPLC& plc, TetgenMesh& meshOut,
+						 const char* switches, const QString& executable,
+						 const QString& fileBase, double timeOut)
+{
+	PROFILE_FUNC();
+	const QString smeshName = fileBase + ".smesh";
+	{
+		ofstream out(smeshName.toLocal8Bit().constData());
+		UG_COND_THROW(!out, "Couldn't write " << smeshName.toLocal8Bit().constData());
+		out << setprecision(17);
+		out << "# part 1: nodes\n";
+		out << plc.num_points() << " 3 0 0\n";
+		for(int i = 0; i < plc.num_points(); ++i){
+			out << i << " " << plc.points[3 * i] << " " << plc.points[3 * i + 1]
+				<< " " << plc.points[3 * i + 2] << "\n";
+		}
+		out << "# part 2: facets\n";
+		out << plc.num_facets() << " 1\n";
+		for(int i = 0; i < plc.num_facets(); ++i){
+			out << plc.facetOffsets[i + 1] - plc.facetOffsets[i];
+			for(int j = plc.facetOffsets[i]; j < plc.facetOffsets[i + 1]; ++j)
+				out << " " << plc.facetCorners[j];
+			out << " " << plc.facetMarkers[i] << "\n";
+		}
+		const int numHoles = (int)plc.holes.size() / 3;
+		out << "# part 3: holes\n";
+		out << numHoles << "\n";
+		for(int i = 0; i < numHoles; ++i){
+			out << i << " " << plc.holes[3 * i] << " " << plc.holes[3 * i + 1]
+				<< " " << plc.holes[3 * i + 2] << "\n";
+		}
+		out << "# part 4: regions\n0\n";
+		UG_COND_THROW(!out, "Couldn't write " << smeshName.toLocal8Bit().constData());
+	}
+
+	QProcess proc;
+	proc.setProcessChannelMode(QProcess::MergedChannels);
+	proc.start(executable, QStringList() << QString("-").append(switches) << smeshName);
+	if(!proc.waitForFinished(timeOut < 0 ? -1 : (int)(timeOut * 1000))
+	   || proc.exitStatus() != QProcess::NormalExit || proc.exitCode() != 0)
+	{
+		if(proc.state() == QProcess::Running)
+			proc.kill();
+		RemoveTetgenRegionFiles(fileBase);
+		UG_THROW("Received error during execution of tetgen: "
+				 << proc.errorString().toLocal8Bit().constData());
+	}
+
+//	tetgen numbers its output like its input, i.e. starting at 0
+	bool ok = true;
+	{
+		MappedFile nodeFile;
+		ok = nodeFile.open((fileBase + ".1.node").toLocal8Bit().constData());
+		const char* p = nodeFile.data();
+		const char* end = p + nodeFile.size();
+		int header[1];
+		p = NextDataLine(p, end);
+		ok = ok && ParseNumbers(p, end, header, 1);
+		const int numPoints = ok ? header[0] : 0;
+		meshOut.points.resize(3 * numPoints);
+		for(int i = 0; ok && i < numPoints; ++i){
+			double vals[4];
+			p = NextDataLine(p, end);
+			ok = ParseNumbers(p, end, vals, 4) && vals[0] == i;
+			copy(vals + 1, vals + 4, &meshOut.points[3 * i]);
+		}
+	}
+	{
+		MappedFile eleFile;
+		ok = ok && eleFile.open((fileBase + ".1.ele").toLocal8Bit().constData());
+		const char* p = eleFile.data();
+		const char* end = p + eleFile.size();
+		int header[2];
+		p = NextDataLine(p, end);
+		ok = ok && ParseNumbers(p, end, header, 2) && header[1] >= 4;
+		const int numTets = ok ? header[0] : 0;
+		meshOut.tetrahedra.resize(4 * numTets);
+		for(int i = 0; ok && i < numTets; ++i){
+			int vals[5];
+			p = NextDataLine(p, end);
+			ok = ParseNumbers(p, end, vals, 5) && vals[0] == i;
+			copy(vals + 1, vals + 5, &meshOut.tetrahedra[4 * i]);
+		}
+	}
+	meshOut.triangles.clear();
+	meshOut.triangleMarkers.clear();
+
+	RemoveTetgenRegionFiles(fileBase);
+	UG_COND_THROW(!ok, "Couldn't read the output of tetgen for "
+				  << smeshName.toLocal8Bit().constData());
+}
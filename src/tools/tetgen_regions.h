@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2026:  G-CSC, Goethe University Frankfurt
+ * Author: Sebastian Reiter
+ * 
+ * This file is part of ProMesh.
+ * 
+ * ProMesh is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License version 3 (as published by the
+ * Free Software Foundation) with the following additional attribution
+ * requirements (according to LGPL/GPL v3 §7):
+ * 
+ * (1) The following notice must be displayed in the Appropriate Legal Notices
+ * of covered and combined works: "Based on ProMesh (www.promesh3d.com)".
+ * 
+ * (2) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S. and Wittum, G. ProMesh -- a flexible interactive meshing software
+ *   for unstructured hybrid grids in 1, 2, and 3 dimensions. In preparation."
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#ifndef __H__PROMESH_tetgen_regions
+#define __H__PROMESH_tetgen_regions
+
+#include <functional>
+#include <vector>
+#include <QString>
+#include "lib_grid/lib_grid.h"
+#include "tetgen_in_process.h"
+
+///	tetrahedralizes the PLC of the region with the given index.
+/**	Called concurrently for different regions if TetrahedralizeRegions is
+ * called with concurrent = true.*/
+typedef std::function<void (const TetgenPLC& plc, TetgenMesh& meshOut,
+							int regionIndex)>	TetgenRegionFunc;
+
+///	fills each closed region of a triangle surface with tetrahedra.
+/**	The regions are the connected volumes into which the given triangles
+ * divide space. They are found geometrically by sorting the triangles
+ * radially around each of their edges, so internal surfaces may separate
+ * any number of regions. A surface which lies completely inside a region
+ * is passed to tetgen together with the region's boundary and a hole point.
+ *
+ * tetgen is called through 'tetgen' for each region. If concurrent is true,
+ * the regions are processed concurrently. This requires a thread safe
+ * 'tetgen', e.g. RunTetgenExecutable. RunTetgen serializes all calls, since
+ * the tetgen library has global state. Since the boundary triangles of each region are
+ * passed to tetgen, tetgen has to be called with the 'Y' switch, so that
+ * triangles which are shared by two regions stay conforming.
+ *
+ * The tetrahedra are created in the grid and connected to the original
+ * vertices of the surface. Each region gets its own new subset. The surface
+ * itself isn't changed. Throws an error if the surface isn't closed,
+ * contains faces other than triangles or if tetgen fails.
+ *
+ * \return the number of regions which were tetrahedralized.*/
+int TetrahedralizeRegions(ug::Grid& grid, ug::ISubsetHandler& sh,
+						  ug::APosition& aPos, const std::vector<ug::Face*>& faces,
+						  const TetgenRegionFunc& tetgen, bool concurrent);
+
+///	tetrahedralizes plc by calling the tetgen executable.
+/**	The PLC is written to fileBase.smesh and the result is read from
+ * fileBase.1.node and fileBase.1.ele. All those files are removed afterwards.
+ * Can be called concurrently for different file bases. Throws an error if
+ * tetgen fails or doesn't finish within timeOut seconds (-1: no time out).*/
+void RunTetgenExecutable(const TetgenPLC& plc, TetgenMesh& meshOut,
+						 const char* switches, const QString& executable,
+						 const QString& fileBase, double timeOut);
+
+#endif	//__H__PROMESH_tetgen_regions
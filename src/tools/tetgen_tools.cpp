@@ -35,6 +35,9 @@
 #include "bridge/util.h"
 #include "tooltips.h"
 #include "tools/file_io_tools.h"
+#include "tools/tetgen_in_process.h"
+#include "tools/tetgen_regions.h"
+#include "options/options.h"
 #include "lib_grid/file_io/file_io_tetgen.h"
 
 using namespace ug;
@@ -92,18 +95,10 @@ static void RemoveTetgenFiles (const QString& eleFileName)
 	QFile::remove(filename);
 }
 
+///	tetrahedralizes a mesh through the tetgen executable and temporary files
 static
-void TetrahedralizeEx (	Mesh* mesh,
-                        number maxRadiusEdgeRatio,
-                       	number minDihedralAngle,
-						bool preserveOuter,
-						bool preserveAll,
-						bool separateVolumes,
-						bool appendSubsetsAtEnd,
-						int verbosity,
-						double timeOut)
+void TetrahedralizeExternal (Mesh* mesh, const QString& switches, double timeOut)
 {
-
 	QString outFileName = TmpFileName("plc", ".smesh");
 	// UG_LOG("Saving to file: " << outFileName.toLocal8Bit().constData() << std::endl);
 
@@ -112,14 +107,7 @@ void TetrahedralizeEx (	Mesh* mesh,
 	}
 
 	QString args;
-	args.append("-").append(BuildTetgenArguments(mesh->grid().num_faces() > 0,
-	                            false,
-	                            maxRadiusEdgeRatio,
-                                minDihedralAngle,
-                                preserveOuter,
-                                preserveAll,
-                                verbosity));
-
+	args.append("-").append(switches);
 	args.append(" ").append(outFileName);
 
 
@@ -156,7 +144,12 @@ void TetrahedralizeEx (	Mesh* mesh,
 //	remove temporary files
 	QFile::remove(outFileName);
 	RemoveTetgenFiles(inFileName);
+}
 
+///	separates the new tetrahedra into subsets and names those subsets
+static
+void AssignTetrahedraSubsets (Mesh* mesh, bool separateVolumes, bool appendSubsetsAtEnd)
+{
 	SubsetHandler& sh = mesh->subset_handler();
 	Grid& grid = mesh->grid();
 
@@ -172,7 +165,38 @@ void TetrahedralizeEx (	Mesh* mesh,
 //	assign a subset name
 	for(int i = oldNumSubsets; i < sh.num_subsets(); ++i)
 		sh.subset_info(i).name = "tetrahedra";
+}
+
+static
+void TetrahedralizeEx (	Mesh* mesh,
+                        number maxRadiusEdgeRatio,
+                       	number minDihedralAngle,
+						bool preserveOuter,
+						bool preserveAll,
+						bool separateVolumes,
+						bool appendSubsetsAtEnd,
+						int verbosity,
+						double timeOut)
+{
+	QString switches = BuildTetgenArguments(mesh->grid().num_faces() > 0,
+	                            false,
+	                            maxRadiusEdgeRatio,
+                                minDihedralAngle,
+                                preserveOuter,
+                                preserveAll,
+                                verbosity);
+
+	if(GetOptions().tetgen.inProcess && TetgenInProcessAvailable()){
+	//	no temporary files are involved. Note that time outs aren't supported.
+		UG_LOG("Calling 'tetgen' by Hang Si (www.tetgen.org)\n");
+		TetrahedralizeInProcess(mesh->grid(), mesh->subset_handler(),
+								mesh->position_attachment(),
+								switches.toLocal8Bit().constData());
+	}
+	else
+		TetrahedralizeExternal(mesh, switches, timeOut);
 
+	AssignTetrahedraSubsets(mesh, separateVolumes, appendSubsetsAtEnd);
 	UG_LOG("Done\n");
 }
 
@@ -242,6 +266,68 @@ void RetetrahedralizeEx (Mesh* mesh,
 	UG_LOG("Done\n");
 }
 
+static
+void TetrahedralizeRegionsEx (Mesh* mesh,
+							  number maxRadiusEdgeRatio,
+							  number minDihedralAngle,
+							  bool preserveAll,
+							  int verbosity,
+							  double timeOut)
+{
+	Grid& grid = mesh->grid();
+	Selector& sel = mesh->selector();
+
+//	the selected triangles or all faces define the regions
+	vector<Face*> faces;
+	if(sel.num<Face>() > 0)
+		faces.assign(sel.begin<Face>(), sel.end<Face>());
+	else
+		faces.assign(grid.begin<Face>(), grid.end<Face>());
+
+//	the boundary of each region is preserved ('Y'), so that the triangles
+//	which are shared by neighbored regions stay conforming.
+	const string switches = BuildTetgenArguments(true, false,
+	                            maxRadiusEdgeRatio,
+                                minDihedralAngle,
+                                true,
+                                preserveAll,
+                                verbosity).toLocal8Bit().constData();
+
+	const QString call = AppDir().path()	.append(QDir::separator())
+											.append("tools")
+											.append(QDir::separator())
+											.append("tetgen");
+
+	UG_LOG("Calling 'tetgen' by Hang Si (www.tetgen.org)\n");
+	int numRegions;
+	if(!QFile::exists(call) && TetgenInProcessAvailable()){
+	//	the tetgen library has global state. Without the executable, regions
+	//	are thus processed one after the other.
+		numRegions = TetrahedralizeRegions(grid, mesh->subset_handler(),
+							mesh->position_attachment(), faces,
+							[&switches](const TetgenPLC& plc, TetgenMesh& meshOut, int)
+							{
+								RunTetgen(plc, meshOut, switches.c_str());
+							},
+							false);
+	}
+	else{
+	//	one tetgen process per region, so that regions are processed concurrently
+		const QString fileBase = TmpFileName("region", "");
+		numRegions = TetrahedralizeRegions(grid, mesh->subset_handler(),
+							mesh->position_attachment(), faces,
+							[&](const TetgenPLC& plc, TetgenMesh& meshOut, int regionIndex)
+							{
+								RunTetgenExecutable(plc, meshOut, switches.c_str(), call,
+										QString(fileBase).append("_").append(
+												QString::number(regionIndex)),
+										timeOut);
+							},
+							true);
+	}
+	UG_LOG("Done (" << numRegions << " regions)\n");
+}
+
 
 void RegisterTetgenTools ()
 {
@@ -261,6 +347,20 @@ void RegisterTetgenTools ()
 				"Fills a closed surface with tetrahedra using TetGen. "
 					"Aborts if no result was computet after 'time out' elapsed.");
 
+	reg.add_function("TetrahedralFillRegions", &TetrahedralizeRegionsEx, grp, "",
+				"mesh #"
+				"max radius edge ratio || value=2; min=1; step=0.1D #"
+				"min dihedral angle || value=5; min=0; max=18; step=1 #"
+				"preserve all #"
+				"verbosity || min=0; value=0; max=3; step=1#"
+				"time out (s) || min= -1; value=10; step=1",
+				"Fills each closed region of the selected triangles (or of all faces "
+					"if none are selected) separately with tetrahedra using TetGen. "
+					"Each region gets its own subset. Regions are processed concurrently "
+					"by separate tetgen processes. "
+					"Triangles shared by two regions stay conforming. "
+					"The time out applies to each region if the tetgen executable is used.");
+
 	reg.add_function("RemeshTetrahedra", &RetetrahedralizeEx, grp, "",
 				"mesh #"
 				"max radius edge ratio || value=2; min=1; step=0.1D #"
@@ -25,9 +25,13 @@
  * GNU Lesser General Public License for more details.
  */
 
+#include <algorithm>
 #include <string>
 #include <sstream>
+#include <QDataStream>
+#include <QFile>
 #include "undo.h"
+#include "scene/file_io_compressed.h"
 #include "common/math/misc/math_util.h"
 #include "common/util/file_util.h"
 #include "common/util/string_util.h"
@@ -45,12 +49,10 @@ UndoHistory() :
 }
 
 UndoHistory::
-UndoHistory(const char* fileNamePrefix, int maxSteps) :
+UndoHistory(const char* fileNamePrefix) :
 	m_bInitialized(true),
 	m_counter(0),
-	m_prefix(fileNamePrefix),
-	m_maxSteps(maxSteps),
-	m_numSteps(0)
+	m_prefix(fileNamePrefix)
 {
 }
 
@@ -59,7 +61,7 @@ can_undo()
 {
 	if(!m_bInitialized)
 		return false;
-	return !m_undoFiles.empty();
+	return !m_undoEntries.empty();
 }
 
 bool UndoHistory::
@@ -67,91 +69,494 @@ can_redo()
 {
 	if(!m_bInitialized)
 		return false;
-	return !m_redoFiles.empty();
+	return !m_redoEntries.empty();
 }
 
-const char* UndoHistory::
-undo()
+bool UndoHistory::
+undo(QByteArray& dataOut)
 {
 	if(!m_bInitialized)
-		return NULL;
+		return false;
 
-	if(m_undoFiles.empty())
-		return NULL;
+	if(m_undoEntries.empty())
+		return false;
 
-//	push the current file to the redo stack
-	if(!m_currentFile.empty())
-		m_redoFiles.push(m_currentFile);
-	m_currentFile = m_undoFiles.back();
-	m_undoFiles.pop_back();
-	--m_numSteps;
+//	push the current entry to the redo stack
+	if(!m_currentEntry.name.empty())
+		m_redoEntries.push_back(m_currentEntry);
+	m_currentEntry = m_undoEntries.back();
+	m_undoEntries.pop_back();
 
-	return m_currentFile.c_str();
+	return restore_entry(m_currentEntry, dataOut);
 }
 
-const char* UndoHistory::
-redo()
+bool UndoHistory::
+redo(QByteArray& dataOut)
 {
 	if(!m_bInitialized)
-		return NULL;
+		return false;
 
-	if(m_redoFiles.empty())
-		return NULL;
+	if(m_redoEntries.empty())
+		return false;
 
-//	push the current file to the back of the undo files.
-	if(!m_currentFile.empty())
-		m_undoFiles.push_back(m_currentFile);
-	m_currentFile = m_redoFiles.top();
-	m_redoFiles.pop();
-	++m_numSteps;
+//	push the current entry to the back of the undo entries.
+	if(!m_currentEntry.name.empty())
+		m_undoEntries.push_back(m_currentEntry);
+	m_currentEntry = m_redoEntries.back();
+	m_redoEntries.pop_back();
 
-//	we don't have to check for too many undo-files here,
-//	since only existing files are restored.
+//	we don't have to check the budgets here,
+//	since only existing entries are restored.
 
-	return m_currentFile.c_str();
+	return restore_entry(m_currentEntry, dataOut);
 }
 
-const char* UndoHistory::
-create_history_entry()
+void UndoHistory::
+create_history_entry(const CreateWriteFunc& createWriteFunc, size_t numBytes)
 {
 	if(!m_bInitialized)
-		return NULL;
+		return;
 
 //	clear the redo stack
-	if(!m_redoFiles.empty()){
-		while(!m_redoFiles.empty()){
-			QFile rmFile(m_redoFiles.top().c_str());
-			m_redoFiles.pop();
-			rmFile.remove();
-		}
-	}
+	for(size_t i = 0; i < m_redoEntries.size(); ++i)
+		remove_entry(m_redoEntries[i]);
+	m_redoEntries.clear();
+
+	UndoFileWriter& writer = UndoHistoryProvider::inst().writer();
 
 //	add undo entry
-	if(!m_currentFile.empty()){
-		m_undoFiles.push_back(m_currentFile);
-		++m_numSteps;
-	}
+	if(!m_currentEntry.name.empty())
+		m_undoEntries.push_back(m_currentEntry);
+
+//	the mesh is only copied once the writer can hold the copy. If snapshots
+//	are created faster than they are written, this waits for the entries
+//	which are still in flight. No entry is dropped.
+	writer.wait_for_capacity(numBytes);
+	WriteFunc write = createWriteFunc();
 
-//	set up the new file
+//	set up the new entry
 	stringstream ss;
-	ss << m_prefix << m_counter++ << m_suffix;
-	m_currentFile = ss.str();
+	ss << m_prefix << m_counter++;
+
+	Entry entry;
+	entry.name = ss.str();
+	entry.blocks.reset(new BlockVec);
+	m_currentEntry = entry;
+
+//	the snapshot is serialized directly into the compressor. Only the
+//	compressed blocks are kept.
+	shared_ptr<BlockVec> blocks = entry.blocks;
+	writer.enqueue(entry.name,
+		[write, blocks]() mutable -> bool
+	{
+		BlockCompressor compressor([blocks](const QByteArray& block){
+										blocks->push_back(block);
+										return true;
+									}, 1);
+		bool success = write(compressor);
+	//	release the data which was written as early as possible
+		write = WriteFunc();
 
-//	check whether we have to erase a file
-	if(m_numSteps == m_maxSteps){
-		--m_numSteps;
-		QFile rmFile(m_undoFiles.front().c_str());
-		m_undoFiles.pop_front();
-		rmFile.remove();
+		success = compressor.finish() && success;
+		if(!success)
+			blocks->clear();
+		return success;
+	}, numBytes);
+
+	enforce_budgets();
+}
+
+bool UndoHistory::
+restore_entry(const Entry& entry, QByteArray& dataOut)
+{
+	UndoFileWriter& writer = UndoHistoryProvider::inst().writer();
+	writer.wait_until_written(entry.name);
+	dataOut.clear();
+
+	BlockVec spilledBlocks;
+	if(entry.onDisk){
+		writer.wait_until_written(spill_filename(entry));
+		QFile in(spill_filename(entry).c_str());
+		if(!in.open(QIODevice::ReadOnly))
+			return false;
+		QDataStream stream(&in);
+		quint32 numBlocks = 0;
+		stream >> numBlocks;
+		spilledBlocks.resize(numBlocks);
+		for(quint32 i = 0; i < numBlocks; ++i)
+			stream >> spilledBlocks[i];
+		if(stream.status() != QDataStream::Ok)
+			return false;
 	}
 
-	return m_currentFile.c_str();
+	const BlockVec& blocks = entry.onDisk ? spilledBlocks : *entry.blocks;
+	if(blocks.empty())
+		return false;
+
+	size_t curBlock = 0;
+	BlockDecompressor decompressor([&blocks, &curBlock](QByteArray& blockOut){
+										if(curBlock < blocks.size())
+											blockOut = blocks[curBlock++];
+										else
+											blockOut.clear();
+										return true;
+									});
+	dataOut = decompressor.readAll();
+	if(decompressor.failed()){
+		dataOut.clear();
+		return false;
+	}
+	return true;
+}
+
+void UndoHistory::
+remove_entry(const Entry& entry)
+{
+	UndoFileWriter& writer = UndoHistoryProvider::inst().writer();
+	writer.discard(entry.name);
+	if(entry.onDisk){
+		writer.discard(spill_filename(entry));
+		QFile::remove(spill_filename(entry).c_str());
+	}
+}
+
+size_t UndoHistory::
+entry_size(Entry& entry)
+{
+	if(entry.numBytes == 0 && !entry.onDisk
+	   && !UndoHistoryProvider::inst().writer().is_pending(entry.name))
+	{
+		const BlockVec& blocks = *entry.blocks;
+		for(size_t i = 0; i < blocks.size(); ++i)
+			entry.numBytes += blocks[i].size();
+	}
+	return entry.numBytes;
 }
 
 void UndoHistory::
-set_suffix(const char *suffix)
+spill_entry(Entry& entry)
+{
+	shared_ptr<BlockVec> blocks = entry.blocks;
+	string filename = spill_filename(entry);
+	UndoHistoryProvider::inst().writer().enqueue(filename,
+		[blocks, filename]() -> bool
+	{
+		QFile file(filename.c_str());
+		if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+			return false;
+		QDataStream stream(&file);
+		stream << (quint32)blocks->size();
+		for(size_t i = 0; i < blocks->size(); ++i)
+			stream << (*blocks)[i];
+		return stream.status() == QDataStream::Ok;
+	});
+
+//	the memory is released as soon as the blocks were written
+	entry.blocks.reset();
+	entry.onDisk = true;
+}
+
+void UndoHistory::
+enforce_budgets()
+{
+	const UndoHistoryProvider& provider = UndoHistoryProvider::inst();
+
+	size_t memUsed = 0;
+	size_t diskUsed = 0;
+	auto addEntrySize = [&](Entry& entry){
+		if(entry.onDisk)
+			diskUsed += entry_size(entry);
+		else
+			memUsed += entry_size(entry);
+	};
+
+	addEntrySize(m_currentEntry);
+	for(EntryQueue::iterator iter = m_undoEntries.begin();
+		iter != m_undoEntries.end(); ++iter)
+	{
+		addEntrySize(*iter);
+	}
+	for(size_t i = 0; i < m_redoEntries.size(); ++i)
+		addEntrySize(m_redoEntries[i]);
+
+//	move the oldest entries in memory to disk. Redo entries are not moved,
+//	since they are dropped with the next entry anyways.
+	for(EntryQueue::iterator iter = m_undoEntries.begin();
+		iter != m_undoEntries.end() && memUsed > provider.memory_budget(); ++iter)
+	{
+		if(iter->onDisk || iter->numBytes == 0)
+			continue;
+		memUsed -= iter->numBytes;
+		diskUsed += iter->numBytes;
+		spill_entry(*iter);
+	}
+
+//	drop the oldest entries if they don't fit on disk
+	while(diskUsed > provider.disk_budget() && !m_undoEntries.empty()){
+		Entry& entry = m_undoEntries.front();
+		if(entry.onDisk)
+			diskUsed -= entry.numBytes;
+		else
+			memUsed -= entry.numBytes;
+		remove_entry(entry);
+		m_undoEntries.pop_front();
+	}
+}
+
+////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////
+//	UndoFileWriter implementation
+UndoFileWriter::
+UndoFileWriter(size_t maxPendingBytes) :
+	m_currentJob(0),
+	m_nextJobId(1),
+	m_busy(false),
+	m_quit(false),
+	m_maxPendingBytes(maxPendingBytes),
+	m_pendingBytes(0)
+{
+}
+
+UndoFileWriter::
+~UndoFileWriter()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_quit = true;
+	}
+	m_jobQueued.notify_all();
+	if(m_thread.joinable())
+		m_thread.join();
+}
+
+UndoFileWriter::JobId UndoFileWriter::
+enqueue(const std::string& filename, const WriteFunc& writeFunc, size_t numBytes)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	Job job;
+	job.id = m_nextJobId++;
+	job.filename = filename;
+	job.write = writeFunc;
+	job.numBytes = numBytes;
+	m_jobs.push_back(job);
+	m_pendingBytes += numBytes;
+
+	if(!m_thread.joinable())
+		m_thread = std::thread(&UndoFileWriter::run, this);
+	m_jobQueued.notify_one();
+	return job.id;
+}
+
+bool UndoFileWriter::
+has_capacity_locked(size_t numBytes) const
+{
+//	a single job which exceeds the cap on its own is always accepted
+	return m_pendingBytes == 0 || m_pendingBytes + numBytes <= m_maxPendingBytes;
+}
+
+bool UndoFileWriter::
+has_capacity(size_t numBytes)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return has_capacity_locked(numBytes);
+}
+
+void UndoFileWriter::
+wait_for_capacity(size_t numBytes)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_jobDone.wait(lock, [this, numBytes](){return has_capacity_locked(numBytes);});
+}
+
+bool UndoFileWriter::
+try_discard_locked(std::deque<Job>::iterator iter, WriteFunc& discardedFuncOut)
+{
+	if(iter == m_jobs.end())
+		return false;
+
+	discardedFuncOut.swap(iter->write);
+	m_pendingBytes -= iter->numBytes;
+	m_jobs.erase(iter);
+	return true;
+}
+
+bool UndoFileWriter::
+try_discard(const std::string& filename)
 {
-	m_suffix = suffix;
+	WriteFunc discardedFunc;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		std::deque<Job>::iterator iter = m_jobs.begin();
+		while(iter != m_jobs.end() && iter->filename != filename)
+			++iter;
+		if(!try_discard_locked(iter, discardedFunc))
+			return false;
+	}
+	m_jobDone.notify_all();
+//	the data held by discardedFunc is released here, outside of the lock.
+	return true;
+}
+
+bool UndoFileWriter::
+try_discard(JobId id)
+{
+	WriteFunc discardedFunc;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		std::deque<Job>::iterator iter = m_jobs.begin();
+		while(iter != m_jobs.end() && iter->id != id)
+			++iter;
+		if(!try_discard_locked(iter, discardedFunc))
+			return false;
+	}
+	m_jobDone.notify_all();
+	return true;
+}
+
+bool UndoFileWriter::
+is_pending_locked(const std::string& filename) const
+{
+	if(m_busy && m_currentFile == filename)
+		return true;
+	for(size_t i = 0; i < m_jobs.size(); ++i){
+		if(m_jobs[i].filename == filename)
+			return true;
+	}
+	return false;
+}
+
+bool UndoFileWriter::
+is_job_pending_locked(JobId id) const
+{
+	if(m_busy && m_currentJob == id)
+		return true;
+	for(size_t i = 0; i < m_jobs.size(); ++i){
+		if(m_jobs[i].id == id)
+			return true;
+	}
+	return false;
+}
+
+void UndoFileWriter::
+wait_until_written(const std::string& filename)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_jobDone.wait(lock, [this, &filename](){return !is_pending_locked(filename);});
+}
+
+void UndoFileWriter::
+discard(const std::string& filename)
+{
+	WriteFunc discardedFunc;
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		for(std::deque<Job>::iterator iter = m_jobs.begin();
+			iter != m_jobs.end(); ++iter)
+		{
+			if(iter->filename == filename){
+				discardedFunc.swap(iter->write);
+				m_pendingBytes -= iter->numBytes;
+				m_jobs.erase(iter);
+				m_jobDone.notify_all();
+				break;
+			}
+		}
+		m_jobDone.wait(lock, [this, &filename](){return !is_pending_locked(filename);});
+	}
+//	the copy of the mesh held by discardedFunc is released here, outside of the lock.
+}
+
+void UndoFileWriter::
+wait_until_idle()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_jobDone.wait(lock, [this](){return m_jobs.empty() && !m_busy;});
+}
+
+bool UndoFileWriter::
+is_pending(const std::string& filename)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return is_pending_locked(filename);
+}
+
+bool UndoFileWriter::
+is_job_pending(JobId id)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return is_job_pending_locked(id);
+}
+
+size_t UndoFileWriter::
+num_pending()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_jobs.size() + (m_busy ? 1 : 0);
+}
+
+void UndoFileWriter::
+take_failed_jobs(std::vector<FailedJob>& jobsOut)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	jobsOut.swap(m_failedJobs);
+	m_failedJobs.clear();
+}
+
+void UndoFileWriter::
+take_failed_files(std::vector<std::string>& filesOut)
+{
+	std::vector<FailedJob> failedJobs;
+	take_failed_jobs(failedJobs);
+	filesOut.clear();
+	for(size_t i = 0; i < failedJobs.size(); ++i)
+		filesOut.push_back(failedJobs[i].filename);
+}
+
+void UndoFileWriter::
+run()
+{
+	while(true){
+		Job job;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_jobQueued.wait(lock, [this](){return m_quit || !m_jobs.empty();});
+			if(m_jobs.empty())
+				return;
+			job.id = m_jobs.front().id;
+			job.filename = m_jobs.front().filename;
+			job.write.swap(m_jobs.front().write);
+			job.numBytes = m_jobs.front().numBytes;
+			m_jobs.pop_front();
+			m_currentFile = job.filename;
+			m_currentJob = job.id;
+			m_busy = true;
+		}
+
+		bool success = false;
+		try{
+			success = job.write();
+		}
+		catch(...){
+			success = false;
+		}
+	//	release the data of the job before it is reported as written
+		job.write = WriteFunc();
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_busy = false;
+			m_currentFile.clear();
+			m_currentJob = 0;
+			m_pendingBytes -= job.numBytes;
+			if(!success){
+				FailedJob failed;
+				failed.id = job.id;
+				failed.filename = job.filename;
+				m_failedJobs.push_back(failed);
+			}
+		}
+		m_jobDone.notify_all();
+	}
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -159,7 +564,8 @@ set_suffix(const char *suffix)
 //	UndoHistoryProvider implementation
 UndoHistoryProvider::
 UndoHistoryProvider() :
-	m_maxUndoSteps(100),
+	m_memoryBudget(size_t(512) << 20),
+	m_diskBudget(size_t(4096) << 20),
 	m_historyCounter(0)
 {
 }
@@ -167,6 +573,9 @@ UndoHistoryProvider() :
 UndoHistoryProvider::
 ~UndoHistoryProvider()
 {
+//	files which are still written would otherwise survive the cleanup
+	m_writer.wait_until_idle();
+
 	if(!m_path.empty()){
 	//	remove all files in .history
 		QDir history(m_parentDir);
@@ -227,5 +636,12 @@ create_undo_history()
 	stringstream ss;
 	ss << m_path << "/entry_" << m_historyCounter << "_";
 	++m_historyCounter;
-	return UndoHistory(ss.str().c_str(), m_maxUndoSteps);
+	return UndoHistory(ss.str().c_str());
+}
+
+void UndoHistoryProvider::
+set_budgets(size_t memoryBytes, size_t diskBytes)
+{
+	m_memoryBudget = memoryBytes;
+	m_diskBudget = diskBytes;
 }
@@ -28,16 +28,35 @@
 #ifndef UNDO_H
 #define UNDO_H
 
-#include <string>
+#include <condition_variable>
 #include <deque>
-#include <stack>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <memory>
+#include <vector>
+#include <QByteArray>
 #include <qdir.h>
 
+class QIODevice;
+
+///	Stores compressed mesh snapshots for undo and redo.
+/**	Entries are serialized and compressed in memory by the UndoFileWriter of
+ * the UndoHistoryProvider. No uncompressed data is written to disk.
+ * Compressed entries are kept in memory until the memory budget of the
+ * provider is exceeded. Older entries are then spilled to disk. If the disk
+ * budget is exceeded, the oldest entries are dropped.*/
 class UndoHistory
 {
 	public:
+	///	writes a snapshot of a mesh to the given device. Executed on the writer thread.
+		typedef std::function<bool (QIODevice& out)>	WriteFunc;
+	///	copies a mesh and returns a function which writes the copy. Executed on the calling thread.
+		typedef std::function<WriteFunc ()>				CreateWriteFunc;
+
 		UndoHistory();
-		UndoHistory(const char* fileNamePrefix, int maxSteps);
+		UndoHistory(const char* fileNamePrefix);
 
 	/** returns true if undo is possible for the given id*/
 		bool can_undo();
@@ -45,41 +64,169 @@ class UndoHistory
 	/** returns true if redo is possible for the given id*/
 		bool can_redo();
 
-	/** returns the name of the last valid undo-file and NULL if
-	 *	none exists. The undo-file is popped from the stack
-	 *	The returned pointer is valid until the next call of
-	 *	either undo, redo or create_history_entry.*/
-		const char* undo();
-
-	/** returns the name of the next valid redo-file and NULL if
-	 *	none exists. The redo-file is popped from the stack
-	 *	The returned pointer is valid until the next call of
-	 *	either undo, redo or create_history_entry.*/
-		const char* redo();
+	/** decompresses the last undo entry to dataOut. Returns false if none
+	 *	exists or if the entry couldn't be restored. The entry is popped
+	 *	from the stack. If it is still being written, the method waits.*/
+		bool undo(QByteArray& dataOut);
 
-	/**	returns the filename for the next history entry.
-	 *	Please note that this action clears the redo-stack.
-	 *	The returned pointer is valid until the next call of
-	 *	either undo, redo or create_history_entry.*/
-		const char* create_history_entry();
+	/** decompresses the next redo entry to dataOut. Returns false if none
+	 *	exists or if the entry couldn't be restored. The entry is popped
+	 *	from the stack.*/
+		bool redo(QByteArray& dataOut);
 
-	/**	Sets a suffix which is appended to each filename.*/
-		void set_suffix(const char* suffix);
+	/**	creates a new history entry which is written in the background.
+	 *	createWriteFunc is called to copy the mesh once the writer can hold
+	 *	another numBytes bytes, see UndoFileWriter::wait_for_capacity.
+	 *	Until then it blocks on the entries which are still being written.
+	 *	Please note that this action clears the redo-stack.*/
+		void create_history_entry(const CreateWriteFunc& createWriteFunc,
+								  size_t numBytes);
 
 	private:
-		typedef std::deque<std::string>	FileQueue;
-		typedef std::stack<std::string>	FileStack;
+		typedef std::vector<QByteArray>	BlockVec;
 
+		struct Entry{
+			Entry() : onDisk(false), numBytes(0)	{}
+		///	unique name of the entry. Used as key in the writer and for the spill file.
+			std::string					name;
+		///	compressed blocks of the entry. Filled by the writer thread.
+			std::shared_ptr<BlockVec>	blocks;
+			bool						onDisk;
+		///	compressed size. 0 while the entry is being written.
+			size_t						numBytes;
+		};
+
+		typedef std::deque<Entry>	EntryQueue;
+		typedef std::vector<Entry>	EntryStack;
+
+		bool restore_entry(const Entry& entry, QByteArray& dataOut);
+		void remove_entry(const Entry& entry);
+		size_t entry_size(Entry& entry);
+		void spill_entry(Entry& entry);
+		void enforce_budgets();
+		static std::string spill_filename(const Entry& entry)	{return entry.name + ".z";}
+
+	private:
 		bool		m_bInitialized;
 		int			m_counter;
 		std::string m_prefix;
-		std::string m_suffix;
-		std::string m_currentFile;
-		FileQueue	m_undoFiles;
-		FileStack	m_redoFiles;
-		int			m_maxSteps;
-		int			m_numSteps;
+		Entry		m_currentEntry;
+		EntryQueue	m_undoEntries;
+		EntryStack	m_redoEntries;
+};
+
+///	Writes undo files on a background thread.
+/**	Also used by the MainWindow to save meshes in the background.
+ * The data which shall be written has to be owned by the write function,
+ * e.g. through a copy of the mesh. enqueue never blocks.
+ *
+ * The memory held by queued and running jobs is capped by max_pending_bytes.
+ * Callers pass the size of the data which a job holds to enqueue and call
+ * wait_for_capacity before they create that data, e.g. before a mesh is
+ * copied on the GUI thread.
+ *
+ * Write functions must not access the GUI, since they are
+ * executed on the writer thread.*/
+class UndoFileWriter
+{
+	public:
+		typedef std::function<bool ()>	WriteFunc;
+	///	identifies a job. Ids are unique for the lifetime of a writer, 0 is never used.
+		typedef size_t					JobId;
+
+		struct FailedJob{
+			JobId		id;
+			std::string	filename;
+		};
+
+	///	default cap of the memory held by pending jobs (1 GB)
+		static const size_t DEFAULT_MAX_PENDING_BYTES = size_t(1) << 30;
+
+		UndoFileWriter(size_t maxPendingBytes = DEFAULT_MAX_PENDING_BYTES);
+		~UndoFileWriter();
+
+	/** schedules writeFunc, which writes the file 'filename'.
+	 *	numBytes is the memory held by writeFunc. It counts against the cap
+	 *	until writeFunc was executed and destroyed on the writer thread.
+	 *	Returns the id of the new job.*/
+		JobId enqueue(const std::string& filename, const WriteFunc& writeFunc,
+					  size_t numBytes = 0);
 
+	/** returns true if numBytes more bytes can be held without exceeding the cap.
+	 *	This is always the case if no job is pending.*/
+		bool has_capacity(size_t numBytes);
+
+	/** blocks until has_capacity(numBytes) returns true.*/
+		void wait_for_capacity(size_t numBytes);
+
+	/** removes the given file from the queue if it wasn't started yet.
+	 *	Returns true if the job was removed. Never blocks.*/
+		bool try_discard(const std::string& filename);
+
+	/** removes the given job from the queue if it wasn't started yet.
+	 *	Returns true if the job was removed. Never blocks.*/
+		bool try_discard(JobId id);
+
+	/** blocks until the given file was written. Returns immediately
+	 *	if the file is not in the queue.*/
+		void wait_until_written(const std::string& filename);
+
+	/** removes the given file from the queue or waits until it was written
+	 *	if it is currently being written.*/
+		void discard(const std::string& filename);
+
+	/** blocks until all queued files were written.*/
+		void wait_until_idle();
+
+	/** returns true if the given file is queued or currently written.*/
+		bool is_pending(const std::string& filename);
+
+	/** returns true if the given job is queued or currently executed.*/
+		bool is_job_pending(JobId id);
+
+	/** the number of files which are queued or currently written.*/
+		size_t num_pending();
+
+	/** returns the jobs whose write function failed since the last call
+	 *	to take_failed_jobs or take_failed_files.*/
+		void take_failed_jobs(std::vector<FailedJob>& jobsOut);
+
+	/** returns the names of files whose write function failed since the last call
+	 *	to take_failed_jobs or take_failed_files.*/
+		void take_failed_files(std::vector<std::string>& filesOut);
+
+		size_t max_pending_bytes() const	{return m_maxPendingBytes;}
+
+	private:
+		struct Job{
+			Job() : id(0), numBytes(0)	{}
+			JobId		id;
+			std::string	filename;
+			WriteFunc	write;
+			size_t		numBytes;
+		};
+
+		void run();
+		bool is_pending_locked(const std::string& filename) const;
+		bool is_job_pending_locked(JobId id) const;
+		bool has_capacity_locked(size_t numBytes) const;
+		bool try_discard_locked(std::deque<Job>::iterator iter, WriteFunc& discardedFuncOut);
+
+	private:
+		std::mutex				m_mutex;
+		std::condition_variable	m_jobQueued;
+		std::condition_variable	m_jobDone;
+		std::deque<Job>			m_jobs;
+		std::string				m_currentFile;
+		JobId					m_currentJob;
+		JobId					m_nextJobId;
+		bool					m_busy;
+		bool					m_quit;
+		size_t					m_maxPendingBytes;
+	///	memory held by queued jobs and the running job
+		size_t					m_pendingBytes;
+		std::vector<FailedJob>	m_failedJobs;
+		std::thread				m_thread;
 };
 
 class UndoHistoryProvider
@@ -94,16 +241,26 @@ class UndoHistoryProvider
 	 *	be associated.*/
 		UndoHistory create_undo_history();
 
+	/** sets the number of bytes which each history may use in memory and on disk.*/
+		void set_budgets(size_t memoryBytes, size_t diskBytes);
+		size_t memory_budget() const	{return m_memoryBudget;}
+		size_t disk_budget() const		{return m_diskBudget;}
+
+	/** writes the undo files of all histories in the background.*/
+		UndoFileWriter& writer()	{return m_writer;}
+
 	private:
 		UndoHistoryProvider();
 		~UndoHistoryProvider();
 
 	private:
-		int m_maxUndoSteps;
+		size_t		m_memoryBudget;
+		size_t		m_diskBudget;
 		std::string	m_path;				//the complete path
 		std::string	m_historyDirName;	//only the name of the history directory
 		QDir		m_parentDir;
 		int m_historyCounter;
+		UndoFileWriter	m_writer;
 };
 
 #endif // UNDO_H
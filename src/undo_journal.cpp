@@ -0,0 +1,1450 @@
+/*
+ * Copyright (c) 2026:  G-CSC, Goethe University Frankfurt
+ * Author: Sebastian Reiter
+ * 
+ * This file is part of ProMesh.
+ * 
+ * ProMesh is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License version 3 (as published by the
+ * Free Software Foundation) with the following additional attribution
+ * requirements (according to LGPL/GPL v3 §7):
+ * 
+ * (1) The following notice must be displayed in the Appropriate Legal Notices
+ * of covered and combined works: "Based on ProMesh (www.promesh3d.com)".
+ * 
+ * (2) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S. and Wittum, G. ProMesh -- a flexible interactive meshing software
+ *   for unstructured hybrid grids in 1, 2, and 3 dimensions. In preparation."
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <stdint.h>
+#include "undo.h"
+#include "undo_journal.h"
+#include "util/parallel_util.h"
+#include "common/profiler/profiler.h"
+
+using namespace std;
+using namespace ug;
+
+namespace{
+///	number of elements which are processed in one go during parallel scans
+const size_t SCAN_CHUNK_SIZE = 8192;
+
+inline bool PositionsDiffer(const vector3& p0, const vector3& p1)
+{
+	return p0.x() != p1.x() || p0.y() != p1.y() || p0.z() != p1.z();
+}
+
+template <class T>
+void SortAndRemoveDuplicates(vector<T>& v)
+{
+	sort(v.begin(), v.end());
+	v.erase(unique(v.begin(), v.end()), v.end());
+}
+
+bool SubsetInfosEqual(const vector<SubsetInfo>& infos0,
+					  const vector<SubsetInfo>& infos1)
+{
+	if(infos0.size() != infos1.size())
+		return false;
+
+	for(size_t i = 0; i < infos0.size(); ++i){
+		const SubsetInfo& si0 = infos0[i];
+		const SubsetInfo& si1 = infos1[i];
+		if(si0.name != si1.name
+		   || si0.materialIndex != si1.materialIndex
+		   || si0.subsetState != si1.subsetState
+		   || si0.color.x() != si1.color.x()
+		   || si0.color.y() != si1.color.y()
+		   || si0.color.z() != si1.color.z()
+		   || si0.color.w() != si1.color.w())
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+void GetSubsetInfos(vector<SubsetInfo>& infosOut, SubsetHandler& sh)
+{
+	infosOut.clear();
+	infosOut.reserve(sh.num_subsets());
+	for(int i = 0; i < sh.num_subsets(); ++i)
+		infosOut.push_back(sh.subset_info(i));
+}
+
+///	appends id to the last range if possible or starts a new range
+template <class TRange>
+void AddToSelectionRanges(vector<TRange>& ranges, unsigned int id,
+						  byte oldSelected, byte newSelected)
+{
+	if(!ranges.empty()){
+		TRange& r = ranges.back();
+		if(r.firstId + r.numIds == id && r.oldSelected == oldSelected
+		   && r.newSelected == newSelected)
+		{
+			++r.numIds;
+			return;
+		}
+	}
+
+	TRange r;
+	r.firstId = id;
+	r.numIds = 1;
+	r.oldSelected = oldSelected;
+	r.newSelected = newSelected;
+	ranges.push_back(r);
+}
+
+///	appends the ranges of src to dest and merges adjacent ranges
+template <class TRange>
+void AppendSelectionRanges(vector<TRange>& dest, const vector<TRange>& src)
+{
+	if(src.empty())
+		return;
+
+	size_t first = 0;
+	if(!dest.empty()){
+		TRange& r = dest.back();
+		const TRange& n = src.front();
+		if(r.firstId + r.numIds == n.firstId && r.oldSelected == n.oldSelected
+		   && r.newSelected == n.newSelected)
+		{
+			r.numIds += n.numIds;
+			first = 1;
+		}
+	}
+	dest.insert(dest.end(), src.begin() + first, src.end());
+}
+
+void RestoreSubsetInfos(SubsetHandler& sh, const vector<SubsetInfo>& infos)
+{
+//	all elements have already been removed from surplus subsets
+	while(sh.num_subsets() > (int)infos.size())
+		sh.erase_subset(sh.num_subsets() - 1);
+
+	if(!infos.empty())
+		sh.subset_required((int)infos.size() - 1);
+
+	for(size_t i = 0; i < infos.size(); ++i)
+		sh.subset_info((int)i) = infos[i];
+}
+
+////////////////////////////////////////////////////////////////////////
+//	serialization of records
+template <class T>
+void WriteValue(string& out, const T& val)
+{
+	out.append(reinterpret_cast<const char*>(&val), sizeof(T));
+}
+
+template <class T>
+void WriteVector(string& out, const vector<T>& vec)
+{
+	WriteValue(out, (uint64_t)vec.size());
+	if(!vec.empty())
+		out.append(reinterpret_cast<const char*>(&vec[0]), vec.size() * sizeof(T));
+}
+
+void WriteSubsetInfos(string& out, const vector<SubsetInfo>& infos)
+{
+	WriteValue(out, (uint64_t)infos.size());
+	for(size_t i = 0; i < infos.size(); ++i){
+		const SubsetInfo& si = infos[i];
+		WriteValue(out, (uint64_t)si.name.size());
+		out.append(si.name);
+		WriteValue(out, si.materialIndex);
+		WriteValue(out, si.color);
+		WriteValue(out, si.subsetState);
+	}
+}
+
+template <class T>
+bool ReadValue(const string& in, size_t& pos, T& valOut)
+{
+	if(in.size() - pos < sizeof(T))
+		return false;
+	memcpy(&valOut, in.data() + pos, sizeof(T));
+	pos += sizeof(T);
+	return true;
+}
+
+template <class T>
+bool ReadVector(const string& in, size_t& pos, vector<T>& vecOut)
+{
+	uint64_t num;
+	if(!ReadValue(in, pos, num) || num > (in.size() - pos) / sizeof(T))
+		return false;
+	vecOut.resize((size_t)num);
+	if(num > 0){
+		memcpy(&vecOut[0], in.data() + pos, (size_t)num * sizeof(T));
+		pos += (size_t)num * sizeof(T);
+	}
+	return true;
+}
+
+bool ReadSubsetInfos(const string& in, size_t& pos, vector<SubsetInfo>& infosOut)
+{
+	uint64_t num;
+	if(!ReadValue(in, pos, num) || num > in.size() - pos)
+		return false;
+	infosOut.resize((size_t)num);
+	for(size_t i = 0; i < infosOut.size(); ++i){
+		SubsetInfo& si = infosOut[i];
+		uint64_t nameLen;
+		if(!ReadValue(in, pos, nameLen) || nameLen > in.size() - pos)
+			return false;
+		si.name.assign(in, pos, (size_t)nameLen);
+		pos += (size_t)nameLen;
+		if(!(ReadValue(in, pos, si.materialIndex)
+			 && ReadValue(in, pos, si.color)
+			 && ReadValue(in, pos, si.subsetState)))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+}//	end of anonymous namespace
+
+
+bool UndoJournal::Step::
+has_element_changes() const
+{
+	for(int i = 0; i < NUM_LEVELS; ++i){
+		if(!(created[i].empty() && erased[i].empty() && changed[i].empty()
+			 && selChanged[i].empty()))
+		{
+			return true;
+		}
+	}
+	return !moved.empty();
+}
+
+void UndoJournal::TouchedElements::
+clear()
+{
+	vertices.clear();
+	faces.clear();
+	volumes.clear();
+	vacated = false;
+}
+
+void UndoJournal::TouchedElements::
+add_vacated(const vector3& p)
+{
+	if(!vacated){
+		vacatedMin = vacatedMax = p;
+		vacated = true;
+	}
+	else{
+		VecCompMin(vacatedMin, vacatedMin, p);
+		VecCompMax(vacatedMax, vacatedMax, p);
+	}
+}
+
+bool UndoJournal::Step::
+changes_selection_only() const
+{
+	for(int i = 0; i < NUM_LEVELS; ++i){
+		if(!(created[i].empty() && erased[i].empty() && changed[i].empty()))
+			return false;
+	}
+	return moved.empty()
+		   && SubsetInfosEqual(shBefore, shAfter)
+		   && SubsetInfosEqual(creaseBefore, creaseAfter);
+}
+
+size_t UndoJournal::Step::
+memory_size() const
+{
+	size_t numBytes = sizeof(Step)
+					  + (createdPos.capacity() + erasedPos.capacity()) * sizeof(vector3)
+					  + vrtIds.capacity() * sizeof(unsigned int)
+					  + moved.capacity() * sizeof(PosChange)
+					  + (shBefore.capacity() + shAfter.capacity()
+						 + creaseBefore.capacity() + creaseAfter.capacity())
+						* sizeof(SubsetInfo);
+	for(int i = 0; i < NUM_LEVELS; ++i){
+		numBytes += (created[i].capacity() + erased[i].capacity()) * sizeof(ElemState)
+					+ changed[i].capacity() * sizeof(AttribChange)
+					+ selChanged[i].capacity() * sizeof(SelectionRange);
+	}
+	return numBytes;
+}
+
+
+UndoJournal::
+UndoJournal() :
+	m_grid(NULL),
+	m_sh(NULL),
+	m_creaseHandler(NULL),
+	m_sel(NULL),
+	m_replaying(false),
+	m_selectionOnlyReplay(false),
+	m_idEpoch(0),
+	m_aInfo("UndoJournal_ElemInfo"),
+	m_aCommittedPos("UndoJournal_CommittedPosition"),
+	m_historyBytes(0)
+{
+}
+
+UndoJournal::
+~UndoJournal()
+{
+	release();
+}
+
+void UndoJournal::
+init(Grid& grid, SubsetHandler& sh, SubsetHandler& creaseHandler,
+	 Selector& sel, APosition& aPos)
+{
+	release();
+
+	m_grid = &grid;
+	m_sh = &sh;
+	m_creaseHandler = &creaseHandler;
+	m_sel = &sel;
+
+	grid.attach_to_vertices_dv(m_aInfo, ElemInfo());
+	grid.attach_to_edges_dv(m_aInfo, ElemInfo());
+	grid.attach_to_faces_dv(m_aInfo, ElemInfo());
+	grid.attach_to_volumes_dv(m_aInfo, ElemInfo());
+	grid.attach_to_vertices(m_aCommittedPos);
+
+	m_aaInfoVRT.access(grid, m_aInfo);
+	m_aaInfoEDGE.access(grid, m_aInfo);
+	m_aaInfoFACE.access(grid, m_aInfo);
+	m_aaInfoVOL.access(grid, m_aInfo);
+	m_aaPos.access(grid, aPos);
+	m_aaCommittedPos.access(grid, m_aCommittedPos);
+
+	reset_history();
+
+	grid.register_observer(this, OT_GRID_OBSERVER | OT_VERTEX_OBSERVER
+						   | OT_EDGE_OBSERVER | OT_FACE_OBSERVER
+						   | OT_VOLUME_OBSERVER);
+}
+
+void UndoJournal::
+release()
+{
+	if(!m_grid)
+		return;
+
+	m_grid->unregister_observer(this);
+
+	m_aaInfoVRT.invalidate();
+	m_aaInfoEDGE.invalidate();
+	m_aaInfoFACE.invalidate();
+	m_aaInfoVOL.invalidate();
+	m_aaPos.invalidate();
+	m_aaCommittedPos.invalidate();
+
+	m_grid->detach_from_vertices(m_aInfo);
+	m_grid->detach_from_edges(m_aInfo);
+	m_grid->detach_from_faces(m_aInfo);
+	m_grid->detach_from_volumes(m_aInfo);
+	m_grid->detach_from_vertices(m_aCommittedPos);
+
+	release_data();
+}
+
+void UndoJournal::
+release_data()
+{
+	m_undoSteps.clear();
+	m_redoSteps.clear();
+	m_historyBytes = 0;
+	m_pending = Step();
+	m_shInfos.clear();
+	m_creaseInfos.clear();
+	for(int i = 0; i < NUM_LEVELS; ++i){
+		vector<GridObject*>().swap(m_elems[i]);
+		vector<unsigned int>().swap(m_freshIds[i]);
+		vector<unsigned int>().swap(m_freeIds[i]);
+		vector<unsigned int>().swap(m_touchedIds[i]);
+	}
+
+	m_grid = NULL;
+	m_sh = NULL;
+	m_creaseHandler = NULL;
+	m_sel = NULL;
+}
+
+template <class TElem>
+void UndoJournal::
+take_current_state()
+{
+	typedef typename geometry_traits<TElem>::iterator iter_t;
+	const int lvl = TElem::BASE_OBJECT_ID;
+	vector<GridObject*>& elems = m_elems[lvl];
+	elems.clear();
+	elems.reserve(m_grid->num<TElem>());
+	m_freshIds[lvl].clear();
+	m_freeIds[lvl].clear();
+
+	for(iter_t iter = m_grid->begin<TElem>(); iter != m_grid->end<TElem>(); ++iter){
+		TElem* e = *iter;
+		ElemInfo& ei = info(e);
+		ei.id = (unsigned int)elems.size();
+		ei.subset = m_sh->get_subset_index(e);
+		ei.crease = m_creaseHandler->get_subset_index(e);
+		ei.selected = m_sel->get_selection_status(e);
+		ei.fresh = false;
+		elems.push_back(e);
+	}
+
+	if(lvl == VERTEX){
+		for(VertexIterator iter = m_grid->begin<Vertex>();
+			iter != m_grid->end<Vertex>(); ++iter)
+		{
+			m_aaCommittedPos[*iter] = m_aaPos[*iter];
+		}
+	}
+}
+
+void UndoJournal::
+reset_history()
+{
+	m_undoSteps.clear();
+	m_redoSteps.clear();
+	m_historyBytes = 0;
+	m_pending = Step();
+	++m_idEpoch;
+
+	take_current_state<Vertex>();
+	take_current_state<Edge>();
+	take_current_state<Face>();
+	take_current_state<Volume>();
+
+	GetSubsetInfos(m_shInfos, *m_sh);
+	GetSubsetInfos(m_creaseInfos, *m_creaseHandler);
+}
+
+UndoJournal::ElemInfo& UndoJournal::
+info(GridObject* e)
+{
+	switch(e->base_object_id()){
+		case VERTEX:	return info(static_cast<Vertex*>(e));
+		case EDGE:		return info(static_cast<Edge*>(e));
+		case FACE:		return info(static_cast<Face*>(e));
+		case VOLUME:	return info(static_cast<Volume*>(e));
+		default: UG_THROW("UndoJournal: Unsupported base object id: "
+						  << e->base_object_id());
+	}
+}
+
+////////////////////////////////////////////////////////////////////////
+//	recording
+template <class TElem>
+void UndoJournal::
+register_element(TElem* e)
+{
+	const int lvl = TElem::BASE_OBJECT_ID;
+	ElemInfo& ei = info(e);
+	ei = ElemInfo();
+	ei.id = new_id(lvl);
+	m_elems[lvl][ei.id] = e;
+	m_freshIds[lvl].push_back(ei.id);
+}
+
+template <class TElem>
+void UndoJournal::
+unregister_element(TElem* e)
+{
+	const int lvl = TElem::BASE_OBJECT_ID;
+	ElemInfo& ei = info(e);
+	vector<GridObject*>& elems = m_elems[lvl];
+
+//	the element may already have been unregistered by elements_to_be_cleared
+	if(ei.id >= elems.size() || elems[ei.id] != e)
+		return;
+
+	if(!(m_replaying || ei.fresh))
+		record_erased(e, m_pending);
+	free_id(lvl, ei.id);
+}
+
+unsigned int UndoJournal::
+new_id(int lvl)
+{
+	vector<GridObject*>& elems = m_elems[lvl];
+	vector<unsigned int>& freeIds = m_freeIds[lvl];
+
+//	A step may erase an element and create another one with the same id.
+//	This is fine, since all elements of a step are removed before any element
+//	is restored. During replays the recorded ids are assigned, which may
+//	take ids from the free list, so entries are validated on use.
+	if(!m_replaying){
+		while(!freeIds.empty()){
+			const unsigned int id = freeIds.back();
+			freeIds.pop_back();
+			if(!elems[id])
+				return id;
+		}
+	}
+
+	elems.push_back(NULL);
+	return (unsigned int)(elems.size() - 1);
+}
+
+void UndoJournal::
+free_id(int lvl, unsigned int id)
+{
+	m_elems[lvl][id] = NULL;
+	m_freeIds[lvl].push_back(id);
+
+//	ids which were taken again during replays are still listed
+	if(m_freeIds[lvl].size() > m_elems[lvl].size())
+		rebuild_free_ids(lvl);
+}
+
+void UndoJournal::
+rebuild_free_ids(int lvl)
+{
+	const vector<GridObject*>& elems = m_elems[lvl];
+	vector<unsigned int>& freeIds = m_freeIds[lvl];
+	freeIds.clear();
+//	reversed, so that low ids are reused first
+	for(size_t i = elems.size(); i > 0; --i){
+		if(!elems[i - 1])
+			freeIds.push_back((unsigned int)(i - 1));
+	}
+}
+
+template <class TElem>
+void UndoJournal::
+fill_state(TElem* e, const ElemInfo& ei, ElemState& esOut, Step& step)
+{
+	esOut.id = ei.id;
+	esOut.roid = e->reference_object_id();
+	esOut.subset = ei.subset;
+	esOut.crease = ei.crease;
+	esOut.selected = ei.selected;
+	esOut.numVrts = 0;
+	esOut.firstVrt = (unsigned int)step.vrtIds.size();
+}
+
+void UndoJournal::
+record_erased(Vertex* e, Step& step)
+{
+	const ElemInfo& ei = info(e);
+	ElemState es;
+	fill_state(e, ei, es, step);
+	step.erased[VERTEX].push_back(es);
+	step.erasedPos.push_back(m_aaCommittedPos[e]);
+}
+
+template <class TElem>
+void UndoJournal::
+record_erased(TElem* e, Step& step)
+{
+	const ElemInfo& ei = info(e);
+	ElemState es;
+	fill_state(e, ei, es, step);
+	es.numVrts = (byte)e->num_vertices();
+	for(size_t i = 0; i < e->num_vertices(); ++i)
+		step.vrtIds.push_back(info(e->vertex(i)).id);
+	step.erased[TElem::BASE_OBJECT_ID].push_back(es);
+}
+
+void UndoJournal::
+record_created(Vertex* e, Step& step)
+{
+	ElemState es;
+	fill_state(e, info(e), es, step);
+	step.created[VERTEX].push_back(es);
+	step.createdPos.push_back(m_aaPos[e]);
+	m_aaCommittedPos[e] = m_aaPos[e];
+}
+
+template <class TElem>
+void UndoJournal::
+record_created(TElem* e, Step& step)
+{
+	ElemState es;
+	fill_state(e, info(e), es, step);
+	es.numVrts = (byte)e->num_vertices();
+	for(size_t i = 0; i < e->num_vertices(); ++i)
+		step.vrtIds.push_back(info(e->vertex(i)).id);
+	step.created[TElem::BASE_OBJECT_ID].push_back(es);
+}
+
+template <class TElem>
+void UndoJournal::
+record_created_elements(Step& step)
+{
+	const int lvl = TElem::BASE_OBJECT_ID;
+	vector<GridObject*>& elems = m_elems[lvl];
+	vector<unsigned int>& freshIds = m_freshIds[lvl];
+
+	for(size_t i = 0; i < freshIds.size(); ++i){
+	//	elements which were created and erased again since the last
+	//	undo point are of no interest.
+		TElem* e = static_cast<TElem*>(elems[freshIds[i]]);
+		if(!e)
+			continue;
+
+		ElemInfo& ei = info(e);
+		if(!ei.fresh)
+			continue;
+
+		ei.subset = m_sh->get_subset_index(e);
+		ei.crease = m_creaseHandler->get_subset_index(e);
+		ei.selected = m_sel->get_selection_status(e);
+		ei.fresh = false;
+		record_created(e, step);
+	}
+	freshIds.clear();
+}
+
+template <class TElem>
+void UndoJournal::
+record_changed_elements(Step& step)
+{
+	typedef typename geometry_traits<TElem>::iterator iter_t;
+	vector<pair<iter_t, iter_t> > chunks;
+	CollectIteratorChunks(chunks, m_grid->begin<TElem>(), m_grid->end<TElem>(),
+						  SCAN_CHUNK_SIZE);
+
+	const size_t numThreadChunks = NumParallelChunks(chunks.size(), 1);
+	vector<vector<AttribChange> > chunkChanges(numThreadChunks);
+	vector<vector<SelectionRange> > chunkSelRanges(numThreadChunks);
+
+	ParallelForChunks(chunks.size(), 1,
+		[&](size_t threadChunk, size_t chunksBegin, size_t chunksEnd)
+	{
+		vector<AttribChange>& changes = chunkChanges[threadChunk];
+		vector<SelectionRange>& selRanges = chunkSelRanges[threadChunk];
+		for(size_t ichunk = chunksBegin; ichunk < chunksEnd; ++ichunk){
+			for(iter_t iter = chunks[ichunk].first;
+				iter != chunks[ichunk].second; ++iter)
+			{
+				TElem* e = *iter;
+				ElemInfo& ei = info(e);
+				if(ei.fresh)
+					continue;
+
+				const int si = m_sh->get_subset_index(e);
+				const int ci = m_creaseHandler->get_subset_index(e);
+				const byte sel = m_sel->get_selection_status(e);
+				if(si == ei.subset && ci == ei.crease){
+					if(sel != ei.selected){
+						AddToSelectionRanges(selRanges, ei.id, ei.selected, sel);
+						ei.selected = sel;
+					}
+				}
+				else{
+					AttribChange c;
+					c.id = ei.id;
+					c.oldSubset = ei.subset;
+					c.newSubset = si;
+					c.oldCrease = ei.crease;
+					c.newCrease = ci;
+					c.oldSelected = ei.selected;
+					c.newSelected = sel;
+					changes.push_back(c);
+
+					ei.subset = si;
+					ei.crease = ci;
+					ei.selected = sel;
+				}
+			}
+		}
+	});
+
+	vector<AttribChange>& changed = step.changed[TElem::BASE_OBJECT_ID];
+	vector<SelectionRange>& selChanged = step.selChanged[TElem::BASE_OBJECT_ID];
+	for(size_t i = 0; i < chunkChanges.size(); ++i){
+		changed.insert(changed.end(), chunkChanges[i].begin(), chunkChanges[i].end());
+		AppendSelectionRanges(selChanged, chunkSelRanges[i]);
+	}
+}
+
+void UndoJournal::
+record_moved_vertices(Step& step)
+{
+	vector<pair<VertexIterator, VertexIterator> > chunks;
+	CollectIteratorChunks(chunks, m_grid->begin<Vertex>(), m_grid->end<Vertex>(),
+						  SCAN_CHUNK_SIZE);
+
+	vector<vector<PosChange> > chunkMoves(NumParallelChunks(chunks.size(), 1));
+
+	ParallelForChunks(chunks.size(), 1,
+		[&](size_t threadChunk, size_t chunksBegin, size_t chunksEnd)
+	{
+		vector<PosChange>& moves = chunkMoves[threadChunk];
+		for(size_t ichunk = chunksBegin; ichunk < chunksEnd; ++ichunk){
+			for(VertexIterator iter = chunks[ichunk].first;
+				iter != chunks[ichunk].second; ++iter)
+			{
+				Vertex* v = *iter;
+				if(info(v).fresh)
+					continue;
+
+				vector3& committedPos = m_aaCommittedPos[v];
+				const vector3& pos = m_aaPos[v];
+				if(PositionsDiffer(pos, committedPos)){
+					PosChange m;
+					m.id = info(v).id;
+					m.oldPos = committedPos;
+					m.newPos = pos;
+					moves.push_back(m);
+					committedPos = pos;
+				}
+			}
+		}
+	});
+
+	for(size_t i = 0; i < chunkMoves.size(); ++i)
+		step.moved.insert(step.moved.end(), chunkMoves[i].begin(), chunkMoves[i].end());
+}
+
+void UndoJournal::
+collect_changes(Step& step)
+{
+	PROFILE_FUNC();
+	step = Step();
+	swap(step.erased, m_pending.erased);
+	swap(step.erasedPos, m_pending.erasedPos);
+	swap(step.vrtIds, m_pending.vrtIds);
+	m_pending = Step();
+
+//	changes have to be recorded before the fresh elements are committed.
+	record_changed_elements<Vertex>(step);
+	record_changed_elements<Edge>(step);
+	record_changed_elements<Face>(step);
+	record_changed_elements<Volume>(step);
+	record_moved_vertices(step);
+
+	record_created_elements<Vertex>(step);
+	record_created_elements<Edge>(step);
+	record_created_elements<Face>(step);
+	record_created_elements<Volume>(step);
+
+	step.shBefore.swap(m_shInfos);
+	GetSubsetInfos(m_shInfos, *m_sh);
+	step.shAfter = m_shInfos;
+
+	step.creaseBefore.swap(m_creaseInfos);
+	GetSubsetInfos(m_creaseInfos, *m_creaseHandler);
+	step.creaseAfter = m_creaseInfos;
+}
+
+void UndoJournal::
+create_history_entry()
+{
+	if(!is_initialized())
+		return;
+
+	Step step;
+	collect_changes(step);
+
+	if(!step.has_element_changes()
+	   && SubsetInfosEqual(step.shBefore, step.shAfter)
+	   && SubsetInfosEqual(step.creaseBefore, step.creaseAfter))
+	{
+		return;
+	}
+
+	push_step(step);
+}
+
+void UndoJournal::
+create_move_entry(const vector<Vertex*>& vrts)
+{
+	if(!is_initialized())
+		return;
+
+	bool topologyChanged = false;
+	for(int i = 0; i < NUM_LEVELS; ++i){
+		if(!(m_freshIds[i].empty() && m_pending.erased[i].empty()))
+			topologyChanged = true;
+	}
+
+	if(topologyChanged){
+		create_history_entry();
+		return;
+	}
+
+	Step step;
+	for(size_t i = 0; i < vrts.size(); ++i){
+		Vertex* v = vrts[i];
+		vector3& committedPos = m_aaCommittedPos[v];
+		const vector3& pos = m_aaPos[v];
+		if(PositionsDiffer(pos, committedPos)){
+			PosChange m;
+			m.id = info(v).id;
+			m.oldPos = committedPos;
+			m.newPos = pos;
+			step.moved.push_back(m);
+			committedPos = pos;
+		}
+	}
+
+	if(step.moved.empty())
+		return;
+
+	step.shBefore = step.shAfter = m_shInfos;
+	step.creaseBefore = step.creaseAfter = m_creaseInfos;
+	push_step(step);
+}
+
+void UndoJournal::
+push_step(Step& step)
+{
+	record_step(step, true);
+
+	for(size_t i = 0; i < m_redoSteps.size(); ++i)
+		m_historyBytes -= m_redoSteps[i].memory_size();
+	m_redoSteps.clear();
+
+	m_undoSteps.push_back(Step());
+	swap(m_undoSteps.back(), step);
+	m_historyBytes += m_undoSteps.back().memory_size();
+
+//	the newest step is always kept, even if it alone exceeds the budget.
+	const size_t budget = UndoHistoryProvider::inst().memory_budget();
+	while(m_historyBytes > budget && m_undoSteps.size() > 1){
+		m_historyBytes -= m_undoSteps.front().memory_size();
+		m_undoSteps.pop_front();
+	}
+}
+
+////////////////////////////////////////////////////////////////////////
+//	replay
+bool UndoJournal::
+undo(TouchedElements& touchedOut)
+{
+	PROFILE_FUNC();
+	if(!(is_initialized() && can_undo()))
+		return false;
+
+	Step pending;
+	collect_changes(pending);
+	m_selectionOnlyReplay = pending.changes_selection_only()
+							&& m_undoSteps.back().changes_selection_only();
+	if(!(apply(pending, false, touchedOut)
+		 && apply(m_undoSteps.back(), false, touchedOut)))
+	{
+		m_selectionOnlyReplay = false;
+		discard_touched_elements(touchedOut);
+		reset_history();
+		return false;
+	}
+	take_touched_elements(touchedOut);
+
+	record_step(m_undoSteps.back(), false);
+	m_redoSteps.push_back(Step());
+	swap(m_redoSteps.back(), m_undoSteps.back());
+	m_undoSteps.pop_back();
+	return true;
+}
+
+bool UndoJournal::
+redo(TouchedElements& touchedOut)
+{
+	PROFILE_FUNC();
+	if(!(is_initialized() && can_redo()))
+		return false;
+
+	Step pending;
+	collect_changes(pending);
+	m_selectionOnlyReplay = pending.changes_selection_only()
+							&& m_redoSteps.back().changes_selection_only();
+	if(!(apply(pending, false, touchedOut)
+		 && apply(m_redoSteps.back(), true, touchedOut)))
+	{
+		m_selectionOnlyReplay = false;
+		discard_touched_elements(touchedOut);
+		reset_history();
+		return false;
+	}
+	take_touched_elements(touchedOut);
+
+	record_step(m_redoSteps.back(), true);
+	m_undoSteps.push_back(Step());
+	swap(m_undoSteps.back(), m_redoSteps.back());
+	m_redoSteps.pop_back();
+	return true;
+}
+
+bool UndoJournal::
+apply(const Step& step, bool forward, TouchedElements& touchedOut)
+{
+	const vector<ElemState>* toRemove = forward ? step.erased : step.created;
+	const vector<ElemState>* toRestore = forward ? step.created : step.erased;
+	const vector<vector3>& restorePos = forward ? step.createdPos : step.erasedPos;
+	const SubsetInfoVec& shInfos = forward ? step.shAfter : step.shBefore;
+	const SubsetInfoVec& creaseInfos = forward ? step.creaseAfter : step.creaseBefore;
+
+	m_replaying = true;
+
+//	make sure that all subsets to which elements will be assigned exist
+	if(!shInfos.empty())
+		m_sh->subset_required((int)shInfos.size() - 1);
+	if(!creaseInfos.empty())
+		m_creaseHandler->subset_required((int)creaseInfos.size() - 1);
+
+	bool ok = true;
+	for(int lvl = NUM_LEVELS - 1; ok && lvl >= 0; --lvl)
+		ok = remove_elements(toRemove[lvl], lvl, touchedOut);
+
+	for(int lvl = 0; ok && lvl < NUM_LEVELS; ++lvl)
+		ok = restore_elements(step, toRestore[lvl], restorePos, lvl, touchedOut);
+
+	for(int lvl = 0; ok && lvl < NUM_LEVELS; ++lvl){
+		const vector<AttribChange>& changes = step.changed[lvl];
+		const vector<GridObject*>& elems = m_elems[lvl];
+		for(size_t i = 0; i < changes.size(); ++i){
+			const AttribChange& c = changes[i];
+			if(c.id >= elems.size() || !elems[c.id]){
+				ok = false;
+				break;
+			}
+			if(forward)
+				assign_state(elems[c.id], c.newSubset, c.newCrease, c.newSelected);
+			else
+				assign_state(elems[c.id], c.oldSubset, c.oldCrease, c.oldSelected);
+		}
+	}
+
+	for(int lvl = 0; ok && lvl < NUM_LEVELS; ++lvl){
+		const vector<SelectionRange>& ranges = step.selChanged[lvl];
+		const vector<GridObject*>& elems = m_elems[lvl];
+		for(size_t i = 0; ok && i < ranges.size(); ++i){
+			const SelectionRange& r = ranges[i];
+			const byte sel = forward ? r.newSelected : r.oldSelected;
+			for(unsigned int id = r.firstId; id < r.firstId + r.numIds; ++id){
+				if(id >= elems.size() || !elems[id]){
+					ok = false;
+					break;
+				}
+			//	subsets are unchanged in this case. We keep the committed ones.
+				const ElemInfo& ei = info(elems[id]);
+				assign_state(elems[id], ei.subset, ei.crease, sel);
+			}
+		}
+	}
+
+	if(ok && !step.moved.empty()){
+		const vector<GridObject*>& vrts = m_elems[VERTEX];
+		Grid::traits<Face>::secure_container faces;
+		Grid::traits<Volume>::secure_container vols;
+		for(size_t i = 0; i < step.moved.size(); ++i){
+			const PosChange& m = step.moved[i];
+			if(m.id >= vrts.size() || !vrts[m.id]){
+				ok = false;
+				break;
+			}
+			Vertex* v = static_cast<Vertex*>(vrts[m.id]);
+			touchedOut.add_vacated(m_aaPos[v]);
+			m_aaPos[v] = m_aaCommittedPos[v] = forward ? m.newPos : m.oldPos;
+			m_touchedIds[VERTEX].push_back(m.id);
+
+			m_grid->associated_elements(faces, v);
+			for(size_t j = 0; j < faces.size(); ++j)
+				m_touchedIds[FACE].push_back(info(faces[j]).id);
+			m_grid->associated_elements(vols, v);
+			for(size_t j = 0; j < vols.size(); ++j)
+				m_touchedIds[VOLUME].push_back(info(vols[j]).id);
+		}
+	}
+
+	RestoreSubsetInfos(*m_sh, shInfos);
+	RestoreSubsetInfos(*m_creaseHandler, creaseInfos);
+	m_shInfos = shInfos;
+	m_creaseInfos = creaseInfos;
+
+	m_replaying = false;
+
+	if(!ok)
+		UG_LOG("WARNING in UndoJournal::apply: The journal does not match the grid.\n");
+	return ok;
+}
+
+void UndoJournal::
+discard_touched_elements(TouchedElements& touchedOut)
+{
+//	elements which were touched may have been erased in the meantime
+	for(int lvl = 0; lvl < NUM_LEVELS; ++lvl)
+		m_touchedIds[lvl].clear();
+	touchedOut.clear();
+}
+
+void UndoJournal::
+take_touched_elements(TouchedElements& touchedOut)
+{
+//	elements are tracked by id, since a later step may have erased them again.
+	for(int lvl = 0; lvl < NUM_LEVELS; ++lvl){
+		vector<unsigned int>& ids = m_touchedIds[lvl];
+		if(lvl == EDGE){
+			ids.clear();
+			continue;
+		}
+
+		SortAndRemoveDuplicates(ids);
+		const vector<GridObject*>& elems = m_elems[lvl];
+		for(size_t i = 0; i < ids.size(); ++i){
+			GridObject* e = ids[i] < elems.size() ? elems[ids[i]] : NULL;
+			if(!e)
+				continue;
+			switch(lvl){
+				case VERTEX:	touchedOut.vertices.push_back(static_cast<Vertex*>(e)); break;
+				case FACE:		touchedOut.faces.push_back(static_cast<Face*>(e)); break;
+				case VOLUME:	touchedOut.volumes.push_back(static_cast<Volume*>(e)); break;
+			}
+		}
+		ids.clear();
+	}
+}
+
+bool UndoJournal::
+remove_elements(const vector<ElemState>& elems, int lvl,
+				TouchedElements& touchedOut)
+{
+	const vector<GridObject*>& tbl = m_elems[lvl];
+	for(size_t i = 0; i < elems.size(); ++i){
+		const unsigned int id = elems[i].id;
+		if(id >= tbl.size())
+			return false;
+
+	//	the element may have been erased together with one of its sides already.
+		GridObject* e = tbl[id];
+		if(!e)
+			continue;
+
+		switch(lvl){
+			case VERTEX:
+				touchedOut.add_vacated(m_aaPos[static_cast<Vertex*>(e)]);
+				m_grid->erase(static_cast<Vertex*>(e));
+				break;
+			case EDGE:		m_grid->erase(static_cast<Edge*>(e)); break;
+			case FACE:		m_grid->erase(static_cast<Face*>(e)); break;
+			case VOLUME:	m_grid->erase(static_cast<Volume*>(e)); break;
+		}
+	}
+	return true;
+}
+
+bool UndoJournal::
+restore_elements(const Step& step, const vector<ElemState>& elems,
+				 const vector<vector3>& vrtPositions, int lvl,
+				 TouchedElements& touchedOut)
+{
+	const vector<GridObject*>& vrtTbl = m_elems[VERTEX];
+	Vertex* vrts[MAX_VOLUME_VERTICES];
+
+	for(size_t i = 0; i < elems.size(); ++i){
+		const ElemState& es = elems[i];
+		GridObject* e = NULL;
+		if(lvl == VERTEX){
+			Vertex* v = *m_grid->create<RegularVertex>();
+			m_aaPos[v] = m_aaCommittedPos[v] = vrtPositions[i];
+			e = v;
+		}
+		else{
+			if(es.numVrts > MAX_VOLUME_VERTICES)
+				return false;
+			for(size_t j = 0; j < es.numVrts; ++j){
+				const unsigned int vrtId = step.vrtIds[es.firstVrt + j];
+				if(vrtId >= vrtTbl.size() || !vrtTbl[vrtId])
+					return false;
+				vrts[j] = static_cast<Vertex*>(vrtTbl[vrtId]);
+			}
+
+			e = create_element(es.roid, vrts, es.numVrts);
+			if(!e)
+				return false;
+		}
+
+		assign_id(e, es.id);
+		m_touchedIds[lvl].push_back(es.id);
+		assign_state(e, es.subset, es.crease, es.selected);
+	}
+	return true;
+}
+
+GridObject* UndoJournal::
+create_element(int roid, Vertex* const* vrts, size_t numVrts)
+{
+	Grid& g = *m_grid;
+	switch(roid){
+		case ROID_EDGE:{
+		//	the edge may have been created automatically together with a face
+			if(Edge* e = g.get_edge(vrts[0], vrts[1]))
+				return e;
+			return *g.create<RegularEdge>(EdgeDescriptor(vrts[0], vrts[1]));
+		}
+
+		case ROID_TRIANGLE:
+		case ROID_QUADRILATERAL:{
+			FaceDescriptor fd((uint)numVrts);
+			for(size_t i = 0; i < numVrts; ++i)
+				fd.set_vertex((uint)i, vrts[i]);
+			if(Face* f = g.get_face(fd))
+				return f;
+			if(roid == ROID_TRIANGLE)
+				return *g.create<Triangle>(TriangleDescriptor(vrts[0], vrts[1], vrts[2]));
+			return *g.create<Quadrilateral>(QuadrilateralDescriptor(vrts[0], vrts[1],
+																	vrts[2], vrts[3]));
+		}
+
+		case ROID_TETRAHEDRON:
+		case ROID_PYRAMID:
+		case ROID_PRISM:
+		case ROID_HEXAHEDRON:
+		case ROID_OCTAHEDRON:{
+			VolumeDescriptor vd((uint)numVrts);
+			for(size_t i = 0; i < numVrts; ++i)
+				vd.set_vertex((uint)i, vrts[i]);
+			if(Volume* v = g.get_volume(vd))
+				return v;
+
+			switch(roid){
+				case ROID_TETRAHEDRON:
+					return *g.create<Tetrahedron>(TetrahedronDescriptor(
+								vrts[0], vrts[1], vrts[2], vrts[3]));
+				case ROID_PYRAMID:
+					return *g.create<Pyramid>(PyramidDescriptor(
+								vrts[0], vrts[1], vrts[2], vrts[3], vrts[4]));
+				case ROID_PRISM:
+					return *g.create<Prism>(PrismDescriptor(
+								vrts[0], vrts[1], vrts[2], vrts[3], vrts[4], vrts[5]));
+				case ROID_HEXAHEDRON:
+					return *g.create<Hexahedron>(HexahedronDescriptor(
+								vrts[0], vrts[1], vrts[2], vrts[3],
+								vrts[4], vrts[5], vrts[6], vrts[7]));
+				default:
+					return *g.create<Octahedron>(OctahedronDescriptor(
+								vrts[0], vrts[1], vrts[2], vrts[3], vrts[4], vrts[5]));
+			}
+		}
+
+		default:
+			UG_LOG("WARNING in UndoJournal::create_element: Unsupported "
+				   "reference object id: " << roid << "\n");
+			return NULL;
+	}
+}
+
+void UndoJournal::
+assign_id(GridObject* e, unsigned int id)
+{
+	const int lvl = e->base_object_id();
+	vector<GridObject*>& elems = m_elems[lvl];
+	ElemInfo& ei = info(e);
+
+//	the element was registered with a new id during its creation
+	if(ei.id < elems.size() && elems[ei.id] == e)
+		free_id(lvl, ei.id);
+
+	if(id >= elems.size())
+		elems.resize(id + 1, NULL);
+	elems[id] = e;
+	ei.id = id;
+}
+
+template <class TElem>
+void UndoJournal::
+assign_state(TElem* e, int subset, int crease, byte selected)
+{
+	if(m_sh->get_subset_index(e) != subset)
+		m_sh->assign_subset(e, subset);
+	if(m_creaseHandler->get_subset_index(e) != crease)
+		m_creaseHandler->assign_subset(e, crease);
+	if(selected)
+		m_sel->select(e, selected);
+	else if(m_sel->is_selected(e))
+		m_sel->deselect(e);
+
+	ElemInfo& ei = info(e);
+	ei.subset = subset;
+	ei.crease = crease;
+	ei.selected = selected;
+	ei.fresh = false;
+}
+
+void UndoJournal::
+assign_state(GridObject* e, int subset, int crease, byte selected)
+{
+	switch(e->base_object_id()){
+		case VERTEX:	assign_state(static_cast<Vertex*>(e), subset, crease, selected); break;
+		case EDGE:		assign_state(static_cast<Edge*>(e), subset, crease, selected); break;
+		case FACE:		assign_state(static_cast<Face*>(e), subset, crease, selected); break;
+		case VOLUME:	assign_state(static_cast<Volume*>(e), subset, crease, selected); break;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////
+//	records
+void UndoJournal::
+record_step(const Step& step, bool forward)
+{
+	if(!m_recordFunc)
+		return;
+
+	string record;
+	record.reserve(step.memory_size());
+	record.push_back(forward ? 1 : 0);
+	write_step(record, step);
+	m_recordFunc(record);
+}
+
+void UndoJournal::
+write_step(string& out, const Step& step)
+{
+	for(int i = 0; i < NUM_LEVELS; ++i){
+		WriteVector(out, step.created[i]);
+		WriteVector(out, step.erased[i]);
+		WriteVector(out, step.changed[i]);
+		WriteVector(out, step.selChanged[i]);
+	}
+	WriteVector(out, step.createdPos);
+	WriteVector(out, step.erasedPos);
+	WriteVector(out, step.vrtIds);
+	WriteVector(out, step.moved);
+	WriteSubsetInfos(out, step.shBefore);
+	WriteSubsetInfos(out, step.shAfter);
+	WriteSubsetInfos(out, step.creaseBefore);
+	WriteSubsetInfos(out, step.creaseAfter);
+}
+
+bool UndoJournal::
+read_step(const string& in, size_t& pos, Step& stepOut)
+{
+	for(int i = 0; i < NUM_LEVELS; ++i){
+		if(!(ReadVector(in, pos, stepOut.created[i])
+			 && ReadVector(in, pos, stepOut.erased[i])
+			 && ReadVector(in, pos, stepOut.changed[i])
+			 && ReadVector(in, pos, stepOut.selChanged[i])))
+		{
+			return false;
+		}
+	}
+
+	if(!(ReadVector(in, pos, stepOut.createdPos)
+		 && ReadVector(in, pos, stepOut.erasedPos)
+		 && ReadVector(in, pos, stepOut.vrtIds)
+		 && ReadVector(in, pos, stepOut.moved)
+		 && ReadSubsetInfos(in, pos, stepOut.shBefore)
+		 && ReadSubsetInfos(in, pos, stepOut.shAfter)
+		 && ReadSubsetInfos(in, pos, stepOut.creaseBefore)
+		 && ReadSubsetInfos(in, pos, stepOut.creaseAfter)))
+	{
+		return false;
+	}
+
+//	make sure that the vertex ids of all elements are available
+	for(int i = 0; i < NUM_LEVELS; ++i){
+		const vector<ElemState>* states[2] = {&stepOut.created[i], &stepOut.erased[i]};
+		for(int j = 0; j < 2; ++j){
+			for(size_t k = 0; k < states[j]->size(); ++k){
+				const ElemState& es = (*states[j])[k];
+				if((size_t)es.firstVrt + es.numVrts > stepOut.vrtIds.size())
+					return false;
+			}
+		}
+	}
+
+	return stepOut.createdPos.size() == stepOut.created[VERTEX].size()
+		   && stepOut.erasedPos.size() == stepOut.erased[VERTEX].size();
+}
+
+template <class TElem>
+void UndoJournal::
+write_ids(string& idsOut)
+{
+	typedef typename geometry_traits<TElem>::iterator iter_t;
+	vector<IdRun> runs;
+	for(iter_t iter = m_grid->begin<TElem>(); iter != m_grid->end<TElem>(); ++iter){
+		const unsigned int id = info(*iter).id;
+		if(!runs.empty() && runs.back().firstId + runs.back().numIds == id)
+			++runs.back().numIds;
+		else{
+			IdRun r;
+			r.firstId = id;
+			r.numIds = 1;
+			runs.push_back(r);
+		}
+	}
+	WriteValue(idsOut, (uint64_t)m_grid->num<TElem>());
+	WriteVector(idsOut, runs);
+}
+
+void UndoJournal::
+write_ids(string& idsOut)
+{
+//	ids are stored as runs of consecutive ids, since most elements keep
+//	the order in which they were created.
+	idsOut.clear();
+	write_ids<Vertex>(idsOut);
+	write_ids<Edge>(idsOut);
+	write_ids<Face>(idsOut);
+	write_ids<Volume>(idsOut);
+}
+
+template <class TElem>
+bool UndoJournal::
+assign_ids(const string& ids, size_t& pos)
+{
+	typedef typename geometry_traits<TElem>::iterator iter_t;
+	const int lvl = TElem::BASE_OBJECT_ID;
+
+	uint64_t numElems;
+	vector<IdRun> runs;
+	if(!(ReadValue(ids, pos, numElems) && ReadVector(ids, pos, runs))
+	   || numElems != m_grid->num<TElem>())
+	{
+		return false;
+	}
+
+	size_t tableSize = 0;
+	uint64_t numIds = 0;
+	for(size_t i = 0; i < runs.size(); ++i){
+		tableSize = max<size_t>(tableSize, (size_t)runs[i].firstId + runs[i].numIds);
+		numIds += runs[i].numIds;
+	}
+	if(numIds != numElems)
+		return false;
+
+	vector<GridObject*>& elems = m_elems[lvl];
+	elems.assign(tableSize, NULL);
+
+	iter_t iter = m_grid->begin<TElem>();
+	for(size_t i = 0; i < runs.size(); ++i){
+		for(unsigned int id = runs[i].firstId;
+			id < runs[i].firstId + runs[i].numIds; ++id, ++iter)
+		{
+			if(elems[id])
+				return false;
+			elems[id] = *iter;
+			info(*iter).id = id;
+		}
+	}
+	rebuild_free_ids(lvl);
+	return true;
+}
+
+bool UndoJournal::
+assign_ids(const string& ids)
+{
+	if(!is_initialized())
+		return false;
+
+	size_t pos = 0;
+	if(assign_ids<Vertex>(ids, pos) && assign_ids<Edge>(ids, pos)
+	   && assign_ids<Face>(ids, pos) && assign_ids<Volume>(ids, pos))
+	{
+		return true;
+	}
+
+//	the ids don't match the grid. Elements may now share ids.
+	reset_history();
+	return false;
+}
+
+bool UndoJournal::
+replay_record(const string& record, TouchedElements& touchedOut)
+{
+	if(!is_initialized() || record.empty())
+		return false;
+
+	Step step;
+	size_t pos = 1;
+	if(!read_step(record, pos, step) || pos != record.size())
+		return false;
+
+//	uncommitted changes would otherwise be recorded with the next entry
+	Step pending;
+	collect_changes(pending);
+
+	m_selectionOnlyReplay = false;
+	if(!apply(step, record[0] != 0, touchedOut)){
+		discard_touched_elements(touchedOut);
+		return false;
+	}
+	take_touched_elements(touchedOut);
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////
+//	GridObserver callbacks
+void UndoJournal::
+grid_to_be_destroyed(Grid* grid)
+{
+//	the attachments are destroyed together with the grid
+	release_data();
+}
+
+void UndoJournal::
+elements_to_be_cleared(Grid* grid)
+{
+//	all elements are erased. We record them here in one go and ignore
+//	the erase notifications which may follow.
+	for(VolumeIterator iter = grid->begin<Volume>(); iter != grid->end<Volume>(); ++iter)
+		unregister_element(*iter);
+	for(FaceIterator iter = grid->begin<Face>(); iter != grid->end<Face>(); ++iter)
+		unregister_element(*iter);
+	for(EdgeIterator iter = grid->begin<Edge>(); iter != grid->end<Edge>(); ++iter)
+		unregister_element(*iter);
+	for(VertexIterator iter = grid->begin<Vertex>(); iter != grid->end<Vertex>(); ++iter)
+		unregister_element(*iter);
+}
+
+void UndoJournal::
+vertex_created(Grid* grid, Vertex* vrt, GridObject* pParent, bool replacesParent)
+{
+	register_element(vrt);
+}
+
+void UndoJournal::
+edge_created(Grid* grid, Edge* e, GridObject* pParent, bool replacesParent)
+{
+	register_element(e);
+}
+
+void UndoJournal::
+face_created(Grid* grid, Face* f, GridObject* pParent, bool replacesParent)
+{
+	register_element(f);
+}
+
+void UndoJournal::
+volume_created(Grid* grid, Volume* vol, GridObject* pParent, bool replacesParent)
+{
+	register_element(vol);
+}
+
+void UndoJournal::
+vertex_to_be_erased(Grid* grid, Vertex* vrt, Vertex* replacedBy)
+{
+	unregister_element(vrt);
+}
+
+void UndoJournal::
+edge_to_be_erased(Grid* grid, Edge* e, Edge* replacedBy)
+{
+	unregister_element(e);
+}
+
+void UndoJournal::
+face_to_be_erased(Grid* grid, Face* f, Face* replacedBy)
+{
+	unregister_element(f);
+}
+
+void UndoJournal::
+volume_to_be_erased(Grid* grid, Volume* vol, Volume* replacedBy)
+{
+	unregister_element(vol);
+}
@@ -0,0 +1,365 @@
+/*
+ * Copyright (c) 2026:  G-CSC, Goethe University Frankfurt
+ * Author: Sebastian Reiter
+ * 
+ * This file is part of ProMesh.
+ * 
+ * ProMesh is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License version 3 (as published by the
+ * Free Software Foundation) with the following additional attribution
+ * requirements (according to LGPL/GPL v3 §7):
+ * 
+ * (1) The following notice must be displayed in the Appropriate Legal Notices
+ * of covered and combined works: "Based on ProMesh (www.promesh3d.com)".
+ * 
+ * (2) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S. and Wittum, G. ProMesh -- a flexible interactive meshing software
+ *   for unstructured hybrid grids in 1, 2, and 3 dimensions. In preparation."
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#ifndef __H__PROMESH_undo_journal
+#define __H__PROMESH_undo_journal
+
+#include <deque>
+#include <functional>
+#include <string>
+#include <vector>
+#include "lib_grid/lib_grid.h"
+
+///	Records the changes of a grid between undo points and replays them on undo / redo.
+/**	Instead of storing a snapshot of the whole mesh for each undo point, the
+ * journal records which elements were created and erased and which vertices
+ * were moved, which elements changed their subset, crease-subset or
+ * selection state and how the subset infos changed. Undo and redo replay
+ * those records in place, so their cost is proportional to the size of
+ * the change and unchanged elements keep their identity.
+ *
+ * Each element is identified by an id which is stored in an attachment and
+ * which survives its erasure and recreation through undo / redo. Ids of
+ * erased elements are reused for new elements, so that the id tables don't
+ * grow beyond the largest number of elements which existed at a time. This
+ * is safe, since undo and redo always restore the exact id assignment of
+ * the targeted undo point.
+ *
+ * Besides the history, the journal keeps an ElemInfo (16 bytes) for each
+ * element, a pointer per id and a copy of each vertex position (the position
+ * at the last undo point), against which moved vertices are detected.
+ *
+ * Each committed or replayed history entry can be passed as a serialized
+ * record to a record function. Replaying those records on a checkpoint of
+ * the grid restores the current state, which is used for crash recovery.
+ *
+ * Changes to custom attachments and to the projection handler are not recorded.
+ * Elements are recreated as regular elements of the same reference object type.*/
+class UndoJournal : public ug::GridObserver
+{
+	public:
+		UndoJournal();
+		virtual ~UndoJournal();
+
+	///	attaches the journal and takes the current state as the initial undo point.
+		void init(ug::Grid& grid, ug::SubsetHandler& sh,
+				  ug::SubsetHandler& creaseHandler, ug::Selector& sel,
+				  ug::APosition& aPos);
+
+	///	detaches the journal from the grid and releases the history.
+		void release();
+
+		bool is_initialized() const		{return m_grid != NULL;}
+
+		bool can_undo() const			{return !m_undoSteps.empty();}
+		bool can_redo() const			{return !m_redoSteps.empty();}
+
+	///	returns true if the last call to undo or redo only changed the selection.
+	/**	In this case neither the geometry nor the subsets have been touched.*/
+		bool last_replay_changed_selection_only() const	{return m_selectionOnlyReplay;}
+
+	///	creates a history entry from all changes since the last undo point.
+	/**	Clears the redo stack. Does nothing if nothing changed. The oldest
+	 * entries are dropped if the history exceeds the memory budget of the
+	 * UndoHistoryProvider.*/
+		void create_history_entry();
+
+	///	creates a history entry for the given vertices, which were moved since the last undo point.
+	/**	Only the positions of the given vertices are compared, which makes
+	 * this method much cheaper than create_history_entry for large grids.
+	 * The caller has to guarantee that no other attributes were changed
+	 * since the last undo point. If elements were created or erased, the
+	 * method falls back to create_history_entry.*/
+		void create_move_entry(const std::vector<ug::Vertex*>& vrts);
+
+	///	elements whose geometry changed during a replay
+	/**	Used to update normals, bounding spheres and the bounding box locally.*/
+		struct TouchedElements{
+			TouchedElements() : vacated(false)	{}
+			void clear();
+		///	extends the vacated box by p
+			void add_vacated(const ug::vector3& p);
+
+		///	moved and recreated vertices
+			std::vector<ug::Vertex*>	vertices;
+		///	recreated faces and faces which contain moved vertices
+			std::vector<ug::Face*>		faces;
+		///	recreated volumes and volumes which contain moved vertices
+			std::vector<ug::Volume*>	volumes;
+		///	true if vertices were moved or erased
+			bool						vacated;
+		///	bounding box of the previous positions of moved and erased vertices
+			ug::vector3					vacatedMin, vacatedMax;
+		};
+
+	///	reverts uncommitted changes and the last history entry.
+	/**	Elements whose geometry changed are appended to touchedOut.
+	 * If the journal is inconsistent with the grid, the history is cleared
+	 * and false is returned. touchedOut is empty in this case.*/
+		bool undo(TouchedElements& touchedOut);
+
+	///	reverts uncommitted changes and replays the last undone history entry.
+		bool redo(TouchedElements& touchedOut);
+
+	///	called with a serialized record of each history entry which is committed or replayed.
+		typedef std::function<void (const std::string& record)>	RecordFunc;
+		void set_record_func(const RecordFunc& recordFunc)	{m_recordFunc = recordFunc;}
+
+	///	changes whenever ids are reassigned to all elements.
+	/**	Records can only be replayed onto a checkpoint of the same epoch.*/
+		int id_epoch() const		{return m_idEpoch;}
+
+	///	writes the ids of all elements in iteration order.
+	/**	Together with a copy of the grid which is taken at the same time, the
+	 * ids form a checkpoint onto which later records can be replayed.
+	 * Must only be called if there are no uncommitted changes, e.g. directly
+	 * after create_history_entry.*/
+		void write_ids(std::string& idsOut);
+
+	///	assigns ids which were written by write_ids to the elements in iteration order.
+	/**	Returns false if ids doesn't match the grid.*/
+		bool assign_ids(const std::string& ids);
+
+	///	applies a record which was passed to the record function.
+	/**	Returns false if the record is corrupt or doesn't match the grid.*/
+		bool replay_record(const std::string& record, TouchedElements& touchedOut);
+
+	//	GridObserver callbacks
+		virtual void grid_to_be_destroyed(ug::Grid* grid);
+		virtual void elements_to_be_cleared(ug::Grid* grid);
+
+		virtual void vertex_created(ug::Grid* grid, ug::Vertex* vrt,
+									ug::GridObject* pParent = NULL,
+									bool replacesParent = false);
+		virtual void edge_created(ug::Grid* grid, ug::Edge* e,
+								  ug::GridObject* pParent = NULL,
+								  bool replacesParent = false);
+		virtual void face_created(ug::Grid* grid, ug::Face* f,
+								  ug::GridObject* pParent = NULL,
+								  bool replacesParent = false);
+		virtual void volume_created(ug::Grid* grid, ug::Volume* vol,
+									ug::GridObject* pParent = NULL,
+									bool replacesParent = false);
+
+		virtual void vertex_to_be_erased(ug::Grid* grid, ug::Vertex* vrt,
+										 ug::Vertex* replacedBy = NULL);
+		virtual void edge_to_be_erased(ug::Grid* grid, ug::Edge* e,
+									   ug::Edge* replacedBy = NULL);
+		virtual void face_to_be_erased(ug::Grid* grid, ug::Face* f,
+									   ug::Face* replacedBy = NULL);
+		virtual void volume_to_be_erased(ug::Grid* grid, ug::Volume* vol,
+										 ug::Volume* replacedBy = NULL);
+
+	private:
+		static const unsigned int INVALID_ID = 0xFFFFFFFF;
+		enum{NUM_LEVELS = 4};
+
+	///	per element data. All values except id are those of the last undo point.
+		struct ElemInfo{
+			ElemInfo() : id(INVALID_ID), subset(-1), crease(-1),
+						 selected(0), fresh(true)	{}
+			unsigned int	id;
+			int				subset;
+			int				crease;
+			ug::byte		selected;
+		///	true if the element was created since the last undo point
+			bool			fresh;
+		};
+
+		typedef ug::Attachment<ElemInfo>	AElemInfo;
+
+	///	state of a created or erased element
+		struct ElemState{
+			unsigned int	id;
+			int				roid;
+			int				subset;
+			int				crease;
+			ug::byte		selected;
+			ug::byte		numVrts;
+		///	index of the first vertex id in Step::vrtIds (not used for vertices)
+			unsigned int	firstVrt;
+		};
+
+		struct AttribChange{
+			unsigned int	id;
+			int				oldSubset, newSubset;
+			int				oldCrease, newCrease;
+			ug::byte		oldSelected, newSelected;
+		};
+
+	///	a range of consecutive ids whose selection status changed from old to new
+	/**	Selection changes are stored separately, since a selection usually
+	 * changes for large blocks of elements without further changes.*/
+		struct SelectionRange{
+			unsigned int	firstId;
+			unsigned int	numIds;
+			ug::byte		oldSelected, newSelected;
+		};
+
+		struct PosChange{
+			unsigned int	id;
+			ug::vector3		oldPos, newPos;
+		};
+
+	///	a run of consecutive ids of elements which are consecutive in iteration order
+		struct IdRun{
+			unsigned int	firstId;
+			unsigned int	numIds;
+		};
+
+		typedef std::vector<ug::SubsetInfo>	SubsetInfoVec;
+
+		struct Step{
+			std::vector<ElemState>		created[NUM_LEVELS];
+			std::vector<ElemState>		erased[NUM_LEVELS];
+		///	positions of created / erased vertices (parallel to created[0] / erased[0])
+			std::vector<ug::vector3>	createdPos;
+			std::vector<ug::vector3>	erasedPos;
+			std::vector<unsigned int>	vrtIds;
+			std::vector<AttribChange>	changed[NUM_LEVELS];
+			std::vector<SelectionRange>	selChanged[NUM_LEVELS];
+			std::vector<PosChange>		moved;
+			SubsetInfoVec				shBefore, shAfter;
+			SubsetInfoVec				creaseBefore, creaseAfter;
+
+			bool has_element_changes() const;
+		///	true if only the selection status of some elements was changed
+			bool changes_selection_only() const;
+		///	approximate number of bytes used by the step
+			size_t memory_size() const;
+		};
+
+	private:
+		ElemInfo& info(ug::Vertex* e)	{return m_aaInfoVRT[e];}
+		ElemInfo& info(ug::Edge* e)		{return m_aaInfoEDGE[e];}
+		ElemInfo& info(ug::Face* e)		{return m_aaInfoFACE[e];}
+		ElemInfo& info(ug::Volume* e)	{return m_aaInfoVOL[e];}
+		ElemInfo& info(ug::GridObject* e);
+
+	///	assigns ids to all elements and takes their current state as committed state.
+		template <class TElem> void take_current_state();
+
+		template <class TElem> void register_element(TElem* e);
+		template <class TElem> void unregister_element(TElem* e);
+
+	///	returns an unused id of the given level, preferably one of an erased element.
+	/**	Ids of erased elements are only reused outside of replays, since
+	 * replays assign the recorded ids to the elements they recreate.*/
+		unsigned int new_id(int lvl);
+	///	releases the slot of id in m_elems and makes id available for reuse.
+		void free_id(int lvl, unsigned int id);
+	///	collects the ids of all empty slots of the given level.
+		void rebuild_free_ids(int lvl);
+
+		void record_erased(ug::Vertex* e, Step& step);
+		template <class TElem> void record_erased(TElem* e, Step& step);
+		void record_created(ug::Vertex* e, Step& step);
+		template <class TElem> void record_created(TElem* e, Step& step);
+		template <class TElem> void record_created_elements(Step& step);
+		template <class TElem> void record_changed_elements(Step& step);
+		void record_moved_vertices(Step& step);
+
+		template <class TElem>
+		void fill_state(TElem* e, const ElemInfo& ei, ElemState& esOut, Step& step);
+
+	///	fills step with all changes since the last undo point and commits them.
+		void collect_changes(Step& step);
+
+	///	applies a step either forward (redo) or backward (undo)
+		bool apply(const Step& step, bool forward, TouchedElements& touchedOut);
+
+	///	resolves the ids of elements which were touched by apply and appends them to touchedOut.
+		void take_touched_elements(TouchedElements& touchedOut);
+	///	clears the touched ids and touchedOut after a failed replay.
+		void discard_touched_elements(TouchedElements& touchedOut);
+
+		bool remove_elements(const std::vector<ElemState>& elems, int level,
+							 TouchedElements& touchedOut);
+		bool restore_elements(const Step& step, const std::vector<ElemState>& elems,
+							  const std::vector<ug::vector3>& vrtPositions,
+							  int level, TouchedElements& touchedOut);
+		ug::GridObject* create_element(int roid, ug::Vertex* const* vrts,
+									   size_t numVrts);
+		void assign_id(ug::GridObject* e, unsigned int id);
+		void assign_state(ug::GridObject* e, int subset, int crease,
+						  ug::byte selected);
+		template <class TElem>
+		void assign_state(TElem* e, int subset, int crease, ug::byte selected);
+
+	///	passes a serialized record of step to the record function.
+		void record_step(const Step& step, bool forward);
+		static void write_step(std::string& out, const Step& step);
+		static bool read_step(const std::string& in, size_t& pos, Step& stepOut);
+		template <class TElem> void write_ids(std::string& idsOut);
+		template <class TElem> bool assign_ids(const std::string& ids, size_t& pos);
+
+	///	pushes step to the undo steps, clears the redo steps and enforces the budget.
+		void push_step(Step& step);
+
+	///	clears all recorded data and takes the current state as initial undo point.
+		void reset_history();
+
+	///	releases all data without accessing the grid.
+		void release_data();
+
+	private:
+		ug::Grid*			m_grid;
+		ug::SubsetHandler*	m_sh;
+		ug::SubsetHandler*	m_creaseHandler;
+		ug::Selector*		m_sel;
+		bool				m_replaying;
+		bool				m_selectionOnlyReplay;
+		int					m_idEpoch;
+		RecordFunc			m_recordFunc;
+
+		AElemInfo			m_aInfo;
+		ug::APosition		m_aCommittedPos;
+		ug::Grid::VertexAttachmentAccessor<AElemInfo>	m_aaInfoVRT;
+		ug::Grid::EdgeAttachmentAccessor<AElemInfo>		m_aaInfoEDGE;
+		ug::Grid::FaceAttachmentAccessor<AElemInfo>		m_aaInfoFACE;
+		ug::Grid::VolumeAttachmentAccessor<AElemInfo>	m_aaInfoVOL;
+		ug::Grid::VertexAttachmentAccessor<ug::APosition>	m_aaPos;
+		ug::Grid::VertexAttachmentAccessor<ug::APosition>	m_aaCommittedPos;
+
+	///	maps ids to elements (NULL for erased elements), one table per level
+		std::vector<ug::GridObject*>	m_elems[NUM_LEVELS];
+	///	ids of elements which were created since the last undo point
+		std::vector<unsigned int>		m_freshIds[NUM_LEVELS];
+	///	ids whose slot in m_elems was released. May contain ids which were taken again.
+		std::vector<unsigned int>		m_freeIds[NUM_LEVELS];
+	///	ids of elements whose geometry changed during the current replay
+		std::vector<unsigned int>		m_touchedIds[NUM_LEVELS];
+	///	elements which existed at the last undo point and were erased since
+		Step							m_pending;
+		SubsetInfoVec					m_shInfos;
+		SubsetInfoVec					m_creaseInfos;
+
+		std::deque<Step>	m_undoSteps;
+		std::vector<Step>	m_redoSteps;
+	///	memory used by the steps in m_undoSteps and m_redoSteps
+		size_t				m_historyBytes;
+};
+
+#endif	//__H__PROMESH_undo_journal
@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2026:  G-CSC, Goethe University Frankfurt
+ * Author: Sebastian Reiter
+ * 
+ * This file is part of ProMesh.
+ * 
+ * ProMesh is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License version 3 (as published by the
+ * Free Software Foundation) with the following additional attribution
+ * requirements (according to LGPL/GPL v3 §7):
+ * 
+ * (1) The following notice must be displayed in the Appropriate Legal Notices
+ * of covered and combined works: "Based on ProMesh (www.promesh3d.com)".
+ * 
+ * (2) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S. and Wittum, G. ProMesh -- a flexible interactive meshing software
+ *   for unstructured hybrid grids in 1, 2, and 3 dimensions. In preparation."
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#ifndef __H__PROMESH_mapped_file
+#define __H__PROMESH_mapped_file
+
+#include <cstddef>
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+
+///	Maps a file into memory for reading or reads it completely if it can't be mapped.
+class MappedFile
+{
+	public:
+		MappedFile() : m_mapped(NULL)	{}
+		~MappedFile()
+		{
+			if(m_mapped)
+				m_file.unmap(m_mapped);
+		}
+
+	///	returns false if the file can't be opened.
+		bool open(const char* filename)
+		{
+			m_file.setFileName(QString::fromLocal8Bit(filename));
+			if(!m_file.open(QIODevice::ReadOnly))
+				return false;
+			if(m_file.size() > 0)
+				m_mapped = m_file.map(0, m_file.size());
+			if(!m_mapped)
+				m_content = m_file.readAll();
+			return true;
+		}
+
+		const char* data() const
+		{
+			return m_mapped ? reinterpret_cast<const char*>(m_mapped)
+							: m_content.constData();
+		}
+
+		size_t size() const
+		{
+			return m_mapped ? (size_t)m_file.size() : (size_t)m_content.size();
+		}
+
+	private:
+		MappedFile(const MappedFile&);
+		MappedFile& operator=(const MappedFile&);
+
+	private:
+		QFile		m_file;
+		uchar*		m_mapped;
+		QByteArray	m_content;
+};
+
+#endif	//__H__PROMESH_mapped_file
@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2026:  G-CSC, Goethe University Frankfurt
+ * Author: Sebastian Reiter
+ * 
+ * This file is part of ProMesh.
+ * 
+ * ProMesh is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License version 3 (as published by the
+ * Free Software Foundation) with the following additional attribution
+ * requirements (according to LGPL/GPL v3 §7):
+ * 
+ * (1) The following notice must be displayed in the Appropriate Legal Notices
+ * of covered and combined works: "Based on ProMesh (www.promesh3d.com)".
+ * 
+ * (2) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S. and Wittum, G. ProMesh -- a flexible interactive meshing software
+ *   for unstructured hybrid grids in 1, 2, and 3 dimensions. In preparation."
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#ifndef __H__PROMESH_parallel_util
+#define __H__PROMESH_parallel_util
+
+#include <algorithm>
+#include <exception>
+#include <thread>
+#include <utility>
+#include <vector>
+
+///	Number of threads which are used by the parallel helpers below (at least 1).
+inline unsigned int NumWorkerThreads()
+{
+	unsigned int num = std::thread::hardware_concurrency();
+	return num > 0 ? num : 1;
+}
+
+///	Returns the number of chunks into which ParallelForChunks splits numItems items.
+inline size_t NumParallelChunks(size_t numItems, size_t minChunkSize)
+{
+	if(numItems == 0)
+		return 0;
+	minChunkSize = std::max<size_t>(minChunkSize, 1);
+	size_t numChunks = (numItems + minChunkSize - 1) / minChunkSize;
+	return std::min<size_t>(numChunks, NumWorkerThreads());
+}
+
+///	Splits [0, numItems) into contiguous chunks and processes them concurrently.
+/**	func is called as func(chunkIndex, begin, end) for each chunk. Chunk 0 is
+ * processed on the calling thread. Chunks are ordered, i.e. results which are
+ * gathered per chunk can be concatenated in chunk order to obtain a
+ * deterministic result. If a chunk throws, the first exception is rethrown
+ * on the calling thread after all chunks finished.
+ *
+ * \return the number of chunks which were processed (see NumParallelChunks).*/
+template <class TFunc>
+size_t ParallelForChunks(size_t numItems, size_t minChunkSize, TFunc func)
+{
+	const size_t numChunks = NumParallelChunks(numItems, minChunkSize);
+	if(numChunks == 0)
+		return 0;
+
+	const size_t chunkSize = (numItems + numChunks - 1) / numChunks;
+	if(numChunks == 1){
+		func(size_t(0), size_t(0), numItems);
+		return 1;
+	}
+
+	std::vector<std::exception_ptr> errors(numChunks);
+	std::vector<std::thread> threads;
+	threads.reserve(numChunks - 1);
+
+	for(size_t i = 1; i < numChunks; ++i){
+		const size_t begin = std::min(i * chunkSize, numItems);
+		const size_t end = std::min(begin + chunkSize, numItems);
+		threads.push_back(std::thread([&func, &errors, i, begin, end](){
+			try{
+				func(i, begin, end);
+			}
+			catch(...){
+				errors[i] = std::current_exception();
+			}
+		}));
+	}
+
+	try{
+		func(size_t(0), size_t(0), std::min(chunkSize, numItems));
+	}
+	catch(...){
+		errors[0] = std::current_exception();
+	}
+
+	for(size_t i = 0; i < threads.size(); ++i)
+		threads[i].join();
+
+	for(size_t i = 0; i < errors.size(); ++i){
+		if(errors[i])
+			std::rethrow_exception(errors[i]);
+	}
+	return numChunks;
+}
+
+///	Appends ranges of at most maxChunkSize elements which cover [begin, end) to chunksOut.
+/**	Useful to process non random-access ranges (e.g. ug::Grid iterators) with
+ * ParallelForChunks. The range is walked once.*/
+template <class TIter>
+void CollectIteratorChunks(std::vector<std::pair<TIter, TIter> >& chunksOut,
+						   TIter begin, TIter end, size_t maxChunkSize)
+{
+	maxChunkSize = std::max<size_t>(maxChunkSize, 1);
+	while(begin != end){
+		TIter chunkEnd = begin;
+		for(size_t i = 0; i < maxChunkSize && chunkEnd != end; ++i)
+			++chunkEnd;
+		chunksOut.push_back(std::make_pair(begin, chunkEnd));
+		begin = chunkEnd;
+	}
+}
+
+#endif	//__H__PROMESH_parallel_util
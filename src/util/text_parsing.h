@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2026:  G-CSC, Goethe University Frankfurt
+ * Author: Sebastian Reiter
+ * 
+ * This file is part of ProMesh.
+ * 
+ * ProMesh is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License version 3 (as published by the
+ * Free Software Foundation) with the following additional attribution
+ * requirements (according to LGPL/GPL v3 §7):
+ * 
+ * (1) The following notice must be displayed in the Appropriate Legal Notices
+ * of covered and combined works: "Based on ProMesh (www.promesh3d.com)".
+ * 
+ * (2) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S. and Wittum, G. ProMesh -- a flexible interactive meshing software
+ *   for unstructured hybrid grids in 1, 2, and 3 dimensions. In preparation."
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#ifndef __H__PROMESH_text_parsing
+#define __H__PROMESH_text_parsing
+
+#include <cstring>
+#include <stdint.h>
+#include <QByteArray>
+
+//	helpers for parsers which work on a memory range [p, end) of a text file.
+
+inline bool IsSpace(char c)
+{
+	return c == ' ' || c == '\t' || c == '\r';
+}
+
+inline bool IsDigit(char c)
+{
+	return c >= '0' && c <= '9';
+}
+
+inline const char* SkipSpaces(const char* p, const char* end)
+{
+	while(p < end && IsSpace(*p))
+		++p;
+	return p;
+}
+
+inline const char* FindLineEnd(const char* p, const char* end)
+{
+	const char* lineEnd = static_cast<const char*>(memchr(p, '\n', end - p));
+	return lineEnd ? lineEnd : end;
+}
+
+inline const char* NextLine(const char* lineEnd, const char* end)
+{
+	return lineEnd < end ? lineEnd + 1 : end;
+}
+
+///	parses a floating point number independently of the current locale.
+/**	Returns the position behind the number or NULL if there is no number.
+ * Numbers with at most 15 significant digits and an exponent of at most 22
+ * are converted exactly by a single multiplication or division. All others
+ * are converted by QByteArray::toDouble.*/
+inline const char* ParseNumber(const char* p, const char* end, double& valOut)
+{
+	static const double POW10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+								   1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19,
+								   1e20, 1e21, 1e22};
+
+	const char* start = p;
+	bool negative = false;
+	if(p < end && (*p == '-' || *p == '+')){
+		negative = (*p == '-');
+		++p;
+	}
+
+	uint64_t mantissa = 0;
+	int numDigits = 0;
+	int exponent = 0;
+	bool gotDigits = false;
+	for(; p < end && IsDigit(*p); ++p){
+		gotDigits = true;
+		if(numDigits < 19){
+			mantissa = mantissa * 10 + (*p - '0');
+			if(mantissa)
+				++numDigits;
+		}
+		else
+			++exponent;
+	}
+	if(p < end && *p == '.'){
+		for(++p; p < end && IsDigit(*p); ++p){
+			gotDigits = true;
+			if(numDigits < 19){
+				mantissa = mantissa * 10 + (*p - '0');
+				if(mantissa)
+					++numDigits;
+				--exponent;
+			}
+		}
+	}
+	if(!gotDigits)
+		return NULL;
+
+	if(p < end && (*p == 'e' || *p == 'E')){
+		const char* q = p + 1;
+		bool negativeExp = false;
+		if(q < end && (*q == '-' || *q == '+')){
+			negativeExp = (*q == '-');
+			++q;
+		}
+		if(q < end && IsDigit(*q)){
+			int e = 0;
+			for(; q < end && IsDigit(*q); ++q){
+				if(e < 10000)
+					e = e * 10 + (*q - '0');
+			}
+			exponent += negativeExp ? -e : e;
+			p = q;
+		}
+	}
+
+	if(numDigits <= 15 && exponent >= -22 && exponent <= 22){
+		double val = (double)mantissa;
+		if(exponent < 0)
+			val /= POW10[-exponent];
+		else
+			val *= POW10[exponent];
+		valOut = negative ? -val : val;
+		return p;
+	}
+
+	bool ok = false;
+	valOut = QByteArray(start, (int)(p - start)).toDouble(&ok);
+	return ok ? p : NULL;
+}
+
+///	parses a decimal integer. Returns the position behind it or NULL if there is none.
+inline const char* ParseInt(const char* p, const char* end, int64_t& valOut)
+{
+	bool negative = false;
+	if(p < end && (*p == '-' || *p == '+')){
+		negative = (*p == '-');
+		++p;
+	}
+	if(p >= end || !IsDigit(*p))
+		return NULL;
+
+	int64_t val = 0;
+	for(; p < end && IsDigit(*p); ++p){
+		if(val > (int64_t(1) << 53))
+			return NULL;
+		val = val * 10 + (*p - '0');
+	}
+	valOut = negative ? -val : val;
+	return p;
+}
+
+#endif	//__H__PROMESH_text_parsing
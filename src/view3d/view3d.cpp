@@ -45,6 +45,8 @@ View3D::View3D(QWidget *parent) :
 	m_zFar = 1000.f;
 
 	m_bDrawSelRect = false;
+	m_hoverPicking = false;
+	m_hoverEventPending = false;
 
 	m_pRenderer = NULL;
 	setFormat(QGLFormat(QGL::DoubleBuffer | QGL::DepthBuffer));
@@ -504,9 +506,46 @@ void View3D::mouseMoveEvent(QMouseEvent *event)
 		updateGL();
 	}
 
+	if(m_hoverPicking && scaledEvent->buttons() == Qt::NoButton){
+		m_hoverPos = scaledEvent->pos();
+		if(!m_hoverEventPending){
+			m_hoverEventPending = true;
+			QTimer::singleShot(0, this, SLOT(emit_hover()));
+		}
+	}
+
 	emit View3D::mouseMoved(scaledEvent);
 }
 
+void View3D::emit_hover()
+{
+	if(!m_hoverEventPending)
+		return;
+	m_hoverEventPending = false;
+	emit mouseHovered(m_hoverPos.x(), m_hoverPos.y());
+}
+
+void View3D::leaveEvent(QEvent* event)
+{
+	if(m_hoverPicking){
+		m_hoverEventPending = false;
+		emit hoverLeft();
+	}
+	QGLWidget::leaveEvent(event);
+}
+
+void View3D::set_hover_picking_enabled(bool enable)
+{
+	if(m_hoverPicking == enable)
+		return;
+
+	m_hoverPicking = enable;
+	m_hoverEventPending = false;
+	setMouseTracking(enable);
+	if(!enable)
+		emit hoverLeft();
+}
+
 void View3D::mouseReleaseEvent(QMouseEvent *event)
 {
 	QMouseEvent* scaledEvent = new QMouseEvent(QEvent::MouseButtonPress,
@@ -79,11 +79,23 @@ class View3D : public QGLWidget
 	///	if bDrawIt is true, the view will draw a the given rect until the method is called with bDrawIt == false.
 		void drawSelectionRect(bool bDrawIt, float xMin = 0, float yMin = 0,
 								 float xMax = 0, float yMax = 0);
+
+	///	enables or disables hover picking.
+	/**	If enabled, mouse moves without pressed buttons are reported through
+	 *	mouseHovered. Consecutive moves are merged, so that at most one
+	 *	mouseHovered signal is emitted per iteration of the event loop.*/
+		void set_hover_picking_enabled(bool enable);
+		bool hover_picking_enabled() const		{return m_hoverPicking;}
+
 	signals:
 		void mousePressed(QMouseEvent* event);
 		void mouseMoved(QMouseEvent* event);
 		void mouseReleased(QMouseEvent* event);
 		void keyReleased(QKeyEvent* event);
+	///	emitted if hover picking is enabled. Coordinates are scaled like those of mouseMoved.
+		void mouseHovered(int x, int y);
+	///	emitted if hover picking is enabled and the mouse left the view
+		void hoverLeft();
 
 	protected:
 	//	derived from QGLWidget
@@ -96,6 +108,7 @@ class View3D : public QGLWidget
 		void wheelEvent(QWheelEvent *event);
 		void mouseDoubleClickEvent(QMouseEvent *event);
 		void keyReleaseEvent(QKeyEvent * event);
+		void leaveEvent(QEvent* event);
 
 	//	helper methods
 		unsigned int get_camera_drag_flags();
@@ -105,6 +118,7 @@ class View3D : public QGLWidget
 	//	slots
 	protected slots:
 		void interpolate_cam_states();
+		void emit_hover();
 
 	protected:
 	//	camera
@@ -132,6 +146,11 @@ class View3D : public QGLWidget
 		bool m_bDrawSelRect;
 		cam::vector2 m_selRectMin;
 		cam::vector2 m_selRectMax;
+
+	//	hover picking
+		bool	m_hoverPicking;
+		bool	m_hoverEventPending;
+		QPoint	m_hoverPos;
 };
 
 #endif
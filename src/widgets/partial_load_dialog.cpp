@@ -0,0 +1,194 @@
+/*
+ * Copyright (c) 2026:  G-CSC, Goethe University Frankfurt
+ * Author: Sebastian Reiter
+ * 
+ * This file is part of ProMesh.
+ * 
+ * ProMesh is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License version 3 (as published by the
+ * Free Software Foundation) with the following additional attribution
+ * requirements (according to LGPL/GPL v3 §7):
+ * 
+ * (1) The following notice must be displayed in the Appropriate Legal Notices
+ * of covered and combined works: "Based on ProMesh (www.promesh3d.com)".
+ * 
+ * (2) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S. and Wittum, G. ProMesh -- a flexible interactive meshing software
+ *   for unstructured hybrid grids in 1, 2, and 3 dimensions. In preparation."
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include <algorithm>
+#include <QtWidgets>
+#include "truncated_double_spin_box.h"
+#include "partial_load_dialog.h"
+
+///	index of the entry of unassigned elements in the subset list
+static const int UNASSIGNED_SUBSET = -1;
+
+static QString ElementCountText(const MeshFileSubsetSummary& s)
+{
+	return QString("%1 / %2 / %3 / %4")
+			.arg(s.numElems[0]).arg(s.numElems[1])
+			.arg(s.numElems[2]).arg(s.numElems[3]);
+}
+
+static QString BoxText(const MeshFileSubsetSummary& s)
+{
+	if(!s.hasBox)
+		return QString("-");
+	return QString("(%1, %2, %3) - (%4, %5, %6)")
+			.arg(s.boxMin.x()).arg(s.boxMin.y()).arg(s.boxMin.z())
+			.arg(s.boxMax.x()).arg(s.boxMax.y()).arg(s.boxMax.z());
+}
+
+static QTreeWidgetItem* CreateSubsetItem(QTreeWidget* list, const QString& name,
+										 const MeshFileSubsetSummary& s, int si)
+{
+	QTreeWidgetItem* item = new QTreeWidgetItem(list);
+	item->setText(0, name);
+	item->setText(1, ElementCountText(s));
+	item->setText(2, BoxText(s));
+	item->setData(0, Qt::UserRole, si);
+	item->setCheckState(0, Qt::Checked);
+	if(s.color.w() >= 0){
+		QPixmap pixmap(12, 12);
+		pixmap.fill(QColor::fromRgbF(s.color.x(), s.color.y(), s.color.z()));
+		item->setIcon(0, QIcon(pixmap));
+	}
+	return item;
+}
+
+PartialLoadDialog::
+PartialLoadDialog(QWidget* parent, const QString& filename,
+				  const MeshFileSummary& summary) :
+	QDialog(parent)
+{
+	setWindowTitle(tr("Load Partially"));
+
+	QVBoxLayout* vLayout = new QVBoxLayout(this);
+	vLayout->addWidget(new QLabel(tr("Choose the subsets and the region of '%1' which shall be loaded.")
+									.arg(QFileInfo(filename).fileName()), this));
+
+//	subsets
+	m_subsetList = new QTreeWidget(this);
+	m_subsetList->setColumnCount(3);
+	m_subsetList->setRootIsDecorated(false);
+	m_subsetList->setHeaderLabels(QStringList() << tr("subset")
+												<< tr("vrts / edges / faces / vols")
+												<< tr("bounding box"));
+	for(size_t i = 0; i < summary.subsets.size(); ++i){
+		CreateSubsetItem(m_subsetList, QString::fromStdString(summary.subsets[i].name),
+						 summary.subsets[i], (int)i);
+	}
+	const MeshFileSubsetSummary& unassigned = summary.unassigned;
+	if(unassigned.numElems[0] + unassigned.numElems[1]
+	   + unassigned.numElems[2] + unassigned.numElems[3] > 0)
+	{
+		CreateSubsetItem(m_subsetList, tr("(no subset)"), unassigned, UNASSIGNED_SUBSET);
+	}
+	m_subsetList->resizeColumnToContents(0);
+	m_subsetList->resizeColumnToContents(1);
+	vLayout->addWidget(m_subsetList);
+
+	QHBoxLayout* subsetBtnLayout = new QHBoxLayout();
+	QPushButton* btn = new QPushButton(tr("Select All"), this);
+	connect(btn, SIGNAL(clicked()), this, SLOT(selectAllSubsets()));
+	subsetBtnLayout->addWidget(btn);
+	btn = new QPushButton(tr("Deselect All"), this);
+	connect(btn, SIGNAL(clicked()), this, SLOT(deselectAllSubsets()));
+	subsetBtnLayout->addWidget(btn);
+	subsetBtnLayout->addStretch();
+	vLayout->addLayout(subsetBtnLayout);
+
+//	region. Initialized with the bounding box of the whole file.
+	m_useBox = new QCheckBox(tr("only load elements whose center lies in the box"), this);
+	connect(m_useBox, SIGNAL(toggled(bool)), this, SLOT(useBoxToggled(bool)));
+	vLayout->addWidget(m_useBox);
+
+	QGridLayout* boxLayout = new QGridLayout();
+	const char* coordNames[] = {"x", "y", "z"};
+	boxLayout->addWidget(new QLabel(tr("min:"), this), 1, 0);
+	boxLayout->addWidget(new QLabel(tr("max:"), this), 2, 0);
+	for(int i = 0; i < 3; ++i){
+		boxLayout->addWidget(new QLabel(tr(coordNames[i]), this), 0, i + 1);
+		TruncatedDoubleSpinBox** boxes[] = {m_boxMin, m_boxMax};
+		const ug::vector3* values[] = {&summary.total.boxMin, &summary.total.boxMax};
+		for(int j = 0; j < 2; ++j){
+			TruncatedDoubleSpinBox* spin = new TruncatedDoubleSpinBox(this);
+			spin->setLocale(QLocale(tr("C")));
+			spin->setDecimals(9);
+			spin->setRange(-1e+9, 1e+9);
+			spin->setSingleStep(1.);
+			spin->setValue((*values[j])[i]);
+			spin->setEnabled(false);
+			boxLayout->addWidget(spin, j + 1, i + 1);
+			boxes[j][i] = spin;
+		}
+	}
+	vLayout->addLayout(boxLayout);
+
+//	create ok and cancel buttons
+	QDialogButtonBox* buttons = new QDialogButtonBox(QDialogButtonBox::Ok
+													 | QDialogButtonBox::Cancel,
+													 Qt::Horizontal, this);
+	connect(buttons, SIGNAL(accepted()), this, SLOT(accept()));
+	connect(buttons, SIGNAL(rejected()), this, SLOT(reject()));
+	vLayout->addWidget(buttons);
+
+	resize(600, 400);
+}
+
+PartialLoadFilter PartialLoadDialog::
+filter() const
+{
+	PartialLoadFilter filter;
+	for(int i = 0; i < m_subsetList->topLevelItemCount(); ++i){
+		QTreeWidgetItem* item = m_subsetList->topLevelItem(i);
+		if(item->checkState(0) == Qt::Checked)
+			filter.subsets.push_back(item->data(0, Qt::UserRole).toInt());
+		else
+			filter.useSubsets = true;
+	}
+	std::sort(filter.subsets.begin(), filter.subsets.end());
+
+	filter.useBox = m_useBox->isChecked();
+	for(int i = 0; i < 3; ++i){
+		filter.boxMin[i] = m_boxMin[i]->value();
+		filter.boxMax[i] = m_boxMax[i]->value();
+	}
+	return filter;
+}
+
+void PartialLoadDialog::
+selectAllSubsets()
+{
+	set_all_subsets_checked(true);
+}
+
+void PartialLoadDialog::
+deselectAllSubsets()
+{
+	set_all_subsets_checked(false);
+}
+
+void PartialLoadDialog::
+useBoxToggled(bool checked)
+{
+	for(int i = 0; i < 3; ++i){
+		m_boxMin[i]->setEnabled(checked);
+		m_boxMax[i]->setEnabled(checked);
+	}
+}
+
+void PartialLoadDialog::
+set_all_subsets_checked(bool checked)
+{
+	for(int i = 0; i < m_subsetList->topLevelItemCount(); ++i)
+		m_subsetList->topLevelItem(i)->setCheckState(0, checked ? Qt::Checked : Qt::Unchecked);
+}
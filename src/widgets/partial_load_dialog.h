@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2026:  G-CSC, Goethe University Frankfurt
+ * Author: Sebastian Reiter
+ * 
+ * This file is part of ProMesh.
+ * 
+ * ProMesh is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License version 3 (as published by the
+ * Free Software Foundation) with the following additional attribution
+ * requirements (according to LGPL/GPL v3 §7):
+ * 
+ * (1) The following notice must be displayed in the Appropriate Legal Notices
+ * of covered and combined works: "Based on ProMesh (www.promesh3d.com)".
+ * 
+ * (2) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S. and Wittum, G. ProMesh -- a flexible interactive meshing software
+ *   for unstructured hybrid grids in 1, 2, and 3 dimensions. In preparation."
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#ifndef __H__PROMESH_partial_load_dialog
+#define __H__PROMESH_partial_load_dialog
+
+#include <QDialog>
+#include "../scene/partial_load.h"
+
+class QCheckBox;
+class QTreeWidget;
+class TruncatedDoubleSpinBox;
+
+///	Lets the user choose the subsets and the region of a mesh file which shall be loaded.
+/**	The dialog lists the subsets of a file together with their element
+ * counts and bounding boxes, as returned by ReadMeshFileSummary.*/
+class PartialLoadDialog : public QDialog
+{
+	Q_OBJECT
+
+	public:
+		PartialLoadDialog(QWidget* parent, const QString& filename,
+						  const MeshFileSummary& summary);
+
+	///	returns the filter which corresponds to the current choice of the user.
+		PartialLoadFilter filter() const;
+
+	protected slots:
+		void selectAllSubsets();
+		void deselectAllSubsets();
+		void useBoxToggled(bool checked);
+
+	private:
+		void set_all_subsets_checked(bool checked);
+
+	private:
+		QTreeWidget*			m_subsetList;
+		QCheckBox*				m_useBox;
+		TruncatedDoubleSpinBox*	m_boxMin[3];
+		TruncatedDoubleSpinBox*	m_boxMax[3];
+};
+
+#endif	//__H__PROMESH_partial_load_dialog